@@ -17,7 +17,8 @@ typedef struct {
     uint8_t action;         // 0=None, 1=Send, 2=Restore
     uint8_t backspace;      // Characters to delete
     uint8_t count;          // Valid chars count
-    uint8_t flags;          // 0x01 = key consumed
+    uint8_t flags;          // 0x01 = key consumed, 0x02 = passthrough filled in
+    uint64_t passthrough[2]; // Keycodes (< 128) that are no-ops after this key
 } ImeResult;
 
 // Core lifecycle
@@ -0,0 +1,108 @@
+// ViKey - App State Journal Benchmark
+// bench_app_state.cpp
+// Latency of one smart-switch state save on the hook thread: writing it out
+// synchronously, as the registry path did, against queueing it for the journal
+
+#include "bench_common.h"
+#include "app_state_journal.h"
+#include "binary_io.h"
+#include <fcntl.h>
+#include <unistd.h>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+static const int FOCUS_CHANGES = 2000;
+static const int APPS = 40;
+static const auto KEYS_BETWEEN = std::chrono::microseconds(200);  // typing between focus changes
+
+struct Latency {
+    std::vector<double> micros;
+
+    void Report(const char* name) {
+        std::sort(micros.begin(), micros.end());
+        auto at = [&](double p) { return micros[static_cast<size_t>(p * (micros.size() - 1))]; };
+        double sum = 0;
+        for (double m : micros) sum += m;
+        std::printf("%-34s p50 %8.2f  p99 %8.2f  p99.9 %8.2f  max %8.2f  total %8.1f ms\n", name, at(0.5), at(0.99),
+                    at(0.999), micros.back(), sum / 1000);
+    }
+};
+
+// The hook keeps typing between focus changes; only the save itself is timed
+template <typename Save>
+static Latency Run(Save&& save) {
+    Latency latency;
+    latency.micros.reserve(FOCUS_CHANGES);
+    for (int i = 0; i < FOCUS_CHANGES; i++) {
+        std::wstring app = L"app" + std::to_wstring(i % APPS) + L".exe";
+        auto start = std::chrono::steady_clock::now();
+        save(app, (i / APPS) % 2 == 0);
+        auto end = std::chrono::steady_clock::now();
+        latency.micros.push_back(std::chrono::duration<double, std::micro>(end - start).count());
+        while (std::chrono::steady_clock::now() - end < KEYS_BETWEEN) {
+        }
+    }
+    return latency;
+}
+
+// One open, write and close per change, like RegCreateKeyExW/RegSetValueExW/RegCloseKey
+static void SaveSynchronously(const fs::path& path, const std::wstring& app, bool enabled, bool sync) {
+    std::string record(2 + 2 * Utf16Length(app) + 4, '\0');
+    PutU32(PutText(PutU16(&record[0], static_cast<uint32_t>(Utf16Length(app))), app), enabled ? 1 : 0);
+    int fd = open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND, 0644);
+    if (fd < 0) return;
+    if (write(fd, record.data(), record.size()) < 0) std::perror("write");
+    if (sync) fdatasync(fd);
+    close(fd);
+}
+
+int main() {
+    fs::path dir = fs::temp_directory_path();
+    std::printf("%d focus changes over %d apps, latency of the save in us\n", FOCUS_CHANGES, APPS);
+
+    fs::path syncPath = dir / "vikey_bench_sync.dat";
+    fs::remove(syncPath);
+    Run([&](const std::wstring& app, bool enabled) { SaveSynchronously(syncPath, app, enabled, false); })
+        .Report("synchronous write");
+    Run([&](const std::wstring& app, bool enabled) { SaveSynchronously(syncPath, app, enabled, true); })
+        .Report("synchronous write + fdatasync");
+    fs::remove(syncPath);
+
+    fs::path journalPath = dir / "vikey_bench_appstates.journal";
+    fs::remove(journalPath);
+    {
+        // Small compaction threshold, so rewrites happen while the hook is saving
+        AppStateJournal journal(journalPath, 128);
+        AppStateMap states;
+        journal.Load(states);
+        AppStateMap memory;
+        Run([&](const std::wstring& app, bool enabled) {
+            // What AppDetector::SaveAppState() does now
+            auto it = memory.find(app);
+            if (it != memory.end() && it->second.enabled == enabled) return;
+            memory[app].enabled = enabled;
+            journal.RecordEnabled(app, enabled);
+        }).Report("journal (map + queue)");
+
+        double flush = BenchBestSeconds([&]() { journal.Flush(); }, 1);
+        AppStateJournal::Stats stats = journal.GetStats();
+        std::printf("  %ju records, %ju appended in %ju batches, %ju compactions, %ju failures; exit flush %.2f ms\n",
+                    static_cast<uintmax_t>(stats.records), static_cast<uintmax_t>(stats.appended),
+                    static_cast<uintmax_t>(stats.batches), static_cast<uintmax_t>(stats.compactions),
+                    static_cast<uintmax_t>(stats.failures), flush * 1000);
+    }
+
+    // Startup: one read and replay
+    size_t apps = 0;
+    double load = BenchBestSeconds([&]() {
+        AppStateJournal journal(journalPath);
+        AppStateMap states;
+        journal.Load(states);
+        apps = states.size();
+    }, 20);
+    std::printf("  load: %zu apps from %ju bytes in %.1f us\n", apps, static_cast<uintmax_t>(fs::file_size(journalPath)),
+                load * 1e6);
+    fs::remove(journalPath);
+    return 0;
+}
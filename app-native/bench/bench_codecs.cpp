@@ -0,0 +1,44 @@
+// ViKey - Codec Throughput Benchmark
+// bench_codecs.cpp
+// Compares the legacy codecs: two-byte VNI, single-byte TCVN3/VISCII, VIQR mnemonics and UTF-8 bytes
+
+#include "bench_common.h"
+#include "encoding_converter.h"
+
+int main() {
+    EncodingConverter& conv = EncodingConverter::Instance();
+    const std::wstring unicode = BenchCorpus(4 * 1024 * 1024);
+    const std::wstring vni = conv.Convert(unicode, VietEncoding::Unicode, VietEncoding::VNI_Windows);
+    const std::wstring tcvn3 = conv.Convert(unicode, VietEncoding::Unicode, VietEncoding::TCVN3);
+    const std::wstring viscii = conv.Convert(unicode, VietEncoding::Unicode, VietEncoding::VISCII);
+    const std::wstring viqr = conv.Convert(unicode, VietEncoding::Unicode, VietEncoding::VIQR);
+    const std::wstring utf8 = conv.Convert(unicode, VietEncoding::Unicode, VietEncoding::UTF8_Bytes);
+
+    struct Case {
+        const char* name;
+        const std::wstring* input;
+        VietEncoding from;
+        VietEncoding to;
+    };
+    const Case cases[] = {
+        {"Unicode -> VNI", &unicode, VietEncoding::Unicode, VietEncoding::VNI_Windows},
+        {"VNI -> Unicode", &vni, VietEncoding::VNI_Windows, VietEncoding::Unicode},
+        {"Unicode -> TCVN3", &unicode, VietEncoding::Unicode, VietEncoding::TCVN3},
+        {"TCVN3 -> Unicode", &tcvn3, VietEncoding::TCVN3, VietEncoding::Unicode},
+        {"Unicode -> VISCII", &unicode, VietEncoding::Unicode, VietEncoding::VISCII},
+        {"VISCII -> Unicode", &viscii, VietEncoding::VISCII, VietEncoding::Unicode},
+        {"Unicode -> VIQR", &unicode, VietEncoding::Unicode, VietEncoding::VIQR},
+        {"VIQR -> Unicode", &viqr, VietEncoding::VIQR, VietEncoding::Unicode},
+        {"Unicode -> UTF-8 bytes", &unicode, VietEncoding::Unicode, VietEncoding::UTF8_Bytes},
+        {"UTF-8 bytes -> Unicode", &utf8, VietEncoding::UTF8_Bytes, VietEncoding::Unicode},
+    };
+
+    std::printf("Corpus: %zu characters\n", unicode.size());
+    for (const Case& c : cases) {
+        size_t sink = 0;
+        double s = BenchBestSeconds([&]() { sink += conv.Convert(*c.input, c.from, c.to).size(); });
+        BenchReportThroughput(c.name, c.input->size(), s);
+        if (sink == 0) std::printf("(empty output)\n");
+    }
+    return 0;
+}
@@ -0,0 +1,47 @@
+// ViKey - Benchmark Helpers
+// bench_common.h
+// Timing and corpus helpers shared by the standalone native benchmarks
+
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <string>
+
+// Sample text covering every Vietnamese letter group, tone and case
+inline const wchar_t* BenchSampleText() {
+    return L"Tiếng Việt là ngôn ngữ chính thức của nước Cộng hòa Xã hội chủ nghĩa Việt Nam. "
+           L"Trăm năm trong cõi người ta, chữ tài chữ mệnh khéo là ghét nhau. "
+           L"Đường vô xứ Nghệ quanh quanh, non xanh nước biếc như tranh họa đồ. "
+           L"HÀ NỘI, ĐÀ NẴNG, HUẾ: kỹ sư, tỷ lệ, lý do, ỷ lại, ướt áo, ừ ử.\n";
+}
+
+// Repeat the sample text until it reaches at least minChars characters
+inline std::wstring BenchCorpus(size_t minChars) {
+    std::wstring sample = BenchSampleText();
+    std::wstring corpus;
+    corpus.reserve(minChars + sample.size());
+    while (corpus.size() < minChars) corpus += sample;
+    return corpus;
+}
+
+// Run fn repeatedly and return the best wall time per run in seconds
+template <typename Fn>
+double BenchBestSeconds(Fn&& fn, int runs = 5) {
+    double best = 1e30;
+    for (int i = 0; i < runs; i++) {
+        auto start = std::chrono::steady_clock::now();
+        fn();
+        double s = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        best = std::min(best, s);
+    }
+    return best;
+}
+
+// Print one throughput line: name, characters/s, MiB/s of wchar_t input
+inline void BenchReportThroughput(const char* name, size_t chars, double seconds) {
+    double mchars = chars / seconds / 1e6;
+    double mib = chars * sizeof(wchar_t) / seconds / (1024.0 * 1024.0);
+    std::printf("%-28s %9.1f Mchar/s %9.1f MiB/s\n", name, mchars, mib);
+}
@@ -0,0 +1,86 @@
+// ViKey - Rust Core for Benchmarks
+// bench_core.h
+// The core static library (VIKEY_CORE_LIB) bound to a CoreEngine, the same
+// key path RustBridge runs over core.dll
+
+#pragma once
+
+#include "core_api.h"
+#include "core_engine.h"
+#include "settings_snapshot.h"
+
+// The exports, linked statically; their signatures are core_api.h's
+extern "C" {
+ImeInitFn ime_init;
+ImeWarmupFn ime_warmup;
+ImeClearFn ime_clear;
+ImeClearAllFn ime_clear_all;
+ImeFreeFn ime_free;
+ImeSnapshotFn ime_snapshot;
+ImeRestoreFn ime_restore;
+ImeMethodFn ime_method;
+ImeFlagFn ime_enabled;
+ImeFlagFn ime_modern;
+ImeFlagFn ime_english_auto_restore;
+ImeFlagFn ime_auto_capitalize;
+ImeFlagFn ime_skip_w_shortcut;
+ImeFlagFn ime_bracket_shortcut;
+ImeFlagFn ime_esc_restore;
+ImeFlagFn ime_free_tone;
+ImeFlagFn ime_allow_foreign_consonants;
+ImeAddShortcutFn ime_add_shortcut;
+ImeRemoveShortcutFn ime_remove_shortcut;
+ImeClearShortcutsFn ime_clear_shortcuts;
+ImeKeyFn ime_key;
+ImeKeyExtFn ime_key_ext;
+ImeReplayFn ime_replay;
+}
+
+inline CoreApi StaticCoreApi() {
+    CoreApi api;
+    api.ime_init = ime_init;
+    api.ime_warmup = ime_warmup;
+    api.ime_clear = ime_clear;
+    api.ime_clear_all = ime_clear_all;
+    api.ime_free = ime_free;
+    api.ime_snapshot = ime_snapshot;
+    api.ime_restore = ime_restore;
+    api.ime_method = ime_method;
+    api.ime_enabled = ime_enabled;
+    api.ime_modern = ime_modern;
+    api.ime_english_auto_restore = ime_english_auto_restore;
+    api.ime_auto_capitalize = ime_auto_capitalize;
+    api.ime_skip_w_shortcut = ime_skip_w_shortcut;
+    api.ime_bracket_shortcut = ime_bracket_shortcut;
+    api.ime_esc_restore = ime_esc_restore;
+    api.ime_free_tone = ime_free_tone;
+    api.ime_allow_foreign_consonants = ime_allow_foreign_consonants;
+    api.ime_add_shortcut = ime_add_shortcut;
+    api.ime_remove_shortcut = ime_remove_shortcut;
+    api.ime_clear_shortcuts = ime_clear_shortcuts;
+    api.ime_key = ime_key;
+    api.ime_key_ext = ime_key_ext;
+    api.ime_replay = ime_replay;
+    return api;
+}
+
+// A freshly initialized core behind `engine`, set up the way RustBridge's
+// Initialize() and ImeProcessor::ApplySettings set it up. One engine at a
+// time: the core keeps a single global state.
+inline void StartCoreEngine(CoreEngine& engine, const SettingsSnapshot& settings) {
+    engine.Bind(StaticCoreApi());
+    ime_init();
+    engine.SetEnabled(settings.enabled);
+    engine.SetMethod(settings.method);
+    engine.ApplySettings(settings);
+    engine.ClearAll();
+}
+
+// The app's default settings with another input method, tone style and cache
+inline SettingsSnapshot BenchSettings(InputMethod method, bool modernTone, bool resultCache) {
+    SettingsSnapshot settings;
+    settings.method = method;
+    settings.modernTone = modernTone;
+    settings.resultCache = resultCache;
+    return settings;
+}
@@ -0,0 +1,26 @@
+// ViKey - Encoding Detection Benchmark
+// bench_detect.cpp
+// Time to classify a 1 MiB sample in each encoding
+
+#include "bench_common.h"
+#include "encoding_converter.h"
+
+int main() {
+    const VietEncoding encodings[] = {
+        VietEncoding::Unicode, VietEncoding::VNI_Windows, VietEncoding::TCVN3, VietEncoding::Unicode_Comp,
+        VietEncoding::VISCII, VietEncoding::VIQR,
+    };
+    const std::wstring unicode = BenchCorpus(1024 * 1024);
+
+    for (VietEncoding enc : encodings) {
+        std::wstring text = EncodingConverter::Instance().Convert(unicode, VietEncoding::Unicode, enc);
+        std::string bytes = EncodingConverter::EncodeBytes(text, enc);
+        bytes.resize(1024 * 1024);
+
+        std::vector<EncodingGuess> guesses;
+        double s = BenchBestSeconds([&]() { guesses = EncodingConverter::DetectBytes(bytes.data(), bytes.size()); }, 20);
+        std::printf("%-20ls 1 MiB in %7.1f us -> %ls (%.0f%%)\n", EncodingConverter::GetEncodingName(enc), s * 1e6,
+                    EncodingConverter::GetEncodingName(guesses[0].encoding), guesses[0].confidence * 100);
+    }
+    return 0;
+}
@@ -0,0 +1,81 @@
+// ViKey - Exclusion Matcher Benchmark
+// bench_exclusion.cpp
+// One exclusion check per focus change against 1000 rules: the old
+// copy-and-lowercase scan, the compiled rules, and the per-app cached verdict
+
+#include "bench_common.h"
+#include "exclusion_matcher.h"
+#include <cwctype>
+#include <vector>
+
+static const int RULES = 1000;
+static const int APPS = 200;
+static const int CHECKS = 200000;
+
+// Mixed case, as users type them into the dialog
+static std::vector<std::wstring> MakeRules() {
+    std::vector<std::wstring> rules;
+    for (int i = 0; i < RULES - 100; i++) rules.push_back(L"Tool" + std::to_wstring(i) + L".EXE");
+    for (int i = 0; i < 50; i++) rules.push_back(L"Vendor" + std::to_wstring(i) + L"*");
+    for (int i = 0; i < 25; i++) rules.push_back(L"suite" + std::to_wstring(i) + L"-*.exe");
+    for (int i = 0; i < 25; i++) rules.push_back(L"*\\Company" + std::to_wstring(i) + L"\\*");
+    return rules;
+}
+
+// Foreground apps as GetForegroundAppPath() returns them; a few are excluded
+static std::vector<std::wstring> MakeApps() {
+    std::vector<std::wstring> apps;
+    for (int i = 0; i < APPS; i++) {
+        std::wstring name = i % 10 == 0 ? L"tool" + std::to_wstring(i * 3) + L".exe"
+                          : i % 10 == 1 ? L"vendor" + std::to_wstring(i % 50) + L"app.exe"
+                                        : L"app" + std::to_wstring(i) + L".exe";
+        apps.push_back(L"c:\\program files\\app" + std::to_wstring(i) + L"\\bin\\" + name);
+    }
+    return apps;
+}
+
+// AppDetector::IsCurrentAppExcluded() before the matcher; exact names only
+static bool LegacyExcluded(const std::vector<std::wstring>& rules, const std::wstring& path) {
+    std::wstring currentApp(AppNameFromPath(path));
+    for (const auto& excluded : rules) {
+        std::wstring lowerExcluded = excluded;
+        std::transform(lowerExcluded.begin(), lowerExcluded.end(), lowerExcluded.begin(), ::towlower);
+        if (currentApp == lowerExcluded) return true;
+    }
+    return false;
+}
+
+static void Report(const char* name, double seconds, int hits) {
+    std::printf("%-30s %9.1f ns/check  (%d excluded)\n", name, seconds * 1e9 / CHECKS, hits);
+}
+
+int main() {
+    std::vector<std::wstring> rules = MakeRules();
+    std::vector<std::wstring> apps = MakeApps();
+    std::printf("%d rules, %d apps, %d checks\n", RULES, APPS, CHECKS);
+
+    int hits = 0;
+    double legacy = BenchBestSeconds([&]() {
+        hits = 0;
+        for (int i = 0; i < CHECKS; i++) hits += LegacyExcluded(rules, apps[i % APPS]);
+    }, 3);
+    Report("copy + lowercase scan", legacy, hits);
+
+    ExclusionMatcher matcher;
+    double compile = BenchBestSeconds([&]() { matcher.Compile(rules); }, 20);
+    std::printf("%-30s %9.1f us\n", "compile", compile * 1e6);
+
+    double uncached = BenchBestSeconds([&]() {
+        hits = 0;
+        for (int i = 0; i < CHECKS; i++) hits += matcher.Matches(apps[i % APPS]);
+    });
+    Report("compiled rules", uncached, hits);
+
+    // What a focus change does: look up the app's id, then its verdict
+    double cached = BenchBestSeconds([&]() {
+        hits = 0;
+        for (int i = 0; i < CHECKS; i++) hits += matcher.IsExcluded(matcher.Intern(apps[i % APPS]));
+    });
+    Report("interned id + cached verdict", cached, hits);
+    return 0;
+}
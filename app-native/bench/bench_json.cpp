@@ -0,0 +1,100 @@
+// ViKey - JSON Import/Export Benchmark
+// bench_json.cpp
+// Exporting and importing a 100k-shortcut file in each encoding the import accepts
+
+#include "bench_common.h"
+#include "settings_json.h"
+
+static const size_t SHORTCUTS = 100000;
+static const double TARGET_SECONDS = 0.100;  // import budget for the whole file
+
+static std::vector<TextShortcut> MakeShortcuts() {
+    const std::wstring sample = BenchSampleText();
+    std::vector<TextShortcut> shortcuts;
+    shortcuts.reserve(SHORTCUTS);
+    for (size_t i = 0; i < SHORTCUTS; i++) {
+        // Values of 20-80 characters, some needing escapes
+        size_t start = (i * 7) % (sample.size() - 80);
+        std::wstring value = sample.substr(start, 20 + i % 61);
+        if (i % 10 == 0) value += L" \"q\" \\ ]}";
+        shortcuts.push_back({L"sc" + std::to_wstring(i), value});
+    }
+    return shortcuts;
+}
+
+// UTF-8 file bytes, as a hand-edited or third-party export would be
+static std::string ToUtf8(const std::wstring& text) {
+    std::string out;
+    out.reserve(text.size() + text.size() / 2);
+    for (wchar_t wc : text) {
+        uint32_t c = static_cast<uint32_t>(wc);
+        if (c < 0x80) {
+            out += static_cast<char>(c);
+        } else if (c < 0x800) {
+            out += static_cast<char>(0xC0 | (c >> 6));
+            out += static_cast<char>(0x80 | (c & 0x3F));
+        } else {
+            out += static_cast<char>(0xE0 | (c >> 12));
+            out += static_cast<char>(0x80 | ((c >> 6) & 0x3F));
+            out += static_cast<char>(0x80 | (c & 0x3F));
+        }
+    }
+    return out;
+}
+
+// UTF-16LE file bytes with a BOM, as ExportShortcutsToFile writes them
+static std::string ToUtf16File(const std::wstring& text) {
+    std::string out = "\xFF\xFE";
+    out.reserve(2 + text.size() * 2);
+    for (wchar_t c : text) {
+        out += static_cast<char>(c & 0xFF);
+        out += static_cast<char>((c >> 8) & 0xFF);
+    }
+    return out;
+}
+
+static void Report(const char* name, size_t bytes, double seconds, bool ok) {
+    std::printf("%-28s %8.2f ms %9.1f MiB/s  %s\n", name, seconds * 1000, bytes / seconds / (1024.0 * 1024.0),
+                ok ? (seconds < TARGET_SECONDS ? "ok" : "SLOW") : "FAILED");
+}
+
+int main() {
+    const std::vector<TextShortcut> shortcuts = MakeShortcuts();
+
+    std::wstring json;
+    double exportSeconds = BenchBestSeconds([&]() { json = ExportShortcutsJson(shortcuts); });
+    std::printf("%zu shortcuts, %zu characters of JSON\n", shortcuts.size(), json.size());
+    Report("export", json.size() * sizeof(wchar_t), exportSeconds, true);
+
+    const std::string utf8 = ToUtf8(json);
+    const std::string utf16 = ToUtf16File(json);
+    std::vector<TextShortcut> imported;
+    bool ok = true;
+
+    double seconds = BenchBestSeconds([&]() {
+        JsonReader reader(json.data(), json.size());
+        ok = ImportShortcutsJson(reader, imported) && imported.size() == shortcuts.size();
+    });
+    Report("import wstring", json.size() * sizeof(wchar_t), seconds, ok);
+
+    seconds = BenchBestSeconds([&]() {
+        ok = WithJsonFileReader(utf8.data(), utf8.size(),
+                                [&](auto& reader) { return ImportShortcutsJson(reader, imported); }) &&
+             imported.size() == shortcuts.size();
+    });
+    Report("import UTF-8 file", utf8.size(), seconds, ok);
+
+    seconds = BenchBestSeconds([&]() {
+        ok = WithJsonFileReader(utf16.data(), utf16.size(),
+                                [&](auto& reader) { return ImportShortcutsJson(reader, imported); }) &&
+             imported.size() == shortcuts.size();
+    });
+    Report("import UTF-16 file", utf16.size(), seconds, ok);
+
+    bool same = imported.size() == shortcuts.size();
+    for (size_t i = 0; same && i < shortcuts.size(); i++) {
+        same = imported[i].key == shortcuts[i].key && imported[i].value == shortcuts[i].value;
+    }
+    std::printf("round trip: %s\n", same ? "identical" : "MISMATCH");
+    return same ? 0 : 1;
+}
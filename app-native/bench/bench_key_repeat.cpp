@@ -0,0 +1,129 @@
+// ViKey - Held Key Auto-repeat Benchmark
+// bench_key_repeat.cpp
+// Holds a key down for 10 s of 30 Hz auto-repeat. The full path sends every
+// repeat through CoreEngine over the Rust core and, when the result is text to send, through
+// TextSender's sleeps (modelled, not slept); the fast path asks
+// KeyRepeatTracker and lets the repeat through natively, with one ClearAll on
+// release. Reports how far behind the repeat rate each path ends up. Needs the
+// core static library (VIKEY_CORE_LIB).
+//
+// Usage: bench_key_repeat
+
+#include "bench_common.h"
+#include "bench_core.h"
+#include "key_repeat.h"
+#include <vector>
+
+// macOS keycodes (core/src/data/keys.rs)
+static const uint16_t KEY_A = 0, KEY_O = 31, KEY_D = 2, KEY_W = 13, KEY_S = 1, KEY_J = 38, KEY_DELETE = 51;
+static const uint8_t VK_BACK = 0x08;
+
+static const double REPEAT_MS = 1000.0 / 30;
+static const int REPEATS = 300;  // 10 s
+
+// What ImeProcessor's SendText costs in sleeps, in ms (text_sender.cpp):
+// SendTextFast, or the clipboard for long replacements
+static double SendMs(int backspaces, int chars) {
+    if (backspaces > 4 || chars > 15) return backspaces * 20.0 + (backspaces ? 20 : 0) + 30 + 50;
+    return backspaces * 16.0 + (backspaces ? 20 : 0) + chars * 5.0;
+}
+
+struct Scenario {
+    const char* name;
+    std::vector<uint16_t> typed;  // typed before the key is held
+    uint16_t held;
+    uint8_t vk;
+};
+
+struct Outcome {
+    int sends = 0;
+    double engineNs = 0;   // total time in the engine or the tracker
+    double behindMs = 0;   // when the last repeat is done, after it arrived
+    double worstMs = 0;
+};
+
+// Each repeat is handled once the previous one is: a hook that takes longer
+// than the repeat interval falls further behind with every key
+static void Handled(Outcome& out, double arrivalMs, double& doneMs, double costMs) {
+    doneMs = std::max(doneMs, arrivalMs) + costMs;
+    out.behindMs = doneMs - arrivalMs;
+    out.worstMs = std::max(out.worstMs, out.behindMs);
+}
+
+// The app's default settings, with the scenario's word typed
+static void Prepare(CoreEngine& engine, const Scenario& s) {
+    StartCoreEngine(engine, BenchSettings(InputMethod::Telex, true, false));
+    for (uint16_t key : s.typed) engine.ProcessKeyExt(key, false, false, false);
+}
+
+static Outcome FullPath(const Scenario& s) {
+    CoreEngine engine;
+    Prepare(engine, s);
+    Outcome out;
+    double doneMs = 0;
+    for (int i = 0; i < REPEATS; i++) {
+        auto start = std::chrono::steady_clock::now();
+        ImeResult r = engine.ProcessKeyExt(s.held, false, false, false);
+        double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+        double costMs = ns / 1e6;
+        if (r.action == ImeAction::Send && r.count > 0) {
+            out.sends++;
+            costMs += SendMs(r.backspace, r.count);
+        }
+        out.engineNs += ns;
+        Handled(out, i * REPEAT_MS, doneMs, costMs);
+    }
+    return out;
+}
+
+static Outcome FastPath(const Scenario& s) {
+    CoreEngine engine;
+    Prepare(engine, s);
+    Outcome out;
+    KeyRepeatTracker keys;
+    double doneMs = 0;
+    uint32_t firstDown = 1000000;
+    keys.KeyDown(s.vk, firstDown - 500);  // the press, before the typematic delay
+    for (int i = 0; i < REPEATS; i++) {
+        auto start = std::chrono::steady_clock::now();
+        if (keys.KeyDown(s.vk, firstDown + static_cast<uint32_t>(i * REPEAT_MS))) keys.Bypassed(s.vk);
+        double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+        out.engineNs += ns;
+        Handled(out, i * REPEAT_MS, doneMs, ns / 1e6);
+    }
+    auto start = std::chrono::steady_clock::now();
+    if (keys.KeyUp(s.vk)) engine.ClearAll();
+    out.engineNs += std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    return out;
+}
+
+static void Report(const char* path, const Outcome& out) {
+    std::printf("  %-10s %4d sends %9.0f ns/repeat   %8.0f ms behind at release, %8.0f worst\n", path, out.sends,
+                out.engineNs / REPEATS, out.behindMs, out.worstMs);
+}
+
+int main() {
+    // "viet", "vieejt" (việt) and "nguowif" (người) as Telex keys
+    const std::vector<uint16_t> viet = {9, 34, 14, 17};
+    const std::vector<uint16_t> viet2 = {9, 34, 14, 14, 38, 17};
+    const std::vector<uint16_t> nguoi = {45, 5, 32, 31, 13, 34, 3};
+    const std::vector<Scenario> scenarios = {
+        {"Telex, holding a after \"h\"", {4}, KEY_A, 'A'},
+        {"Telex, holding o after \"tr\"", {17, 15}, KEY_O, 'O'},
+        {"Telex, holding d", {}, KEY_D, 'D'},
+        {"Telex, holding w after \"u\"", {32}, KEY_W, 'W'},
+        {"Telex, holding s after \"viet\"", viet, KEY_S, 'S'},
+        {"Telex, holding j after \"viet\"", viet, KEY_J, 'J'},
+        {"Telex, Backspace after \"viet\"", viet, KEY_DELETE, VK_BACK},
+        {"Telex, Backspace after \"việt\"", viet2, KEY_DELETE, VK_BACK},
+        {"Telex, Backspace after \"người\"", nguoi, KEY_DELETE, VK_BACK},
+    };
+
+    std::printf("%d repeats at 30 Hz (%.1f ms apart)\n", REPEATS, REPEAT_MS);
+    for (const Scenario& s : scenarios) {
+        std::printf("\n%s\n", s.name);
+        Report("full path", FullPath(s));
+        Report("fast path", FastPath(s));
+    }
+    return 0;
+}
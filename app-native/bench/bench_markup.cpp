@@ -0,0 +1,90 @@
+// ViKey - Markup Converter Benchmark
+// bench_markup.cpp
+// Streaming HTML/RTF conversion vs the raw codec on the same text
+
+#include "bench_common.h"
+#include "markup_converter.h"
+
+static const size_t PIECE = 64 * 1024;  // bytes per Feed(), as vikey-convert reads
+
+// Wrap each sample line of corpus in markup for the given format
+static std::string BuildDocument(MarkupFormat format, const std::wstring& corpus, VietEncoding enc) {
+    std::string text = EncodingConverter::EncodeBytes(
+        EncodingConverter::Instance().Convert(corpus, VietEncoding::Unicode, enc), enc);
+    std::string doc;
+    doc.reserve(text.size() + text.size() / 4);
+    size_t start = 0;
+    while (start < text.size()) {
+        size_t end = text.find('\n', start);
+        if (end == std::string::npos) end = text.size();
+        if (format == MarkupFormat::Html) {
+            doc += "<p class=\"body\"><b>";
+            doc.append(text, start, end - start);
+            doc += "</b></p>\n";
+        } else {
+            doc += "{\\pard\\f0\\fs24 ";
+            doc.append(text, start, end - start);
+            doc += "\\par}\n";
+        }
+        start = end + 1;
+    }
+    return doc;
+}
+
+static double TimeMarkup(MarkupFormat format, VietEncoding from, VietEncoding to, const std::string& doc,
+                         std::string& out) {
+    return BenchBestSeconds([&]() {
+        out.clear();
+        MarkupConverter converter(format, from, to);
+        for (size_t i = 0; i < doc.size(); i += PIECE) {
+            converter.Feed(doc.data() + i, std::min(PIECE, doc.size() - i), out);
+        }
+        converter.Finish(out);
+    });
+}
+
+int main() {
+    const std::wstring corpus = BenchCorpus(4 * 1024 * 1024);
+    struct Pair {
+        const char* name;
+        VietEncoding from;
+        VietEncoding to;
+    };
+    const Pair PAIRS[] = {
+        {"VNI -> Unicode", VietEncoding::VNI_Windows, VietEncoding::Unicode},
+        {"Unicode -> TCVN3", VietEncoding::Unicode, VietEncoding::TCVN3},
+        {"TCVN3 -> VNI", VietEncoding::TCVN3, VietEncoding::VNI_Windows},
+    };
+
+    std::printf("Corpus: %zu characters; MB/s of input bytes\n\n", corpus.size());
+    std::printf("%-18s %12s %12s %12s\n", "pair", "raw codec", "HTML", "RTF");
+
+    std::string out;
+    std::wstring wideOut;
+    for (const Pair& pair : PAIRS) {
+        // Raw: decode bytes, transcode, encode bytes, as for a plain text file
+        std::string plain = EncodingConverter::EncodeBytes(
+            EncodingConverter::Instance().Convert(corpus, VietEncoding::Unicode, pair.from), pair.from);
+        double rawSeconds = BenchBestSeconds([&]() {
+            std::wstring text = EncodingConverter::DecodeBytes(plain.data(), plain.size(), pair.from);
+            wideOut = EncodingConverter::Instance().Convert(text, pair.from, pair.to);
+            out = EncodingConverter::EncodeBytes(wideOut, pair.to);
+        });
+
+        // RTF carries legacy bytes as \'xx, so it is built from the escaped text
+        std::string html = BuildDocument(MarkupFormat::Html, corpus, pair.from);
+        std::string rtf;
+        {
+            std::string in = BuildDocument(MarkupFormat::Rtf, corpus, pair.from);
+            MarkupConverter escape(MarkupFormat::Rtf, pair.from, pair.from);
+            escape.Feed(in.data(), in.size(), rtf);
+            escape.Finish(rtf);
+        }
+        double htmlSeconds = TimeMarkup(MarkupFormat::Html, pair.from, pair.to, html, out);
+        double rtfSeconds = TimeMarkup(MarkupFormat::Rtf, pair.from, pair.to, rtf, out);
+
+        std::printf("%-18s %12.0f %12.0f %12.0f\n", pair.name, plain.size() / rawSeconds / 1e6,
+                    html.size() / htmlSeconds / 1e6, rtf.size() / rtfSeconds / 1e6);
+    }
+    return 0;
+}
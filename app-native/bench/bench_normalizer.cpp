@@ -0,0 +1,60 @@
+// ViKey - Normalizer Benchmark
+// bench_normalizer.cpp
+// VietNormalizer NFC/NFD throughput, against ICU when it is available
+
+#include "bench_common.h"
+#include "viet_normalizer.h"
+
+#ifdef VIKEY_HAVE_ICU
+#include <unicode/normalizer2.h>
+#include <unicode/unistr.h>
+#endif
+
+int main() {
+    const std::wstring nfc = BenchCorpus(4 * 1024 * 1024);
+    std::wstring nfd;
+    VietNormalizer::ToNfd(nfc.data(), nfc.size(), nfd);
+    const std::wstring ascii(nfc.size(), L'a');
+
+    std::printf("Corpus: %zu characters (NFC), %zu (NFD)\n", nfc.size(), nfd.size());
+
+    std::wstring out;
+    double s = BenchBestSeconds([&]() { out.clear(); VietNormalizer::ToNfd(nfc.data(), nfc.size(), out); });
+    BenchReportThroughput("ViKey NFC -> NFD", nfc.size(), s);
+    s = BenchBestSeconds([&]() { out.clear(); VietNormalizer::ToNfc(nfd.data(), nfd.size(), out); });
+    BenchReportThroughput("ViKey NFD -> NFC", nfd.size(), s);
+    s = BenchBestSeconds([&]() { out.clear(); VietNormalizer::ToNfc(nfc.data(), nfc.size(), out); });
+    BenchReportThroughput("ViKey NFC -> NFC", nfc.size(), s);
+    s = BenchBestSeconds([&]() { out.clear(); VietNormalizer::ToNfc(ascii.data(), ascii.size(), out); });
+    BenchReportThroughput("ViKey ASCII -> NFC", ascii.size(), s);
+
+#ifdef VIKEY_HAVE_ICU
+    // ICU works on UTF-16; conversion is done up front and not timed
+    auto toIcu = [](const std::wstring& w) {
+        icu::UnicodeString u;
+        for (wchar_t c : w) u.append(static_cast<UChar32>(c));
+        return u;
+    };
+    const icu::UnicodeString icuNfc = toIcu(nfc);
+    const icu::UnicodeString icuNfd = toIcu(nfd);
+    const icu::UnicodeString icuAscii = toIcu(ascii);
+
+    UErrorCode status = U_ZERO_ERROR;
+    const icu::Normalizer2* icuNfcNorm = icu::Normalizer2::getNFCInstance(status);
+    const icu::Normalizer2* icuNfdNorm = icu::Normalizer2::getNFDInstance(status);
+    if (U_FAILURE(status)) return 1;
+
+    icu::UnicodeString r;
+    s = BenchBestSeconds([&]() { UErrorCode e = U_ZERO_ERROR; r = icuNfdNorm->normalize(icuNfc, e); });
+    BenchReportThroughput("ICU   NFC -> NFD", nfc.size(), s);
+    s = BenchBestSeconds([&]() { UErrorCode e = U_ZERO_ERROR; r = icuNfcNorm->normalize(icuNfd, e); });
+    BenchReportThroughput("ICU   NFD -> NFC", nfd.size(), s);
+    s = BenchBestSeconds([&]() { UErrorCode e = U_ZERO_ERROR; r = icuNfcNorm->normalize(icuNfc, e); });
+    BenchReportThroughput("ICU   NFC -> NFC", nfc.size(), s);
+    s = BenchBestSeconds([&]() { UErrorCode e = U_ZERO_ERROR; r = icuNfcNorm->normalize(icuAscii, e); });
+    BenchReportThroughput("ICU   ASCII -> NFC", ascii.size(), s);
+#else
+    std::printf("(built without ICU; no comparison)\n");
+#endif
+    return 0;
+}
@@ -0,0 +1,134 @@
+// ViKey - Settings Persister Benchmark
+// bench_persister.cpp
+// Rapid toggling: synchronous saves vs the write-behind persister, both over
+// a file-backed store that rewrites its file like a registry hive flush
+
+#include "bench_common.h"
+#include "settings_persister.h"
+#include <cstdio>
+#include <fstream>
+#include <map>
+
+using namespace std::chrono_literals;
+
+// All values in one file, rewritten through a temporary and renamed per batch
+class FileStorage : public SettingsStorage {
+public:
+    explicit FileStorage(std::string path) : m_path(std::move(path)) {}
+    ~FileStorage() override { std::remove(m_path.c_str()); }
+
+    bool ReadAll(PersistedValues& values) override {
+        values = PersistedValues(m_values.begin(), m_values.end());
+        return true;
+    }
+
+    bool Write(const std::vector<PersistedWrite>& batch) override {
+        auto start = std::chrono::steady_clock::now();
+        for (const auto& write : batch) m_values[write.name] = write.value;
+        std::string tmp = m_path + ".tmp";
+        {
+            std::wofstream out(tmp, std::ios::trunc);
+            for (const auto& item : m_values) {
+                out << item.first << L'=';
+                if (item.second.kind == PersistedValue::Kind::Number) out << item.second.number;
+                else out << item.second.text;
+                out << L'\n';
+            }
+            if (!out) return false;
+        }
+        bool ok = std::rename(tmp.c_str(), m_path.c_str()) == 0;
+        writes++;
+        values += batch.size();
+        seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        return ok;
+    }
+
+    int writes = 0;
+    size_t values = 0;
+    double seconds = 0;  // time spent in Write()
+
+private:
+    std::string m_path;
+    std::map<std::wstring, PersistedValue> m_values;
+};
+
+// What Settings::Save() hands over: 29 numbers and the two list strings.
+// Save n toggles Enabled and moves one other value, so no window is a no-op.
+static const int NUMBER_VALUES = 29;
+
+static std::vector<PersistedWrite> AllValues(int n, const std::wstring& shortcuts) {
+    std::vector<PersistedWrite> values;
+    for (int i = 0; i < NUMBER_VALUES; i++) {
+        uint32_t value = i == 0 ? n % 2 : i == 1 ? n % 7 : 1;
+        values.push_back({L"Value" + std::to_wstring(i), PersistedValue::Number(value)});
+    }
+    values.push_back({L"TextShortcuts", PersistedValue::String(shortcuts)});
+    values.push_back({L"ExcludedApps", PersistedValue::String(L"game.exe|photoshop.exe")});
+    return values;
+}
+
+static std::wstring ShortcutString() {
+    std::wstring s;
+    for (int i = 0; i < 20; i++) s += L"k" + std::to_wstring(i) + L"|" + BenchSampleText() + L";";
+    return s;
+}
+
+struct RunResult {
+    double saveMicros;  // caller-side time per Save()
+    int writes;
+    size_t values;
+    double writeMillis;  // storage time in total
+};
+
+static void Print(const char* name, int saves, const RunResult& r) {
+    std::printf("%-34s %5d saves %9.2f us/save %5d writes %6zu values %8.2f ms in storage\n", name, saves,
+                r.saveMicros, r.writes, r.values, r.writeMillis);
+}
+
+// The old Save(): every value written on the calling (UI/hook) thread
+static RunResult RunSynchronous(int saves, std::chrono::milliseconds gap) {
+    FileStorage storage("bench_persister_sync.txt");
+    const std::wstring shortcuts = ShortcutString();
+    double callerSeconds = 0;
+    for (int i = 0; i < saves; i++) {
+        auto start = std::chrono::steady_clock::now();
+        storage.Write(AllValues(i, shortcuts));
+        callerSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        if (gap.count() > 0) std::this_thread::sleep_for(gap);
+    }
+    return {callerSeconds / saves * 1e6, storage.writes, storage.values, storage.seconds * 1000};
+}
+
+static RunResult RunPersister(int saves, std::chrono::milliseconds gap) {
+    FileStorage storage("bench_persister_async.txt");
+    const std::wstring shortcuts = ShortcutString();
+    double callerSeconds = 0;
+    {
+        SettingsPersister persister(storage);
+        for (const auto& write : AllValues(0, shortcuts)) persister.SetStored(write.name.c_str(), write.value);
+        for (int i = 0; i < saves; i++) {
+            auto start = std::chrono::steady_clock::now();
+            for (auto& write : AllValues(i + 1, shortcuts)) {
+                persister.Set(write.name.c_str(), std::move(write.value));
+            }
+            callerSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            if (gap.count() > 0) std::this_thread::sleep_for(gap);
+        }
+        persister.Flush();  // as CleanupInstance() does on exit
+    }
+    return {callerSeconds / saves * 1e6, storage.writes, storage.values, storage.seconds * 1000};
+}
+
+int main() {
+    std::printf("debounce window: %lld ms\n", static_cast<long long>(SettingsPersister::DEFAULT_DEBOUNCE.count()));
+
+    // Ctrl+Space held down: as fast as the hook delivers
+    Print("burst, synchronous", 1000, RunSynchronous(1000, 0ms));
+    Print("burst, persister", 1000, RunPersister(1000, 0ms));
+
+    // Rapid manual toggling, about 40 a second for 2 seconds
+    Print("40/s for 2 s, synchronous", 80, RunSynchronous(80, 25ms));
+    Print("40/s for 2 s, persister", 80, RunPersister(80, 25ms));
+
+    return 0;
+}
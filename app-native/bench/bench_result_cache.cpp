@@ -0,0 +1,149 @@
+// ViKey - Word Result Cache Benchmark
+// bench_result_cache.cpp
+// Replays Vietnamese text typed in Telex and VNI through CoreEngine, RustBridge's
+// key path, once with the result cache off (the default) and once with it on;
+// the outputs must be identical. Reports hit rate and per-key latency. Needs
+// the core static library (VIKEY_CORE_LIB).
+//
+// Usage: bench_result_cache [utf-8 text file...]   (default: the sample text)
+
+#include "bench_common.h"
+#include "bench_core.h"
+#include "bench_typing.h"
+#include "encoding_converter.h"
+#include "keycodes.h"
+#include <fstream>
+#include <iterator>
+#include <vector>
+
+static const uint16_t KEY_SPACE = 49;
+static const uint16_t CLEAR = 0xFFFF;  // Enter, Tab, arrows: the hook only clears the engine
+
+struct Key {
+    uint16_t code;
+    bool caps;
+    bool shift;
+};
+
+// The typed text as the engine sees it: Windows keys mapped as
+// ImeProcessor maps them, keys the engine never gets dropped
+static std::vector<Key> EngineKeys(const std::wstring& text, bool vni) {
+    TypingStyle style;
+    style.vni = vni;
+    style.escEvery = 40;
+    std::vector<Key> keys;
+    for (const Keystroke& key : TypeText(text, style).keys) {
+        if (KeyCodes::IsBufferClearKey(key.vk) && key.vk != VK_SPACE_KEY) {
+            keys.push_back({CLEAR, false, false});
+            continue;
+        }
+        uint16_t code = KeyCodes::ToMacKeycode(key.vk);
+        if (code != 0xFFFF) keys.push_back({code, key.shift, key.shift});
+    }
+    return keys;
+}
+
+struct Output {
+    uint8_t action = 0;
+    uint8_t backspace = 0;
+    uint8_t flags = 0;
+    std::wstring text;
+
+    bool operator==(const Output& other) const {
+        return action == other.action && backspace == other.backspace && flags == other.flags &&
+               text == other.text;
+    }
+};
+
+struct Replay {
+    std::vector<Output> outputs;
+    std::vector<double> hitNs, engineNs, allNs;
+    ResultCache::Stats stats;
+};
+
+// The hook's flow: Space is processed then clears, other break keys only clear
+static Replay Run(const std::vector<Key>& keys, bool vni, bool useCache) {
+    CoreEngine engine;
+    StartCoreEngine(engine, BenchSettings(vni ? InputMethod::VNI : InputMethod::Telex, true, useCache));
+
+    Replay replay;
+    replay.outputs.reserve(keys.size());
+    for (const Key& key : keys) {
+        auto start = std::chrono::steady_clock::now();
+        if (key.code == CLEAR) {
+            engine.Clear();
+            continue;
+        }
+        uint64_t hits = engine.GetResultCacheStats().hits;
+        ImeResult result = engine.ProcessKeyExt(key.code, key.caps, false, key.shift);
+        if (key.code == KEY_SPACE) engine.Clear();
+        double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+        bool hit = engine.GetResultCacheStats().hits != hits;
+        replay.outputs.push_back({static_cast<uint8_t>(result.action), result.backspace,
+                                  static_cast<uint8_t>(result.flags & ImeResult::FLAG_KEY_CONSUMED),
+                                  result.GetText()});
+        (hit ? replay.hitNs : replay.engineNs).push_back(ns);
+        replay.allNs.push_back(ns);
+    }
+    replay.stats = engine.GetResultCacheStats();
+    return replay;
+}
+
+static double Mean(const std::vector<double>& v) {
+    double sum = 0;
+    for (double x : v) sum += x;
+    return v.empty() ? 0 : sum / v.size();
+}
+
+static double Percentile(std::vector<double> v, double p) {
+    if (v.empty()) return 0;
+    size_t i = static_cast<size_t>(p * (v.size() - 1));
+    std::nth_element(v.begin(), v.begin() + i, v.end());
+    return v[i];
+}
+
+static void ReportLatency(const char* name, const std::vector<double>& ns) {
+    std::printf("  %-22s %9zu keys %8.0f ns mean %8.0f p50 %8.0f p99\n", name, ns.size(), Mean(ns),
+                Percentile(ns, 0.5), Percentile(ns, 0.99));
+}
+
+static std::wstring LoadText(int argc, char** argv) {
+    if (argc < 2) return BenchCorpus(200000);
+    std::wstring text;
+    for (int i = 1; i < argc; i++) {
+        std::ifstream file(argv[i], std::ios::binary);
+        std::string bytes((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        text += EncodingConverter::DecodeBytes(bytes.data(), bytes.size(), VietEncoding::Unicode);
+        text += L'\n';
+    }
+    return text;
+}
+
+int main(int argc, char** argv) {
+    std::wstring text = LoadText(argc, argv);
+    std::printf("%zu characters of text\n", text.size());
+
+    int failures = 0;
+    for (bool vni : {false, true}) {
+        std::vector<Key> keys = EngineKeys(text, vni);
+        Replay every = Run(keys, vni, false);
+        Replay cached = Run(keys, vni, true);
+
+        size_t differ = 0;
+        for (size_t i = 0; i < every.outputs.size(); i++) differ += !(every.outputs[i] == cached.outputs[i]);
+        failures += differ > 0;
+
+        const ResultCache::Stats& s = cached.stats;
+        double lookups = static_cast<double>(s.hits + s.misses);
+        std::printf("\n%s: %zu keys to the engine, outputs %s\n", vni ? "VNI" : "Telex", every.outputs.size(),
+                    differ ? "DIFFER" : "identical");
+        std::printf("  hit rate %.1f%% of cacheable keys, %.1f%% of all keys; %llu replayed\n",
+                    lookups > 0 ? 100.0 * s.hits / lookups : 0.0, 100.0 * s.hits / every.outputs.size(),
+                    static_cast<unsigned long long>(s.replayed));
+        ReportLatency("every key, no cache", every.allNs);
+        ReportLatency("every key, cache", cached.allNs);
+        ReportLatency("  cache hits", cached.hitNs);
+        ReportLatency("  engine calls", cached.engineNs);
+    }
+    return failures;
+}
@@ -0,0 +1,151 @@
+// ViKey - Settings Store Benchmark
+// bench_settings_store.cpp
+// Startup load of the settings through each backend: the single settings file
+// everywhere, and on Windows also the registry key, read both the old way
+// (one query per value, one key open per string) and with ReadAll()
+
+#include "bench_common.h"
+#include "settings_file.h"
+#include <fstream>
+#ifdef _WIN32
+#include "settings_registry.h"
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace fs = std::filesystem;
+
+// The 29 numbers Settings::Load() reads, plus the two list strings
+static const wchar_t* const NUMBER_NAMES[] = {
+    L"Enabled", L"Method", L"ModernTone", L"EnglishAutoRestore", L"AutoCapitalize", L"EscRestore",
+    L"FreeTone", L"AllowForeignConsonants", L"SkipWTextShortcut", L"BracketTextShortcut", L"SlowMode",
+    L"ClipboardMode", L"SmartSwitch", L"SilentStartup", L"ShortcutsEnabled", L"CheckForUpdates",
+    L"HotkeyCtrl", L"HotkeyShift", L"HotkeyAlt", L"HotkeyWin", L"HotkeyKey", L"ConvertHotkeyCtrl",
+    L"ConvertHotkeyShift", L"ConvertHotkeyAlt", L"ConvertHotkeyWin", L"ConvertHotkeyKey", L"ConvertFrom",
+    L"ConvertTo", L"ConvertDetect",
+};
+
+static PersistedValues MakeValues(size_t shortcuts) {
+    PersistedValues values;
+    uint32_t n = 0;
+    for (const wchar_t* name : NUMBER_NAMES) values[name] = PersistedValue::Number(n++ % 3);
+
+    const std::wstring sample = BenchSampleText();
+    std::wstring list;
+    for (size_t i = 0; i < shortcuts; i++) {
+        if (!list.empty()) list += L';';
+        list += L"sc" + std::to_wstring(i) + L'|' + sample.substr((i * 7) % (sample.size() - 60), 10 + i % 50);
+    }
+    values[L"TextShortcuts"] = PersistedValue::String(list);
+    values[L"ExcludedApps"] = PersistedValue::String(L"game.exe|photoshop.exe|mstsc.exe|code.exe");
+    return values;
+}
+
+static std::vector<PersistedWrite> AsBatch(const PersistedValues& values) {
+    std::vector<PersistedWrite> batch;
+    for (const auto& item : values) batch.push_back({item.first, item.second});
+    return batch;
+}
+
+// Drop the file from the page cache, so the next read goes to the disk
+static bool EvictFromCache(const fs::path& path) {
+#if defined(POSIX_FADV_DONTNEED)
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+    bool ok = fdatasync(fd) == 0 && posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED) == 0;
+    close(fd);
+    return ok;
+#else
+    (void)path;
+    return false;
+#endif
+}
+
+static void Report(const char* name, double seconds, size_t values) {
+    std::printf("%-44s %9.1f us  (%zu values)\n", name, seconds * 1e6, values);
+}
+
+static void BenchFile(const char* label, size_t shortcuts) {
+    fs::path path = fs::temp_directory_path() / "vikey_bench_settings.dat";
+    PersistedValues values = MakeValues(shortcuts);
+    FileSettingsStorage(path).Write(AsBatch(values));
+    std::printf("%s: %zu shortcuts, %ju byte file\n", label, shortcuts, static_cast<uintmax_t>(fs::file_size(path)));
+
+    // Everything Settings::Load() pays: a fresh storage, one read, checksum, decode
+    size_t read = 0;
+    auto load = [&]() {
+        FileSettingsStorage storage(path);
+        PersistedValues loaded;
+        storage.ReadAll(loaded);
+        read = loaded.size();
+    };
+    bool cold = false;
+    double coldSeconds = 1e30;
+    for (int i = 0; i < 5; i++) {
+        cold = EvictFromCache(path);
+        coldSeconds = std::min(coldSeconds, BenchBestSeconds(load, 1));
+    }
+    if (cold) Report("  file, cold (page cache dropped)", coldSeconds, read);
+    Report("  file, warm", BenchBestSeconds(load, 50), read);
+
+    // Save(): encode, write the temporary, rename over the file
+    FileSettingsStorage storage(path);
+    std::vector<PersistedWrite> one = {{L"Enabled", PersistedValue::Number(0)}};
+    Report("  file, one-value write (whole file)", BenchBestSeconds([&]() { storage.Write(one); }, 20), 1);
+    fs::remove(path);
+}
+
+#ifdef _WIN32
+static const wchar_t* BENCH_KEY = L"SOFTWARE\\ViKeyBenchSettings";
+
+// Settings::Load() before the file store: one open, a query per value, and
+// a second open for each list string
+static size_t LoadRegistryPerValue() {
+    size_t read = 0;
+    HKEY hKey;
+    if (RegOpenKeyExW(HKEY_CURRENT_USER, BENCH_KEY, 0, KEY_READ, &hKey) == ERROR_SUCCESS) {
+        for (const wchar_t* name : NUMBER_NAMES) {
+            DWORD value = 0, size = sizeof(value), type = REG_DWORD;
+            if (RegQueryValueExW(hKey, name, nullptr, &type, (LPBYTE)&value, &size) == ERROR_SUCCESS) read++;
+        }
+        RegCloseKey(hKey);
+    }
+    for (const wchar_t* name : {L"TextShortcuts", L"ExcludedApps"}) {
+        if (RegOpenKeyExW(HKEY_CURRENT_USER, BENCH_KEY, 0, KEY_READ, &hKey) != ERROR_SUCCESS) continue;
+        static wchar_t buffer[4096];
+        DWORD size = sizeof(buffer), type = REG_SZ;
+        if (RegQueryValueExW(hKey, name, nullptr, &type, (LPBYTE)buffer, &size) == ERROR_SUCCESS) read++;
+        RegCloseKey(hKey);
+    }
+    return read;
+}
+
+static void BenchRegistry(const char* label, size_t shortcuts) {
+    PersistedValues values = MakeValues(shortcuts);
+    RegistrySettingsStorage storage(BENCH_KEY);
+    storage.Write(AsBatch(values));
+    std::printf("%s: %zu shortcuts in HKCU\\%ls\n", label, shortcuts, BENCH_KEY);
+
+    size_t read = 0;
+    Report("  registry, query per value", BenchBestSeconds([&]() { read = LoadRegistryPerValue(); }, 50), read);
+    Report("  registry, ReadAll()", BenchBestSeconds([&]() {
+        PersistedValues loaded;
+        RegistrySettingsStorage(BENCH_KEY).ReadAll(loaded);
+        read = loaded.size();
+    }, 50), read);
+    RegDeleteTreeW(HKEY_CURRENT_USER, BENCH_KEY);
+}
+#endif
+
+int main() {
+    BenchFile("default settings", 20);
+    BenchFile("large shortcut list", 2000);
+#ifdef _WIN32
+    BenchRegistry("default settings", 20);
+    BenchRegistry("large shortcut list", 2000);
+#else
+    std::printf("registry backend: Windows only\n");
+#endif
+    return 0;
+}
@@ -0,0 +1,61 @@
+// ViKey - Transcoding Matrix Benchmark
+// bench_transcode.cpp
+// Fused single-pass transcoders vs the two-pass path through Unicode, all 4x4 pairs
+
+#include "bench_common.h"
+#include "encoding_converter.h"
+
+static const VietEncoding ENCODINGS[] = {
+    VietEncoding::Unicode, VietEncoding::VNI_Windows, VietEncoding::TCVN3, VietEncoding::Unicode_Comp,
+    VietEncoding::VISCII, VietEncoding::VIQR, VietEncoding::UTF8_Bytes,
+};
+
+static const char* ShortName(VietEncoding enc) {
+    switch (enc) {
+        case VietEncoding::Unicode: return "Unicode";
+        case VietEncoding::VNI_Windows: return "VNI";
+        case VietEncoding::TCVN3: return "TCVN3";
+        case VietEncoding::Unicode_Comp: return "NFD";
+        case VietEncoding::VISCII: return "VISCII";
+        case VietEncoding::VIQR: return "VIQR";
+        case VietEncoding::UTF8_Bytes: return "UTF8b";
+    }
+    return "?";
+}
+
+int main() {
+    const std::wstring unicode = BenchCorpus(4 * 1024 * 1024);
+    std::printf("Corpus: %zu characters; Mchar/s of source text, fused / two-pass\n\n", unicode.size());
+    std::printf("%-8s", "from\\to");
+    for (VietEncoding to : ENCODINGS) std::printf("%20s", ShortName(to));
+    std::printf("\n");
+
+    std::wstring out;
+    std::wstring mid;
+    for (VietEncoding from : ENCODINGS) {
+        std::wstring input;
+        EncodingConverter::GetTranscoder(VietEncoding::Unicode, from)(unicode.data(), unicode.size(), input);
+        std::printf("%-8s", ShortName(from));
+
+        for (VietEncoding to : ENCODINGS) {
+            auto fused = EncodingConverter::GetTranscoder(from, to);
+            auto decode = EncodingConverter::GetTranscoder(from, VietEncoding::Unicode);
+            auto encode = EncodingConverter::GetTranscoder(VietEncoding::Unicode, to);
+
+            double fusedSeconds = BenchBestSeconds([&]() {
+                out.clear();
+                fused(input.data(), input.size(), out);
+            });
+            // Two-pass: materialize the Unicode intermediate, then encode it
+            double twoPassSeconds = BenchBestSeconds([&]() {
+                mid.clear();
+                out.clear();
+                decode(input.data(), input.size(), mid);
+                encode(mid.data(), mid.size(), out);
+            });
+            std::printf("%9.0f /%8.0f ", input.size() / fusedSeconds / 1e6, input.size() / twoPassSeconds / 1e6);
+        }
+        std::printf("\n");
+    }
+    return 0;
+}
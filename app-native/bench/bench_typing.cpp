@@ -0,0 +1,161 @@
+// ViKey - End-to-end Typing Benchmark
+// bench_typing.cpp
+// Types Vietnamese text in Telex and VNI, typos and Backspaces included, through
+// the app's key handling (KeyHandler, CoreEngine), the Rust core and a screen
+// that applies what TextSender would send and the keys the IME lets through.
+// The screen must end up holding the text. Reports keys per second and per-key
+// latency percentiles, TextSender's sleeps excluded. Needs the core static
+// library (VIKEY_CORE_LIB).
+//
+// Usage: bench_typing [--modern] [--cache] [utf-8 text file...]   (default: the sample text)
+// --modern expects modern tone placement (hoà) in the text, as the app's
+// default setting produces; the sample text uses the classic one (hòa).
+// --cache turns on the result cache (CoreEngine::SetResultCacheEnabled).
+
+#include "bench_common.h"
+#include "bench_core.h"
+#include "bench_typing.h"
+#include "encoding_converter.h"
+#include "key_handler.h"
+#include "shortcut_manager.h"
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+// The edit control the text lands in, caret always at the end
+class Screen {
+public:
+    void Backspace(size_t count) { m_text.resize(m_text.size() - std::min(count, m_text.size())); }
+    void Insert(const std::wstring& text) { m_text += text; }
+    void Insert(wchar_t c) { m_text += c; }
+    const std::wstring& Text() const { return m_text; }
+
+private:
+    std::wstring m_text;
+};
+
+// One key down from the hook's callback to its return: the KeyHandler calls
+// KeyboardHook::ProcessKey and ImeProcessor::OnKeyPressed make, with Windows
+// replaced by the screen (the IME on, no modifiers but Shift, no held keys).
+// A key the IME does not block reaches the screen as itself.
+class Pipeline {
+public:
+    Pipeline(bool vni, bool modernTone, bool resultCache) : m_keys(m_engine) {
+        StartCoreEngine(m_engine, BenchSettings(vni ? InputMethod::VNI : InputMethod::Telex, modernTone, resultCache));
+        ShortcutManager::Instance().Clear();
+    }
+
+    void Key(const Keystroke& key) {
+        if (!Handled(key)) Native(key);
+    }
+
+    const Screen& GetScreen() const { return m_screen; }
+    size_t Sends() const { return m_sends; }
+    const ResultCache::Stats& CacheStats() const { return m_engine.GetResultCacheStats(); }
+
+private:
+    // True if the key was blocked
+    bool Handled(const Keystroke& key) {
+        if (!m_keys.Admit(key.vk, false, false)) return false;
+        TextEdit edit;
+        bool handled = m_keys.OnKeyPressed(key.vk, key.shift, false, edit);
+        Send(edit);
+        m_keys.KeyDone(key.vk);
+        return handled;
+    }
+
+    // TextSender in Unicode: the same edit whether it goes by SendInput or
+    // the clipboard
+    void Send(const TextEdit& edit) {
+        if (edit.Empty()) return;
+        m_sends++;
+        m_screen.Backspace(static_cast<size_t>(edit.backspaces));
+        m_screen.Insert(edit.text);
+    }
+
+    void Native(const Keystroke& key) {
+        if (key.vk == VK_BACK_KEY) m_screen.Backspace(1);
+        else if (key.native) m_screen.Insert(key.native);
+    }
+
+    CoreEngine m_engine;
+    KeyHandler m_keys;
+    Screen m_screen;
+    size_t m_sends = 0;
+};
+
+static double Percentile(std::vector<double>& ns, double p) {
+    size_t i = static_cast<size_t>(p * (ns.size() - 1));
+    std::nth_element(ns.begin(), ns.begin() + i, ns.end());
+    return ns[i];
+}
+
+// Where the screen first differs from the text, with some context
+static void ReportMismatch(const std::wstring& screen, const std::wstring& expected) {
+    size_t at = 0;
+    while (at < screen.size() && at < expected.size() && screen[at] == expected[at]) at++;
+    size_t from = at > 30 ? at - 30 : 0;
+    std::string ctxScreen = EncodingConverter::EncodeBytes(screen.substr(from, 60), VietEncoding::Unicode);
+    std::string ctxExpected = EncodingConverter::EncodeBytes(expected.substr(from, 60), VietEncoding::Unicode);
+    for (std::string* s : {&ctxScreen, &ctxExpected}) {
+        for (char& c : *s) if (c == '\n') c = ' ';
+    }
+    std::printf("  first difference at character %zu of %zu\n    screen:   %s\n    expected: %s\n", at,
+                expected.size(), ctxScreen.c_str(), ctxExpected.c_str());
+}
+
+static std::wstring LoadText(const std::vector<const char*>& files) {
+    if (files.empty()) return BenchCorpus(200000);
+    std::wstring text;
+    for (const char* path : files) {
+        std::ifstream file(path, std::ios::binary);
+        std::string bytes((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        text += EncodingConverter::DecodeBytes(bytes.data(), bytes.size(), VietEncoding::Unicode);
+        text += L'\n';
+    }
+    return text;
+}
+
+int main(int argc, char** argv) {
+    bool modernTone = false;
+    bool resultCache = false;
+    std::vector<const char*> files;
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--modern") == 0) modernTone = true;
+        else if (std::strcmp(argv[i], "--cache") == 0) resultCache = true;
+        else files.push_back(argv[i]);
+    }
+    std::wstring text = LoadText(files);
+    std::printf("%zu characters of text, %s tone placement, result cache %s\n", text.size(),
+                modernTone ? "modern" : "classic", resultCache ? "on" : "off");
+
+    int failures = 0;
+    for (bool vni : {false, true}) {
+        TypingStyle style;
+        style.vni = vni;
+        TypedText typed = TypeText(text, style);
+
+        Pipeline pipeline(vni, modernTone, resultCache);
+        std::vector<double> ns;
+        ns.reserve(typed.keys.size());
+        auto start = std::chrono::steady_clock::now();
+        for (const Keystroke& key : typed.keys) {
+            auto keyStart = std::chrono::steady_clock::now();
+            pipeline.Key(key);
+            ns.push_back(std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - keyStart).count());
+        }
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        bool same = pipeline.GetScreen().Text() == typed.expected;
+        failures += !same;
+        const ResultCache::Stats& cache = pipeline.CacheStats();
+        std::printf("\n%s: %zu keys, %zu sends, %llu cache hits, screen %s\n", vni ? "VNI" : "Telex",
+                    typed.keys.size(), pipeline.Sends(), static_cast<unsigned long long>(cache.hits),
+                    same ? "matches the text" : "DIFFERS");
+        if (!same) ReportMismatch(pipeline.GetScreen().Text(), typed.expected);
+        std::printf("  %.2f M keys/s\n", typed.keys.size() / seconds / 1e6);
+        std::printf("  per key: p50 %.0f ns, p90 %.0f, p99 %.0f, p99.9 %.0f, max %.0f\n", Percentile(ns, 0.5),
+                    Percentile(ns, 0.9), Percentile(ns, 0.99), Percentile(ns, 0.999), Percentile(ns, 1.0));
+    }
+    return failures;
+}
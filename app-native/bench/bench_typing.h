@@ -0,0 +1,146 @@
+// ViKey - Typing Simulation for Benchmarks
+// bench_typing.h
+// Turns Vietnamese text back into the Windows key presses that type it in
+// Telex or VNI, with typos corrected by Backspace along the way
+
+#pragma once
+
+#include "keycodes.h"
+#include "viet_normalizer.h"
+#include <algorithm>
+#include <cstdint>
+#include <cwctype>
+#include <string>
+#include <vector>
+
+// One key down as the hook sees it
+struct Keystroke {
+    uint8_t vk;
+    bool shift;
+    wchar_t native;  // what the key types when the IME lets it through; 0 for none
+};
+
+struct TypingStyle {
+    bool vni = false;
+    unsigned typoEvery = 12;  // about one word in N has a typo fixed with Backspace; 0 for none
+    unsigned escEvery = 0;    // about one word in N is followed by ESC; 0 for none
+};
+
+struct TypedText {
+    std::vector<Keystroke> keys;
+    std::wstring expected;  // the text in NFC, without characters no key types
+};
+
+namespace BenchTyping {
+
+inline void PushChar(std::vector<Keystroke>& keys, wchar_t c) {
+    bool upper = c >= L'A' && c <= L'Z';
+    if (upper || (c >= L'a' && c <= L'z')) {
+        keys.push_back({static_cast<uint8_t>(VK_A_KEY + (upper ? c - L'A' : c - L'a')), upper, c});
+    } else if (c >= L'0' && c <= L'9') {
+        keys.push_back({static_cast<uint8_t>(VK_0_KEY + (c - L'0')), false, c});
+    }
+}
+
+// Punctuation and white space on a US layout; false for anything else
+inline bool PushOther(std::vector<Keystroke>& keys, wchar_t c) {
+    struct Key { wchar_t c; int vk; bool shift; };
+    static const Key KEYS[] = {
+        {L' ', VK_SPACE_KEY, false},     {L'\n', VK_RETURN_KEY, false},   {L'\t', VK_TAB_KEY, false},
+        {L'.', VK_OEM_PERIOD_KEY, false}, {L',', VK_OEM_COMMA_KEY, false}, {L';', VK_OEM_1_KEY, false},
+        {L':', VK_OEM_1_KEY, true},       {L'\'', VK_OEM_7_KEY, false},    {L'"', VK_OEM_7_KEY, true},
+        {L'-', VK_OEM_MINUS_KEY, false},  {L'/', VK_OEM_2_KEY, false},     {L'?', VK_OEM_2_KEY, true},
+        {L'!', VK_0_KEY + 1, true},       {L'(', VK_0_KEY + 9, true},      {L')', VK_0_KEY, true},
+    };
+    for (const Key& key : KEYS) {
+        if (key.c != c) continue;
+        keys.push_back({static_cast<uint8_t>(key.vk), key.shift, c});
+        return true;
+    }
+    return false;
+}
+
+// Keys for one word in NFD: letters with their modifiers in place, the tone
+// key last, as most people type. Returns how many keys come before the first
+// modifier or tone key.
+inline size_t TypeWord(std::vector<Keystroke>& keys, const std::wstring& word, bool vni) {
+    size_t start = keys.size();
+    size_t plain = SIZE_MAX;
+    wchar_t tone = 0;
+    wchar_t base = 0;  // the letter the marks that follow belong to; NFD puts a dot below first
+    for (wchar_t c : word) {
+        bool upper = c == 0x0110;
+        if (c == 0x0110 || c == 0x0111) {  // đ
+            PushChar(keys, upper ? L'D' : L'd');
+            plain = std::min(plain, keys.size() - start);
+            PushChar(keys, vni ? L'9' : L'd');
+            continue;
+        }
+        if (c < 0x0300 || c > 0x036F) base = c;
+        else plain = std::min(plain, keys.size() - start);
+        switch (c) {
+        case 0x0302: PushChar(keys, vni ? L'6' : static_cast<wchar_t>(towlower(base))); break;
+        case 0x0306: PushChar(keys, vni ? L'8' : L'w'); break;
+        case 0x031B: PushChar(keys, vni ? L'7' : L'w'); break;
+        case 0x0300: case 0x0301: case 0x0303: case 0x0309: case 0x0323: tone = c; break;
+        default: PushChar(keys, c);
+        }
+    }
+    switch (tone) {
+    case 0x0301: PushChar(keys, vni ? L'1' : L's'); break;
+    case 0x0300: PushChar(keys, vni ? L'2' : L'f'); break;
+    case 0x0309: PushChar(keys, vni ? L'3' : L'r'); break;
+    case 0x0303: PushChar(keys, vni ? L'4' : L'x'); break;
+    case 0x0323: PushChar(keys, vni ? L'5' : L'j'); break;
+    }
+    return std::min(plain, keys.size() - start);
+}
+
+inline bool IsWordChar(wchar_t c) {
+    return (c >= L'a' && c <= L'z') || (c >= L'A' && c <= L'Z') || (c >= L'0' && c <= L'9') ||
+           (c >= 0x0300 && c <= 0x036F) || c == 0x0110 || c == 0x0111;
+}
+
+}  // namespace BenchTyping
+
+// The whole text as key presses. A typo is a wrong letter among the word's
+// plain letters, deleted with Backspace before the first modifier key. Later
+// in the word it would test something else: the engine gives up on a word the
+// wrong letter makes English or invalid ("nôk" -> "nook", "chủk" -> "churk")
+// and Backspace does not bring the marks back.
+inline TypedText TypeText(const std::wstring& text, const TypingStyle& style) {
+    using namespace BenchTyping;
+    std::wstring nfd;
+    VietNormalizer::ToNfd(text.data(), text.size(), nfd);
+
+    TypedText typed;
+    std::wstring expectedNfd;
+    uint32_t seed = 12345;
+    std::wstring word;
+    for (size_t i = 0; i <= nfd.size(); i++) {
+        wchar_t c = i < nfd.size() ? nfd[i] : L'\n';
+        if (IsWordChar(c)) {
+            word += c;
+            continue;
+        }
+        if (!word.empty()) {
+            seed = seed * 1103515245 + 12345;
+            uint32_t roll = seed >> 16;
+            size_t start = typed.keys.size();
+            size_t plain = TypeWord(typed.keys, word, style.vni);
+            if (style.typoEvery && roll % style.typoEvery == 0 && plain > 1) {
+                size_t at = start + 1 + (roll >> 4) % (plain - 1);
+                typed.keys.insert(typed.keys.begin() + at, {{static_cast<uint8_t>(VK_A_KEY + 'k' - 'a'), false, L'k'},
+                                                            {static_cast<uint8_t>(VK_BACK_KEY), false, 0}});
+            }
+            if (style.escEvery && roll % style.escEvery == 1) {
+                typed.keys.push_back({static_cast<uint8_t>(VK_ESCAPE_KEY), false, 0});
+            }
+            expectedNfd += word;
+            word.clear();
+        }
+        if (i < nfd.size() && PushOther(typed.keys, c)) expectedNfd += c;
+    }
+    VietNormalizer::ToNfc(expectedNfd.data(), expectedNfd.size(), typed.expected);
+    return typed;
+}
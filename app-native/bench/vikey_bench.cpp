@@ -0,0 +1,273 @@
+// ViKey - Native Layer Microbenchmarks
+// vikey_bench.cpp
+// Google Benchmark suite for the per-key and per-document paths: key code
+// mapping, shortcut matching, encoding conversion, engine results and the
+// settings JSON format. Built when Google Benchmark is found; the engine
+// round trips need the core static library (VIKEY_CORE_LIB) as well.
+//
+// Usage: vikey_bench [--benchmark_filter=<regex>]
+//        vikey_bench --benchmark_out=vikey_bench.json --benchmark_out_format=json
+// (the vikey_bench_report target writes the JSON with repetitions)
+
+#include <benchmark/benchmark.h>
+#include "bench_common.h"
+#include "encoding_converter.h"
+#include "ime_result.h"
+#include "keycodes.h"
+#include "settings_json.h"
+#include "shortcut_manager.h"
+#ifdef VIKEY_BENCH_CORE
+#include "bench_core.h"
+#endif
+#include <string>
+#include <vector>
+
+// Every VK code the hook can see, one key per iteration
+static void BM_KeyCodes_ToMacKeycode(benchmark::State& state) {
+    int vk = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(KeyCodes::ToMacKeycode(vk));
+        vk = (vk + 1) & 0xFF;
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_KeyCodes_ToMacKeycode);
+
+static void BM_KeyCodes_ToChar(benchmark::State& state) {
+    int vk = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(KeyCodes::ToChar(vk, (vk & 1) != 0, false));
+        vk = (vk + 1) & 0xFF;
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_KeyCodes_ToChar);
+
+// The checks ProcessKey makes before a key reaches the engine
+static void BM_KeyCodes_Classify(benchmark::State& state) {
+    int vk = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(KeyCodes::IsRelevantKey(vk) && !KeyCodes::IsBufferClearKey(vk));
+        vk = (vk + 1) & 0xFF;
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_KeyCodes_Classify);
+
+static std::vector<TextShortcut> MakeShortcuts(size_t count) {
+    const std::wstring sample = BenchSampleText();
+    std::vector<TextShortcut> shortcuts;
+    shortcuts.reserve(count);
+    for (size_t i = 0; i < count; i++) {
+        size_t start = (i * 7) % (sample.size() - 80);
+        shortcuts.push_back({L"sc" + std::to_wstring(i), sample.substr(start, 20 + i % 61)});
+    }
+    return shortcuts;
+}
+
+// A word typed into the shortcut buffer, then cleared by a word boundary
+static void BM_Shortcut_OnChar(benchmark::State& state) {
+    ShortcutManager& shortcuts = ShortcutManager::Instance();
+    shortcuts.SetShortcuts(MakeShortcuts(static_cast<size_t>(state.range(0))));
+    const char word[] = "truong";
+    for (auto _ : state) {
+        for (const char* c = word; *c; c++) shortcuts.OnChar(*c);
+        shortcuts.Clear();
+    }
+    state.SetItemsProcessed(state.iterations() * (sizeof(word) - 1));
+}
+BENCHMARK(BM_Shortcut_OnChar)->Arg(10)->Arg(1000);
+
+// Space after a word: the last shortcut in the table, or none at all
+static void CheckExpansion(benchmark::State& state, bool hit) {
+    size_t count = static_cast<size_t>(state.range(0));
+    ShortcutManager& shortcuts = ShortcutManager::Instance();
+    shortcuts.SetShortcuts(MakeShortcuts(count));
+    const std::string word = hit ? "sc" + std::to_string(count - 1) : "truong";
+    for (auto _ : state) {
+        for (char c : word) shortcuts.OnChar(c);
+        auto expansion = shortcuts.CheckExpansion();
+        if (expansion.second != (hit ? word.size() : 0)) state.SkipWithError("wrong expansion");
+        benchmark::DoNotOptimize(expansion);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+static void BM_Shortcut_CheckExpansionHit(benchmark::State& state) {
+    CheckExpansion(state, true);
+}
+BENCHMARK(BM_Shortcut_CheckExpansionHit)->RangeMultiplier(10)->Range(10, 10000);
+
+static void BM_Shortcut_CheckExpansionMiss(benchmark::State& state) {
+    CheckExpansion(state, false);
+}
+BENCHMARK(BM_Shortcut_CheckExpansionMiss)->RangeMultiplier(10)->Range(10, 10000);
+
+static const VietEncoding ENCODINGS[] = {
+    VietEncoding::Unicode, VietEncoding::VNI_Windows, VietEncoding::TCVN3, VietEncoding::Unicode_Comp,
+    VietEncoding::VISCII,  VietEncoding::VIQR,        VietEncoding::UTF8_Bytes,
+};
+
+// Stable names for the result files, unlike the display names
+static const char* EncodingId(VietEncoding enc) {
+    switch (enc) {
+    case VietEncoding::Unicode: return "unicode";
+    case VietEncoding::VNI_Windows: return "vni";
+    case VietEncoding::TCVN3: return "tcvn3";
+    case VietEncoding::Unicode_Comp: return "nfd";
+    case VietEncoding::VISCII: return "viscii";
+    case VietEncoding::VIQR: return "viqr";
+    case VietEncoding::UTF8_Bytes: return "utf8bytes";
+    }
+    return "unknown";
+}
+
+// Convert() of the sample corpus, re-encoded as the source encoding; the
+// range is the length of the Unicode text: a word, a paragraph, a document
+static void BM_Convert(benchmark::State& state, VietEncoding from, VietEncoding to) {
+    EncodingConverter& converter = EncodingConverter::Instance();
+    std::wstring unicode = BenchCorpus(static_cast<size_t>(state.range(0)));
+    unicode.resize(static_cast<size_t>(state.range(0)));
+    const std::wstring text = converter.Convert(unicode, VietEncoding::Unicode, from);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(converter.Convert(text, from, to));
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(unicode.size()));
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(text.size() * sizeof(wchar_t)));
+}
+
+static void RegisterConvert() {
+    for (VietEncoding from : ENCODINGS) {
+        for (VietEncoding to : ENCODINGS) {
+            if (from == to) continue;
+            std::string name = std::string("BM_Convert/") + EncodingId(from) + "_to_" + EncodingId(to);
+            benchmark::RegisterBenchmark(name.c_str(), BM_Convert, from, to)->Arg(16)->Arg(4 << 10)->Arg(256 << 10);
+        }
+    }
+}
+
+// A result as the engine returns it: `count` characters of Vietnamese text
+static ImeResult MakeResult(size_t count) {
+    const std::wstring sample = BenchSampleText();
+    std::vector<uint32_t> chars;
+    for (size_t i = 0; i < count; i++) chars.push_back(static_cast<uint32_t>(sample[i % sample.size()]));
+    return ImeResult(ImeAction::Send, 1, static_cast<uint8_t>(count), 0, chars.data(), chars.size());
+}
+
+static void BM_ImeResult_GetText(benchmark::State& state) {
+    const ImeResult result = MakeResult(static_cast<size_t>(state.range(0)));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(result.GetText());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_ImeResult_GetText)->Arg(1)->Arg(7)->Arg(32)->Arg(255);
+
+// The copy ParseResult makes of every engine result
+static void BM_ImeResult_FromNative(benchmark::State& state) {
+    NativeResult native = {};
+    native.action = static_cast<uint8_t>(ImeAction::Send);
+    native.count = static_cast<uint8_t>(state.range(0));
+    for (int i = 0; i < native.count; i++) native.chars[i] = 0x1EC7;  // ệ
+    for (auto _ : state) {
+        ImeResult result(static_cast<ImeAction>(native.action), native.backspace, native.count, native.flags,
+                         native.chars, native.count);
+        benchmark::DoNotOptimize(result);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_ImeResult_FromNative)->Arg(1)->Arg(7)->Arg(255);
+
+static void BM_SettingsJson_Export(benchmark::State& state) {
+    const std::vector<TextShortcut> shortcuts = MakeShortcuts(static_cast<size_t>(state.range(0)));
+    size_t size = 0;
+    for (auto _ : state) {
+        std::wstring json = ExportShortcutsJson(shortcuts);
+        size = json.size();
+        benchmark::DoNotOptimize(json);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(size * sizeof(wchar_t)));
+}
+BENCHMARK(BM_SettingsJson_Export)->RangeMultiplier(10)->Range(10, 10000);
+
+// UTF-16LE file bytes with a BOM, as ExportShortcutsToFile writes them
+static std::string ToUtf16File(const std::wstring& text) {
+    std::string out = "\xFF\xFE";
+    out.reserve(2 + text.size() * 2);
+    for (wchar_t c : text) {
+        out += static_cast<char>(c & 0xFF);
+        out += static_cast<char>((c >> 8) & 0xFF);
+    }
+    return out;
+}
+
+// Importing an exported file: UTF-16 as written by the app, or UTF-8
+static void ImportJson(benchmark::State& state, bool utf16) {
+    const std::vector<TextShortcut> shortcuts = MakeShortcuts(static_cast<size_t>(state.range(0)));
+    const std::wstring json = ExportShortcutsJson(shortcuts);
+    const std::string bytes = utf16 ? ToUtf16File(json) : EncodingConverter::EncodeBytes(json, VietEncoding::Unicode);
+    std::vector<TextShortcut> imported;
+    for (auto _ : state) {
+        bool ok = WithJsonFileReader(bytes.data(), bytes.size(),
+                                     [&](auto& reader) { return ImportShortcutsJson(reader, imported); });
+        if (!ok || imported.size() != shortcuts.size()) state.SkipWithError("import failed");
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(bytes.size()));
+}
+
+static void BM_SettingsJson_ImportUtf16(benchmark::State& state) {
+    ImportJson(state, true);
+}
+BENCHMARK(BM_SettingsJson_ImportUtf16)->RangeMultiplier(10)->Range(10, 10000);
+
+static void BM_SettingsJson_ImportUtf8(benchmark::State& state) {
+    ImportJson(state, false);
+}
+BENCHMARK(BM_SettingsJson_ImportUtf8)->RangeMultiplier(10)->Range(10, 10000);
+
+#ifdef VIKEY_BENCH_CORE
+// Telex keystrokes of everyday words, each followed by Space
+static std::vector<uint16_t> TelexKeys() {
+    const char* words[] = {"tieengs", "vieejt", "laf", "ngoon", "nguwx", "chinhs", "thuwcs", "cuar",
+                           "nuwowcs", "coongj", "hoaf",  "xax",  "hooij", "chur",  "nghiax", "nam"};
+    std::vector<uint16_t> keys;
+    for (const char* word : words) {
+        for (const char* c = word; *c; c++) keys.push_back(KeyCodes::ToMacKeycode(*c - 'a' + VK_A_KEY));
+        keys.push_back(KeyCodes::ToMacKeycode(VK_SPACE_KEY));
+    }
+    return keys;
+}
+
+// RustBridge's key path without the DLL: CoreEngine over the static library,
+// then the result's text as ImeProcessor uses it
+static void BM_CoreEngine_ProcessKeyExt(benchmark::State& state) {
+    const std::vector<uint16_t> keys = TelexKeys();
+    const uint16_t space = KeyCodes::ToMacKeycode(VK_SPACE_KEY);
+    CoreEngine engine;
+    StartCoreEngine(engine, BenchSettings(InputMethod::Telex, true, state.range(0) != 0));
+    size_t i = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(engine.ProcessKeyExt(keys[i], false, false, false).GetText());
+        if (keys[i] == space) engine.Clear();
+        if (++i == keys.size()) i = 0;
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_CoreEngine_ProcessKeyExt)->ArgName("cache")->Arg(0)->Arg(1);
+#endif
+
+int main(int argc, char** argv) {
+    RegisterConvert();
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv)) return 1;
+#ifdef VIKEY_BENCH_CORE
+    benchmark::AddCustomContext("vikey_core", "linked");
+#else
+    benchmark::AddCustomContext("vikey_core", "not linked");
+#endif
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
@@ -3,8 +3,8 @@
 // Project: ViKey | Author: Tran Cong Sinh | https://github.com/kmis8x/ViKey
 
 #include "app_detector.h"
+#include "settings.h"
 #include <psapi.h>
-#include <algorithm>
 
 #pragma comment(lib, "psapi.lib")
 
@@ -18,11 +18,19 @@ AppDetector::AppDetector()
 }
 
 std::wstring AppDetector::GetForegroundAppName() {
+    return std::wstring(AppNameFromPath(GetForegroundAppPath()));
+}
+
+std::wstring AppDetector::GetForegroundAppPath() {
     HWND hwnd = GetForegroundWindow();
     if (!hwnd) return L"";
 
     DWORD processId = 0;
     GetWindowThreadProcessId(hwnd, &processId);
+    return GetAppPath(processId);
+}
+
+std::wstring AppDetector::GetAppPath(DWORD processId) {
     if (processId == 0) return L"";
 
     HANDLE hProcess = OpenProcess(PROCESS_QUERY_LIMITED_INFORMATION, FALSE, processId);
@@ -30,23 +38,15 @@ std::wstring AppDetector::GetForegroundAppName() {
 
     wchar_t exePath[MAX_PATH] = {};
     DWORD size = MAX_PATH;
-    std::wstring appName;
+    std::wstring appPath;
 
     if (QueryFullProcessImageNameW(hProcess, 0, exePath, &size)) {
-        // Extract filename from full path
-        std::wstring fullPath(exePath);
-        size_t lastSlash = fullPath.find_last_of(L"\\");
-        if (lastSlash != std::wstring::npos) {
-            appName = fullPath.substr(lastSlash + 1);
-        } else {
-            appName = fullPath;
-        }
-        // Convert to lowercase for consistency
-        std::transform(appName.begin(), appName.end(), appName.begin(), ::towlower);
+        // Lowercase for consistency
+        appPath = FoldCase(std::wstring_view(exePath, size));
     }
 
     CloseHandle(hProcess);
-    return appName;
+    return appPath;
 }
 
 bool AppDetector::HasAppChanged() {
@@ -62,18 +62,14 @@ bool AppDetector::HasAppChanged() {
     return false;
 }
 
+// Called on every focus change with smart switch on: memory only, the journal
+// thread does the writing
 void AppDetector::SaveAppState(const std::wstring& app, bool enabled) {
     if (app.empty()) return;
+    auto it = m_appStates.find(app);
+    if (it != m_appStates.end() && it->second.enabled == enabled) return;
     m_appStates[app].enabled = enabled;
-
-    // Save to registry
-    HKEY hKey;
-    if (RegCreateKeyExW(HKEY_CURRENT_USER, APP_STATES_PATH, 0, nullptr,
-                        REG_OPTION_NON_VOLATILE, KEY_WRITE, nullptr, &hKey, nullptr) == ERROR_SUCCESS) {
-        DWORD value = enabled ? 1 : 0;
-        RegSetValueExW(hKey, app.c_str(), 0, REG_DWORD, (LPBYTE)&value, sizeof(value));
-        RegCloseKey(hKey);
-    }
+    if (m_journal) m_journal->RecordEnabled(app, enabled);
 }
 
 bool AppDetector::GetAppState(const std::wstring& app, bool defaultEnabled) {
@@ -88,46 +84,27 @@ bool AppDetector::GetAppState(const std::wstring& app, bool defaultEnabled) {
 
 void AppDetector::ClearAppState(const std::wstring& app) {
     if (app.empty()) return;
-    m_appStates.erase(app);
-
-    // Remove from registry
-    HKEY hKey;
-    if (RegOpenKeyExW(HKEY_CURRENT_USER, APP_STATES_PATH, 0, KEY_WRITE, &hKey) == ERROR_SUCCESS) {
-        RegDeleteValueW(hKey, app.c_str());
-        RegCloseKey(hKey);
-    }
+    if (m_appStates.erase(app) && m_journal) m_journal->RecordClear(app);
 }
 
 void AppDetector::SetExcludedApps(const std::vector<std::wstring>& apps) {
     m_excludedApps = apps;
+    m_exclusions.Compile(apps);
 }
 
-bool AppDetector::IsCurrentAppExcluded() {
-    std::wstring currentApp = GetForegroundAppName();
-    if (currentApp.empty()) return false;
+bool AppDetector::IsAppExcluded(const std::wstring& appPath) {
+    if (appPath.empty() || m_exclusions.RuleCount() == 0) return false;
+    return m_exclusions.IsExcluded(m_exclusions.Intern(appPath));
+}
 
-    for (const auto& excluded : m_excludedApps) {
-        std::wstring lowerExcluded = excluded;
-        std::transform(lowerExcluded.begin(), lowerExcluded.end(), lowerExcluded.begin(), ::towlower);
-        if (currentApp == lowerExcluded) {
-            return true;
-        }
-    }
-    return false;
+bool AppDetector::IsCurrentAppExcluded() {
+    return IsAppExcluded(GetForegroundAppPath());
 }
 
 void AppDetector::SetAppEncoding(const std::wstring& app, int encoding) {
     if (app.empty()) return;
     m_appStates[app].encoding = encoding;
-
-    // Save to registry
-    HKEY hKey;
-    if (RegCreateKeyExW(HKEY_CURRENT_USER, APP_ENCODINGS_PATH, 0, nullptr,
-                        REG_OPTION_NON_VOLATILE, KEY_WRITE, nullptr, &hKey, nullptr) == ERROR_SUCCESS) {
-        DWORD value = static_cast<DWORD>(encoding);
-        RegSetValueExW(hKey, app.c_str(), 0, REG_DWORD, (LPBYTE)&value, sizeof(value));
-        RegCloseKey(hKey);
-    }
+    if (m_journal) m_journal->RecordEncoding(app, encoding);
 }
 
 int AppDetector::GetAppEncoding(const std::wstring& app, int defaultEncoding) {
@@ -141,6 +118,29 @@ int AppDetector::GetAppEncoding(const std::wstring& app, int defaultEncoding) {
 }
 
 void AppDetector::Load() {
+    std::wstring path = Settings::DataFilePath(L"appstates.journal");
+    if (path.empty()) {
+        LoadFromRegistry();
+        return;
+    }
+
+    m_journal = std::make_unique<AppStateJournal>(path);
+    if (m_journal->Load(m_appStates)) return;
+
+    // First run with a journal: take over what older versions saved in the
+    // registry. The keys are left as they were.
+    LoadFromRegistry();
+    for (const auto& item : m_appStates) {
+        m_journal->RecordEnabled(item.first, item.second.enabled);
+        if (item.second.encoding != 0) m_journal->RecordEncoding(item.first, item.second.encoding);
+    }
+}
+
+void AppDetector::Flush() {
+    if (m_journal) m_journal->Flush();
+}
+
+void AppDetector::LoadFromRegistry() {
     // Load all app states from registry
     HKEY hKey;
     if (RegOpenKeyExW(HKEY_CURRENT_USER, APP_STATES_PATH, 0, KEY_READ, &hKey) == ERROR_SUCCESS) {
@@ -185,44 +185,4 @@ void AppDetector::Load() {
         }
         RegCloseKey(hKey);
     }
-
-    // Load excluded apps
-    HKEY hMainKey;
-    if (RegOpenKeyExW(HKEY_CURRENT_USER, REGISTRY_PATH, 0, KEY_READ, &hMainKey) == ERROR_SUCCESS) {
-        wchar_t buffer[4096] = {};
-        DWORD size = sizeof(buffer);
-        DWORD type = REG_SZ;
-        if (RegQueryValueExW(hMainKey, L"ExcludedApps", nullptr, &type, (LPBYTE)buffer, &size) == ERROR_SUCCESS) {
-            // Parse pipe-delimited list
-            std::wstring apps(buffer);
-            m_excludedApps.clear();
-            size_t pos = 0;
-            while (pos < apps.length()) {
-                size_t pipe = apps.find(L'|', pos);
-                if (pipe == std::wstring::npos) pipe = apps.length();
-                std::wstring app = apps.substr(pos, pipe - pos);
-                if (!app.empty()) {
-                    m_excludedApps.push_back(app);
-                }
-                pos = pipe + 1;
-            }
-        }
-        RegCloseKey(hMainKey);
-    }
-}
-
-void AppDetector::Save() {
-    // Save excluded apps to registry
-    HKEY hKey;
-    if (RegCreateKeyExW(HKEY_CURRENT_USER, REGISTRY_PATH, 0, nullptr,
-                        REG_OPTION_NON_VOLATILE, KEY_WRITE, nullptr, &hKey, nullptr) == ERROR_SUCCESS) {
-        std::wstring apps;
-        for (size_t i = 0; i < m_excludedApps.size(); i++) {
-            if (i > 0) apps += L'|';
-            apps += m_excludedApps[i];
-        }
-        RegSetValueExW(hKey, L"ExcludedApps", 0, REG_SZ,
-                       (LPBYTE)apps.c_str(), static_cast<DWORD>((apps.length() + 1) * sizeof(wchar_t)));
-        RegCloseKey(hKey);
-    }
 }
@@ -5,14 +5,11 @@
 #pragma once
 
 #include <windows.h>
+#include <memory>
 #include <string>
-#include <unordered_map>
-
-// Per-app state storage
-struct AppState {
-    bool enabled;
-    int encoding;  // For Feature 8: App Encoding Memory
-};
+#include <vector>
+#include "app_state_journal.h"
+#include "exclusion_matcher.h"
 
 class AppDetector {
 public:
@@ -21,6 +18,13 @@ public:
     // Get current foreground app name (e.g., "notepad.exe")
     std::wstring GetForegroundAppName();
 
+    // Full image path of the foreground app, lowercased
+    // (e.g., "c:\windows\system32\notepad.exe"); empty if unknown
+    std::wstring GetForegroundAppPath();
+
+    // Full image path of a process, lowercased; empty if unknown
+    std::wstring GetAppPath(DWORD processId);
+
     // Check if foreground app has changed since last call
     bool HasAppChanged();
 
@@ -29,8 +33,10 @@ public:
     bool GetAppState(const std::wstring& app, bool defaultEnabled);
     void ClearAppState(const std::wstring& app);
 
-    // Exclusion list (Feature 3)
+    // Exclusion list (Feature 3), owned and stored by Settings. The rules
+    // are compiled here, so a check is a hash lookup of the app's id.
     void SetExcludedApps(const std::vector<std::wstring>& apps);
+    bool IsAppExcluded(const std::wstring& appPath);  // from GetForegroundAppPath()
     bool IsCurrentAppExcluded();
     const std::vector<std::wstring>& GetExcludedApps() const { return m_excludedApps; }
 
@@ -38,9 +44,13 @@ public:
     void SetAppEncoding(const std::wstring& app, int encoding);
     int GetAppEncoding(const std::wstring& app, int defaultEncoding);
 
-    // Load/Save to registry
+    // Load per-app states with one read of the journal (registry values of
+    // older versions are imported on the first run). Changes are kept in
+    // memory and appended to the journal by its own thread.
     void Load();
-    void Save();
+
+    // Write journaled changes now; call before exiting
+    void Flush();
 
 private:
     AppDetector();
@@ -48,12 +58,15 @@ private:
     AppDetector(const AppDetector&) = delete;
     AppDetector& operator=(const AppDetector&) = delete;
 
+    void LoadFromRegistry();
+
     HWND m_lastHwnd;
     std::wstring m_lastAppName;
-    std::unordered_map<std::wstring, AppState> m_appStates;
+    AppStateMap m_appStates;  // authoritative; the journal only mirrors it
     std::vector<std::wstring> m_excludedApps;
+    ExclusionMatcher m_exclusions;
+    std::unique_ptr<AppStateJournal> m_journal;  // null without a data folder: nothing is saved
 
-    static constexpr const wchar_t* REGISTRY_PATH = L"SOFTWARE\\ViKey";
     static constexpr const wchar_t* APP_STATES_PATH = L"SOFTWARE\\ViKey\\AppStates";
     static constexpr const wchar_t* APP_ENCODINGS_PATH = L"SOFTWARE\\ViKey\\AppEncodings";
 };
@@ -0,0 +1,238 @@
+// ViKey - Per-App State Journal Implementation
+// app_state_journal.cpp
+
+#include "app_state_journal.h"
+#include "binary_io.h"
+#include <cstring>
+
+static const char JOURNAL_MAGIC[4] = {'V', 'K', 'J', 0x1A};
+static const size_t HEADER_SIZE = 8;
+
+AppStateJournal::AppStateJournal(std::filesystem::path path, size_t compactMinRecords)
+    : m_path(std::move(path)), m_compactMinRecords(compactMinRecords) {
+    m_worker = std::thread(&AppStateJournal::Work, this);
+}
+
+AppStateJournal::~AppStateJournal() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_wake.notify_one();
+    m_worker.join();
+}
+
+bool AppStateJournal::Load(AppStateMap& states) {
+    std::string bytes;
+    AppStateMap loaded;
+    size_t records = 0;
+    bool valid = false;   // a journal of this format
+    bool intact = false;  // ...with no damaged tail
+    if (ReadWholeFile(m_path, bytes) && bytes.size() >= HEADER_SIZE &&
+        std::memcmp(bytes.data(), JOURNAL_MAGIC, sizeof(JOURNAL_MAGIC)) == 0) {
+        ByteReader header(bytes.data() + sizeof(JOURNAL_MAGIC), HEADER_SIZE - sizeof(JOURNAL_MAGIC));
+        uint32_t format = 0, reserved = 0;
+        header.U16(format);
+        header.U16(reserved);
+        valid = format == APP_STATE_JOURNAL_FORMAT && reserved == 0;
+    }
+
+    if (valid) {
+        ByteReader reader(bytes.data() + HEADER_SIZE, bytes.size() - HEADER_SIZE);
+        Record record;
+        intact = true;
+        while (!reader.AtEnd()) {
+            const char* start = reader.Position();
+            uint32_t op = 0, units = 0, crc = 0;
+            if (!reader.U8(op) || op < 1 || op > 3 || !reader.U16(units) || !reader.Text(units, record.app) ||
+                !reader.U32(record.value)) {
+                intact = false;
+                break;
+            }
+            size_t length = reader.Position() - start;
+            if (!reader.U32(crc) || Crc32(start, length) != crc) {
+                intact = false;
+                break;
+            }
+            record.op = static_cast<Op>(op);
+            Apply(loaded, record);
+            records++;
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_state = loaded;
+        m_fileRecords = records;
+        m_rewrite = !intact;
+        m_loaded = true;
+    }
+    m_wake.notify_one();
+    if (!valid) return false;
+    states = std::move(loaded);
+    return true;
+}
+
+void AppStateJournal::RecordEnabled(const std::wstring& app, bool enabled) {
+    Push(Op::Enabled, app, enabled ? 1 : 0);
+}
+
+void AppStateJournal::RecordEncoding(const std::wstring& app, int encoding) {
+    Push(Op::Encoding, app, static_cast<uint32_t>(encoding));
+}
+
+void AppStateJournal::RecordClear(const std::wstring& app) {
+    Push(Op::Clear, app, 0);
+}
+
+// No wake-up while the writer is ticking: notify_one() is a system call, and
+// the woken writer may preempt the hook thread
+void AppStateJournal::Push(Op op, const std::wstring& app, uint32_t value) {
+    bool wake;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stats.records++;
+        m_pending.push_back({op, app, value});
+        wake = m_sleeping;
+    }
+    if (wake) m_wake.notify_one();
+}
+
+void AppStateJournal::Flush() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    if (!m_loaded) return;  // the writer writes nothing before Load()
+    uint64_t ticket = ++m_flushRequested;
+    m_wake.notify_one();
+    m_written.wait(lock, [&]() { return m_flushDone >= ticket; });
+}
+
+AppStateJournal::Stats AppStateJournal::GetStats() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_stats;
+}
+
+void AppStateJournal::Apply(AppStateMap& states, const Record& record) {
+    switch (record.op) {
+    case Op::Enabled:
+        states[record.app].enabled = record.value != 0;
+        break;
+    case Op::Encoding:
+        states[record.app].encoding = static_cast<int>(record.value);
+        break;
+    case Op::Clear:
+        states.erase(record.app);
+        break;
+    }
+}
+
+void AppStateJournal::Encode(std::string& out, const Record& record) {
+    size_t start = out.size();
+    out.resize(start + 1 + 2 + 2 * Utf16Length(record.app) + 4 + 4);
+    char* p = &out[start];
+    *p++ = static_cast<char>(record.op);
+    p = PutU16(p, static_cast<uint32_t>(Utf16Length(record.app)));
+    p = PutText(p, record.app);
+    p = PutU32(p, record.value);
+    PutU32(p, Crc32(&out[start], p - &out[start]));
+}
+
+void AppStateJournal::Work() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+
+    // Until Load() has read the file, m_state is not what the file holds and
+    // a write would replace the file with it
+    m_wake.wait(lock, [&]() { return m_loaded || m_stop; });
+    if (!m_loaded) return;
+
+    int idleTicks = 0;
+    for (;;) {
+        // Write what is queued once per tick; after IDLE_TICKS empty ticks,
+        // sleep until Push() wakes us
+        auto flushRequested = [&]() { return m_stop || m_flushDone < m_flushRequested; };
+        if (!flushRequested()) {
+            if (m_pending.empty() && idleTicks >= IDLE_TICKS) {
+                m_sleeping = true;
+                m_wake.wait(lock, [&]() { return flushRequested() || !m_pending.empty(); });
+                m_sleeping = false;
+            } else {
+                m_wake.wait_for(lock, WRITE_INTERVAL, flushRequested);
+            }
+        }
+        idleTicks = m_pending.empty() ? idleTicks + 1 : 0;
+
+        uint64_t ticket = m_flushRequested;
+        bool stop = m_stop;
+        std::vector<Record> batch;
+        batch.swap(m_pending);
+
+        // File I/O happens outside the lock, so Record*() never waits on the disk
+        lock.unlock();
+        WriteBatch(batch);
+        lock.lock();
+
+        m_flushDone = ticket;
+        m_written.notify_all();
+        if (stop && m_pending.empty()) return;
+    }
+}
+
+void AppStateJournal::WriteBatch(const std::vector<Record>& batch) {
+    if (batch.empty() && !m_rewrite) return;
+    for (const auto& record : batch) Apply(m_state, record);
+
+    size_t records = m_fileRecords + batch.size();
+    bool compact = m_rewrite || (records >= m_compactMinRecords && records > COMPACT_FACTOR * m_state.size());
+    bool ok = compact ? Compact() : Append(batch);
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!ok) {
+        m_stats.failures++;
+        m_rewrite = true;
+    } else if (compact) {
+        m_stats.compactions++;
+    } else {
+        m_stats.appended += batch.size();
+        m_stats.batches++;
+    }
+}
+
+bool AppStateJournal::Append(const std::vector<Record>& batch) {
+    if (!m_out.is_open()) {
+        m_out.clear();
+        m_out.open(m_path, std::ios::binary | std::ios::app);
+        if (!m_out) return false;
+    }
+    std::string bytes;
+    for (const auto& record : batch) Encode(bytes, record);
+    m_out.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+    m_out.flush();
+    if (!m_out) {
+        m_out.close();
+        return false;
+    }
+    m_fileRecords += batch.size();
+    return true;
+}
+
+// One enabled record per app, plus its encoding when one is set
+bool AppStateJournal::Compact() {
+    m_out.close();  // the file is replaced under this handle
+
+    std::string bytes(JOURNAL_MAGIC, sizeof(JOURNAL_MAGIC));
+    bytes.resize(HEADER_SIZE);
+    PutU16(PutU16(&bytes[sizeof(JOURNAL_MAGIC)], APP_STATE_JOURNAL_FORMAT), 0);
+    size_t records = 0;
+    for (const auto& item : m_state) {
+        Encode(bytes, {Op::Enabled, item.first, item.second.enabled ? 1u : 0u});
+        records++;
+        if (item.second.encoding != 0) {
+            Encode(bytes, {Op::Encoding, item.first, static_cast<uint32_t>(item.second.encoding)});
+            records++;
+        }
+    }
+
+    if (!ReplaceFileContents(m_path, bytes)) return false;
+    m_fileRecords = records;
+    m_rewrite = false;
+    return true;
+}
@@ -0,0 +1,117 @@
+// ViKey - Per-App State Journal
+// app_state_journal.h
+// Append-only log of per-app IME state changes, written and compacted on a
+// background thread so the keystroke path never waits on storage
+
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// Per-app state storage
+struct AppState {
+    bool enabled = false;
+    int encoding = 0;  // For Feature 8: App Encoding Memory
+};
+
+using AppStateMap = std::unordered_map<std::wstring, AppState>;
+
+// File layout, all integers little-endian:
+//   header  "VKJ" 0x1A, u16 format, u16 reserved
+//   record  u8 op (1 enabled, 2 encoding, 3 clear), u16 app length, app (UTF-16 units),
+//           u32 value, u32 CRC-32 of the record up to here
+// Replaying the records in order gives the state. A torn last record (a crash
+// mid-append) is dropped on load and the file is rewritten on the next write.
+constexpr uint16_t APP_STATE_JOURNAL_FORMAT = 1;
+
+class AppStateJournal {
+public:
+    // Rewrite the file as a snapshot once it holds at least this many
+    // records and more than COMPACT_FACTOR per app
+    static constexpr size_t COMPACT_MIN_RECORDS = 512;
+    static constexpr size_t COMPACT_FACTOR = 4;
+
+    // The writer wakes this often while changes come in, and sleeps until
+    // the next change after IDLE_TICKS quiet ones
+    static constexpr std::chrono::milliseconds WRITE_INTERVAL{250};
+    static constexpr int IDLE_TICKS = 40;
+
+    explicit AppStateJournal(std::filesystem::path path, size_t compactMinRecords = COMPACT_MIN_RECORDS);
+    ~AppStateJournal();  // flushes
+
+    // One read of the file, replayed into states; call before the first
+    // Record*(). False when there is no usable file: the next write then
+    // creates one from what is recorded from here on. The writer thread
+    // writes nothing until this has run; without it changes are dropped.
+    bool Load(AppStateMap& states);
+
+    // Queue a change and return; the writer thread appends it within
+    // WRITE_INTERVAL. Takes a lock and copies the name, nothing more.
+    void RecordEnabled(const std::wstring& app, bool enabled);
+    void RecordEncoding(const std::wstring& app, int encoding);
+    void RecordClear(const std::wstring& app);
+
+    // Write queued changes now and wait until they are in the file
+    void Flush();
+
+    struct Stats {
+        uint64_t records = 0;      // Record*() calls
+        uint64_t appended = 0;     // records appended to the file
+        uint64_t batches = 0;      // appends (one per writer wake-up)
+        uint64_t compactions = 0;  // snapshot rewrites
+        uint64_t failures = 0;     // writes that failed; the next write rewrites the file
+    };
+    Stats GetStats() const;
+
+private:
+    AppStateJournal(const AppStateJournal&) = delete;
+    AppStateJournal& operator=(const AppStateJournal&) = delete;
+
+    enum class Op : uint8_t { Enabled = 1, Encoding = 2, Clear = 3 };
+
+    struct Record {
+        Op op;
+        std::wstring app;
+        uint32_t value;
+    };
+
+    void Push(Op op, const std::wstring& app, uint32_t value);
+    static void Apply(AppStateMap& states, const Record& record);
+    static void Encode(std::string& out, const Record& record);
+
+    // Writer thread only
+    void Work();
+    void WriteBatch(const std::vector<Record>& batch);
+    bool Append(const std::vector<Record>& batch);
+    bool Compact();
+
+    const std::filesystem::path m_path;
+    const size_t m_compactMinRecords;
+
+    mutable std::mutex m_mutex;
+    std::condition_variable m_wake;     // writer: flush, stop, or a record while sleeping
+    std::condition_variable m_written;  // Flush(): a batch is in the file
+    std::vector<Record> m_pending;
+    uint64_t m_flushRequested = 0;
+    uint64_t m_flushDone = 0;
+    bool m_stop = false;
+    bool m_sleeping = false;  // the writer waits for a Push() rather than its next tick
+    bool m_loaded = false;    // Load() has run; the writer idles until then
+    Stats m_stats;
+
+    // Owned by the writer thread once it sees m_loaded; Load() sets them first
+    AppStateMap m_state;        // what the file replays to, plus the batch being written
+    std::ofstream m_out;        // open for appending between batches
+    size_t m_fileRecords = 0;   // records in the file
+    bool m_rewrite = true;      // missing, damaged or failed: write a snapshot next
+
+    std::thread m_worker;
+};
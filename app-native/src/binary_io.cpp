@@ -0,0 +1,89 @@
+// ViKey - Binary File Helpers Implementation
+// binary_io.cpp
+
+#include "binary_io.h"
+#include <array>
+#include <cstdio>
+#include <fstream>
+#include <system_error>
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+// CRC-32 (IEEE 802.3, reflected), eight bytes per step; tables built at compile time
+static constexpr std::array<std::array<uint32_t, 256>, 8> MakeCrcTables() {
+    std::array<std::array<uint32_t, 256>, 8> tables{};
+    for (uint32_t i = 0; i < 256; i++) {
+        uint32_t c = i;
+        for (int k = 0; k < 8; k++) c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+        tables[0][i] = c;
+    }
+    for (uint32_t i = 0; i < 256; i++) {
+        for (int t = 1; t < 8; t++) {
+            uint32_t prev = tables[t - 1][i];
+            tables[t][i] = tables[0][prev & 0xFF] ^ (prev >> 8);
+        }
+    }
+    return tables;
+}
+
+static constexpr std::array<std::array<uint32_t, 256>, 8> CRC_TABLES = MakeCrcTables();
+
+uint32_t Crc32(const char* data, size_t size) {
+    const unsigned char* p = reinterpret_cast<const unsigned char*>(data);
+    uint32_t crc = 0xFFFFFFFFu;
+    for (; size >= 8; p += 8, size -= 8) {
+        uint32_t lo = crc ^ (p[0] | (p[1] << 8) | (p[2] << 16) | (static_cast<uint32_t>(p[3]) << 24));
+        crc = CRC_TABLES[7][lo & 0xFF] ^ CRC_TABLES[6][(lo >> 8) & 0xFF] ^
+              CRC_TABLES[5][(lo >> 16) & 0xFF] ^ CRC_TABLES[4][lo >> 24] ^
+              CRC_TABLES[3][p[4]] ^ CRC_TABLES[2][p[5]] ^ CRC_TABLES[1][p[6]] ^ CRC_TABLES[0][p[7]];
+    }
+    for (; size > 0; p++, size--) crc = CRC_TABLES[0][(crc ^ *p) & 0xFF] ^ (crc >> 8);
+    return crc ^ 0xFFFFFFFFu;
+}
+
+bool ReadWholeFile(const std::filesystem::path& path, std::string& bytes) {
+    std::ifstream in(path, std::ios::binary | std::ios::ate);
+    if (!in) return false;
+    std::streamoff size = in.tellg();
+    if (size < 0) return false;
+    bytes.assign(static_cast<size_t>(size), '\0');
+    in.seekg(0);
+    return size == 0 || static_cast<bool>(in.read(&bytes[0], size));
+}
+
+// Flush the data to the disk, not just to the OS: a rename can reach the disk
+// before the contents it points to
+static bool WriteDurably(const std::filesystem::path& path, const std::string& bytes) {
+#ifdef _WIN32
+    FILE* file = _wfopen(path.c_str(), L"wb");
+#else
+    FILE* file = std::fopen(path.c_str(), "wb");
+#endif
+    if (!file) return false;
+    bool ok = std::fwrite(bytes.data(), 1, bytes.size(), file) == bytes.size() && std::fflush(file) == 0;
+#ifdef _WIN32
+    ok = ok && _commit(_fileno(file)) == 0;
+#else
+    ok = ok && fsync(fileno(file)) == 0;
+#endif
+    return std::fclose(file) == 0 && ok;
+}
+
+bool ReplaceFileContents(const std::filesystem::path& path, const std::string& bytes) {
+    std::filesystem::path tmp = path;
+    tmp += ".tmp";
+    std::error_code ec;
+    if (!WriteDurably(tmp, bytes)) {
+        std::filesystem::remove(tmp, ec);
+        return false;
+    }
+    std::filesystem::rename(tmp, path, ec);
+    if (ec) {
+        std::filesystem::remove(tmp, ec);
+        return false;
+    }
+    return true;
+}
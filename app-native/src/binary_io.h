@@ -0,0 +1,112 @@
+// ViKey - Binary File Helpers
+// binary_io.h
+// Little-endian encoding, CRC-32 and whole-file I/O shared by the settings
+// file and the per-app state journal
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+
+// CRC-32 (IEEE 802.3), as zlib computes it
+uint32_t Crc32(const char* data, size_t size);
+
+// The writers fill a buffer sized up front (Utf16Length() for text) and
+// return the position after what they wrote
+
+inline char* PutU16(char* out, uint32_t v) {
+    out[0] = static_cast<char>(v & 0xFF);
+    out[1] = static_cast<char>((v >> 8) & 0xFF);
+    return out + 2;
+}
+
+inline char* PutU32(char* out, uint32_t v) {
+    return PutU16(PutU16(out, v & 0xFFFF), v >> 16);
+}
+
+// Text is stored as UTF-16 units, so a file reads the same where wchar_t is 32 bits
+inline size_t Utf16Length(const std::wstring& text) {
+    size_t units = text.size();
+    if (sizeof(wchar_t) > 2) {
+        for (wchar_t wc : text) {
+            if (static_cast<uint32_t>(wc) > 0xFFFF && static_cast<uint32_t>(wc) <= 0x10FFFF) units++;
+        }
+    }
+    return units;
+}
+
+inline char* PutText(char* out, const std::wstring& text) {
+    for (wchar_t wc : text) {
+        uint32_t c = static_cast<uint32_t>(wc);
+        if (c > 0xFFFF && c <= 0x10FFFF) {
+            c -= 0x10000;
+            out = PutU16(out, 0xD800 | (c >> 10));
+            out = PutU16(out, 0xDC00 | (c & 0x3FF));
+        } else {
+            out = PutU16(out, c);
+        }
+    }
+    return out;
+}
+
+// Bounds-checked reader; every read fails once the data runs out
+class ByteReader {
+public:
+    ByteReader(const char* data, size_t size)
+        : m_p(reinterpret_cast<const unsigned char*>(data)), m_end(m_p + size) {}
+
+    bool U8(uint32_t& v) {
+        if (m_end - m_p < 1) return false;
+        v = *m_p++;
+        return true;
+    }
+    bool U16(uint32_t& v) {
+        if (m_end - m_p < 2) return false;
+        v = m_p[0] | (m_p[1] << 8);
+        m_p += 2;
+        return true;
+    }
+    bool U32(uint32_t& v) {
+        if (m_end - m_p < 4) return false;
+        v = m_p[0] | (m_p[1] << 8) | (m_p[2] << 16) | (static_cast<uint32_t>(m_p[3]) << 24);
+        m_p += 4;
+        return true;
+    }
+    bool Text(size_t units, std::wstring& text) {
+        if (static_cast<size_t>(m_end - m_p) / 2 < units) return false;
+        text.resize(units);
+        wchar_t* out = &text[0];
+        const unsigned char* end = m_p + units * 2;
+        while (m_p < end) {
+            uint32_t c = m_p[0] | (m_p[1] << 8);
+            m_p += 2;
+            if (sizeof(wchar_t) > 2 && c >= 0xD800 && c < 0xDC00 && m_p < end) {
+                uint32_t low = m_p[0] | (m_p[1] << 8);
+                if (low >= 0xDC00 && low < 0xE000) {
+                    c = 0x10000 + ((c - 0xD800) << 10) + (low - 0xDC00);
+                    m_p += 2;
+                }
+            }
+            *out++ = static_cast<wchar_t>(c);
+        }
+        text.resize(out - text.data());
+        return true;
+    }
+
+    const char* Position() const { return reinterpret_cast<const char*>(m_p); }
+    size_t Remaining() const { return m_end - m_p; }
+    bool AtEnd() const { return m_p == m_end; }
+
+private:
+    const unsigned char* m_p;
+    const unsigned char* m_end;
+};
+
+// The whole file in one read; false if it cannot be opened or read
+bool ReadWholeFile(const std::filesystem::path& path, std::string& bytes);
+
+// Write to <path>.tmp, flush it to the disk and rename it over path: a reader
+// sees the old file or the new one, never a partial write, even after a power loss
+bool ReplaceFileContents(const std::filesystem::path& path, const std::string& bytes);
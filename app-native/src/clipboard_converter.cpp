@@ -0,0 +1,131 @@
+// ViKey - Background Clipboard Conversion Implementation
+// clipboard_converter.cpp
+// ConversionJob chunking and the ClipboardConverter worker thread
+
+#include "clipboard_converter.h"
+#include <algorithm>
+
+ConversionJob::ConversionJob(std::wstring text, VietEncoding from, VietEncoding to, size_t chunkChars)
+    : m_source(std::move(text)),
+      m_stream(EncodingConverter::CreateStream(from, to)),
+      m_chunkChars(chunkChars > 0 ? chunkChars : DEFAULT_CHUNK_CHARS) {
+    if (!m_stream) {
+        m_status = JobStatus::Failed;
+        return;
+    }
+    m_result.reserve(m_source.size() + m_source.size() / 2);
+}
+
+bool ConversionJob::Step() {
+    if (m_status != JobStatus::Running) return false;
+    if (m_cancelled.load(std::memory_order_relaxed)) {
+        m_status = JobStatus::Cancelled;
+        m_result.clear();
+        return false;
+    }
+
+    size_t n = std::min(m_chunkChars, m_source.size() - m_position);
+    m_stream->Put(m_source.data() + m_position, n, m_result);
+    m_position += n;
+
+    if (m_position < m_source.size()) {
+        m_permille.store(static_cast<uint32_t>(m_position * 1000 / m_source.size()), std::memory_order_relaxed);
+        return true;
+    }
+    m_stream->Flush(m_result);
+    m_permille.store(1000, std::memory_order_relaxed);
+    m_status = JobStatus::Done;
+    return false;
+}
+
+JobStatus ConversionJob::Run() {
+    while (Step()) {}
+    return m_status;
+}
+
+ClipboardConverter::ClipboardConverter(ClipboardAccess& clipboard) : m_clipboard(clipboard) {}
+
+ClipboardConverter::~ClipboardConverter() {
+    Cancel();
+    Wait();
+}
+
+bool ClipboardConverter::Start(VietEncoding from, VietEncoding to, bool detect) {
+    if (m_running.exchange(true, std::memory_order_acq_rel)) return false;
+
+    // The previous worker has returned (m_running was false); reap it
+    if (m_worker.joinable()) m_worker.join();
+    m_cancelled.store(false, std::memory_order_relaxed);
+    m_worker = std::thread(&ClipboardConverter::Work, this, from, to, detect);
+    return true;
+}
+
+void ClipboardConverter::Cancel() {
+    m_cancelled.store(true, std::memory_order_relaxed);
+    std::lock_guard<std::mutex> lock(m_jobMutex);
+    if (m_job) m_job->Cancel();
+}
+
+void ClipboardConverter::Wait() {
+    if (m_worker.joinable()) m_worker.join();
+}
+
+void ClipboardConverter::Work(VietEncoding from, VietEncoding to, bool detect) {
+    ClipboardConversionResult result = Convert(from, to, detect);
+    m_running.store(false, std::memory_order_release);
+    if (onFinished) onFinished(result);
+}
+
+ClipboardConversionResult ClipboardConverter::Convert(VietEncoding from, VietEncoding to, bool detect) {
+    ClipboardConversionResult result;
+    result.from = from;
+    result.to = to;
+
+    uint32_t sequence = m_clipboard.SequenceNumber();
+    std::wstring text;
+    if (!m_clipboard.ReadText(text) || text.empty()) {
+        result.status = JobStatus::Empty;
+        return result;
+    }
+    result.chars = text.size();
+
+    if (detect) {
+        EncodingGuess best = EncodingConverter::Detect(text.data(), text.size()).front();
+        if (best.confidence > 0) result.from = best.encoding;
+    }
+    if (result.from == to) {
+        result.status = JobStatus::Empty;
+        return result;
+    }
+
+    ConversionJob job(std::move(text), result.from, to, m_chunkChars);
+    {
+        std::lock_guard<std::mutex> lock(m_jobMutex);
+        m_job = &job;
+        if (m_cancelled.load(std::memory_order_relaxed)) job.Cancel();
+    }
+
+    uint32_t reported = 0;
+    while (job.Step()) {
+        uint32_t permille = job.Permille();
+        if (onProgress && permille != reported) onProgress(permille);
+        reported = permille;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_jobMutex);
+        m_job = nullptr;
+    }
+
+    result.status = job.Status();
+    if (result.status != JobStatus::Done) return result;
+    if (onProgress) onProgress(1000);
+
+    // Never overwrite something the user copied while we were converting
+    if (m_clipboard.SequenceNumber() != sequence) {
+        result.status = JobStatus::Superseded;
+    } else if (!m_clipboard.WriteText(job.Result())) {
+        result.status = JobStatus::Failed;
+    }
+    return result;
+}
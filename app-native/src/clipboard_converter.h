@@ -0,0 +1,125 @@
+// ViKey - Background Clipboard Conversion
+// clipboard_converter.h
+// Chunked, cancellable conversion jobs and a worker that converts the clipboard in place
+
+#pragma once
+
+#include "encoding_converter.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+// Clipboard text as the converter sees it. The Win32 clipboard implements
+// this in the app (clipboard_win32.h); tests use an in-memory stand-in.
+class ClipboardAccess {
+public:
+    virtual ~ClipboardAccess() = default;
+
+    // Current text; false if the clipboard holds no text or cannot be opened
+    virtual bool ReadText(std::wstring& text) = 0;
+
+    // Replace the clipboard contents with text
+    virtual bool WriteText(const std::wstring& text) = 0;
+
+    // Changes whenever the clipboard contents change (GetClipboardSequenceNumber)
+    virtual uint32_t SequenceNumber() = 0;
+};
+
+enum class JobStatus {
+    Running,
+    Done,
+    Cancelled,
+    Empty,       // nothing to convert: no text, or the text is already in the target encoding
+    Superseded,  // the clipboard changed while converting; the new contents were kept
+    Failed       // the clipboard could not be read or written
+};
+
+// Converts one text between encodings a chunk at a time, so a caller can
+// report progress and stop between chunks. Chunk boundaries may fall anywhere:
+// the codecs carry state across them.
+class ConversionJob {
+public:
+    static constexpr size_t DEFAULT_CHUNK_CHARS = 64 * 1024;
+
+    ConversionJob(std::wstring text, VietEncoding from, VietEncoding to,
+                  size_t chunkChars = DEFAULT_CHUNK_CHARS);
+
+    // Convert the next chunk; false once the job is finished or cancelled
+    bool Step();
+
+    // Step until finished or cancelled
+    JobStatus Run();
+
+    // Safe to call from any thread; takes effect before the next chunk
+    void Cancel() { m_cancelled.store(true, std::memory_order_relaxed); }
+
+    JobStatus Status() const { return m_status; }
+
+    // Source characters converted so far, in 1/1000 of the total
+    uint32_t Permille() const { return m_permille.load(std::memory_order_relaxed); }
+
+    const std::wstring& Result() const { return m_result; }
+    std::wstring TakeResult() { return std::move(m_result); }
+
+private:
+    std::wstring m_source;
+    std::wstring m_result;
+    std::unique_ptr<TranscodeStream> m_stream;
+    size_t m_chunkChars;
+    size_t m_position = 0;
+    JobStatus m_status = JobStatus::Running;
+    std::atomic<bool> m_cancelled{false};
+    std::atomic<uint32_t> m_permille{0};
+};
+
+struct ClipboardConversionResult {
+    JobStatus status = JobStatus::Failed;
+    VietEncoding from = VietEncoding::Unicode;  // the detected encoding when detection was asked for
+    VietEncoding to = VietEncoding::Unicode;
+    size_t chars = 0;                           // characters read from the clipboard
+};
+
+// Runs clipboard conversions on a worker thread, one at a time, so the
+// thread that owns the keyboard hook never waits on a large selection.
+// Callbacks run on the worker thread; the app forwards them as messages.
+class ClipboardConverter {
+public:
+    explicit ClipboardConverter(ClipboardAccess& clipboard);
+    ~ClipboardConverter();  // cancels a running job and waits for it
+
+    // Read the clipboard, convert it and write it back. With detect the
+    // source encoding is taken from the text, falling back to from.
+    // False (and nothing started) while a previous job is still running.
+    bool Start(VietEncoding from, VietEncoding to, bool detect);
+
+    void Cancel();
+    bool IsRunning() const { return m_running.load(std::memory_order_acquire); }
+
+    // Block until the current job, if any, has finished
+    void Wait();
+
+    void SetChunkChars(size_t chunkChars) { m_chunkChars = chunkChars; }
+
+    std::function<void(uint32_t permille)> onProgress;
+    std::function<void(const ClipboardConversionResult&)> onFinished;
+
+private:
+    ClipboardConverter(const ClipboardConverter&) = delete;
+    ClipboardConverter& operator=(const ClipboardConverter&) = delete;
+
+    void Work(VietEncoding from, VietEncoding to, bool detect);
+    ClipboardConversionResult Convert(VietEncoding from, VietEncoding to, bool detect);
+
+    ClipboardAccess& m_clipboard;
+    size_t m_chunkChars = ConversionJob::DEFAULT_CHUNK_CHARS;
+    std::thread m_worker;
+    std::atomic<bool> m_running{false};
+    std::atomic<bool> m_cancelled{false};
+    std::mutex m_jobMutex;  // guards m_job for Cancel()
+    ConversionJob* m_job = nullptr;
+};
@@ -0,0 +1,56 @@
+// ViKey - Win32 Clipboard Access Implementation
+// clipboard_win32.cpp
+
+#include "clipboard_win32.h"
+#include <cwchar>
+
+bool Win32Clipboard::Open() {
+    for (int attempt = 0; attempt < 10; attempt++) {
+        if (OpenClipboard(nullptr)) return true;
+        Sleep(20);
+    }
+    return false;
+}
+
+bool Win32Clipboard::ReadText(std::wstring& text) {
+    if (!IsClipboardFormatAvailable(CF_UNICODETEXT) || !Open()) return false;
+
+    bool ok = false;
+    HANDLE hData = GetClipboardData(CF_UNICODETEXT);
+    if (hData) {
+        const wchar_t* pData = static_cast<const wchar_t*>(GlobalLock(hData));
+        if (pData) {
+            // The terminator is not guaranteed to be at the end of the block
+            size_t maxChars = GlobalSize(hData) / sizeof(wchar_t);
+            text.assign(pData, wcsnlen(pData, maxChars));
+            GlobalUnlock(hData);
+            ok = true;
+        }
+    }
+    CloseClipboard();
+    return ok;
+}
+
+bool Win32Clipboard::WriteText(const std::wstring& text) {
+    size_t size = (text.size() + 1) * sizeof(wchar_t);
+    HGLOBAL hGlobal = GlobalAlloc(GMEM_MOVEABLE, size);
+    if (!hGlobal) return false;
+
+    wchar_t* pGlobal = static_cast<wchar_t*>(GlobalLock(hGlobal));
+    if (!pGlobal) {
+        GlobalFree(hGlobal);
+        return false;
+    }
+    memcpy(pGlobal, text.c_str(), size);
+    GlobalUnlock(hGlobal);
+
+    if (!Open()) {
+        GlobalFree(hGlobal);
+        return false;
+    }
+    EmptyClipboard();
+    bool ok = SetClipboardData(CF_UNICODETEXT, hGlobal) != nullptr;
+    if (!ok) GlobalFree(hGlobal);  // ownership passes to the system only on success
+    CloseClipboard();
+    return ok;
+}
@@ -0,0 +1,19 @@
+// ViKey - Win32 Clipboard Access
+// clipboard_win32.h
+// ClipboardAccess over the Windows clipboard (CF_UNICODETEXT)
+
+#pragma once
+
+#include <windows.h>
+#include "clipboard_converter.h"
+
+class Win32Clipboard : public ClipboardAccess {
+public:
+    bool ReadText(std::wstring& text) override;
+    bool WriteText(const std::wstring& text) override;
+    uint32_t SequenceNumber() override { return GetClipboardSequenceNumber(); }
+
+private:
+    // Another process may hold the clipboard for a moment; retry briefly
+    static bool Open();
+};
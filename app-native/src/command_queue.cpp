@@ -0,0 +1,73 @@
+// ViKey - Command Queue Implementation
+// command_queue.cpp
+
+#include "command_queue.h"
+#include <cstdint>
+
+static size_t RoundUpToPowerOfTwo(size_t n) {
+    size_t size = 2;
+    while (size < n) size <<= 1;
+    return size;
+}
+
+CommandQueue::CommandQueue(size_t capacity)
+    : m_mask(RoundUpToPowerOfTwo(capacity) - 1)
+    , m_cells(new Cell[m_mask + 1])
+    , m_tail(0)
+    , m_head(0) {
+    for (size_t i = 0; i <= m_mask; i++) {
+        m_cells[i].sequence.store(i, std::memory_order_relaxed);
+    }
+}
+
+CommandQueue::~CommandQueue() = default;
+
+bool CommandQueue::Post(Command command) {
+    size_t pos = m_tail.load(std::memory_order_relaxed);
+    for (;;) {
+        Cell& cell = m_cells[pos & m_mask];
+        size_t sequence = cell.sequence.load(std::memory_order_acquire);
+        intptr_t diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos);
+        if (diff == 0) {
+            // The cell is free for this lap: claim it
+            if (m_tail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                cell.command = std::move(command);
+                cell.sequence.store(pos + 1, std::memory_order_release);
+                return true;
+            }
+        } else if (diff < 0) {
+            return false;  // still holds a command from the previous lap
+        } else {
+            pos = m_tail.load(std::memory_order_relaxed);  // another thread claimed it
+        }
+    }
+}
+
+bool CommandQueue::TryTake(Command& command) {
+    // Single consumer: the head is ours, only the cell's turn needs checking
+    size_t pos = m_head.load(std::memory_order_relaxed);
+    Cell& cell = m_cells[pos & m_mask];
+    if (cell.sequence.load(std::memory_order_acquire) != pos + 1) return false;
+
+    command = std::move(cell.command);
+    cell.command = nullptr;
+    m_head.store(pos + 1, std::memory_order_relaxed);
+    cell.sequence.store(pos + m_mask + 1, std::memory_order_release);
+    return true;
+}
+
+size_t CommandQueue::Drain() {
+    size_t ran = 0;
+    Command command;
+    while (TryTake(command)) {
+        command();
+        command = nullptr;
+        ran++;
+    }
+    return ran;
+}
+
+bool CommandQueue::Empty() const {
+    size_t pos = m_head.load(std::memory_order_relaxed);
+    return m_cells[pos & m_mask].sequence.load(std::memory_order_acquire) != pos + 1;
+}
@@ -0,0 +1,54 @@
+// ViKey - Command Queue
+// command_queue.h
+// Bounded lock-free queue of commands for the keyboard thread: any thread
+// posts, the owning thread runs them in order between keys
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <memory>
+
+// A ring of cells, each with a sequence number that says whose turn it is
+// (Vyukov's bounded queue). Posting claims a cell with one compare-exchange
+// and never waits for the consumer, so a busy UI thread cannot stall the
+// keyboard thread and a stalled keyboard thread only fills the ring.
+class CommandQueue {
+public:
+    using Command = std::function<void()>;
+
+    static constexpr size_t DEFAULT_CAPACITY = 256;
+
+    // Capacity is rounded up to a power of two
+    explicit CommandQueue(size_t capacity = DEFAULT_CAPACITY);
+    ~CommandQueue();
+
+    CommandQueue(const CommandQueue&) = delete;
+    CommandQueue& operator=(const CommandQueue&) = delete;
+
+    // Any thread. False if the queue is full; the command is not kept.
+    bool Post(Command command);
+
+    // Owning thread only: run the commands posted so far, in order. Returns
+    // how many ran. Commands posted while draining run in the same call.
+    size_t Drain();
+
+    // Whether a Drain() now would run nothing (a hint while others post)
+    bool Empty() const;
+
+    size_t Capacity() const { return m_mask + 1; }
+
+private:
+    struct Cell {
+        std::atomic<size_t> sequence;
+        Command command;
+    };
+
+    bool TryTake(Command& command);
+
+    const size_t m_mask;
+    std::unique_ptr<Cell[]> m_cells;
+    alignas(64) std::atomic<size_t> m_tail;  // next cell to post into
+    alignas(64) std::atomic<size_t> m_head;  // next cell to run
+};
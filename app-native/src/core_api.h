@@ -0,0 +1,56 @@
+// ViKey - Rust Core C API
+// core_api.h
+// The functions core exports (core/src/lib.rs), declared once. RustBridge
+// fills a CoreApi from core.dll; the Linux benchmarks fill one from the
+// static library.
+
+#pragma once
+
+#include <cstdint>
+#include "ime_result.h"
+
+extern "C" {
+typedef void ImeInitFn();
+typedef void ImeWarmupFn();
+typedef void ImeClearFn();
+typedef void ImeClearAllFn();
+typedef void ImeFreeFn(NativeResult* result);
+typedef int64_t ImeSnapshotFn(uint8_t* out, int64_t maxLen);
+typedef bool ImeRestoreFn(const uint8_t* data, int64_t len);
+typedef void ImeMethodFn(uint8_t method);
+typedef void ImeFlagFn(bool on);  // ime_enabled, ime_modern and the other switches
+typedef void ImeAddShortcutFn(const char* trigger, const char* replacement);
+typedef void ImeRemoveShortcutFn(const char* trigger);
+typedef void ImeClearShortcutsFn();
+typedef NativeResult* ImeKeyFn(uint16_t key, bool caps, bool ctrl);
+typedef NativeResult* ImeKeyExtFn(uint16_t key, bool caps, bool ctrl, bool shift);
+typedef void ImeReplayFn(const uint32_t* strokes, int64_t len);
+}
+
+// One pointer per export; null when the loaded core lacks it (older cores
+// have no ime_replay, ime_snapshot or ime_warmup)
+struct CoreApi {
+    ImeInitFn* ime_init = nullptr;
+    ImeWarmupFn* ime_warmup = nullptr;
+    ImeClearFn* ime_clear = nullptr;
+    ImeClearAllFn* ime_clear_all = nullptr;
+    ImeFreeFn* ime_free = nullptr;
+    ImeSnapshotFn* ime_snapshot = nullptr;
+    ImeRestoreFn* ime_restore = nullptr;
+    ImeMethodFn* ime_method = nullptr;
+    ImeFlagFn* ime_enabled = nullptr;
+    ImeFlagFn* ime_modern = nullptr;
+    ImeFlagFn* ime_english_auto_restore = nullptr;
+    ImeFlagFn* ime_auto_capitalize = nullptr;
+    ImeFlagFn* ime_skip_w_shortcut = nullptr;
+    ImeFlagFn* ime_bracket_shortcut = nullptr;
+    ImeFlagFn* ime_esc_restore = nullptr;
+    ImeFlagFn* ime_free_tone = nullptr;
+    ImeFlagFn* ime_allow_foreign_consonants = nullptr;
+    ImeAddShortcutFn* ime_add_shortcut = nullptr;
+    ImeRemoveShortcutFn* ime_remove_shortcut = nullptr;
+    ImeClearShortcutsFn* ime_clear_shortcuts = nullptr;
+    ImeKeyFn* ime_key = nullptr;
+    ImeKeyExtFn* ime_key_ext = nullptr;
+    ImeReplayFn* ime_replay = nullptr;
+};
@@ -0,0 +1,272 @@
+// ViKey - Core Engine Session Implementation
+// core_engine.cpp
+
+#include "core_engine.h"
+
+// Engine settings packed as the result cache's config key
+static constexpr uint32_t CONFIG_METHOD = 0xFF;
+static constexpr uint32_t CONFIG_ENABLED = 1u << 8;
+static constexpr uint32_t CONFIG_MODERN_TONE = 1u << 9;
+static constexpr uint32_t CONFIG_ENGLISH_AUTO_RESTORE = 1u << 10;
+static constexpr uint32_t CONFIG_AUTO_CAPITALIZE = 1u << 11;
+static constexpr uint32_t CONFIG_SKIP_W_SHORTCUT = 1u << 12;
+static constexpr uint32_t CONFIG_BRACKET_SHORTCUT = 1u << 13;
+static constexpr uint32_t CONFIG_ESC_RESTORE = 1u << 14;
+static constexpr uint32_t CONFIG_FREE_TONE = 1u << 15;
+static constexpr uint32_t CONFIG_FOREIGN_CONSONANTS = 1u << 16;
+static constexpr uint32_t CONFIG_ALL = (1u << 17) - 1;
+
+static uint32_t ConfigBit(uint32_t field, bool on) {
+    return on ? field : 0;
+}
+
+CoreEngine::CoreEngine()
+    : m_passthrough{0, 0}
+    , m_passthroughGeneration(0)
+    , m_generation(1)
+    , m_cacheEnabled(false)
+    , m_config(0)
+    , m_configKnown(0) {
+}
+
+void CoreEngine::Bind(const CoreApi& api) {
+    m_api = api;
+    InvalidatePassthrough();
+    m_cache.Break();
+}
+
+void CoreEngine::Clear() {
+    SyncEngine();
+    if (m_api.ime_clear) m_api.ime_clear();
+    InvalidatePassthrough();
+    m_cache.Anchor();
+}
+
+void CoreEngine::ClearAll() {
+    SyncEngine();
+    if (m_api.ime_clear_all) m_api.ime_clear_all();
+    InvalidatePassthrough();
+    m_cache.Anchor();
+}
+
+std::vector<uint8_t> CoreEngine::Snapshot() {
+    std::vector<uint8_t> snapshot;
+    if (!m_api.ime_snapshot) return snapshot;
+    SyncEngine();
+    snapshot.resize(SNAPSHOT_MAX);
+    int64_t size = m_api.ime_snapshot(snapshot.data(), static_cast<int64_t>(snapshot.size()));
+    snapshot.resize(size > 0 ? static_cast<size_t>(size) : 0);
+    snapshot.shrink_to_fit();
+    return snapshot;
+}
+
+bool CoreEngine::Restore(const std::vector<uint8_t>& snapshot) {
+    if (!m_api.ime_restore || snapshot.empty()) return false;
+    SyncEngine();
+    bool restored = m_api.ime_restore(snapshot.data(), static_cast<int64_t>(snapshot.size()));
+    InvalidatePassthrough();
+    m_cache.Break();
+    return restored;
+}
+
+void CoreEngine::SetMethod(InputMethod method) {
+    SyncEngine();
+    if (m_api.ime_method) m_api.ime_method(static_cast<uint8_t>(method));
+    InvalidatePassthrough();
+    SetConfig(CONFIG_METHOD, static_cast<uint32_t>(method));
+}
+
+void CoreEngine::SetEnabled(bool enabled) {
+    SyncEngine();
+    if (m_api.ime_enabled) m_api.ime_enabled(enabled);
+    InvalidatePassthrough();
+    SetConfig(CONFIG_ENABLED, ConfigBit(CONFIG_ENABLED, enabled));
+}
+
+void CoreEngine::SetModernTone(bool modern) {
+    SyncEngine();
+    if (m_api.ime_modern) m_api.ime_modern(modern);
+    InvalidatePassthrough();
+    SetConfig(CONFIG_MODERN_TONE, ConfigBit(CONFIG_MODERN_TONE, modern));
+}
+
+void CoreEngine::SetEnglishAutoRestore(bool enabled) {
+    SyncEngine();
+    if (m_api.ime_english_auto_restore) m_api.ime_english_auto_restore(enabled);
+    InvalidatePassthrough();
+    SetConfig(CONFIG_ENGLISH_AUTO_RESTORE, ConfigBit(CONFIG_ENGLISH_AUTO_RESTORE, enabled));
+}
+
+void CoreEngine::SetAutoCapitalize(bool enabled) {
+    SyncEngine();
+    if (m_api.ime_auto_capitalize) m_api.ime_auto_capitalize(enabled);
+    InvalidatePassthrough();
+    SetConfig(CONFIG_AUTO_CAPITALIZE, ConfigBit(CONFIG_AUTO_CAPITALIZE, enabled));
+}
+
+void CoreEngine::SetSkipWShortcut(bool skip) {
+    SyncEngine();
+    if (m_api.ime_skip_w_shortcut) m_api.ime_skip_w_shortcut(skip);
+    InvalidatePassthrough();
+    SetConfig(CONFIG_SKIP_W_SHORTCUT, ConfigBit(CONFIG_SKIP_W_SHORTCUT, skip));
+}
+
+void CoreEngine::SetBracketShortcut(bool enabled) {
+    SyncEngine();
+    if (m_api.ime_bracket_shortcut) m_api.ime_bracket_shortcut(enabled);
+    InvalidatePassthrough();
+    SetConfig(CONFIG_BRACKET_SHORTCUT, ConfigBit(CONFIG_BRACKET_SHORTCUT, enabled));
+}
+
+void CoreEngine::SetEscRestore(bool enabled) {
+    SyncEngine();
+    if (m_api.ime_esc_restore) m_api.ime_esc_restore(enabled);
+    InvalidatePassthrough();
+    SetConfig(CONFIG_ESC_RESTORE, ConfigBit(CONFIG_ESC_RESTORE, enabled));
+}
+
+void CoreEngine::SetFreeTone(bool enabled) {
+    SyncEngine();
+    if (m_api.ime_free_tone) m_api.ime_free_tone(enabled);
+    InvalidatePassthrough();
+    SetConfig(CONFIG_FREE_TONE, ConfigBit(CONFIG_FREE_TONE, enabled));
+}
+
+void CoreEngine::SetAllowForeignConsonants(bool enabled) {
+    SyncEngine();
+    if (m_api.ime_allow_foreign_consonants) m_api.ime_allow_foreign_consonants(enabled);
+    InvalidatePassthrough();
+    SetConfig(CONFIG_FOREIGN_CONSONANTS, ConfigBit(CONFIG_FOREIGN_CONSONANTS, enabled));
+}
+
+void CoreEngine::ApplySettings(const SettingsSnapshot& settings) {
+    SetModernTone(settings.modernTone);
+    SetEnglishAutoRestore(settings.englishAutoRestore);
+    SetAutoCapitalize(settings.autoCapitalize);
+    SetEscRestore(settings.escRestore);
+    SetFreeTone(settings.freeTone);
+    SetSkipWShortcut(settings.skipWShortcut);
+    SetBracketShortcut(settings.bracketShortcut);
+    SetAllowForeignConsonants(settings.allowForeignConsonants);
+    SetResultCacheEnabled(settings.resultCache);
+}
+
+void CoreEngine::AddShortcutUtf8(const char* trigger, const char* replacement) {
+    if (!m_api.ime_add_shortcut || !trigger || !replacement) return;
+    SyncEngine();
+    m_api.ime_add_shortcut(trigger, replacement);
+    InvalidatePassthrough();
+    m_cache.Clear();
+}
+
+void CoreEngine::RemoveShortcutUtf8(const char* trigger) {
+    if (!m_api.ime_remove_shortcut || !trigger) return;
+    SyncEngine();
+    m_api.ime_remove_shortcut(trigger);
+    InvalidatePassthrough();
+    m_cache.Clear();
+}
+
+void CoreEngine::ClearShortcuts() {
+    SyncEngine();
+    if (m_api.ime_clear_shortcuts) m_api.ime_clear_shortcuts();
+    InvalidatePassthrough();
+    m_cache.Clear();
+}
+
+ImeResult CoreEngine::ProcessKey(uint16_t keycode, bool caps, bool ctrl) {
+    if (!m_api.ime_key) return ImeResult::Empty();
+
+    SyncEngine();
+    m_cache.Break();
+    uint32_t generation = m_generation.load();
+    NativeResult* ptr = m_api.ime_key(keycode, caps, ctrl);
+    return ParseResult(ptr, generation);
+}
+
+ImeResult CoreEngine::ProcessKeyExt(uint16_t keycode, bool caps, bool ctrl, bool shift) {
+    if (!m_api.ime_key_ext) return ProcessKey(keycode, caps, ctrl);
+
+    // A word typed before: its letters come from the cache
+    uint32_t stroke = ResultCache::Stroke(keycode, caps, shift);
+    bool cacheable = !ctrl && CacheActive();
+    if (cacheable) {
+        if (const CachedResult* hit = m_cache.Lookup(stroke)) {
+            InvalidatePassthrough();  // the mask described the engine's last key
+            return ImeResult(static_cast<ImeAction>(hit->action), hit->backspace,
+                             static_cast<uint8_t>(hit->chars.size()), hit->flags,
+                             hit->chars.data(), hit->chars.size());
+        }
+    }
+
+    SyncEngine();
+    uint32_t generation = m_generation.load();
+    NativeResult* ptr = m_api.ime_key_ext(keycode, caps, ctrl, shift);
+    if (cacheable && ptr) {
+        CachedResult result;
+        result.action = ptr->action;
+        result.backspace = ptr->backspace;
+        result.flags = ptr->flags & ImeResult::FLAG_KEY_CONSUMED;
+        result.chars.assign(ptr->chars, ptr->chars + ptr->count);
+        m_cache.Record(stroke, std::move(result));
+    } else {
+        m_cache.Break();
+    }
+    return ParseResult(ptr, generation);
+}
+
+void CoreEngine::SetResultCacheEnabled(bool enabled) {
+    SyncEngine();
+    m_cacheEnabled = enabled;
+    m_cache.Break();
+}
+
+bool CoreEngine::CacheActive() const {
+    return m_cacheEnabled && m_api.ime_replay && m_configKnown == CONFIG_ALL &&
+           (m_config & CONFIG_ENABLED) && !(m_config & CONFIG_AUTO_CAPITALIZE);
+}
+
+void CoreEngine::SetConfig(uint32_t field, uint32_t value) {
+    m_config = (m_config & ~field) | (value & field);
+    m_configKnown |= field;
+    m_cache.SetConfig(m_config);
+}
+
+void CoreEngine::SyncEngine() {
+    const std::vector<uint32_t>& pending = m_cache.Pending();
+    if (pending.empty()) return;
+    m_api.ime_replay(pending.data(), static_cast<int64_t>(pending.size()));
+    m_cache.PendingReplayed();
+}
+
+bool CoreEngine::IsPassthrough(uint16_t keycode) const {
+    if (keycode >= 128 || m_passthroughGeneration != m_generation.load()) return false;
+    return (m_passthrough[keycode >> 6] >> (keycode & 63)) & 1;
+}
+
+ImeResult CoreEngine::ParseResult(NativeResult* ptr, uint32_t generation) {
+    if (!ptr) {
+        InvalidatePassthrough();
+        return ImeResult::Empty();
+    }
+
+    // A change made while the key was in the engine must not be covered by
+    // its mask: stamping with the earlier generation leaves the mask stale
+    bool hasMask = (ptr->flags & ImeResult::FLAG_PASSTHROUGH_MASK) != 0;
+    m_passthrough[0] = hasMask ? ptr->passthrough[0] : 0;
+    m_passthrough[1] = hasMask ? ptr->passthrough[1] : 0;
+    m_passthroughGeneration = generation;
+
+    ImeResult result(
+        static_cast<ImeAction>(ptr->action),
+        ptr->backspace,
+        ptr->count,
+        ptr->flags,
+        ptr->chars,
+        ptr->count
+    );
+
+    if (m_api.ime_free) m_api.ime_free(ptr);
+
+    return result;
+}
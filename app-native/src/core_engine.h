@@ -0,0 +1,132 @@
+// ViKey - Core Engine Session
+// core_engine.h
+// The key path over the Rust core's C API: result cache, replay and the
+// passthrough mask. RustBridge runs it over core.dll; the benchmarks run the
+// same code over the static library.
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <vector>
+#include "core_api.h"
+#include "ime_result.h"
+#include "input_method.h"
+#include "result_cache.h"
+#include "settings_snapshot.h"
+
+// Calls into the core only through the CoreApi it was bound to, skipping the
+// functions a core lacks. The key path and settings belong to one thread
+// (the keyboard thread in the app); IsPassthrough's generation is the only
+// state read across threads.
+class CoreEngine {
+public:
+    CoreEngine();
+
+    // Use `api` from now on. Does not initialize the core (api.ime_init).
+    void Bind(const CoreApi& api);
+    const CoreApi& Api() const { return m_api; }
+
+    // Clear the typing buffer (on word boundary)
+    void Clear();
+
+    // Clear everything including word history (on cursor change)
+    void ClearAll();
+
+    // The word being typed, as an opaque fixed-size snapshot (core's
+    // WordSnapshot); empty if the engine cannot snapshot it
+    std::vector<uint8_t> Snapshot();
+
+    // Continue a word saved by Snapshot(), replacing the current one. False if
+    // the snapshot does not apply (e.g. taken with another input method).
+    bool Restore(const std::vector<uint8_t>& snapshot);
+
+    // Set input method (Telex=0, VNI=1)
+    void SetMethod(InputMethod method);
+
+    // Enable or disable IME processing
+    void SetEnabled(bool enabled);
+
+    // Set tone style (modern=true: hoa`, old=false: ho`a)
+    void SetModernTone(bool modern);
+
+    // Enable/disable English auto-restore
+    void SetEnglishAutoRestore(bool enabled);
+
+    // Enable/disable auto-capitalize after sentence end
+    void SetAutoCapitalize(bool enabled);
+
+    // Skip w shortcut (w stays as w at word start)
+    void SetSkipWShortcut(bool skip);
+
+    // Enable bracket shortcuts: ] -> u+, [ -> o+
+    void SetBracketShortcut(bool enabled);
+
+    // Enable ESC key restore (restore raw ASCII)
+    void SetEscRestore(bool enabled);
+
+    // Enable free tone placement (skip validation)
+    void SetFreeTone(bool enabled);
+
+    // Allow foreign consonants (f, j, w, z) as valid initials
+    void SetAllowForeignConsonants(bool enabled);
+
+    // Every engine option in `settings` except enabled and method, which the
+    // caller applies with SetEnabled()/SetMethod()
+    void ApplySettings(const SettingsSnapshot& settings);
+
+    // Shortcut management, UTF-8
+    void AddShortcutUtf8(const char* trigger, const char* replacement);
+    void RemoveShortcutUtf8(const char* trigger);
+    void ClearShortcuts();
+
+    // Process a keystroke and get the result
+    ImeResult ProcessKey(uint16_t keycode, bool caps, bool ctrl);
+
+    // Process a keystroke with shift parameter (for VNI symbols)
+    ImeResult ProcessKeyExt(uint16_t keycode, bool caps, bool ctrl, bool shift);
+
+    // True if the last key's result guarantees the engine would pass
+    // `keycode` (without Ctrl) through untouched, so it need not be called.
+    // Any other call into the engine, from any thread, withdraws the mask.
+    bool IsPassthrough(uint16_t keycode) const;
+
+    // Answer letters and digits of words typed before from a cache of earlier
+    // results, without calling the engine (see result_cache.h). Off by default:
+    // a hit only defers the engine's work to a replay at the word's end, which
+    // lengthens that key. Needs a core that can replay keys; inactive while
+    // auto-capitalize is on or before every setting has been applied.
+    void SetResultCacheEnabled(bool enabled);
+    const ResultCache::Stats& GetResultCacheStats() const { return m_cache.GetStats(); }
+
+private:
+    CoreEngine(const CoreEngine&) = delete;
+    CoreEngine& operator=(const CoreEngine&) = delete;
+
+    ImeResult ParseResult(NativeResult* ptr, uint32_t generation);
+
+    // Any engine change other than a key makes the last mask stale
+    void InvalidatePassthrough() { m_generation++; }
+
+    // Bring the engine up to date with keys answered from the cache
+    void SyncEngine();
+    bool CacheActive() const;
+    // Record one setting (CONFIG_* field in core_engine.cpp) for the cache key
+    void SetConfig(uint32_t field, uint32_t value);
+
+    CoreApi m_api;
+
+    // The last key result's passthrough mask, stamped with the generation
+    // read before that key was sent; only the key thread touches these
+    uint64_t m_passthrough[2];
+    uint32_t m_passthroughGeneration;
+    std::atomic<uint32_t> m_generation;
+
+    ResultCache m_cache;
+    bool m_cacheEnabled;
+    uint32_t m_config;       // the engine's settings, as far as this object set them
+    uint32_t m_configKnown;  // CONFIG_* fields set since startup
+
+    // Upper bound on the snapshot size; core's is 664 bytes
+    static constexpr size_t SNAPSHOT_MAX = 1024;
+};
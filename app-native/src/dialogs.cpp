@@ -353,17 +353,22 @@ static INT_PTR CALLBACK ConverterDialogProc(HWND hDlg, UINT message, WPARAM wPar
         SetWindowTextW(hDlg, L"Chuy\u1EC3n m\u00E3 ti\u1EBFng Vi\u1EC7t");
         SetDlgItemTextW(hDlg, IDC_BTN_CONVERT, L"Chuy\u1EC3n \u0111\u1ED5i");
         SetDlgItemTextW(hDlg, IDC_BTN_COPY, L"Sao ch\u00E9p");
+        SetDlgItemTextW(hDlg, IDC_BTN_DETECT, L"Nh\u1EADn di\u1EC7n");
         SetDlgItemTextW(hDlg, IDCANCEL, L"\u0110\u00F3ng");
 
         HWND hFrom = GetDlgItem(hDlg, IDC_COMBO_FROM);
         HWND hTo = GetDlgItem(hDlg, IDC_COMBO_TO);
-        for (int i = 0; i <= 3; i++) {
+        for (int i = 0; i < VIET_ENCODING_COUNT; i++) {
             const wchar_t* name = EncodingConverter::GetEncodingName(static_cast<VietEncoding>(i));
             SendMessageW(hFrom, CB_ADDSTRING, 0, (LPARAM)name);
             SendMessageW(hTo, CB_ADDSTRING, 0, (LPARAM)name);
         }
-        SendMessageW(hFrom, CB_SETCURSEL, 1, 0);
-        SendMessageW(hTo, CB_SETCURSEL, 0, 0);
+        // Start from the pair the conversion hotkey uses
+        const Settings& settings = Settings::Instance();
+        int fromIdx = (settings.convertFrom >= 0 && settings.convertFrom < VIET_ENCODING_COUNT) ? settings.convertFrom : 1;
+        int toIdx = (settings.convertTo >= 0 && settings.convertTo < VIET_ENCODING_COUNT) ? settings.convertTo : 0;
+        SendMessageW(hFrom, CB_SETCURSEL, fromIdx, 0);
+        SendMessageW(hTo, CB_SETCURSEL, toIdx, 0);
         return TRUE;
     }
 
@@ -381,6 +386,33 @@ static INT_PTR CALLBACK ConverterDialogProc(HWND hDlg, UINT message, WPARAM wPar
                 VietEncoding to = static_cast<VietEncoding>(toIdx);
                 std::wstring result = EncodingConverter::Instance().Convert(source, from, to);
                 SetDlgItemTextW(hDlg, IDC_EDIT_TARGET, result.c_str());
+
+                // The last pair converted here is what the clipboard hotkey converts
+                Settings& settings = Settings::Instance();
+                if (settings.convertFrom != fromIdx || settings.convertTo != toIdx) {
+                    settings.convertFrom = fromIdx;
+                    settings.convertTo = toIdx;
+                    settings.Save();
+                }
+            }
+            return TRUE;
+        }
+        case IDC_BTN_DETECT: {
+            // Pick the source encoding from the text itself
+            int len = GetWindowTextLengthW(GetDlgItem(hDlg, IDC_EDIT_SOURCE));
+            std::wstring source(len + 1, L'\0');
+            GetDlgItemTextW(hDlg, IDC_EDIT_SOURCE, &source[0], len + 1);
+            source.resize(len);
+
+            EncodingGuess best = EncodingConverter::Detect(source.data(), source.size()).front();
+            if (best.confidence > 0) {
+                SendMessageW(GetDlgItem(hDlg, IDC_COMBO_FROM), CB_SETCURSEL, static_cast<int>(best.encoding), 0);
+                wchar_t status[64];
+                swprintf_s(status, L"%s (%d%%)", EncodingConverter::GetEncodingName(best.encoding),
+                           static_cast<int>(best.confidence * 100 + 0.5f));
+                SetDlgItemTextW(hDlg, IDC_STATIC_DETECT, status);
+            } else {
+                SetDlgItemTextW(hDlg, IDC_STATIC_DETECT, L"Kh\u00F4ng nh\u1EADn di\u1EC7n \u0111\u01B0\u1EE3c");
             }
             return TRUE;
         }
@@ -3,46 +3,55 @@
 // Project: ViKey | Author: Tran Cong Sinh | https://github.com/kmis8x/ViKey
 
 #include "encoding_converter.h"
-#include <unordered_map>
-
-// VNI Windows mapping (VNI char -> Unicode char)
-static const std::unordered_map<wchar_t, wchar_t> g_vniToUnicode = {
-    // Lowercase vowels with diacritics
-    {0x00E1, 0x00E1}, // a acute - same
-    {0x00E0, 0x00E0}, // a grave - same
-    {0x1EA3, 0x1EA3}, // a hook - same
-    {0x00E3, 0x00E3}, // a tilde - same
-    {0x1EA1, 0x1EA1}, // a dot - same
-    // VNI specific characters
-    {0x00E2, 0x00E2}, // a circumflex - same
-    {0x0103, 0x0103}, // a breve - same
-    // ... more mappings
-};
-
-// Unicode characters for Vietnamese
-static const wchar_t UNICODE_VIET[] = L"aàảãáạăằẳẵắặâầẩẫấậeèẻẽéẹêềểễếệiìỉĩíịoòỏõóọôồổỗốộơờởỡớợuùủũúụưừửữứựyỳỷỹýỵđAÀẢÃÁẠĂẰẲẴẮẶÂẦẨẪẤẬEÈẺẼÉẸÊỀỂỄẾỆIÌỈĨÍỊOÒỎÕÓỌÔỒỔỖỐỘƠỜỞỠỚỢUÙỦŨÚỤƯỪỬỮỨỰYỲỶỸÝỴĐ";
-
-// VNI Windows character codes (corresponding to UNICODE_VIET)
-static const wchar_t VNI_VIET[] = L"aµ¶·¸¹¨»¼½¾¿©ÇÈÉÊËeÌÍÎÏÐª«Ñ®ÒÓiÔÕÖ×Øo¹º»¼½¤åæçèé¥êëìíîuïðñòó¦ôõö÷øyùúûüýđAÙÚÛÜÝ¡ßàáâã¢äåæçèEéêëìí£ïðñòóIôõö÷øO¿ÀÁÂÃ¬ÄÅÆÇÈÊËÌÍÎUÏÐÑÒÓYôõö÷øD";
-
-// TCVN3 character codes
-static const unsigned char TCVN3_VIET[] = {
-    0x61, 0xB5, 0xB6, 0xB7, 0xB8, 0xB9, 0xA8, 0xBB, 0xBC, 0xBD, 0xBE, 0xBF,
-    0xA9, 0xC7, 0xC8, 0xC9, 0xCA, 0xCB, 0x65, 0xCC, 0xCD, 0xCE, 0xCF, 0xD0,
-    0xAA, 0xD1, 0xD2, 0xD3, 0xD4, 0xD5, 0x69, 0xD6, 0xD7, 0xD8, 0xD9, 0xDA,
-    0x6F, 0xDB, 0xDC, 0xDD, 0xDE, 0xDF, 0xA4, 0xE0, 0xE1, 0xE2, 0xE3, 0xE4,
-    0xA5, 0xE5, 0xE6, 0xE7, 0xE8, 0xE9, 0x75, 0xEA, 0xEB, 0xEC, 0xED, 0xEE,
-    0xA6, 0xEF, 0xF0, 0xF1, 0xF2, 0xF3, 0x79, 0xF4, 0xF5, 0xF6, 0xF7, 0xF8,
-    0xAE, // d
-    // Uppercase
-    0x41, 0x80, 0x81, 0x82, 0x83, 0x84, 0xA1, 0x85, 0x86, 0x87, 0x88, 0x89,
-    0xA2, 0x8A, 0x8B, 0x8C, 0x8D, 0x8E, 0x45, 0x8F, 0x90, 0x91, 0x92, 0x93,
-    0xA3, 0x94, 0x95, 0x96, 0x97, 0x98, 0x49, 0x99, 0x9A, 0x9B, 0x9C, 0x9D,
-    0x4F, 0x9E, 0x9F, 0xA0, 0xAF, 0xB0, 0xAC, 0xB1, 0xB2, 0xB3, 0xB4, 0xBA,
-    0xAD, 0xC0, 0xC1, 0xC2, 0xC3, 0xC4, 0x55, 0xC5, 0xC6, 0xFA, 0xFB, 0xFC,
-    0xFD, 0xFE, 0x59, 0xFF,
-    0xD0 // D
-};
+#include "viet_codecs.h"
+#include <array>
+#include <cstdint>
+
+using TranscodeFn = EncodingConverter::TranscodeFn;
+
+// Pair-indexed table of fused transcoders, [from][to], generated from the registry
+template <typename From, typename... To>
+constexpr std::array<TranscodeFn, sizeof...(To)> BuildTranscodeRow(VietCodecs::CodecList<To...>) {
+    return {{&VietCodecs::Transcode<From, To>...}};
+}
+
+template <typename... From>
+constexpr std::array<std::array<TranscodeFn, VietCodecs::CODEC_COUNT>, sizeof...(From)>
+BuildTranscodeMatrix(VietCodecs::CodecList<From...>) {
+    return {{BuildTranscodeRow<From>(VietCodecs::AllCodecs{})...}};
+}
+
+template <typename... Codecs>
+constexpr bool RegistryMatchesEnum(VietCodecs::CodecList<Codecs...>) {
+    size_t index = 0;
+    bool ok = true;
+    ((ok = ok && static_cast<size_t>(Codecs::id) == index++), ...);
+    return ok && index == VietCodecs::CODEC_COUNT;
+}
+
+// Same shape for the streaming converters: one factory per pair
+using StreamFactory = std::unique_ptr<TranscodeStream> (*)();
+
+template <typename From, typename To>
+std::unique_ptr<TranscodeStream> MakeStream() {
+    return std::make_unique<VietCodecs::StreamTranscoder<From, To>>();
+}
+
+template <typename From, typename... To>
+constexpr std::array<StreamFactory, sizeof...(To)> BuildStreamRow(VietCodecs::CodecList<To...>) {
+    return {{&MakeStream<From, To>...}};
+}
+
+template <typename... From>
+constexpr std::array<std::array<StreamFactory, VietCodecs::CODEC_COUNT>, sizeof...(From)>
+BuildStreamMatrix(VietCodecs::CodecList<From...>) {
+    return {{BuildStreamRow<From>(VietCodecs::AllCodecs{})...}};
+}
+
+static_assert(RegistryMatchesEnum(VietCodecs::AllCodecs{}), "codec registry order must follow VietEncoding");
+
+static constexpr auto kTranscoders = BuildTranscodeMatrix(VietCodecs::AllCodecs{});
+static constexpr auto kStreamFactories = BuildStreamMatrix(VietCodecs::AllCodecs{});
 
 EncodingConverter& EncodingConverter::Instance() {
     static EncodingConverter instance;
@@ -55,171 +64,171 @@ const wchar_t* EncodingConverter::GetEncodingName(VietEncoding enc) {
         case VietEncoding::VNI_Windows: return L"VNI Windows";
         case VietEncoding::TCVN3: return L"TCVN3 (ABC)";
         case VietEncoding::Unicode_Comp: return L"Unicode Composite";
+        case VietEncoding::VISCII: return L"VISCII";
+        case VietEncoding::VIQR: return L"VIQR";
+        case VietEncoding::UTF8_Bytes: return L"UTF-8 (byte)";
         default: return L"Unknown";
     }
 }
 
-std::wstring EncodingConverter::Convert(const std::wstring& text, VietEncoding from, VietEncoding to) {
-    if (from == to) return text;
+static bool IsLegacyByteEncoding(VietEncoding enc) {
+    return enc != VietEncoding::Unicode && enc != VietEncoding::Unicode_Comp;
+}
 
-    // First convert to Unicode (intermediate format)
-    std::wstring unicode;
-    switch (from) {
-        case VietEncoding::Unicode:
-            unicode = text;
-            break;
-        case VietEncoding::VNI_Windows:
-            unicode = VNIToUnicode(text);
-            break;
-        case VietEncoding::TCVN3:
-            unicode = TCVN3ToUnicode(text);
-            break;
-        case VietEncoding::Unicode_Comp:
-            unicode = CompositeToUnicode(text);
-            break;
+// Append one code point as UTF-16 (Windows) or UTF-32 (elsewhere)
+static void AppendCodePoint(std::wstring& out, uint32_t cp) {
+    if (sizeof(wchar_t) == 2 && cp >= 0x10000) {
+        cp -= 0x10000;
+        out += static_cast<wchar_t>(0xD800 + (cp >> 10));
+        out += static_cast<wchar_t>(0xDC00 + (cp & 0x3FF));
+    } else {
+        out += static_cast<wchar_t>(cp);
     }
+}
 
-    // Then convert from Unicode to target encoding
-    switch (to) {
+// Whether a decoder fed data up to cut and then the rest gives the same text
+// as one fed both halves at once. UTF-8 must not cut a sequence or put a
+// combining mark (U+0300..U+036F, lead byte 0xCC or 0xCD) apart from its
+// letter; VNI marks are all high bytes, so a cut before ASCII is safe; VIQR
+// can be cut before anything but a mnemonic (or the second d of dd) and not
+// after the backslash that escapes one.
+static bool IsCharBoundary(const unsigned char* data, size_t cut, VietEncoding enc) {
+    unsigned char next = data[cut];
+    unsigned char prev = data[cut - 1];
+    switch (enc) {
         case VietEncoding::Unicode:
-            return unicode;
-        case VietEncoding::VNI_Windows:
-            return UnicodeToVNI(unicode);
-        case VietEncoding::TCVN3:
-            return UnicodeToTCVN3(unicode);
         case VietEncoding::Unicode_Comp:
-            return UnicodeToComposite(unicode);
+        case VietEncoding::UTF8_Bytes:
+            return (next & 0xC0) != 0x80 && next != 0xCC && next != 0xCD;
+        case VietEncoding::VNI_Windows:
+            return next < 0x80;
+        case VietEncoding::VIQR:
+            if (next >= 0x80 || prev == '\\') return false;
+            if (ViqrTables::kMarkClass[next] == ViqrTables::STROKE_CLASS) return (prev | 0x20) != 'd';
+            return ViqrTables::kMarkClass[next] == 0;
+        default:
+            return true;  // one byte per character
     }
+}
 
-    return text;
+size_t EncodingConverter::FindSplit(const char* data, size_t size, size_t pos, size_t searchLimit,
+                                    VietEncoding enc) {
+    if (pos == 0 || pos >= size) return size;
+    size_t limit = (size - pos > searchLimit) ? pos + searchLimit : size;
+    for (size_t i = pos; i < limit; i++) {
+        if (data[i] == '\n') return i + 1;
+    }
+    for (size_t i = pos; i < limit; i++) {
+        if (data[i] == ' ' || data[i] == '\t' || data[i] == '\r') return i + 1;
+    }
+    const unsigned char* bytes = reinterpret_cast<const unsigned char*>(data);
+    for (size_t cut = limit; cut > pos;) {
+        cut--;
+        if (IsCharBoundary(bytes, cut, enc)) return cut;
+    }
+    return size;
 }
 
-// Lazily-built O(1) lookup tables for encoding conversion
-static const std::unordered_map<wchar_t, wchar_t>& GetUnicodeToVNIMap() {
-    static auto map = []() {
-        std::unordered_map<wchar_t, wchar_t> m;
-        size_t len = wcslen(UNICODE_VIET);
-        size_t vniLen = wcslen(VNI_VIET);
-        for (size_t i = 0; i < len && i < vniLen; i++) {
-            m[UNICODE_VIET[i]] = VNI_VIET[i];
+std::wstring EncodingConverter::DecodeBytes(const char* data, size_t size, VietEncoding enc) {
+    const unsigned char* p = reinterpret_cast<const unsigned char*>(data);
+    const unsigned char* end = p + size;
+    std::wstring result;
+    result.reserve(size);
+
+    if (IsLegacyByteEncoding(enc)) {
+        while (p < end) result += static_cast<wchar_t>(*p++);
+        return result;
+    }
+
+    // UTF-8, skipping a BOM; malformed sequences become U+FFFD
+    if (size >= 3 && p[0] == 0xEF && p[1] == 0xBB && p[2] == 0xBF) p += 3;
+    while (p < end) {
+        uint32_t c = *p++;
+        if (c < 0x80) {
+            result += static_cast<wchar_t>(c);
+            continue;
         }
-        return m;
-    }();
-    return map;
-}
-
-static const std::unordered_map<wchar_t, wchar_t>& GetVNIToUnicodeMap() {
-    static auto map = []() {
-        std::unordered_map<wchar_t, wchar_t> m;
-        size_t vniLen = wcslen(VNI_VIET);
-        size_t uniLen = wcslen(UNICODE_VIET);
-        for (size_t i = 0; i < vniLen && i < uniLen; i++) {
-            m[VNI_VIET[i]] = UNICODE_VIET[i];
+        int extra = (c >= 0xF0 && c < 0xF5) ? 3 : (c >= 0xE0 && c < 0xF0) ? 2 : (c >= 0xC2 && c < 0xE0) ? 1 : -1;
+        if (extra < 0 || end - p < extra) {
+            result += static_cast<wchar_t>(0xFFFD);
+            continue;
         }
-        return m;
-    }();
-    return map;
-}
-
-static const std::unordered_map<wchar_t, wchar_t>& GetUnicodeToTCVN3Map() {
-    static auto map = []() {
-        std::unordered_map<wchar_t, wchar_t> m;
-        size_t uniLen = wcslen(UNICODE_VIET);
-        size_t tcvnLen = sizeof(TCVN3_VIET);
-        for (size_t i = 0; i < uniLen && i < tcvnLen; i++) {
-            m[UNICODE_VIET[i]] = static_cast<wchar_t>(TCVN3_VIET[i]);
+        uint32_t cp = c & (0x3F >> extra);
+        bool valid = true;
+        for (int i = 0; i < extra; i++) {
+            if ((p[i] & 0xC0) != 0x80) { valid = false; break; }
+            cp = (cp << 6) | (p[i] & 0x3F);
         }
-        return m;
-    }();
-    return map;
-}
-
-static const std::unordered_map<unsigned char, wchar_t>& GetTCVN3ToUnicodeMap() {
-    static auto map = []() {
-        std::unordered_map<unsigned char, wchar_t> m;
-        size_t tcvnLen = sizeof(TCVN3_VIET);
-        size_t uniLen = wcslen(UNICODE_VIET);
-        for (size_t i = 0; i < tcvnLen && i < uniLen; i++) {
-            m[TCVN3_VIET[i]] = UNICODE_VIET[i];
+        if (!valid || cp > 0x10FFFF || (cp >= 0xD800 && cp <= 0xDFFF)) {
+            result += static_cast<wchar_t>(0xFFFD);
+            continue;
         }
-        return m;
-    }();
-    return map;
-}
-
-std::wstring EncodingConverter::UnicodeToVNI(const std::wstring& text) {
-    const auto& map = GetUnicodeToVNIMap();
-    std::wstring result;
-    result.reserve(text.size());
-    for (wchar_t c : text) {
-        auto it = map.find(c);
-        result += (it != map.end()) ? it->second : c;
+        p += extra;
+        AppendCodePoint(result, cp);
     }
     return result;
 }
 
-std::wstring EncodingConverter::VNIToUnicode(const std::wstring& text) {
-    const auto& map = GetVNIToUnicodeMap();
-    std::wstring result;
-    result.reserve(text.size());
-    for (wchar_t c : text) {
-        auto it = map.find(c);
-        result += (it != map.end()) ? it->second : c;
-    }
-    return result;
-}
+std::string EncodingConverter::EncodeBytes(const std::wstring& text, VietEncoding enc) {
+    std::string result;
+    result.reserve(text.size() + text.size() / 2);
 
-std::wstring EncodingConverter::UnicodeToTCVN3(const std::wstring& text) {
-    const auto& map = GetUnicodeToTCVN3Map();
-    std::wstring result;
-    result.reserve(text.size());
-    for (wchar_t c : text) {
-        auto it = map.find(c);
-        result += (it != map.end()) ? it->second : c;
+    if (IsLegacyByteEncoding(enc)) {
+        for (wchar_t c : text) {
+            result += (static_cast<uint32_t>(c) < 0x100) ? static_cast<char>(c) : '?';
+        }
+        return result;
     }
-    return result;
-}
 
-std::wstring EncodingConverter::TCVN3ToUnicode(const std::wstring& text) {
-    const auto& map = GetTCVN3ToUnicodeMap();
-    std::wstring result;
-    result.reserve(text.size());
-    for (wchar_t c : text) {
-        auto it = map.find(static_cast<unsigned char>(c));
-        result += (it != map.end()) ? it->second : c;
+    for (size_t i = 0; i < text.size(); i++) {
+        uint32_t cp = static_cast<uint32_t>(text[i]);
+        if (sizeof(wchar_t) == 2 && cp >= 0xD800 && cp <= 0xDBFF && i + 1 < text.size()) {
+            uint32_t lo = static_cast<uint32_t>(text[i + 1]);
+            if (lo >= 0xDC00 && lo <= 0xDFFF) {
+                cp = 0x10000 + ((cp - 0xD800) << 10) + (lo - 0xDC00);
+                i++;
+            }
+        }
+        if (cp < 0x80) {
+            result += static_cast<char>(cp);
+        } else if (cp < 0x800) {
+            result += static_cast<char>(0xC0 | (cp >> 6));
+            result += static_cast<char>(0x80 | (cp & 0x3F));
+        } else if (cp < 0x10000) {
+            result += static_cast<char>(0xE0 | (cp >> 12));
+            result += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+            result += static_cast<char>(0x80 | (cp & 0x3F));
+        } else {
+            result += static_cast<char>(0xF0 | (cp >> 18));
+            result += static_cast<char>(0x80 | ((cp >> 12) & 0x3F));
+            result += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+            result += static_cast<char>(0x80 | (cp & 0x3F));
+        }
     }
     return result;
 }
 
-std::wstring EncodingConverter::UnicodeToComposite(const std::wstring& text) {
-    // Unicode NFC -> NFD conversion (precomposed -> decomposed)
-    // Using Windows API
-    int len = NormalizeString(NormalizationD, text.c_str(), -1, nullptr, 0);
-    if (len <= 0) return text;
-
-    std::wstring result(len, L'\0');
-    NormalizeString(NormalizationD, text.c_str(), -1, &result[0], len);
-
-    // Remove trailing null
-    while (!result.empty() && result.back() == L'\0') {
-        result.pop_back();
-    }
-
-    return result;
+EncodingConverter::TranscodeFn EncodingConverter::GetTranscoder(VietEncoding from, VietEncoding to) {
+    size_t f = static_cast<size_t>(from);
+    size_t t = static_cast<size_t>(to);
+    if (f >= VietCodecs::CODEC_COUNT || t >= VietCodecs::CODEC_COUNT) return nullptr;
+    return kTranscoders[f][t];
 }
 
-std::wstring EncodingConverter::CompositeToUnicode(const std::wstring& text) {
-    // Unicode NFD -> NFC conversion (decomposed -> precomposed)
-    int len = NormalizeString(NormalizationC, text.c_str(), -1, nullptr, 0);
-    if (len <= 0) return text;
+std::unique_ptr<TranscodeStream> EncodingConverter::CreateStream(VietEncoding from, VietEncoding to) {
+    size_t f = static_cast<size_t>(from);
+    size_t t = static_cast<size_t>(to);
+    if (f >= VietCodecs::CODEC_COUNT || t >= VietCodecs::CODEC_COUNT) return nullptr;
+    return kStreamFactories[f][t]();
+}
 
-    std::wstring result(len, L'\0');
-    NormalizeString(NormalizationC, text.c_str(), -1, &result[0], len);
+std::wstring EncodingConverter::Convert(const std::wstring& text, VietEncoding from, VietEncoding to) {
+    if (from == to) return text;
 
-    // Remove trailing null
-    while (!result.empty() && result.back() == L'\0') {
-        result.pop_back();
-    }
+    TranscodeFn transcode = GetTranscoder(from, to);
+    if (!transcode) return text;
 
+    std::wstring result;
+    transcode(text.data(), text.size(), result);
     return result;
 }
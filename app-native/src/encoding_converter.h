@@ -4,15 +4,46 @@
 
 #pragma once
 
-#include <windows.h>
+#include <cstddef>
+#include <memory>
 #include <string>
+#include <vector>
 
 // Supported Vietnamese encodings
 enum class VietEncoding {
     Unicode = 0,      // UTF-16/UTF-8 (default)
     VNI_Windows = 1,  // VNI Windows
     TCVN3 = 2,        // TCVN3 (ABC)
-    Unicode_Comp = 3  // Unicode Composite (NFD)
+    Unicode_Comp = 3, // Unicode Composite (NFD)
+    VISCII = 4,       // VISCII (RFC 1456)
+    VIQR = 5,         // VIQR mnemonics in ASCII (RFC 1456)
+    UTF8_Bytes = 6    // UTF-8 held one byte per character (text read as ANSI)
+};
+
+constexpr int VIET_ENCODING_COUNT = 7;
+
+// One candidate from EncodingConverter::Detect
+struct EncodingGuess {
+    VietEncoding encoding;
+    float confidence;  // 0..1; the candidates of one sample sum to 1
+};
+
+// Incremental conversion of one encoding pair, for text that arrives in
+// pieces split anywhere (file chunks, text runs between markup). Decoder
+// state carries over from one Put() to the next until Flush().
+class TranscodeStream {
+public:
+    virtual ~TranscodeStream() = default;
+
+    // Convert the next piece of source text; output is appended to out
+    virtual void Put(const wchar_t* text, size_t len, std::wstring& out) = 0;
+
+    // Append a character that is already Unicode (a decoded entity or
+    // escape), bypassing the source decoder
+    virtual void PutUnicode(wchar_t c, std::wstring& out) = 0;
+
+    // End the current run: pending letters and marks are written out
+    virtual void Flush(std::wstring& out) = 0;
 };
 
 class EncodingConverter {
@@ -22,20 +53,40 @@ public:
     // Convert text between encodings
     std::wstring Convert(const std::wstring& text, VietEncoding from, VietEncoding to);
 
+    // Single-pass converter for one encoding pair; appends its output to out.
+    // Convert() dispatches through these, and chunked callers can use them
+    // directly to avoid a copy per call.
+    using TranscodeFn = void (*)(const wchar_t* text, size_t len, std::wstring& out);
+    static TranscodeFn GetTranscoder(VietEncoding from, VietEncoding to);
+
+    // Streaming form of the same converter; nullptr for an unknown encoding
+    static std::unique_ptr<TranscodeStream> CreateStream(VietEncoding from, VietEncoding to);
+
     // Get encoding name for display
     static const wchar_t* GetEncodingName(VietEncoding enc);
 
+    // Byte-level I/O for files and pipes. Unicode variants are UTF-8 (a
+    // leading BOM is skipped); legacy 8-bit encodings map each byte to the
+    // wchar_t of the same value, which is how the codec tables store them.
+    static std::wstring DecodeBytes(const char* data, size_t size, VietEncoding enc);
+    static std::string EncodeBytes(const std::wstring& text, VietEncoding enc);
+
+    // A cut at or after pos, for converting bytes in independent chunks: the
+    // first line end within searchLimit bytes, else the first blank, else the
+    // last position before pos + searchLimit that no character of enc spans.
+    // size when there is none.
+    static size_t FindSplit(const char* data, size_t size, size_t pos, size_t searchLimit, VietEncoding enc);
+
+    // Guess the encoding of a sample. Returns every encoding, most likely
+    // first. Confidences are all 0 when nothing in the sample tells the
+    // encodings apart (plain ASCII). Large samples are read in evenly spaced
+    // windows, so the cost is bounded whatever the input size.
+    static std::vector<EncodingGuess> Detect(const wchar_t* text, size_t len);
+    static std::vector<EncodingGuess> DetectBytes(const char* data, size_t size);
+
 private:
     EncodingConverter() = default;
     ~EncodingConverter() = default;
     EncodingConverter(const EncodingConverter&) = delete;
     EncodingConverter& operator=(const EncodingConverter&) = delete;
-
-    // Conversion helpers
-    std::wstring UnicodeToVNI(const std::wstring& text);
-    std::wstring VNIToUnicode(const std::wstring& text);
-    std::wstring UnicodeToTCVN3(const std::wstring& text);
-    std::wstring TCVN3ToUnicode(const std::wstring& text);
-    std::wstring UnicodeToComposite(const std::wstring& text);
-    std::wstring CompositeToUnicode(const std::wstring& text);
 };
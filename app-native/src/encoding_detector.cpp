@@ -0,0 +1,527 @@
+// ViKey - Encoding Auto-Detection
+// encoding_detector.cpp
+// EncodingConverter::Detect: ranks VietEncodings by how well a sample's
+// character histogram matches each encoding
+//
+// Project: ViKey | Author: Trần Công Sinh | https://github.com/kmis8x/ViKey
+
+#include "encoding_converter.h"
+#include "tcvn3_tables.h"
+#include "viet_chars.h"
+#include "viscii_tables.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+namespace {
+
+// Reference prose the per-encoding models are built from. Letter
+// frequencies matter, not content; it is encoded with the converter's own
+// tables, so the models always agree with what Convert() produces.
+const wchar_t* const MODEL_TEXT =
+    L"Mùa thu năm ấy, làng tôi được mùa lúa. Sáng sớm, sương còn đọng trên những "
+    L"ngọn cỏ ven đường, mẹ đã dậy nấu cơm cho cả nhà. Bố dắt trâu ra đồng, anh "
+    L"trai vác cày đi theo sau. Tôi đứng ở đầu ngõ nhìn theo cho đến khi bóng hai "
+    L"người khuất sau rặng tre. Ở quê, người ta sống chậm rãi và hiền hòa; ai cũng "
+    L"biết nhau, chuyện nhà này chẳng mấy chốc cả xóm đều hay. Buổi trưa, bọn trẻ "
+    L"chúng tôi rủ nhau ra bờ sông tắm, thả diều trên đê, rồi về nhà ăn bát canh "
+    L"rau muống với cà pháo. Những kỷ niệm ấy theo tôi suốt cả cuộc đời, dù sau "
+    L"này tôi đã rời quê lên thành phố học tập và làm việc. Mỗi khi Tết đến, tôi "
+    L"lại nhớ mùi bánh chưng, tiếng pháo nổ giòn giã và nụ cười của ông bà. "
+    L"Trường học nằm cạnh ủy ban xã, thầy giáo dạy văn rất nghiêm nhưng thương "
+    L"học trò. Thư viện nhỏ có nhiều sách cũ, truyện cổ tích, tiểu thuyết lịch sử "
+    L"và cả những tờ báo đã ngả màu. Người dân trồng khoai, đỗ, lạc; ngoài giờ "
+    L"làm ruộng họ đan rổ rá, dệt chiếu để bán ở chợ phiên. Chủ nhật vừa rồi, "
+    L"Ủy ban nhân dân tỉnh đã tổ chức hội nghị về phát triển kinh tế, giáo dục, "
+    L"y tế và bảo vệ môi trường. Đồng chí Chủ tịch nhấn mạnh yêu cầu nâng cao "
+    L"chất lượng dịch vụ công, ứng dụng công nghệ thông tin và cải cách hành chính.";
+
+// Class of the character before a high character. The 8-bit layouts put
+// different letters at the same byte, and which of them may follow a
+// consonant, a vowel, a capital or another accented letter tells the
+// layouts apart.
+constexpr int CONTEXT_COUNT = 5;
+using ContextHistogram = std::array<std::array<uint32_t, 128>, CONTEXT_COUNT>;
+
+// Counts gathered from a sample
+struct Features {
+    std::array<uint32_t, 128> high{};  // characters 0x80-0xFF (legacy bytes, Latin-1)
+    ContextHistogram context{};        // the same characters by ContextOf(previous)
+    ContextHistogram following{};      // ... and by ContextOf(next)
+    uint32_t precomposed = 0;          // Vietnamese letters above U+00FF
+    uint32_t marks = 0;                // combining marks U+0300-036F
+    uint32_t asciiLetters = 0;
+    uint32_t viqrMnemonics = 0;        // VIQR marks after a vowel, e.g. "e^" "a`" "o'n"
+    uint32_t utf8Bytes = 0;            // characters in UTF-8 sequences stored one byte per char
+    uint32_t highTotal = 0;
+};
+
+// Samples up to this size are read whole; larger ones in WINDOW_COUNT windows
+constexpr size_t WHOLE_SAMPLE = 64 * 1024;
+constexpr size_t WINDOW_COUNT = 16;
+constexpr size_t WINDOW_SIZE = WHOLE_SAMPLE / WINDOW_COUNT;
+
+template <typename Fn>
+void ForEachWindow(size_t size, Fn&& fn) {
+    if (size <= WHOLE_SAMPLE) {
+        fn(size_t{0}, size);
+        return;
+    }
+    size_t stride = (size - WINDOW_SIZE) / (WINDOW_COUNT - 1);
+    for (size_t w = 0; w < WINDOW_COUNT; w++) fn(w * stride, WINDOW_SIZE);
+}
+
+inline bool IsVietLetterAboveLatin1(uint32_t c) {
+    return (c >= 0x0100 && c <= 0x01B0) || (c >= 0x1EA0 && c <= 0x1EF9);
+}
+
+inline bool IsAsciiLetter(uint32_t c) {
+    return (c | 0x20) >= 'a' && (c | 0x20) <= 'z';
+}
+
+inline bool IsAsciiVowel(uint32_t c) {
+    switch (c | 0x20) {
+        case 'a': case 'e': case 'i': case 'o': case 'u': case 'y': return true;
+        default: return false;
+    }
+}
+
+// VIQR: shape marks and ` ~ are rare in other ASCII text, so one after a
+// vowel counts; ' ? . also end sentences and quotes, so they count only
+// inside a word.
+inline void AddViqrEvidence(Features& f, uint32_t prev, uint32_t c, uint32_t next) {
+    if (!IsAsciiVowel(prev)) return;
+    switch (c) {
+        case '(': case '^': case '+': case '`': case '~':
+            f.viqrMnemonics++;
+            break;
+        case '\'': case '?': case '.':
+            if (IsAsciiLetter(next)) f.viqrMnemonics++;
+            break;
+        default:
+            break;
+    }
+}
+
+inline int ContextOf(uint32_t prev) {
+    if (prev >= 0x80 && prev < 0x100) return 4;
+    if (prev >= 'A' && prev <= 'Z') return 3;
+    if (prev >= 'a' && prev <= 'z') return IsAsciiVowel(prev) ? 1 : 2;
+    return 0;
+}
+
+inline void AddCodePoint(Features& f, uint32_t prev, uint32_t c) {
+    if (prev >= 0x80 && prev < 0x100) f.following[ContextOf(c)][prev - 0x80]++;
+    if (c < 0x80) {
+        if (IsAsciiLetter(c)) f.asciiLetters++;
+        return;
+    }
+    if (c < 0x100) {
+        f.high[c - 0x80]++;
+        f.context[ContextOf(prev)][c - 0x80]++;
+    } else if (c >= 0x0300 && c <= 0x036F) {
+        f.marks++;
+    } else if (IsVietLetterAboveLatin1(c)) {
+        f.precomposed++;
+    }
+}
+
+// Byte histogram with four interleaved tables, so runs of the same byte do
+// not serialize on one counter; eight bytes are loaded per step.
+void HistogramBytes(const unsigned char* p, size_t size, std::array<uint32_t, 256>& out) {
+    uint32_t counts[4][256] = {};
+    size_t i = 0;
+    for (; i + 8 <= size; i += 8) {
+        uint64_t word;
+        std::memcpy(&word, p + i, sizeof(word));
+        counts[0][word & 0xFF]++;
+        counts[1][(word >> 8) & 0xFF]++;
+        counts[2][(word >> 16) & 0xFF]++;
+        counts[3][(word >> 24) & 0xFF]++;
+        counts[0][(word >> 32) & 0xFF]++;
+        counts[1][(word >> 40) & 0xFF]++;
+        counts[2][(word >> 48) & 0xFF]++;
+        counts[3][word >> 56]++;
+    }
+    for (; i < size; i++) counts[0][p[i]]++;
+    for (int b = 0; b < 256; b++) out[b] += counts[0][b] + counts[1][b] + counts[2][b] + counts[3][b];
+}
+
+// Context counts only touch high bytes, which are a minority even in legacy text
+void CountContexts(const unsigned char* p, size_t size, Features& f) {
+    for (size_t i = 1; i < size; i++) {
+        if (p[i] >= 0x80) f.context[ContextOf(p[i - 1])][p[i] - 0x80]++;
+        if (p[i - 1] >= 0x80) f.following[ContextOf(p[i])][p[i - 1] - 0x80]++;
+    }
+}
+
+// Decode a UTF-8 window into f. A sequence cut by the window start is
+// skipped; one cut by the window end is ignored rather than counted as bad.
+// Unit is unsigned char for files, wchar_t for UTF-8 held one byte per char.
+template <typename Unit>
+void ScanUtf8(const Unit* p, size_t size, Features& f, uint32_t& valid, uint32_t& bad) {
+    size_t i = 0;
+    uint32_t prev = 0;
+    while (i < size && (p[i] & 0xC0) == 0x80) i++;
+    while (i < size) {
+        uint32_t c = static_cast<uint32_t>(p[i]);
+        if (c < 0x80) {
+            if (i > 0 && i + 1 < size) {
+                AddViqrEvidence(f, static_cast<uint32_t>(p[i - 1]), c, static_cast<uint32_t>(p[i + 1]));
+            }
+            AddCodePoint(f, prev, c);
+            prev = c;
+            i++;
+            continue;
+        }
+        int extra = (c >= 0xF0 && c < 0xF5) ? 3 : (c >= 0xE0 && c < 0xF0) ? 2 : (c >= 0xC2 && c < 0xE0) ? 1 : -1;
+        if (extra < 0) {
+            bad++;
+            i++;
+            continue;
+        }
+        if (size - i <= static_cast<size_t>(extra)) break;
+        uint32_t cp = c & (0x3F >> extra);
+        bool ok = true;
+        for (int k = 1; k <= extra; k++) {
+            uint32_t cont = static_cast<uint32_t>(p[i + k]);
+            if (cont > 0xFF || (cont & 0xC0) != 0x80) { ok = false; break; }
+            cp = (cp << 6) | (cont & 0x3F);
+        }
+        if (!ok) {
+            bad++;
+            i++;
+            continue;
+        }
+        valid++;
+        AddCodePoint(f, prev, cp);
+        prev = cp;
+        i += extra + 1;
+    }
+}
+
+void Finish(Features& f) {
+    f.highTotal = 0;
+    for (uint32_t n : f.high) f.highTotal += n;
+}
+
+// High-character profile of MODEL_TEXT in one encoding: a unit vector for
+// the cosine match, and log-probabilities of each character in each context
+// for the likelihood split
+using ContextWeights = std::array<std::array<float, 128>, CONTEXT_COUNT>;
+
+struct Model {
+    std::array<float, 128> unit{};
+    ContextWeights logProb{};      // by previous character
+    ContextWeights logProbNext{};  // by next character
+};
+
+// Uppercase of the letters in MODEL_TEXT (Latin-1, Latin Extended-A/B and
+// the Vietnamese block), without depending on the C library's locale
+wchar_t ToUpperViet(wchar_t c) {
+    uint32_t u = static_cast<uint32_t>(c);
+    if (u >= 'a' && u <= 'z') return static_cast<wchar_t>(u - 0x20);
+    if (u >= 0xE0 && u <= 0xFE && u != 0xF7) return static_cast<wchar_t>(u - 0x20);
+    if (u >= 0x100 && u < 0x1B0 && u != 0x1AF && (u & 1)) return static_cast<wchar_t>(u - 1);
+    if (u == 0x1B0) return 0x1AF;  // ư
+    if (u >= 0x1EA0 && u <= 0x1EF9 && (u & 1)) return static_cast<wchar_t>(u - 1);
+    return c;
+}
+
+// MODEL_TEXT in one encoding; optionally followed by its capitalized form,
+// since headings and names are often written in capitals
+Features ModelFeatures(VietEncoding enc, bool withCapitals) {
+    std::wstring source = MODEL_TEXT;
+    if (withCapitals) {
+        source += L' ';
+        for (const wchar_t* p = MODEL_TEXT; *p; p++) source += ToUpperViet(*p);
+    }
+    std::wstring text = EncodingConverter::Instance().Convert(source, VietEncoding::Unicode, enc);
+    Features f;
+    for (size_t i = 0; i < text.size(); i++) {
+        AddCodePoint(f, i > 0 ? static_cast<uint32_t>(text[i - 1]) : 0, static_cast<uint32_t>(text[i]));
+    }
+    return f;
+}
+
+// The cosine profile is of running text, where capitals are rare
+void SetUnit(Model& m, VietEncoding enc) {
+    Features f = ModelFeatures(enc, false);
+    float norm = 0;
+    for (uint32_t v : f.high) norm += static_cast<float>(v) * v;
+    norm = std::sqrt(norm);
+    for (size_t i = 0; i < f.high.size(); i++) m.unit[i] = norm > 0 ? f.high[i] / norm : 0.0f;
+}
+
+void SetLogProb(ContextWeights& logProb, const ContextWeights& weights) {
+    for (int ctx = 0; ctx < CONTEXT_COUNT; ctx++) {
+        float total = 0;
+        for (float w : weights[ctx]) total += w;
+        for (size_t i = 0; i < 128; i++) logProb[ctx][i] = std::log(weights[ctx][i] / total);
+    }
+}
+
+// VNI: a byte's meaning depends on the letter before it, so the model is
+// the observed byte-in-context counts, smoothed
+Model BuildByteModel(VietEncoding enc) {
+    Features f = ModelFeatures(enc, true);
+    Model m;
+    SetUnit(m, enc);
+    constexpr float SMOOTHING = 0.1f;  // unseen pairs are rare, not impossible
+    ContextWeights before{};
+    ContextWeights after{};
+    for (int ctx = 0; ctx < CONTEXT_COUNT; ctx++) {
+        for (size_t i = 0; i < 128; i++) {
+            before[ctx][i] = f.context[ctx][i] + SMOOTHING;
+            after[ctx][i] = f.following[ctx][i] + SMOOTHING;
+        }
+    }
+    SetLogProb(m.logProb, before);
+    SetLogProb(m.logProbNext, after);
+    return m;
+}
+
+// Vowel group (GROUP_COUNT for đ), tone and case of a Vietnamese letter
+struct LetterParts {
+    int group;
+    int tone;
+    bool upper;
+};
+
+bool SplitLetter(uint32_t u, LetterParts& parts) {
+    using namespace VietChars;
+    for (int g = 0; g < GROUP_COUNT; g++) {
+        for (int t = 0; t < TONE_COUNT; t++) {
+            char32_t lower = kVowelGroups[g].forms[t];
+            if (u == lower || u == ToUpper(lower)) {
+                parts = {g, t, u != lower};
+                return true;
+            }
+        }
+    }
+    if (u == LOWER_D_STROKE || u == UPPER_D_STROKE) {
+        parts = {GROUP_COUNT, 0, u == UPPER_D_STROKE};
+        return true;
+    }
+    return false;
+}
+
+// Letter frequencies of the accented letters in MODEL_TEXT, kept as
+// separate vowel-group and tone distributions
+struct LetterStats {
+    std::array<float, VietChars::GROUP_COUNT + 1> group{};
+    std::array<float, VietChars::TONE_COUNT> tone{};
+};
+
+LetterStats BuildLetterStats() {
+    LetterStats stats;
+    stats.group.fill(1.0f);
+    stats.tone.fill(1.0f);
+    for (const wchar_t* p = MODEL_TEXT; *p; p++) {
+        LetterParts parts;
+        if (static_cast<uint32_t>(*p) >= 0x80 && SplitLetter(static_cast<uint32_t>(*p), parts)) {
+            stats.group[parts.group] += 1.0f;
+            stats.tone[parts.tone] += 1.0f;
+        }
+    }
+    return stats;
+}
+
+// Chance of a capital after each context: other, vowel, consonant, capital,
+// accented letter
+constexpr float UPPER_AFTER[CONTEXT_COUNT] = {0.15f, 0.02f, 0.02f, 0.9f, 0.2f};
+constexpr float NON_LETTER_WEIGHT = 1e-4f;
+constexpr float D_STROKE_INSIDE_WORD = 0.01f;  // đ only starts a syllable...
+constexpr float D_STROKE_NO_VOWEL = 0.05f;     // ...and a vowel follows it
+constexpr float CAPITAL_AFTER_SMALL = 0.05f;   // "mĐnh", "Trờm" written as "TrờM"
+
+// Single-byte layouts and Unicode: a byte is as likely as the letter it
+// decodes to, scored by vowel group x tone x case. The factored model gives
+// rare letters (ỹ, Ỷ) sensible odds from a short reference text, and a
+// wrong layout gives itself away with letters in the wrong case or of
+// groups that hardly occur.
+template <typename Decode>
+Model BuildLetterModel(VietEncoding enc, const LetterStats& stats, Decode decode) {
+    Model m;
+    SetUnit(m, enc);
+
+    float groupTotal = 0;
+    float toneTotal = 0;
+    for (float v : stats.group) groupTotal += v;
+    for (float v : stats.tone) toneTotal += v;
+
+    ContextWeights before{};
+    ContextWeights after{};
+    for (size_t i = 0; i < 128; i++) {
+        LetterParts parts;
+        bool letter = SplitLetter(static_cast<uint32_t>(decode(static_cast<wchar_t>(0x80 + i))), parts);
+        bool stroke = letter && parts.group == VietChars::GROUP_COUNT;
+        float w = letter ? (stats.group[parts.group] / groupTotal) * (stats.tone[parts.tone] / toneTotal)
+                         : NON_LETTER_WEIGHT;
+        for (int ctx = 0; ctx < CONTEXT_COUNT; ctx++) {
+            // Contexts: 0 other, 1 vowel, 2 consonant, 3 capital, 4 accented letter
+            // The letter itself is scored once, by the previous character;
+            // the next one only adds its penalties
+            float b = w;
+            float a = 1.0f;
+            if (letter) {
+                b *= parts.upper ? UPPER_AFTER[ctx] : 1.0f - UPPER_AFTER[ctx];
+                if (stroke && ctx != 0) b *= D_STROKE_INSIDE_WORD;
+                if (stroke && (ctx == 0 || ctx == 2)) a *= D_STROKE_NO_VOWEL;
+                if (!parts.upper && ctx == 3) a *= CAPITAL_AFTER_SMALL;
+            }
+            before[ctx][i] = b;
+            after[ctx][i] = a;
+        }
+    }
+    SetLogProb(m.logProb, before);
+    SetLogProb(m.logProbNext, after);
+    return m;
+}
+
+struct Models {
+    LetterStats letters = BuildLetterStats();
+    Model unicode = BuildLetterModel(VietEncoding::Unicode, letters, [](wchar_t c) { return c; });
+    Model vni = BuildByteModel(VietEncoding::VNI_Windows);
+    Model tcvn3 = BuildLetterModel(VietEncoding::TCVN3, letters,
+                                   [](wchar_t c) { return Tcvn3Tables::kTables.Decode(c); });
+    Model viscii = BuildLetterModel(VietEncoding::VISCII, letters,
+                                    [](wchar_t c) { return VisciiTables::kTables.Decode(c); });
+};
+
+const Models& GetModels() {
+    static const Models models;
+    return models;
+}
+
+float Cosine(const std::array<uint32_t, 128>& hist, uint32_t total, const Model& model) {
+    if (total == 0) return 0;
+    float dot = 0;
+    float norm = 0;
+    for (size_t i = 0; i < hist.size(); i++) {
+        float v = static_cast<float>(hist[i]);
+        dot += v * model.unit[i];
+        norm += v * v;
+    }
+    return dot / std::sqrt(norm);
+}
+
+double LogLikelihood(const Features& f, const Model& model) {
+    double sum = 0;
+    for (int ctx = 0; ctx < CONTEXT_COUNT; ctx++) {
+        for (size_t i = 0; i < 128; i++) {
+            sum += f.context[ctx][i] * static_cast<double>(model.logProb[ctx][i]) +
+                   f.following[ctx][i] * static_cast<double>(model.logProbNext[ctx][i]);
+        }
+    }
+    return sum;
+}
+
+// How many high characters each 8-bit layout explains. The best cosine
+// match (sharpened, cos^4) says how Vietnamese the histogram looks at all;
+// that evidence is split by likelihood of the characters in context, which
+// unlike the cosine penalizes letters a layout rarely produces where they
+// appear, and so separates layouts sharing most of their byte range (TCVN3
+// and VISCII) even on short samples.
+std::array<float, 4> ExplainHigh(const Features& f, const Models& models) {
+    const Model* layouts[4] = {&models.unicode, &models.vni, &models.tcvn3, &models.viscii};
+    std::array<float, 4> explained{};
+    if (f.highTotal == 0 || f.utf8Bytes > 0) return explained;
+
+    float best = 0;
+    double ll[4];
+    double maxLl = -HUGE_VAL;
+    for (int k = 0; k < 4; k++) {
+        best = std::max(best, Cosine(f.high, f.highTotal, *layouts[k]));
+        ll[k] = LogLikelihood(f, *layouts[k]);
+        maxLl = std::max(maxLl, ll[k]);
+    }
+    double posterior[4];
+    double sum = 0;
+    for (int k = 0; k < 4; k++) sum += posterior[k] = std::exp(ll[k] - maxLl);
+
+    float evidence = best * best * best * best * static_cast<float>(f.highTotal);
+    for (int k = 0; k < 4; k++) explained[k] = evidence * static_cast<float>(posterior[k] / sum);
+    return explained;
+}
+
+// Scores are counts of characters explained by each encoding. Text that
+// decodes as byte-per-char UTF-8 is not compared with the 8-bit layouts.
+std::vector<EncodingGuess> Rank(const Features& f) {
+    std::array<float, 4> high = ExplainHigh(f, GetModels());
+
+    // A few stray hits (an "I'm", a smiley) are not enough for VIQR
+    float viqr = (f.viqrMnemonics * 10 >= f.asciiLetters && f.viqrMnemonics >= 3) ? f.viqrMnemonics * 2.0f : 0.0f;
+
+    std::vector<EncodingGuess> guesses = {
+        {VietEncoding::Unicode, static_cast<float>(f.precomposed) + high[0]},
+        {VietEncoding::VNI_Windows, high[1]},
+        {VietEncoding::TCVN3, high[2]},
+        {VietEncoding::Unicode_Comp, static_cast<float>(f.marks)},
+        {VietEncoding::VISCII, high[3]},
+        {VietEncoding::VIQR, viqr},
+        {VietEncoding::UTF8_Bytes, static_cast<float>(f.utf8Bytes)},
+    };
+
+    float sum = 0;
+    for (const auto& g : guesses) sum += g.confidence;
+    for (auto& g : guesses) g.confidence = sum > 0 ? g.confidence / sum : 0.0f;
+
+    std::stable_sort(guesses.begin(), guesses.end(),
+        [](const EncodingGuess& a, const EncodingGuess& b) { return a.confidence > b.confidence; });
+    return guesses;
+}
+
+}  // namespace
+
+std::vector<EncodingGuess> EncodingConverter::Detect(const wchar_t* text, size_t len) {
+    Features f;
+    Features asUtf8;
+    uint32_t valid = 0;
+    uint32_t bad = 0;
+    ForEachWindow(len, [&](size_t begin, size_t count) {
+        for (size_t i = begin; i < begin + count; i++) {
+            uint32_t c = static_cast<uint32_t>(text[i]);
+            if (c < 0x80 && i > begin && i + 1 < begin + count) {
+                AddViqrEvidence(f, static_cast<uint32_t>(text[i - 1]), c, static_cast<uint32_t>(text[i + 1]));
+            }
+            AddCodePoint(f, i > begin ? static_cast<uint32_t>(text[i - 1]) : 0, c);
+        }
+        ScanUtf8(text + begin, count, asUtf8, valid, bad);
+    });
+    Finish(f);
+
+    // Latin-1 range characters that form UTF-8 sequences: mis-decoded UTF-8
+    if (valid > 0 && bad * 50 <= valid && f.precomposed == 0 && f.marks == 0) f.utf8Bytes = f.highTotal;
+    return Rank(f);
+}
+
+std::vector<EncodingGuess> EncodingConverter::DetectBytes(const char* data, size_t size) {
+    const unsigned char* p = reinterpret_cast<const unsigned char*>(data);
+    if (size >= 3 && p[0] == 0xEF && p[1] == 0xBB && p[2] == 0xBF) {
+        p += 3;
+        size -= 3;
+    }
+
+    Features asBytes;
+    Features asUtf8;
+    uint32_t valid = 0;
+    uint32_t bad = 0;
+    std::array<uint32_t, 256> hist{};
+    ForEachWindow(size, [&](size_t begin, size_t count) {
+        HistogramBytes(p + begin, count, hist);
+        CountContexts(p + begin, count, asBytes);
+        ScanUtf8(p + begin, count, asUtf8, valid, bad);
+    });
+    std::copy(hist.begin() + 0x80, hist.end(), asBytes.high.begin());
+    asBytes.asciiLetters = asUtf8.asciiLetters;
+    asBytes.viqrMnemonics = asUtf8.viqrMnemonics;
+
+    // Real UTF-8 almost never fails to decode; legacy text almost always does
+    bool utf8 = valid > 0 && bad * 50 <= valid;
+    Features& f = utf8 ? asUtf8 : asBytes;
+    Finish(f);
+    return Rank(f);
+}
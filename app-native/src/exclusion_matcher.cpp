@@ -0,0 +1,128 @@
+// ViKey - Exclusion Matcher Implementation
+// exclusion_matcher.cpp
+
+#include "exclusion_matcher.h"
+#include <cwctype>
+
+std::wstring FoldCase(std::wstring_view text) {
+    std::wstring folded(text);
+    for (wchar_t& c : folded) {
+        if (c >= L'A' && c <= L'Z') {
+            c = static_cast<wchar_t>(c + (L'a' - L'A'));
+        } else if (c >= 0x80) {
+            c = static_cast<wchar_t>(std::towlower(c));
+        }
+    }
+    return folded;
+}
+
+std::wstring_view AppNameFromPath(std::wstring_view path) {
+    size_t slash = path.find_last_of(L"\\/");
+    return slash == std::wstring_view::npos ? path : path.substr(slash + 1);
+}
+
+void ExclusionMatcher::Compile(const std::vector<std::wstring>& rules) {
+    m_rules.clear();
+    m_names.clear();
+    m_paths.clear();
+    m_namePrefixes.clear();
+    m_pathPrefixes.clear();
+    m_nameGlobs.clear();
+    m_pathGlobs.clear();
+    m_verdicts.assign(m_verdicts.size(), UNKNOWN);
+
+    m_rules.reserve(rules.size());  // no reallocation below: the views stay valid
+    for (const auto& source : rules) {
+        size_t first = source.find_first_not_of(L" \t");
+        if (first == std::wstring::npos) continue;
+        size_t last = source.find_last_not_of(L" \t");
+        std::wstring rule = FoldCase(std::wstring_view(source).substr(first, last - first + 1));
+        for (wchar_t& c : rule) {
+            if (c == L'/') c = L'\\';
+        }
+        m_rules.push_back(std::move(rule));
+
+        std::wstring_view view = m_rules.back();
+        bool isPath = view.find(L'\\') != std::wstring_view::npos;
+        size_t wildcard = view.find_first_of(L"*?");
+        if (wildcard == std::wstring_view::npos) {
+            if (!isPath) {
+                m_names.insert(view);
+            } else if (view.back() == L'\\') {
+                m_pathPrefixes.push_back(view);
+            } else {
+                m_paths.insert(view);
+            }
+        } else if (wildcard == view.size() - 1 && view.back() == L'*') {
+            (isPath ? m_pathPrefixes : m_namePrefixes).push_back(view.substr(0, wildcard));
+        } else {
+            (isPath ? m_pathGlobs : m_nameGlobs).push_back(view);
+        }
+    }
+}
+
+AppId ExclusionMatcher::Intern(const std::wstring& path) {
+    auto it = m_ids.find(path);
+    if (it != m_ids.end()) return it->second;
+    if (m_appPaths.size() >= MAX_APPS) {
+        m_ids.clear();
+        m_appPaths.clear();
+        m_verdicts.clear();
+    }
+    AppId id = static_cast<AppId>(m_appPaths.size());
+    it = m_ids.emplace(path, id).first;
+    m_appPaths.push_back(&it->first);
+    m_verdicts.push_back(UNKNOWN);
+    return id;
+}
+
+bool ExclusionMatcher::IsExcluded(AppId app) {
+    if (app >= m_verdicts.size()) return false;
+    if (m_verdicts[app] == UNKNOWN) {
+        m_verdicts[app] = Matches(*m_appPaths[app]) ? EXCLUDED : INCLUDED;
+    }
+    return m_verdicts[app] == EXCLUDED;
+}
+
+bool ExclusionMatcher::Matches(std::wstring_view path) const {
+    if (path.empty() || m_rules.empty()) return false;
+    std::wstring_view name = AppNameFromPath(path);
+
+    if (m_names.count(name) || m_paths.count(path)) return true;
+    for (std::wstring_view prefix : m_namePrefixes) {
+        if (name.compare(0, prefix.size(), prefix) == 0) return true;
+    }
+    for (std::wstring_view prefix : m_pathPrefixes) {
+        if (path.compare(0, prefix.size(), prefix) == 0) return true;
+    }
+    for (std::wstring_view pattern : m_nameGlobs) {
+        if (GlobMatch(pattern, name)) return true;
+    }
+    for (std::wstring_view pattern : m_pathGlobs) {
+        if (GlobMatch(pattern, path)) return true;
+    }
+    return false;
+}
+
+// Backtracks only to the last '*', so it is linear in the text for patterns
+// with a single star and O(pattern * text) at worst
+bool ExclusionMatcher::GlobMatch(std::wstring_view pattern, std::wstring_view text) {
+    size_t p = 0, t = 0;
+    size_t star = std::wstring_view::npos, resume = 0;
+    while (t < text.size()) {
+        if (p < pattern.size() && (pattern[p] == L'?' || pattern[p] == text[t])) {
+            p++;
+            t++;
+        } else if (p < pattern.size() && pattern[p] == L'*') {
+            star = p++;
+            resume = t;
+        } else if (star != std::wstring_view::npos) {
+            p = star + 1;
+            t = ++resume;
+        } else {
+            return false;
+        }
+    }
+    while (p < pattern.size() && pattern[p] == L'*') p++;
+    return p == pattern.size();
+}
@@ -0,0 +1,76 @@
+// ViKey - Exclusion Matcher (Feature 3: Exclude Apps)
+// exclusion_matcher.h
+// Compiles the exclusion list once into hash sets and wildcard rules, and
+// caches the verdict per interned executable
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+// Lowercase, as app names and paths are compared; ASCII without a call
+std::wstring FoldCase(std::wstring_view text);
+
+// The executable name at the end of an image path ("c:\x\notepad.exe" -> "notepad.exe")
+std::wstring_view AppNameFromPath(std::wstring_view path);
+
+// Small integer naming one executable (its case-folded image path) until the
+// matcher's table of apps fills up and starts over
+using AppId = uint32_t;
+
+class ExclusionMatcher {
+public:
+    // Distinct apps remembered before Intern() forgets them all and starts over
+    static constexpr size_t MAX_APPS = 1024;
+
+    ExclusionMatcher() = default;
+
+    // Replace the rules. Matching ignores case; each rule is one of:
+    //   notepad.exe       the executable name
+    //   putty*.exe, vim?  a name pattern: * any run of characters, ? one character
+    //   c:\tools\a.exe    a full image path (any rule with '\' or '/')
+    //   c:\games\         every executable under a folder
+    //   *\jetbrains\*     a path pattern
+    // Plain names and paths go to hash sets and trailing-* rules to prefix
+    // lists; only the other patterns are matched one by one.
+    void Compile(const std::vector<std::wstring>& rules);
+
+    // Id of a case-folded image path (or bare name, when the path is unknown).
+    // Interning app MAX_APPS + 1 drops every earlier id and verdict, so use an
+    // id right away rather than keep it.
+    AppId Intern(const std::wstring& path);
+
+    // Cached per app: rules are matched once per app and Compile()
+    bool IsExcluded(AppId app);
+
+    // Match a case-folded image path against the rules, without the cache
+    bool Matches(std::wstring_view path) const;
+
+    size_t RuleCount() const { return m_rules.size(); }
+    size_t AppCount() const { return m_appPaths.size(); }
+
+private:
+    ExclusionMatcher(const ExclusionMatcher&) = delete;
+    ExclusionMatcher& operator=(const ExclusionMatcher&) = delete;
+
+    static bool GlobMatch(std::wstring_view pattern, std::wstring_view text);
+
+    enum Verdict : int8_t { UNKNOWN = -1, INCLUDED = 0, EXCLUDED = 1 };
+
+    // The sets and lists view into m_rules, which is sized once per Compile()
+    std::vector<std::wstring> m_rules;
+    std::unordered_set<std::wstring_view> m_names;
+    std::unordered_set<std::wstring_view> m_paths;
+    std::vector<std::wstring_view> m_namePrefixes;
+    std::vector<std::wstring_view> m_pathPrefixes;
+    std::vector<std::wstring_view> m_nameGlobs;
+    std::vector<std::wstring_view> m_pathGlobs;
+
+    std::unordered_map<std::wstring, AppId> m_ids;
+    std::vector<const std::wstring*> m_appPaths;  // by AppId; keys of m_ids
+    std::vector<Verdict> m_verdicts;              // by AppId
+};
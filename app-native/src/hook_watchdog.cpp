@@ -0,0 +1,61 @@
+// ViKey - Keyboard Hook Watchdog Implementation
+// hook_watchdog.cpp
+
+#include "hook_watchdog.h"
+
+HookWatchdog::HookWatchdog()
+    : HookWatchdog(Config()) {
+}
+
+HookWatchdog::HookWatchdog(const Config& config)
+    : m_config(config) {
+}
+
+void HookWatchdog::HookEvent(Clock::time_point now) {
+    m_lastHookEvent = now;
+    m_unseenKeys = 0;
+}
+
+bool HookWatchdog::Admit(Clock::time_point now) {
+    if (!IsPassingThrough(now)) return true;
+    m_stats.passedThrough++;
+    return false;
+}
+
+void HookWatchdog::KeyDone(Clock::time_point start, Clock::time_point end) {
+    Clock::duration took = end - start;
+    m_stats.keys++;
+    if (took > m_stats.worst) m_stats.worst = took;
+    if (took <= m_config.budget) return;
+
+    m_stats.overruns++;
+    if (m_recentOverruns == 0 || end - m_firstRecentOverrun > m_config.overrunWindow) {
+        m_recentOverruns = 0;
+        m_firstRecentOverrun = end;
+    }
+    if (++m_recentOverruns >= m_config.overrunsToPassThrough) {
+        m_recentOverruns = 0;
+        m_passThroughUntil = end + m_config.passThroughFor;
+        m_stats.passThroughs++;
+    }
+}
+
+void HookWatchdog::SystemKey(Clock::time_point now) {
+    // The hook sees a key before raw input does, so a key that arrives right
+    // after a hook event was that event's key
+    if (m_unseenKeys == 0 && now - m_lastHookEvent <= m_config.lossGrace) return;
+    if (m_unseenKeys++ == 0) m_firstUnseenKey = now;
+}
+
+HookWatchdog::Action HookWatchdog::Check(Clock::time_point now) {
+    if (m_unseenKeys < m_config.lossKeys || now - m_firstUnseenKey < m_config.lossGrace) {
+        return Action::None;
+    }
+    m_stats.losses++;
+    return Action::Reinstall;
+}
+
+void HookWatchdog::Installed(Clock::time_point now) {
+    m_unseenKeys = 0;
+    m_lastHookEvent = now;
+}
@@ -0,0 +1,100 @@
+// ViKey - Keyboard Hook Watchdog
+// hook_watchdog.h
+// Keeps the low-level hook within Windows' time limit and notices when
+// Windows has removed it. Decisions only: the caller supplies the times.
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+
+// Windows silently unhooks a WH_KEYBOARD_LL procedure that takes longer than
+// LowLevelHooksTimeout, and the IME stops working with no error anywhere.
+//
+// Budget: the key callback's duration is compared with `budget`, a margin
+// below that timeout (BudgetFor()). The whole callback counts, including the
+// pauses text injection makes between keys, because Windows counts them too.
+// A few overruns close together mean something is slow (an application that
+// takes ages to accept input, long clipboard sends); keys then pass through
+// untouched for a while instead of risking the hook.
+//
+// Loss: the system's own keyboard input (raw input) is reported here too.
+// If keys keep arriving that the hook never saw, the hook is gone and
+// Check() asks for it to be installed again.
+class HookWatchdog {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    // LowLevelHooksTimeout when the value is not set, and the most Windows
+    // honours (larger values count as this)
+    static constexpr std::chrono::milliseconds DEFAULT_HOOK_TIMEOUT{300};
+    static constexpr std::chrono::milliseconds MAX_HOOK_TIMEOUT{1000};
+
+    // The per-key budget under a LowLevelHooksTimeout of `hookTimeout` (zero:
+    // not set): three quarters of it, the rest left for the time before and
+    // after the callback that it cannot measure
+    static constexpr Clock::duration BudgetFor(Clock::duration hookTimeout) {
+        return (hookTimeout <= Clock::duration::zero() ? Clock::duration(DEFAULT_HOOK_TIMEOUT)
+                : hookTimeout > MAX_HOOK_TIMEOUT      ? Clock::duration(MAX_HOOK_TIMEOUT)
+                                                      : hookTimeout) * 3 / 4;
+    }
+
+    struct Config {
+        Clock::duration budget = BudgetFor(DEFAULT_HOOK_TIMEOUT);         // per key callback
+        int overrunsToPassThrough = 2;                                    // within overrunWindow
+        Clock::duration overrunWindow = std::chrono::seconds(10);
+        Clock::duration passThroughFor = std::chrono::seconds(5);
+        Clock::duration lossGrace = std::chrono::seconds(1);  // unseen keys older than this...
+        int lossKeys = 2;                                     // ...and at least this many
+    };
+
+    enum class Action {
+        None,
+        Reinstall  // the hook is gone: install it again, then call Installed()
+    };
+
+    HookWatchdog();
+    explicit HookWatchdog(const Config& config);
+
+    // Every hook callback, key up or down, ours or not: the hook is alive
+    void HookEvent(Clock::time_point now);
+
+    // Whether the IME may process this key; false while passing keys through
+    bool Admit(Clock::time_point now);
+
+    // An admitted key's callback ran from `start` to `end`
+    void KeyDone(Clock::time_point start, Clock::time_point end);
+
+    // A key down the system delivered (raw input), with or without the hook
+    void SystemKey(Clock::time_point now);
+
+    // Periodic health check
+    Action Check(Clock::time_point now);
+
+    // The hook was installed (or installed again) at `now`
+    void Installed(Clock::time_point now);
+
+    bool IsPassingThrough(Clock::time_point now) const { return now < m_passThroughUntil; }
+
+    struct Stats {
+        uint64_t keys = 0;           // KeyDone() calls
+        uint64_t overruns = 0;       // keys over budget
+        uint64_t passedThrough = 0;  // keys refused by Admit()
+        uint64_t passThroughs = 0;   // times pass-through started
+        uint64_t losses = 0;         // times Check() found the hook gone
+        Clock::duration worst = Clock::duration::zero();
+    };
+    const Stats& GetStats() const { return m_stats; }
+
+private:
+    Config m_config;
+    Stats m_stats;
+
+    int m_recentOverruns = 0;
+    Clock::time_point m_firstRecentOverrun;
+    Clock::time_point m_passThroughUntil;
+
+    Clock::time_point m_lastHookEvent;
+    int m_unseenKeys = 0;  // system keys since the last hook event
+    Clock::time_point m_firstUnseenKey;
+};
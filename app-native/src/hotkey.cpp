@@ -11,10 +11,18 @@ HotkeyManager& HotkeyManager::Instance() {
 HotkeyManager::HotkeyManager()
     : m_hWnd(nullptr)
     , m_registered(false)
-    , m_callback(nullptr) {
+    , m_convertRegistered(false)
+    , m_callback(nullptr)
+    , m_convertCallback(nullptr) {
 }
 
 bool HotkeyManager::Register(HWND hWnd) {
+    // The conversion hotkey is optional: failing to get it (another app owns
+    // the combination) does not affect the toggle
+    const HotkeyConfig& convert = Settings::Instance().convertHotkey;
+    if (!m_convertRegistered && convert.vkCode != 0) {
+        m_convertRegistered = RegisterHotKey(hWnd, CONVERT_HOTKEY_ID, convert.GetModifiers(), convert.vkCode);
+    }
     return Register(hWnd, Settings::Instance().toggleHotkey);
 }
 
@@ -32,6 +40,10 @@ void HotkeyManager::Unregister(HWND hWnd) {
         UnregisterHotKey(hWnd, HOTKEY_ID);
         m_registered = false;
     }
+    if (m_convertRegistered) {
+        UnregisterHotKey(hWnd, CONVERT_HOTKEY_ID);
+        m_convertRegistered = false;
+    }
 }
 
 bool HotkeyManager::UpdateHotkey(HWND hWnd) {
@@ -46,5 +58,11 @@ bool HotkeyManager::ProcessHotkey(WPARAM wParam) {
         }
         return true;
     }
+    if (static_cast<int>(wParam) == CONVERT_HOTKEY_ID) {
+        if (m_convertCallback) {
+            m_convertCallback();
+        }
+        return true;
+    }
     return false;
 }
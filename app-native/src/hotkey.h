@@ -1,6 +1,6 @@
 // ViKey - Global Hotkey Manager
 // hotkey.h
-// Registers configurable global toggle hotkey
+// Registers the configurable global toggle and clipboard conversion hotkeys
 
 #pragma once
 
@@ -12,13 +12,13 @@ class HotkeyManager {
 public:
     static HotkeyManager& Instance();
 
-    // Register toggle hotkey from settings
+    // Register toggle and conversion hotkeys from settings
     bool Register(HWND hWnd);
 
     // Register with specific config
     bool Register(HWND hWnd, const HotkeyConfig& config);
 
-    // Unregister the hotkey
+    // Unregister both hotkeys
     void Unregister(HWND hWnd);
 
     // Re-register with new settings (call after settings change)
@@ -30,11 +30,15 @@ public:
     // Set callback for hotkey press
     void SetCallback(std::function<void()> callback) { m_callback = callback; }
 
+    // Set callback for the clipboard conversion hotkey
+    void SetConvertCallback(std::function<void()> callback) { m_convertCallback = callback; }
+
     // Process WM_HOTKEY message, returns true if handled
     bool ProcessHotkey(WPARAM wParam);
 
     // Get hotkey ID
     static constexpr int HOTKEY_ID = 9000;
+    static constexpr int CONVERT_HOTKEY_ID = 9001;
 
 private:
     HotkeyManager();
@@ -44,5 +48,7 @@ private:
 
     HWND m_hWnd;
     bool m_registered;
+    bool m_convertRegistered;
     std::function<void()> m_callback;
+    std::function<void()> m_convertCallback;
 };
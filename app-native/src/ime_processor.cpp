@@ -14,7 +14,10 @@ ImeProcessor::ImeProcessor()
     : m_enabled(true)
     , m_method(InputMethod::Telex)
     , m_initialized(false)
-    , m_lastAppName(L"") {
+    , m_lastAppName(L"")
+    , m_lastHwnd(nullptr)
+    , m_lastExcluded(false)
+    , m_keys(RustBridge::Instance()) {
 }
 
 bool ImeProcessor::Initialize() {
@@ -44,42 +47,67 @@ void ImeProcessor::Stop() {
 
 void ImeProcessor::SetEnabled(bool enabled) {
     m_enabled = enabled;
-    RustBridge::Instance().SetEnabled(enabled);
+    KeyboardHook::Instance().Post([this, enabled]() { ApplyEnabled(enabled); });
 }
 
-void ImeProcessor::ToggleEnabled() {
-    SetEnabled(!m_enabled);
+void ImeProcessor::ApplyEnabled(bool enabled) {
+    // Stored again here: a window switch on this thread may have changed it
+    // since the UI did
+    m_enabled = enabled;
+    RustBridge::Instance().SetEnabled(enabled);
+}
 
-    // Save state for current app if smart switch is enabled
-    Settings& settings = Settings::Instance();
-    if (settings.smartSwitch) {
-        std::wstring currentApp = AppDetector::Instance().GetForegroundAppName();
-        if (!currentApp.empty()) {
-            AppDetector::Instance().SaveAppState(currentApp, m_enabled);
+bool ImeProcessor::ToggleEnabled() {
+    bool enabled = !m_enabled;
+    m_enabled = enabled;
+    KeyboardHook::Instance().Post([this, enabled]() {
+        ApplyEnabled(enabled);
+
+        // Save state for current app if smart switch is enabled
+        if (SettingsStore::Instance().Current()->smartSwitch) {
+            std::wstring currentApp = AppDetector::Instance().GetForegroundAppName();
+            if (!currentApp.empty()) {
+                AppDetector::Instance().SaveAppState(currentApp, enabled);
+            }
         }
-    }
+    });
+    return enabled;
 }
 
 void ImeProcessor::SetMethod(InputMethod method) {
+    m_method = method;
+    KeyboardHook::Instance().Post([this, method]() { ApplyMethod(method); });
+}
+
+void ImeProcessor::ApplyMethod(InputMethod method) {
     m_method = method;
     RustBridge::Instance().SetMethod(method);
 }
 
+void ImeProcessor::SetAppEncoding(OutputEncoding encoding) {
+    KeyboardHook::Instance().Post([encoding]() {
+        TextSender::Instance().SetOutputEncoding(encoding);
+
+        std::wstring currentApp = AppDetector::Instance().GetForegroundAppName();
+        if (!currentApp.empty()) {
+            AppDetector::Instance().SetAppEncoding(currentApp, static_cast<int>(encoding));
+        }
+    });
+}
+
 void ImeProcessor::ApplySettings() {
-    Settings& settings = Settings::Instance();
+    // One snapshot for the whole pass, so a concurrent Save() cannot mix old and new values
+    std::shared_ptr<const SettingsSnapshot> snapshot = SettingsStore::Instance().Current();
+    m_enabled = snapshot->enabled;
+    m_method = snapshot->method;
+    KeyboardHook::Instance().Post([this, snapshot]() { ApplySettings(*snapshot); });
+}
 
-    SetEnabled(settings.enabled);
-    SetMethod(settings.method);
+void ImeProcessor::ApplySettings(const SettingsSnapshot& settings) {
+    ApplyEnabled(settings.enabled);
+    ApplyMethod(settings.method);
 
-    RustBridge& bridge = RustBridge::Instance();
-    bridge.SetModernTone(settings.modernTone);
-    bridge.SetEnglishAutoRestore(settings.englishAutoRestore);
-    bridge.SetAutoCapitalize(settings.autoCapitalize);
-    bridge.SetEscRestore(settings.escRestore);
-    bridge.SetFreeTone(settings.freeTone);
-    bridge.SetSkipWShortcut(settings.skipWShortcut);
-    bridge.SetBracketShortcut(settings.bracketShortcut);
-    bridge.SetAllowForeignConsonants(settings.allowForeignConsonants);
+    RustBridge::Instance().ApplySettings(settings);
 
     TextSender::Instance().SetSlowMode(settings.slowMode);
     TextSender::Instance().SetClipboardMode(settings.clipboardMode);
@@ -87,11 +115,19 @@ void ImeProcessor::ApplySettings() {
     // Sync excluded apps to AppDetector
     AppDetector::Instance().SetExcludedApps(settings.excludedApps);
 
-    UpdateShortcuts();
+    // Remembered windows may no longer match the exclusions or modes
+    m_contexts.Clear();
+
+    UpdateShortcuts(settings);
 }
 
 void ImeProcessor::UpdateShortcuts() {
-    const auto& shortcuts = Settings::Instance().shortcuts;
+    std::shared_ptr<const SettingsSnapshot> snapshot = SettingsStore::Instance().Current();
+    KeyboardHook::Instance().Post([this, snapshot]() { UpdateShortcuts(*snapshot); });
+}
+
+void ImeProcessor::UpdateShortcuts(const SettingsSnapshot& settings) {
+    const auto& shortcuts = settings.shortcuts;
 
     // Update native shortcut manager (for SPACE expansion)
     ShortcutManager::Instance().SetShortcuts(shortcuts);
@@ -106,97 +142,105 @@ void ImeProcessor::UpdateShortcuts() {
     }
 }
 
-void ImeProcessor::CheckAppChange() {
-    Settings& settings = Settings::Instance();
+WindowContext ImeProcessor::CaptureContext() const {
+    TextSender& sender = TextSender::Instance();
+    WindowContext context;
+    context.app = m_lastAppName;
+    context.enabled = m_enabled;
+    context.excluded = m_lastExcluded;
+    context.encoding = static_cast<int>(sender.GetOutputEncoding());
+    context.injection = sender.IsClipboardMode() ? InjectionProfile::Clipboard
+                      : sender.IsSlowMode()      ? InjectionProfile::Slow
+                                                 : InjectionProfile::Fast;
+    return context;
+}
 
-    AppDetector& detector = AppDetector::Instance();
-    std::wstring currentApp = detector.GetForegroundAppName();
+void ImeProcessor::CheckAppChange(const SettingsSnapshot& settings) {
+    // Same window as the last key: nothing to look up
+    HWND hwnd = GetForegroundWindow();
+    if (!hwnd || hwnd == m_lastHwnd) return;
 
-    if (currentApp.empty()) return;
+    DWORD processId = 0;
+    GetWindowThreadProcessId(hwnd, &processId);
+    WindowKey window{static_cast<uint64_t>(reinterpret_cast<ULONG_PTR>(hwnd)), static_cast<uint32_t>(processId)};
 
-    if (currentApp != m_lastAppName) {
-        // App changed - save state for old app, restore state for new app
+    // Window changed - remember what the old one was doing
+    AppDetector& detector = AppDetector::Instance();
+    if (m_lastHwnd) {
         if (!m_lastAppName.empty() && settings.smartSwitch) {
             detector.SaveAppState(m_lastAppName, m_enabled);
         }
-
-        m_lastAppName = currentApp;
+        WindowContext left = CaptureContext();
+        if (m_enabled) left.engineSnapshot = RustBridge::Instance().Snapshot();
+        m_contexts.Put(m_lastWindow, std::move(left));
+    }
+    m_lastHwnd = hwnd;
+    m_lastWindow = window;
+
+    bool newState = m_enabled;
+    TextSender& sender = TextSender::Instance();
+    const WindowContext* context = m_contexts.Find(window);
+    if (context) {
+        // Seen before: restore without probing the process
+        m_lastAppName = context->app;
+        m_lastExcluded = context->excluded;
+        if (context->excluded) newState = false;
+        else if (settings.smartSwitch) newState = context->enabled;
+        sender.SetOutputEncoding(static_cast<OutputEncoding>(context->encoding));
+        sender.SetClipboardMode(context->injection == InjectionProfile::Clipboard);
+        sender.SetSlowMode(context->injection == InjectionProfile::Slow);
+    } else {
+        std::wstring currentPath = detector.GetAppPath(processId);
+        m_lastAppName = std::wstring(AppNameFromPath(currentPath));
+        m_lastExcluded = !currentPath.empty() && detector.IsAppExcluded(currentPath);
 
         // Check if new app is in exclusion list (Feature 3)
-        if (detector.IsCurrentAppExcluded()) {
-            if (m_enabled) {
-                m_enabled = false;
-                RustBridge::Instance().SetEnabled(false);
-            }
-        } else if (settings.smartSwitch) {
+        if (m_lastExcluded) {
+            newState = false;
+        } else if (settings.smartSwitch && !m_lastAppName.empty()) {
             // Restore state for new app (Feature 2)
-            bool newState = detector.GetAppState(currentApp, settings.enabled);
-            if (newState != m_enabled) {
-                m_enabled = newState;
-                RustBridge::Instance().SetEnabled(newState);
-            }
+            newState = detector.GetAppState(m_lastAppName, settings.enabled);
         }
 
         // Apply per-app encoding (Feature 8)
-        int encoding = detector.GetAppEncoding(currentApp, 0);
-        TextSender::Instance().SetOutputEncoding(static_cast<OutputEncoding>(encoding));
+        int encoding = detector.GetAppEncoding(m_lastAppName, 0);
+        sender.SetOutputEncoding(static_cast<OutputEncoding>(encoding));
+    }
+
+    RustBridge& bridge = RustBridge::Instance();
+    if (newState != m_enabled) {
+        m_enabled = newState;
+        bridge.SetEnabled(newState);
+    }
+
+    // Continue the word this window was in the middle of; a new window (or
+    // one whose word could not be saved) starts clean instead of inheriting
+    // the previous window's word
+    if (m_enabled && !(context && bridge.Restore(context->engineSnapshot))) {
+        bridge.ClearAll();
     }
 }
 
 void ImeProcessor::OnKeyPressed(KeyEventData& event) {
+    // One snapshot per key: the settings dialog may publish a new one at any time
+    const SettingsSnapshot& settings = m_settings.Get();
+
     // Check for app changes (smart switch)
-    CheckAppChange();
+    CheckAppChange(settings);
 
     if (!m_enabled) {
         event.handled = false;
         return;
     }
 
-    int vk = event.vkCode;
-
-    // Handle backspace for shortcut buffer
-    if (vk == VK_BACK_KEY) {
-        ShortcutManager::Instance().OnBackspace();
-    }
-
     // Shortcut expansion is handled by the Rust engine on Space/punctuation.
     // The Rust engine tracks exact buffer state for correct backspace count.
+    TextEdit edit;
+    event.handled = m_keys.OnKeyPressed(event.vkCode, event.shift, event.capsLock, edit);
 
-    // Convert VK code to macOS-style keycode
-    uint16_t macKeycode = KeyCodes::ToMacKeycode(vk);
-    if (macKeycode == 0xFFFF) {
-        event.handled = false;
-        return;
-    }
-
-    // Track typed character for shortcut matching
-    char typedChar = KeyCodes::ToChar(vk, event.shift, event.capsLock);
-    if (typedChar != 0) {
-        ShortcutManager::Instance().OnChar(typedChar);
-    }
-
-    // Determine caps state (XOR of Shift and CapsLock)
-    bool caps = event.shift ^ event.capsLock;
-
-    // Process through Rust engine
-    ImeResult result = RustBridge::Instance().ProcessKeyExt(macKeycode, caps, false, event.shift);
-
-    if (result.action == ImeAction::Send && result.count > 0) {
-        std::wstring text = result.GetText();
-        // For shortcut expansion: use clipboard mode for reliability
-        // - backspaces > 4: indicates shortcut expansion (e.g., "vn " -> "Việt Nam ")
-        // - text.length() > 15: long replacement text causes timing issues with SendInput
-        if (result.backspace > 4 || text.length() > 15) {
-            TextSender::Instance().SendTextClipboard(text, result.backspace);
-        } else {
-            TextSender::Instance().SendText(text, result.backspace);
-        }
-
-        event.handled = true;
-    } else if (result.IsKeyConsumed()) {
-        // Key consumed but no text to send
-        event.handled = true;
+    if (edit.viaClipboard) {
+        TextSender::Instance().SendTextClipboard(edit.text, edit.backspaces);
     } else {
-        event.handled = false;
+        TextSender::Instance().SendText(edit.text, edit.backspaces);
     }
 }
@@ -5,13 +5,21 @@
 #pragma once
 
 #include <windows.h>
+#include <atomic>
 #include "rust_bridge.h"
 #include "keyboard_hook.h"
+#include "key_handler.h"
 #include "text_sender.h"
 #include "shortcut_manager.h"
 #include "settings.h"
+#include "settings_snapshot.h"
 #include "app_detector.h"
+#include "window_context.h"
 
+// The key callback runs on the keyboard thread (KeyboardHook). The setters
+// below are called by the UI: they update what IsEnabled()/GetMethod()
+// report at once and post the change to the keyboard thread, which owns the
+// engine, TextSender, ShortcutManager and per-app state.
 class ImeProcessor {
 public:
     static ImeProcessor& Instance();
@@ -27,19 +35,22 @@ public:
     void SetEnabled(bool enabled);
     bool IsEnabled() const { return m_enabled; }
 
-    // Toggle enabled state
-    void ToggleEnabled();
+    // Toggle enabled state; returns the new state
+    bool ToggleEnabled();
 
     // Set input method
     void SetMethod(InputMethod method);
     InputMethod GetMethod() const { return m_method; }
 
-    // Apply settings from Settings class
+    // Apply the current published SettingsSnapshot
     void ApplySettings();
 
-    // Update shortcuts from Settings
+    // Update shortcuts from the current SettingsSnapshot
     void UpdateShortcuts();
 
+    // Output encoding for the foreground app (tray menu), remembered per app
+    void SetAppEncoding(OutputEncoding encoding);
+
 private:
     ImeProcessor();
     ~ImeProcessor() = default;
@@ -49,11 +60,30 @@ private:
     // Key press handler
     void OnKeyPressed(KeyEventData& event);
 
-    // Check and handle app changes (for smart switch)
-    void CheckAppChange();
+    // Keyboard thread halves of the setters
+    void ApplyEnabled(bool enabled);
+    void ApplyMethod(InputMethod method);
+    void ApplySettings(const SettingsSnapshot& settings);
+
+    // Check and handle foreground window changes (smart switch, exclusions,
+    // per-app encoding); a window seen before is restored from m_contexts
+    void CheckAppChange(const SettingsSnapshot& settings);
+
+    // What the current window is doing, to be restored when it is focused again
+    WindowContext CaptureContext() const;
+
+    void UpdateShortcuts(const SettingsSnapshot& settings);
+
+    // Keystroke-path view of the settings; read once per key
+    SettingsStore::Reader m_settings;
 
-    bool m_enabled;
+    std::atomic<bool> m_enabled;  // written on both threads, see the setters
     std::wstring m_lastAppName;  // Track last app for smart switch
-    InputMethod m_method;
+    HWND m_lastHwnd;             // foreground window of the last key
+    WindowKey m_lastWindow;
+    bool m_lastExcluded;
+    WindowContextStore m_contexts;
+    std::atomic<InputMethod> m_method;
     bool m_initialized;
+    KeyHandler m_keys;  // keyboard thread only
 };
@@ -0,0 +1,36 @@
+// ViKey - Engine Key Result Implementation
+// ime_result.cpp
+
+#include "ime_result.h"
+#include <cstring>
+
+ImeResult::ImeResult(ImeAction a, uint8_t bs, uint8_t c, uint8_t f, const uint32_t* ch, size_t len)
+    : action(a), backspace(bs), count(c), flags(f), m_charCount(0) {
+    if (ch && len > 0) {
+        m_charCount = len < 256 ? len : 256;
+        memcpy(m_chars, ch, m_charCount * sizeof(uint32_t));
+    }
+}
+
+std::wstring ImeResult::GetText() const {
+    if (count == 0) return L"";
+
+    std::wstring result;
+    result.reserve(count);
+
+    for (size_t i = 0; i < count && i < m_charCount; i++) {
+        uint32_t cp = m_chars[i];
+        if (cp == 0) continue;
+
+        // Convert UTF-32 code point to UTF-16
+        if (cp < 0x10000) {
+            result += static_cast<wchar_t>(cp);
+        } else {
+            // Surrogate pair for characters outside BMP
+            cp -= 0x10000;
+            result += static_cast<wchar_t>(0xD800 + (cp >> 10));
+            result += static_cast<wchar_t>(0xDC00 + (cp & 0x3FF));
+        }
+    }
+    return result;
+}
@@ -0,0 +1,62 @@
+// ViKey - Engine Key Result
+// ime_result.h
+// What the Rust core returns for a key, as laid out by core and as used here
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// IME action type
+enum class ImeAction : uint8_t {
+    None = 0,    // No action needed, pass key through
+    Send = 1,    // Send text replacement
+    Restore = 2  // Restore original text (unused)
+};
+
+// Native result structure from Rust (must match core/src/engine/mod.rs)
+// chars[256] (1024 bytes) + action (1) + backspace (1) + count (1) + flags (1)
+// + 4 bytes padding + passthrough[2] (16) = 1048 bytes
+// Note: No packing needed - Rust's #[repr(C)] uses natural alignment
+struct NativeResult {
+    uint32_t chars[256];
+    uint8_t action;
+    uint8_t backspace;
+    uint8_t count;
+    uint8_t flags;
+    uint64_t passthrough[2];  // valid only with FLAG_PASSTHROUGH_MASK; older cores stop at flags
+};
+static_assert(sizeof(NativeResult) == 1048, "NativeResult must match core's Result");
+
+// Managed IME result
+class ImeResult {
+public:
+    static constexpr uint8_t FLAG_KEY_CONSUMED = 0x01;
+    static constexpr uint8_t FLAG_PASSTHROUGH_MASK = 0x02;
+
+    ImeAction action;
+    uint8_t backspace;
+    uint8_t count;
+    uint8_t flags;
+
+    ImeResult() : action(ImeAction::None), backspace(0), count(0), flags(0) {}
+    ImeResult(ImeAction a, uint8_t bs, uint8_t c, uint8_t f, const uint32_t* ch, size_t len);
+
+    // Check if key should be consumed (not passed through)
+    bool IsKeyConsumed() const { return (flags & FLAG_KEY_CONSUMED) != 0; }
+
+    // Whether the typed key must not reach the application: every Send does,
+    // even with nothing to send, because that is how the engine absorbs a key
+    // (the second w of "nuwow", a repeated tone key)
+    bool BlocksKey() const { return action == ImeAction::Send || IsKeyConsumed(); }
+
+    // Get the result text as a wstring
+    std::wstring GetText() const;
+
+    static ImeResult Empty() { return ImeResult(); }
+
+private:
+    uint32_t m_chars[256];
+    size_t m_charCount;
+};
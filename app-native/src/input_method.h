@@ -0,0 +1,13 @@
+// ViKey - Input Method
+// input_method.h
+// Input method enum shared by the engine bridge and the portable settings code
+
+#pragma once
+
+#include <cstdint>
+
+// Input method type
+enum class InputMethod : uint8_t {
+    Telex = 0,
+    VNI = 1
+};
@@ -0,0 +1,433 @@
+// ViKey - JSON Reader Implementation
+// json_reader.cpp
+// Scanning, validation and in-place string decoding for BasicJsonReader
+
+#include "json_reader.h"
+#include <climits>
+#include <cstdint>
+#include <type_traits>
+
+template <typename CharT>
+static uint32_t Unit(CharT c) {
+    return static_cast<uint32_t>(static_cast<typename std::make_unsigned<CharT>::type>(c));
+}
+
+// Write one code point as UTF-16 (Windows) or UTF-32 (elsewhere)
+static wchar_t* PutCodePoint(wchar_t* o, uint32_t cp) {
+    if (sizeof(wchar_t) == 2 && cp >= 0x10000) {
+        cp -= 0x10000;
+        *o++ = static_cast<wchar_t>(0xD800 + (cp >> 10));
+        *o++ = static_cast<wchar_t>(0xDC00 + (cp & 0x3FF));
+    } else {
+        *o++ = static_cast<wchar_t>(cp);
+    }
+    return o;
+}
+
+static int HexValue(uint32_t c) {
+    if (c >= '0' && c <= '9') return static_cast<int>(c - '0');
+    if (c >= 'a' && c <= 'f') return static_cast<int>(c - 'a' + 10);
+    if (c >= 'A' && c <= 'F') return static_cast<int>(c - 'A' + 10);
+    return -1;
+}
+
+// Four hex digits at p (already validated by ScanString)
+template <typename CharT>
+static uint32_t ReadHex4(const CharT* p) {
+    uint32_t v = 0;
+    for (int i = 0; i < 4; i++) v = (v << 4) | static_cast<uint32_t>(HexValue(Unit(p[i])));
+    return v;
+}
+
+// One non-ASCII code point from UTF-8; malformed sequences become U+FFFD and
+// consume one byte
+static uint32_t DecodeMultibyte(const char*& p, const char* end) {
+    uint32_t c = Unit(*p++);
+    int extra = (c >= 0xF0 && c < 0xF5) ? 3 : (c >= 0xE0 && c < 0xF0) ? 2 : (c >= 0xC2 && c < 0xE0) ? 1 : -1;
+    if (extra < 0 || end - p < extra) return 0xFFFD;
+    uint32_t cp = c & (0x3F >> extra);
+    for (int i = 0; i < extra; i++) {
+        if ((Unit(p[i]) & 0xC0) != 0x80) return 0xFFFD;
+        cp = (cp << 6) | (Unit(p[i]) & 0x3F);
+    }
+    static const uint32_t MIN_FOR_LENGTH[] = {0, 0x80, 0x800, 0x10000};
+    if (cp < MIN_FOR_LENGTH[extra] || cp > 0x10FFFF || (cp >= 0xD800 && cp <= 0xDFFF)) return 0xFFFD;
+    p += extra;
+    return cp;
+}
+
+// One code point from 16- or 32-bit units, pairing UTF-16 surrogates
+template <typename CharT>
+static uint32_t DecodeMultibyte(const CharT*& p, const CharT* end) {
+    uint32_t c = Unit(*p++);
+    if (sizeof(CharT) == 2 && c >= 0xD800 && c <= 0xDBFF && p < end) {
+        uint32_t low = Unit(*p);
+        if (low >= 0xDC00 && low <= 0xDFFF) {
+            p++;
+            return 0x10000 + ((c - 0xD800) << 10) + (low - 0xDC00);
+        }
+    }
+    return c;
+}
+
+template <typename CharT>
+BasicJsonReader<CharT>::BasicJsonReader(const CharT* data, size_t length)
+    : m_start(data), m_pos(data), m_end(data + length) {}
+
+template <typename CharT>
+bool BasicJsonReader<CharT>::Fail(const char* message) {
+    if (!m_error) {
+        m_error = message;
+        m_errorOffset = static_cast<size_t>(m_pos - m_start);
+    }
+    m_pending = false;
+    m_depth = 0;
+    return false;
+}
+
+template <typename CharT>
+void BasicJsonReader<CharT>::SkipWhitespace() {
+    while (m_pos < m_end) {
+        uint32_t c = Unit(*m_pos);
+        if (c != ' ' && c != '\n' && c != '\r' && c != '\t') break;
+        m_pos++;
+    }
+}
+
+template <typename CharT>
+JsonType BasicJsonReader<CharT>::Peek() {
+    if (m_error || !m_pending) return JsonType::None;
+    SkipWhitespace();
+    if (m_pos == m_end) {
+        Fail("unexpected end of input");
+        return JsonType::None;
+    }
+    uint32_t c = Unit(*m_pos);
+    switch (c) {
+        case '{': return JsonType::Object;
+        case '[': return JsonType::Array;
+        case '"': return JsonType::String;
+        case 't': case 'f': return JsonType::Bool;
+        case 'n': return JsonType::Null;
+        default:
+            if (c == '-' || (c >= '0' && c <= '9')) return JsonType::Number;
+            Fail("expected a value");
+            return JsonType::None;
+    }
+}
+
+// Peek for type; on a mismatch skip whatever is there instead
+template <typename CharT>
+bool BasicJsonReader<CharT>::TakeValue(JsonType type) {
+    JsonType next = Peek();
+    if (next == type) {
+        m_pending = false;
+        return true;
+    }
+    if (next != JsonType::None) SkipValue();
+    return false;
+}
+
+template <typename CharT>
+bool BasicJsonReader<CharT>::ScanString(const CharT*& begin, const CharT*& end, bool& escaped) {
+    m_pos++;  // opening quote
+    begin = m_pos;
+    escaped = false;
+    while (m_pos < m_end) {
+        uint32_t c = Unit(*m_pos);
+        if (c == '"') {
+            end = m_pos++;
+            return true;
+        }
+        if (c < 0x20) return Fail("control character in string");
+        if (c == '\\') {
+            escaped = true;
+            if (m_end - m_pos < 2) break;
+            uint32_t e = Unit(m_pos[1]);
+            if (e == 'u') {
+                if (m_end - m_pos < 6) break;
+                for (int i = 2; i < 6; i++) {
+                    if (HexValue(Unit(m_pos[i])) < 0) return Fail("bad \\u escape");
+                }
+                m_pos += 6;
+                continue;
+            }
+            if (e != '"' && e != '\\' && e != '/' && e != 'b' && e != 'f' && e != 'n' && e != 'r' && e != 't') {
+                return Fail("bad escape");
+            }
+            m_pos += 2;
+            continue;
+        }
+        m_pos++;
+    }
+    m_pos = m_end;
+    return Fail("unterminated string");
+}
+
+template <typename CharT>
+bool BasicJsonReader<CharT>::ScanNumber(bool& integral) {
+    integral = true;
+    if (Unit(*m_pos) == '-') m_pos++;
+    auto digit = [this]() { return m_pos < m_end && Unit(*m_pos) >= '0' && Unit(*m_pos) <= '9'; };
+    if (!digit()) return Fail("bad number");
+    if (Unit(*m_pos) == '0') {
+        m_pos++;
+    } else {
+        while (digit()) m_pos++;
+    }
+    if (m_pos < m_end && Unit(*m_pos) == '.') {
+        integral = false;
+        m_pos++;
+        if (!digit()) return Fail("bad number");
+        while (digit()) m_pos++;
+    }
+    if (m_pos < m_end && (Unit(*m_pos) == 'e' || Unit(*m_pos) == 'E')) {
+        integral = false;
+        m_pos++;
+        if (m_pos < m_end && (Unit(*m_pos) == '+' || Unit(*m_pos) == '-')) m_pos++;
+        if (!digit()) return Fail("bad number");
+        while (digit()) m_pos++;
+    }
+    return true;
+}
+
+template <typename CharT>
+bool BasicJsonReader<CharT>::ScanLiteral(const char* literal) {
+    for (const char* l = literal; *l; l++, m_pos++) {
+        if (m_pos == m_end || Unit(*m_pos) != static_cast<uint32_t>(*l)) return Fail("bad literal");
+    }
+    return true;
+}
+
+template <typename CharT>
+void BasicJsonReader<CharT>::DecodeString(const CharT* p, const CharT* end, std::wstring& out) const {
+    // Decoding never lengthens the text: size for the worst case, write
+    // through a pointer and trim once at the end
+    size_t base = out.size();
+    out.resize(base + static_cast<size_t>(end - p));
+    wchar_t* o = &out[0] + base;
+    while (p < end) {
+        uint32_t c = Unit(*p);
+        if (c != '\\') {
+            if (c < 0x80 || sizeof(CharT) == sizeof(wchar_t)) {
+                *o++ = static_cast<wchar_t>(c);  // ASCII, or same-width units copied as they are
+                p++;
+            } else {
+                o = PutCodePoint(o, DecodeMultibyte(p, end));
+            }
+            continue;
+        }
+        uint32_t e = Unit(p[1]);
+        p += 2;
+        switch (e) {
+            case 'b': *o++ = L'\b'; break;
+            case 'f': *o++ = L'\f'; break;
+            case 'n': *o++ = L'\n'; break;
+            case 'r': *o++ = L'\r'; break;
+            case 't': *o++ = L'\t'; break;
+            case 'u': {
+                uint32_t cp = ReadHex4(p);
+                p += 4;
+                if (cp >= 0xD800 && cp <= 0xDBFF && end - p >= 6 && Unit(p[0]) == '\\' && Unit(p[1]) == 'u') {
+                    uint32_t low = ReadHex4(p + 2);
+                    if (low >= 0xDC00 && low <= 0xDFFF) {
+                        cp = 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00);
+                        p += 6;
+                    }
+                }
+                if (cp >= 0xD800 && cp <= 0xDFFF) cp = 0xFFFD;  // unpaired surrogate
+                o = PutCodePoint(o, cp);
+                break;
+            }
+            default: *o++ = static_cast<wchar_t>(e); break;  // " \ /
+        }
+    }
+    out.resize(static_cast<size_t>(o - out.data()));
+}
+
+template <typename CharT>
+bool BasicJsonReader<CharT>::ReadBool(bool& out) {
+    if (!TakeValue(JsonType::Bool)) return false;
+    bool value = Unit(*m_pos) == 't';
+    if (!ScanLiteral(value ? "true" : "false")) return false;
+    out = value;
+    return true;
+}
+
+template <typename CharT>
+bool BasicJsonReader<CharT>::ReadInt(int& out) {
+    if (!TakeValue(JsonType::Number)) return false;
+    const CharT* begin = m_pos;
+    bool integral;
+    if (!ScanNumber(integral) || !integral) return false;
+
+    bool negative = Unit(*begin) == '-';
+    if (negative) begin++;
+    const int64_t limit = negative ? -static_cast<int64_t>(INT_MIN) : INT_MAX;
+    int64_t value = 0;
+    for (const CharT* p = begin; p < m_pos; p++) {
+        value = value * 10 + (Unit(*p) - '0');
+        if (value > limit) return false;  // out of range: consumed, not an error
+    }
+    out = static_cast<int>(negative ? -value : value);
+    return true;
+}
+
+template <typename CharT>
+bool BasicJsonReader<CharT>::ReadString(std::wstring& out) {
+    if (!TakeValue(JsonType::String)) return false;
+    const CharT* begin;
+    const CharT* end;
+    bool escaped;
+    if (!ScanString(begin, end, escaped)) return false;
+    out.clear();
+    DecodeString(begin, end, out);
+    return true;
+}
+
+template <typename CharT>
+bool BasicJsonReader<CharT>::BeginObject() {
+    if (!TakeValue(JsonType::Object)) return false;
+    if (m_depth == MAX_DEPTH) return Fail("nesting too deep");
+    m_pos++;
+    m_inArray[m_depth] = false;
+    m_first[m_depth] = true;
+    m_depth++;
+    return true;
+}
+
+template <typename CharT>
+bool BasicJsonReader<CharT>::NextKey() {
+    if (m_error) return false;
+    if (m_pending) SkipValue();  // the caller did not read the previous value
+    if (m_error) return false;
+    if (m_depth == 0 || m_inArray[m_depth - 1]) return Fail("not in an object");
+
+    SkipWhitespace();
+    bool& first = m_first[m_depth - 1];
+    if (m_pos < m_end && Unit(*m_pos) == '}') {
+        // "{}" or the end of "{...}"; a ',' right before it was rejected below
+        m_pos++;
+        m_depth--;
+        return false;
+    }
+    if (!first) {
+        if (m_pos == m_end || Unit(*m_pos) != ',') return Fail("expected ',' or '}'");
+        m_pos++;
+        SkipWhitespace();
+    }
+    first = false;
+    if (m_pos == m_end || Unit(*m_pos) != '"') return Fail("expected a key");
+    if (!ScanString(m_keyBegin, m_keyEnd, m_keyEscaped)) return false;
+    SkipWhitespace();
+    if (m_pos == m_end || Unit(*m_pos) != ':') return Fail("expected ':'");
+    m_pos++;
+    m_pending = true;
+    return true;
+}
+
+template <typename CharT>
+bool BasicJsonReader<CharT>::KeyIs(const char* name) const {
+    if (m_keyEscaped) {
+        std::wstring key = Key();
+        size_t i = 0;
+        for (; name[i]; i++) {
+            if (i == key.size() || key[i] != static_cast<wchar_t>(name[i])) return false;
+        }
+        return i == key.size();
+    }
+    const CharT* p = m_keyBegin;
+    for (; *name; name++, p++) {
+        if (p == m_keyEnd || Unit(*p) != static_cast<uint32_t>(static_cast<unsigned char>(*name))) return false;
+    }
+    return p == m_keyEnd;
+}
+
+template <typename CharT>
+std::wstring BasicJsonReader<CharT>::Key() const {
+    std::wstring key;
+    if (m_keyBegin) DecodeString(m_keyBegin, m_keyEnd, key);
+    return key;
+}
+
+template <typename CharT>
+bool BasicJsonReader<CharT>::BeginArray() {
+    if (!TakeValue(JsonType::Array)) return false;
+    if (m_depth == MAX_DEPTH) return Fail("nesting too deep");
+    m_pos++;
+    m_inArray[m_depth] = true;
+    m_first[m_depth] = true;
+    m_depth++;
+    return true;
+}
+
+template <typename CharT>
+bool BasicJsonReader<CharT>::NextElement() {
+    if (m_error) return false;
+    if (m_pending) SkipValue();
+    if (m_error) return false;
+    if (m_depth == 0 || !m_inArray[m_depth - 1]) return Fail("not in an array");
+
+    SkipWhitespace();
+    bool& first = m_first[m_depth - 1];
+    if (m_pos < m_end && Unit(*m_pos) == ']') {
+        m_pos++;
+        m_depth--;
+        return false;
+    }
+    if (!first) {
+        if (m_pos == m_end || Unit(*m_pos) != ',') return Fail("expected ',' or ']'");
+        m_pos++;
+        SkipWhitespace();
+        if (m_pos < m_end && Unit(*m_pos) == ']') return Fail("trailing ','");
+    }
+    first = false;
+    m_pending = true;
+    return true;
+}
+
+template <typename CharT>
+void BasicJsonReader<CharT>::SkipValue() {
+    const CharT* begin;
+    const CharT* end;
+    bool flag;
+    switch (Peek()) {
+        case JsonType::Object:
+            BeginObject();
+            while (NextKey()) {}
+            break;
+        case JsonType::Array:
+            BeginArray();
+            while (NextElement()) {}
+            break;
+        case JsonType::String:
+            m_pending = false;
+            ScanString(begin, end, flag);
+            break;
+        case JsonType::Number:
+            m_pending = false;
+            ScanNumber(flag);
+            break;
+        case JsonType::Bool:
+            m_pending = false;
+            ScanLiteral(Unit(*m_pos) == 't' ? "true" : "false");
+            break;
+        case JsonType::Null:
+            m_pending = false;
+            ScanLiteral("null");
+            break;
+        case JsonType::None:
+            break;
+    }
+}
+
+template <typename CharT>
+bool BasicJsonReader<CharT>::AtEnd() {
+    if (m_error || m_pending || m_depth > 0) return false;
+    SkipWhitespace();
+    return m_pos == m_end;
+}
+
+template class BasicJsonReader<char>;
+template class BasicJsonReader<char16_t>;
+template class BasicJsonReader<wchar_t>;
@@ -0,0 +1,100 @@
+// ViKey - JSON Reader
+// json_reader.h
+// Single-pass pull parser over UTF-8, UTF-16 or wchar_t text, reading in place
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+enum class JsonType {
+    None,  // no value expected here, end of input, or an error
+    Object,
+    Array,
+    String,
+    Number,
+    Bool,
+    Null
+};
+
+// Pulls values straight out of the caller's buffer, which must outlive the
+// reader. Nothing is copied until the caller asks for a value: keys are
+// compared in place and strings are decoded directly into the caller's string.
+//
+//     JsonReader reader(text.data(), text.size());
+//     if (reader.BeginObject()) {
+//         while (reader.NextKey()) {
+//             if (reader.KeyIs("version")) reader.ReadInt(version);
+//             else if (reader.KeyIs("name")) reader.ReadString(name);
+//         }
+//     }
+//     if (reader.Failed() || !reader.AtEnd()) ...
+//
+// A member or element the caller does not read is skipped by the next
+// NextKey()/NextElement(). A value of the wrong type is skipped and reported
+// with false; only malformed input makes the reader fail, after which every
+// call returns false. Object and array loops must run until they return false.
+template <typename CharT>
+class BasicJsonReader {
+public:
+    static constexpr int MAX_DEPTH = 64;
+
+    BasicJsonReader(const CharT* data, size_t length);
+
+    // Type of the next value without consuming it
+    JsonType Peek();
+
+    // Consume the next value. False (value skipped) if it has another type.
+    bool ReadBool(bool& out);
+    bool ReadInt(int& out);  // integers within int range; no fraction or exponent
+    bool ReadString(std::wstring& out);
+
+    // Objects: BeginObject(), then NextKey() until it returns false at '}'
+    bool BeginObject();
+    bool NextKey();
+    bool KeyIs(const char* name) const;  // ASCII name
+    std::wstring Key() const;
+
+    // Arrays: BeginArray(), then NextElement() until it returns false at ']'
+    bool BeginArray();
+    bool NextElement();
+
+    // Skip the next value and everything nested in it
+    void SkipValue();
+
+    // True when the top-level value has been read and only whitespace remains
+    bool AtEnd();
+
+    bool Failed() const { return m_error != nullptr; }
+    const char* Error() const { return m_error ? m_error : ""; }
+    size_t ErrorOffset() const { return m_errorOffset; }  // in code units
+
+private:
+    bool Fail(const char* message);
+    void SkipWhitespace();
+    bool TakeValue(JsonType type);
+    bool ScanString(const CharT*& begin, const CharT*& end, bool& escaped);
+    bool ScanNumber(bool& integral);
+    bool ScanLiteral(const char* literal);
+    void DecodeString(const CharT* begin, const CharT* end, std::wstring& out) const;
+
+    const CharT* m_start;
+    const CharT* m_pos;
+    const CharT* m_end;
+
+    bool m_pending = true;  // a value is expected next (the top-level one at first)
+    int m_depth = 0;
+    bool m_inArray[MAX_DEPTH];
+    bool m_first[MAX_DEPTH];  // no member or element read yet at this depth
+
+    const CharT* m_keyBegin = nullptr;
+    const CharT* m_keyEnd = nullptr;
+    bool m_keyEscaped = false;
+
+    const char* m_error = nullptr;
+    size_t m_errorOffset = 0;
+};
+
+using JsonReader = BasicJsonReader<wchar_t>;       // std::wstring text
+using Utf8JsonReader = BasicJsonReader<char>;      // UTF-8 bytes
+using Utf16JsonReader = BasicJsonReader<char16_t>; // UTF-16LE file contents
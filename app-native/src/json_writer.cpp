@@ -0,0 +1,106 @@
+// ViKey - JSON Writer Implementation
+// json_writer.cpp
+
+#include "json_writer.h"
+#include <cstdint>
+
+void JsonWriter::NewLine(int depth) {
+    m_out += L'\n';
+    m_out.append(static_cast<size_t>(depth) * 2, L' ');
+}
+
+// Separator and indentation in front of a value (or of a key)
+void JsonWriter::BeforeValue() {
+    if (m_afterKey) {
+        m_afterKey = false;
+        return;
+    }
+    if (m_depth == 0) return;
+    size_t& count = m_count[m_depth - 1];
+    if (count > 0) m_out += L',';
+    if (m_inline[m_depth - 1]) {
+        if (count > 0) m_out += L' ';
+    } else {
+        NewLine(m_depth);
+    }
+    count++;
+}
+
+void JsonWriter::Open(wchar_t bracket, bool isInline) {
+    BeforeValue();
+    m_out += bracket;
+    m_inline[m_depth] = isInline || (m_depth > 0 && m_inline[m_depth - 1]);
+    m_count[m_depth] = 0;
+    m_depth++;
+}
+
+void JsonWriter::Close(wchar_t bracket) {
+    m_depth--;
+    if (m_count[m_depth] > 0 && !m_inline[m_depth]) NewLine(m_depth);
+    m_out += bracket;
+    if (m_depth == 0) m_out += L'\n';
+}
+
+void JsonWriter::BeginObject() { Open(L'{', false); }
+void JsonWriter::BeginInlineObject() { Open(L'{', true); }
+void JsonWriter::EndObject() { Close(L'}'); }
+void JsonWriter::BeginArray() { Open(L'[', false); }
+void JsonWriter::EndArray() { Close(L']'); }
+
+void JsonWriter::Key(const char* name) {
+    BeforeValue();
+    m_out += L'"';
+    while (*name) m_out += static_cast<wchar_t>(static_cast<unsigned char>(*name++));
+    m_out += L"\": ";
+    m_afterKey = true;
+}
+
+void JsonWriter::String(const std::wstring& value) {
+    String(value.data(), value.size());
+}
+
+void JsonWriter::String(const wchar_t* value, size_t length) {
+    static const wchar_t HEX[] = L"0123456789abcdef";
+    BeforeValue();
+    m_out += L'"';
+    const wchar_t* end = value + length;
+    while (value < end) {
+        // Copy the run that needs no escaping in one append
+        const wchar_t* run = value;
+        while (value < end && *value != L'"' && *value != L'\\' && static_cast<uint32_t>(*value) >= 0x20) value++;
+        m_out.append(run, value);
+        if (value == end) break;
+
+        wchar_t c = *value++;
+        switch (c) {
+            case L'"': m_out += L"\\\""; break;
+            case L'\\': m_out += L"\\\\"; break;
+            case L'\n': m_out += L"\\n"; break;
+            case L'\r': m_out += L"\\r"; break;
+            case L'\t': m_out += L"\\t"; break;
+            case L'\b': m_out += L"\\b"; break;
+            case L'\f': m_out += L"\\f"; break;
+            default:
+                m_out += L"\\u00";
+                m_out += HEX[(c >> 4) & 0xF];
+                m_out += HEX[c & 0xF];
+                break;
+        }
+    }
+    m_out += L'"';
+}
+
+void JsonWriter::Int(long long value) {
+    BeforeValue();
+    m_out += std::to_wstring(value);
+}
+
+void JsonWriter::Bool(bool value) {
+    BeforeValue();
+    m_out += value ? L"true" : L"false";
+}
+
+void JsonWriter::Null() {
+    BeforeValue();
+    m_out += L"null";
+}
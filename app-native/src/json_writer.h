@@ -0,0 +1,56 @@
+// ViKey - JSON Writer
+// json_writer.h
+// Appends indented JSON to a std::wstring in one pass, escaping as it goes
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <utility>
+
+// Builds a document with two-space indentation, one member or element per
+// line. Objects opened with BeginInlineObject() stay on one line, which keeps
+// long arrays of small records (shortcuts) readable:
+//
+//     {
+//       "version": 1,
+//       "shortcuts": [
+//         {"key": "vn", "value": "Việt Nam"}
+//       ]
+//     }
+//
+// Inside an object every value is preceded by Key(). Unbalanced Begin/End
+// calls are a programming error and are not diagnosed.
+class JsonWriter {
+public:
+    static constexpr int MAX_DEPTH = 64;
+
+    void BeginObject();
+    void BeginInlineObject();
+    void EndObject();
+    void BeginArray();
+    void EndArray();
+
+    void Key(const char* name);  // ASCII name
+    void String(const std::wstring& value);
+    void String(const wchar_t* value, size_t length);
+    void Int(long long value);
+    void Bool(bool value);
+    void Null();
+
+    void Reserve(size_t chars) { m_out.reserve(chars); }
+    const std::wstring& Str() const { return m_out; }
+    std::wstring Take() { return std::move(m_out); }
+
+private:
+    void BeforeValue();
+    void Open(wchar_t bracket, bool isInline);
+    void Close(wchar_t bracket);
+    void NewLine(int depth);
+
+    std::wstring m_out;
+    int m_depth = 0;
+    bool m_inline[MAX_DEPTH] = {};
+    size_t m_count[MAX_DEPTH] = {};  // members or elements written at each depth
+    bool m_afterKey = false;
+};
@@ -0,0 +1,75 @@
+// ViKey - Key Handling Implementation
+// key_handler.cpp
+
+#include "key_handler.h"
+#include "keycodes.h"
+#include "shortcut_manager.h"
+
+bool KeyHandler::Admit(int vkCode, bool ctrl, bool alt) {
+    // Ctrl on its own, and Ctrl combinations (shortcuts), end the word
+    if (vkCode == VK_CONTROL_KEY) {
+        m_engine.Clear();
+        return false;
+    }
+    if (!KeyCodes::IsRelevantKey(vkCode)) return false;
+    if (ctrl || alt) {
+        if (ctrl) m_engine.Clear();
+        return false;
+    }
+
+    // Word boundary keys, except Space which needs the shortcut check
+    if (KeyCodes::IsBufferClearKey(vkCode) && vkCode != VK_SPACE_KEY) {
+        m_engine.Clear();
+        return false;
+    }
+    return true;
+}
+
+bool KeyHandler::OnKeyPressed(int vkCode, bool shift, bool capsLock, TextEdit& edit) {
+    edit = TextEdit();
+    ShortcutManager& shortcuts = ShortcutManager::Instance();
+
+    // Handle backspace for shortcut buffer
+    if (vkCode == VK_BACK_KEY) {
+        shortcuts.OnBackspace();
+    }
+
+    // Convert VK code to macOS-style keycode
+    uint16_t macKeycode = KeyCodes::ToMacKeycode(vkCode);
+    if (macKeycode == 0xFFFF) return false;
+
+    // Track typed character for shortcut matching
+    char typedChar = KeyCodes::ToChar(vkCode, shift, capsLock);
+    if (typedChar != 0) {
+        shortcuts.OnChar(typedChar);
+    }
+
+    // Keys the last result marked as no-ops (Backspace with nothing left to
+    // delete, ESC with nothing typed) pass straight through
+    if (m_engine.IsPassthrough(macKeycode)) return false;
+
+    // Caps is the XOR of Shift and Caps Lock; Shift alone picks VNI symbols
+    ImeResult result = m_engine.ProcessKeyExt(macKeycode, shift ^ capsLock, false, shift);
+    if (result.action == ImeAction::Send) {
+        edit.backspaces = result.backspace;
+        edit.text = result.GetText();
+        edit.viaClipboard = edit.backspaces > CLIPBOARD_BACKSPACES || edit.text.length() > CLIPBOARD_TEXT;
+    }
+    return result.BlocksKey();
+}
+
+void KeyHandler::KeyDone(int vkCode) {
+    if (KeyCodes::IsBufferClearKey(vkCode)) {
+        m_engine.Clear();
+    }
+}
+
+void KeyHandler::Reset() {
+    m_engine.Clear();
+    ShortcutManager::Instance().Clear();
+}
+
+void KeyHandler::Resync() {
+    m_engine.ClearAll();
+    ShortcutManager::Instance().Clear();
+}
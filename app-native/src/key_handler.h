@@ -0,0 +1,60 @@
+// ViKey - Key Handling
+// key_handler.h
+// What the IME does with a key down: which keys reach the engine, how its
+// answer becomes an edit, and when the word ends. KeyboardHook and
+// ImeProcessor call it around their Win32 parts; bench_typing runs the same
+// decisions against a mock screen.
+
+#pragma once
+
+#include <string>
+#include "core_engine.h"
+
+// An edit to make in the focused application in place of a key: delete
+// `backspaces` characters, then type `text`
+struct TextEdit {
+    int backspaces = 0;
+    std::wstring text;
+    // Long replacements (shortcut expansions) are pasted: as typed keys they
+    // are too many events for SendInput to deliver reliably
+    bool viaClipboard = false;
+
+    bool Empty() const { return backspaces == 0 && text.empty(); }
+};
+
+// Decisions only; the caller reads the modifier state, applies the edit and
+// blocks the key. Keeps no state of its own: the engine and ShortcutManager
+// hold the word.
+class KeyHandler {
+public:
+    explicit KeyHandler(CoreEngine& engine) : m_engine(engine) {}
+
+    // Before the IME: false if the key goes straight to the application.
+    // Keys that end the word there (Ctrl and Ctrl combinations, Enter, Tab,
+    // arrows) clear it first. Space goes on: it may expand a shortcut.
+    bool Admit(int vkCode, bool ctrl, bool alt);
+
+    // The engine's answer to an admitted key, with the IME on. True if the
+    // key must be blocked; `edit` is what to type instead (may be empty).
+    bool OnKeyPressed(int vkCode, bool shift, bool capsLock, TextEdit& edit);
+
+    // After the IME: Space ends the word once the engine has seen it
+    void KeyDone(int vkCode);
+
+    // Keys are about to bypass the IME: forget the word
+    void Reset();
+
+    // Keys bypassed the IME and changed the text (native auto-repeat): start
+    // over from an empty word rather than edit what is no longer there
+    void Resync();
+
+private:
+    KeyHandler(const KeyHandler&) = delete;
+    KeyHandler& operator=(const KeyHandler&) = delete;
+
+    // Longer replacements go by the clipboard (see TextEdit::viaClipboard)
+    static constexpr int CLIPBOARD_BACKSPACES = 4;
+    static constexpr size_t CLIPBOARD_TEXT = 15;
+
+    CoreEngine& m_engine;
+};
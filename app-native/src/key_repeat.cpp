@@ -0,0 +1,35 @@
+// ViKey - Auto-repeat Tracker Implementation
+// key_repeat.cpp
+
+#include "key_repeat.h"
+
+bool KeyRepeatTracker::KeyDown(uint8_t vk, uint32_t timeMs) {
+    // Unsigned difference: the hook's millisecond clock wraps every 49 days
+    bool repeat = m_down[vk] && timeMs - m_lastDown[vk] <= MAX_REPEAT_GAP_MS;
+    m_down[vk] = true;
+    m_lastDown[vk] = timeMs;
+    if (repeat) m_stats.repeats++;
+    else m_stats.presses++;
+    return repeat;
+}
+
+bool KeyRepeatTracker::KeyUp(uint8_t vk) {
+    m_down[vk] = false;
+    if (!m_unsynced || vk != m_bypassedKey) return false;
+    m_unsynced = false;
+    m_stats.resyncs++;
+    return true;
+}
+
+void KeyRepeatTracker::Bypassed(uint8_t vk) {
+    m_stats.bypassed++;
+    m_unsynced = true;
+    m_bypassedKey = vk;
+}
+
+bool KeyRepeatTracker::TakeResync() {
+    if (!m_unsynced) return false;
+    m_unsynced = false;
+    m_stats.resyncs++;
+    return true;
+}
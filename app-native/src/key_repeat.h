@@ -0,0 +1,54 @@
+// ViKey - Auto-repeat Tracker
+// key_repeat.h
+// Tells a held key's auto-repeat from a fresh press for the low-level hook,
+// and says when the engine must be resynced after repeats it did not see
+
+#pragma once
+
+#include <bitset>
+#include <cstdint>
+
+// WH_KEYBOARD_LL gets no previous-state bit, so keys are paired by hand: a
+// key down for a key that is already down is a repeat. A key-up can go
+// missing (the secure desktop takes the keyboard, the hook was reinstalled),
+// so a "repeat" more than MAX_REPEAT_GAP_MS after the key's last down is
+// taken as a fresh press instead of leaving the key stuck.
+//
+// Repeats skip the engine: the hook lets them through natively, and the
+// engine, which no longer knows what is on screen, is cleared once when the
+// run ends, by the key's release or by another key interrupting it.
+class KeyRepeatTracker {
+public:
+    // Longer than any typematic delay Windows offers (1 s), then some
+    static constexpr uint32_t MAX_REPEAT_GAP_MS = 1500;
+
+    // A key went down at `timeMs` (the hook event's time). True if it is an
+    // auto-repeat of a key held down.
+    bool KeyDown(uint8_t vk, uint32_t timeMs);
+
+    // A key went up. True if a run of repeats that bypassed the engine ended
+    // with it: resync the engine now.
+    bool KeyUp(uint8_t vk);
+
+    // A repeat of `vk` went through without the engine
+    void Bypassed(uint8_t vk);
+
+    // Before a fresh key reaches the engine: true if an earlier run bypassed
+    // it and was not resynced yet (another key took over the repeat)
+    bool TakeResync();
+
+    struct Stats {
+        uint64_t presses = 0;   // fresh key downs
+        uint64_t repeats = 0;
+        uint64_t bypassed = 0;  // repeats that skipped the engine
+        uint64_t resyncs = 0;   // KeyUp()/TakeResync() answers of true
+    };
+    const Stats& GetStats() const { return m_stats; }
+
+private:
+    std::bitset<256> m_down;
+    uint32_t m_lastDown[256] = {};
+    bool m_unsynced = false;
+    uint8_t m_bypassedKey = 0;  // the key whose repeats bypassed the engine
+    Stats m_stats;
+};
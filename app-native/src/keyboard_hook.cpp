@@ -5,6 +5,9 @@
 #include "keyboard_hook.h"
 #include "keycodes.h"
 #include "rust_bridge.h"
+#include "startup_timeline.h"
+#include <cstdlib>
+#include <cstring>
 
 // Win32 Constants
 // WH_KEYBOARD_LL is defined in Windows.h as 13
@@ -13,8 +16,18 @@
 #endif
 constexpr int WM_KEYDOWN_MSG = 0x0100;
 constexpr int WM_SYSKEYDOWN_MSG = 0x0104;
+constexpr int WM_KEYUP_MSG = 0x0101;
+constexpr int WM_SYSKEYUP_MSG = 0x0105;
 constexpr DWORD LLKHF_INJECTED_FLAG = 0x10;
 
+// Posted to the keyboard thread after a command is queued
+constexpr UINT WM_HOOK_COMMAND = WM_APP + 1;
+
+// Watchdog health check on the keyboard thread
+constexpr UINT_PTR WATCHDOG_TIMER = 1;
+constexpr UINT WATCHDOG_INTERVAL_MS = 1000;
+constexpr const wchar_t* WATCHDOG_WINDOW_CLASS = L"ViKey_KeyboardThread";
+
 // KBDLLHOOKSTRUCT structure
 struct KBDLLHOOKSTRUCT_DATA {
     DWORD vkCode;
@@ -27,6 +40,35 @@ struct KBDLLHOOKSTRUCT_DATA {
 // Static instance pointer for callback
 static KeyboardHook* g_instance = nullptr;
 
+// LowLevelHooksTimeout in milliseconds, the time Windows gives a hook
+// callback before removing the hook; 0 when it is not set. Usually a DWORD,
+// but some tweaking tools write it as a string.
+static DWORD ReadHookTimeoutMs() {
+    HKEY hKey;
+    if (RegOpenKeyExW(HKEY_CURRENT_USER, L"Control Panel\\Desktop", 0, KEY_READ, &hKey) != ERROR_SUCCESS) {
+        return 0;
+    }
+    DWORD timeout = 0;
+    DWORD type = 0;
+    wchar_t text[16] = {};
+    DWORD size = sizeof(text) - sizeof(wchar_t);
+    if (RegQueryValueExW(hKey, L"LowLevelHooksTimeout", nullptr, &type, (LPBYTE)text, &size) == ERROR_SUCCESS) {
+        if (type == REG_DWORD && size == sizeof(DWORD)) {
+            memcpy(&timeout, text, sizeof(DWORD));
+        } else if (type == REG_SZ) {
+            timeout = wcstoul(text, nullptr, 10);
+        }
+    }
+    RegCloseKey(hKey);
+    return timeout;
+}
+
+static HookWatchdog::Config MakeWatchdogConfig() {
+    HookWatchdog::Config config;
+    config.budget = HookWatchdog::BudgetFor(std::chrono::milliseconds(ReadHookTimeoutMs()));
+    return config;
+}
+
 // Global keyboard hook procedure (not a class member)
 // Use __declspec(noinline) to prevent optimization that might affect the callback
 __declspec(noinline) static LRESULT CALLBACK GlobalLowLevelKeyboardProc(int nCode, WPARAM wParam, LPARAM lParam) {
@@ -36,6 +78,18 @@ __declspec(noinline) static LRESULT CALLBACK GlobalLowLevelKeyboardProc(int nCod
     return CallNextHookEx(nullptr, nCode, wParam, lParam);
 }
 
+LRESULT CALLBACK KeyboardThreadWndProc(HWND hWnd, UINT message, WPARAM wParam, LPARAM lParam) {
+    if (g_instance) {
+        if (message == WM_INPUT) {
+            g_instance->OnRawInput(reinterpret_cast<HRAWINPUT>(lParam));
+        } else if (message == WM_TIMER && wParam == WATCHDOG_TIMER) {
+            g_instance->CheckHealth();
+            return 0;
+        }
+    }
+    return DefWindowProcW(hWnd, message, wParam, lParam);
+}
+
 KeyboardHook& KeyboardHook::Instance() {
     static KeyboardHook instance;
     return instance;
@@ -44,7 +98,12 @@ KeyboardHook& KeyboardHook::Instance() {
 KeyboardHook::KeyboardHook()
     : m_hookId(nullptr)
     , m_isProcessing(false)
-    , m_callback(nullptr) {
+    , m_sawFirstKey(false)
+    , m_callback(nullptr)
+    , m_threadId(0)
+    , m_watchdog(MakeWatchdogConfig())
+    , m_watchdogWindow(nullptr)
+    , m_keys(RustBridge::Instance()) {
     g_instance = this;
 }
 
@@ -54,7 +113,69 @@ KeyboardHook::~KeyboardHook() {
 }
 
 bool KeyboardHook::Start() {
-    if (m_hookId != nullptr) return true;
+    if (m_threadId != 0) {
+        Post([this]() { InstallHook(); });
+        return true;
+    }
+
+    HANDLE started = CreateEventW(nullptr, TRUE, FALSE, nullptr);
+    if (started == nullptr) return false;
+    m_thread = std::thread([this, started]() { Run(started); });
+    WaitForSingleObject(started, INFINITE);
+    CloseHandle(started);
+
+    if (m_hookId == nullptr) {
+        m_thread.join();
+        MessageBoxW(nullptr, L"Failed to install keyboard hook!", L"Hook Error", MB_ICONERROR);
+        return false;
+    }
+    return true;
+}
+
+void KeyboardHook::Run(HANDLE started) {
+    // Every application's keys wait on this thread: let it run ahead of the UI
+    SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_TIME_CRITICAL);
+
+    // Create the thread's message queue before anyone can post to it
+    MSG msg;
+    PeekMessageW(&msg, nullptr, WM_USER, WM_USER, PM_NOREMOVE);
+
+    if (InstallHook()) {
+        m_threadId = GetCurrentThreadId();
+        StartupTimeline::Instance().Mark(StartupTimeline::HOOK_READY);
+    }
+    SetEvent(started);
+    if (m_hookId == nullptr) return;
+
+    // Without it the hook still works, it just is not watched
+    CreateWatchdogWindow();
+
+    // Hook callbacks are delivered inside GetMessage; the posted messages are
+    // command wake-ups, Stop()'s WM_QUIT and the watchdog window's
+    while (GetMessageW(&msg, nullptr, 0, 0) > 0) {
+        if (msg.hwnd == nullptr && msg.message == WM_HOOK_COMMAND) m_commands.Drain();
+        else DispatchMessageW(&msg);
+    }
+
+    if (m_watchdogWindow) {
+        RAWINPUTDEVICE device = {0x01, 0x06, RIDEV_REMOVE, nullptr};  // generic desktop, keyboard
+        RegisterRawInputDevices(&device, 1, sizeof(device));
+        DestroyWindow(m_watchdogWindow);
+        m_watchdogWindow = nullptr;
+    }
+    if (m_hookId != nullptr) {
+        UnhookWindowsHookEx(m_hookId);
+        m_hookId = nullptr;
+    }
+    m_threadId = 0;
+    m_commands.Drain();  // posted before Stop(); from now on Post() runs them inline
+}
+
+bool KeyboardHook::InstallHook() {
+    if (m_hookId != nullptr) {
+        UnhookWindowsHookEx(m_hookId);  // fails harmlessly if Windows already removed it
+        m_hookId = nullptr;
+    }
 
     SetLastError(0);
 
@@ -67,27 +188,95 @@ bool KeyboardHook::Start() {
         hMod,
         0
     );
+    if (m_hookId != nullptr) m_watchdog.Installed(HookWatchdog::Clock::now());
+    return m_hookId != nullptr;
+}
 
-    if (m_hookId == nullptr) {
-        MessageBoxW(nullptr, L"Failed to install keyboard hook!", L"Hook Error", MB_ICONERROR);
+bool KeyboardHook::CreateWatchdogWindow() {
+    HINSTANCE hInstance = GetModuleHandleW(nullptr);
+    WNDCLASSEXW wcex = {};
+    wcex.cbSize = sizeof(WNDCLASSEXW);
+    wcex.lpfnWndProc = KeyboardThreadWndProc;
+    wcex.hInstance = hInstance;
+    wcex.lpszClassName = WATCHDOG_WINDOW_CLASS;
+    RegisterClassExW(&wcex);  // fails harmlessly when registered by an earlier Start()
+
+    m_watchdogWindow = CreateWindowExW(0, WATCHDOG_WINDOW_CLASS, L"", 0, 0, 0, 0, 0,
+                                       HWND_MESSAGE, nullptr, hInstance, nullptr);
+    if (m_watchdogWindow == nullptr) return false;
+
+    // Every key the system delivers, in the background too: the hook should
+    // have seen each of them first
+    RAWINPUTDEVICE device = {0x01, 0x06, RIDEV_INPUTSINK, m_watchdogWindow};  // generic desktop, keyboard
+    RegisterRawInputDevices(&device, 1, sizeof(device));
+    SetTimer(m_watchdogWindow, WATCHDOG_TIMER, WATCHDOG_INTERVAL_MS, nullptr);
+    return true;
+}
+
+void KeyboardHook::OnRawInput(HRAWINPUT input) {
+    RAWINPUT raw;
+    UINT size = sizeof(raw);
+    if (GetRawInputData(input, RID_INPUT, &raw, &size, sizeof(RAWINPUTHEADER)) == static_cast<UINT>(-1)) return;
+    if (raw.header.dwType == RIM_TYPEKEYBOARD && !(raw.data.keyboard.Flags & RI_KEY_BREAK)) {
+        m_watchdog.SystemKey(HookWatchdog::Clock::now());
     }
+}
 
-    return m_hookId != nullptr;
+void KeyboardHook::CheckHealth() {
+    if (m_watchdog.Check(HookWatchdog::Clock::now()) == HookWatchdog::Action::Reinstall) {
+        OutputDebugStringW(L"ViKey: keyboard hook removed by Windows, installing it again\n");
+        Start();
+    }
 }
 
 void KeyboardHook::Stop() {
-    if (m_hookId != nullptr) {
-        UnhookWindowsHookEx(m_hookId);
-        m_hookId = nullptr;
+    if (!m_thread.joinable()) return;
+    PostThreadMessageW(m_threadId, WM_QUIT, 0, 0);
+    m_thread.join();
+}
+
+void KeyboardHook::Post(CommandQueue::Command command) {
+    DWORD threadId = m_threadId;
+    if (threadId == 0 || threadId == GetCurrentThreadId()) {
+        m_commands.Drain();  // keep the order of anything already queued
+        command();
+        return;
     }
+
+    // Full only if the keyboard thread is stuck, and keys are stuck with it
+    while (!m_commands.Post(command)) Sleep(1);
+    PostThreadMessageW(threadId, WM_HOOK_COMMAND, 0, 0);
+}
+
+bool KeyboardHook::IsKeyboardThread() const {
+    DWORD threadId = m_threadId;
+    return threadId == 0 || threadId == GetCurrentThreadId();
 }
 
 LRESULT KeyboardHook::ProcessKey(int nCode, WPARAM wParam, LPARAM lParam) {
+    // Any callback at all: the hook is still installed
+    HookWatchdog::Clock::time_point start = HookWatchdog::Clock::now();
+    m_watchdog.HookEvent(start);
+
     // Prevent recursion
     if (m_isProcessing) {
         return CallNextHookEx(m_hookId, nCode, wParam, lParam);
     }
 
+    // Hook callbacks run ahead of posted messages: apply settings changes
+    // queued before this key first
+    m_commands.Drain();
+
+    // Key-ups only end auto-repeat runs
+    if (nCode >= 0 && (wParam == WM_KEYUP_MSG || wParam == WM_SYSKEYUP_MSG)) {
+        auto* hookStruct = reinterpret_cast<KBDLLHOOKSTRUCT_DATA*>(lParam);
+        if (hookStruct->dwExtraInfo != INJECTED_KEY_MARKER &&
+            m_repeats.KeyUp(static_cast<uint8_t>(hookStruct->vkCode))) {
+            m_keys.Resync();
+        }
+        return CallNextHookEx(m_hookId, nCode, wParam, lParam);
+    }
+
     // Only process key down events
     if (nCode >= 0 && (wParam == WM_KEYDOWN_MSG || wParam == WM_SYSKEYDOWN_MSG)) {
         auto* hookStruct = reinterpret_cast<KBDLLHOOKSTRUCT_DATA*>(lParam);
@@ -98,33 +287,36 @@ LRESULT KeyboardHook::ProcessKey(int nCode, WPARAM wParam, LPARAM lParam) {
             return CallNextHookEx(m_hookId, nCode, wParam, lParam);
         }
 
-        int vkCode = static_cast<int>(hookStruct->vkCode);
-
-        // Clear buffer on Ctrl key press
-        if (vkCode == VK_CONTROL_KEY) {
-            RustBridge::Instance().Clear();
-            return CallNextHookEx(m_hookId, nCode, wParam, lParam);
+        // Time to first key, for the startup report
+        if (!m_sawFirstKey) {
+            m_sawFirstKey = true;
+            StartupTimeline::Instance().Mark(StartupTimeline::FIRST_KEY);
         }
 
-        // Only process relevant keys
-        if (KeyCodes::IsRelevantKey(vkCode)) {
+        int vkCode = static_cast<int>(hookStruct->vkCode);
+        bool repeat = m_repeats.KeyDown(static_cast<uint8_t>(vkCode), hookStruct->time);
+
+        // Keys the IME never sees; those that end the word clear it
+        if (m_keys.Admit(vkCode, IsKeyDown(VK_CONTROL_KEY), IsKeyDown(VK_MENU_KEY))) {
             bool shift = IsKeyDown(VK_SHIFT_KEY);
             bool capsLock = IsCapsLockOn();
-            bool ctrl = IsKeyDown(VK_CONTROL_KEY);
-            bool alt = IsKeyDown(VK_MENU_KEY);
 
-            // Skip Ctrl/Alt combinations (shortcuts)
-            if (ctrl || alt) {
-                if (ctrl) RustBridge::Instance().Clear();
+            // Keys have been over budget lately: pass them through rather
+            // than have Windows remove the hook
+            if (!m_watchdog.Admit(start)) {
+                m_keys.Reset();
                 return CallNextHookEx(m_hookId, nCode, wParam, lParam);
             }
 
-            // Clear buffer on word boundary keys (except Space which needs shortcut check)
-            bool isBufferClearKey = KeyCodes::IsBufferClearKey(vkCode);
-            if (isBufferClearKey && vkCode != VK_SPACE_KEY) {
-                RustBridge::Instance().Clear();
+            // A held key repeats natively without the engine; the engine is
+            // resynced once when the run ends
+            if (repeat && m_callback) {
+                m_repeats.Bypassed(static_cast<uint8_t>(vkCode));
                 return CallNextHookEx(m_hookId, nCode, wParam, lParam);
             }
+            if (m_repeats.TakeResync()) {
+                m_keys.Resync();
+            }
 
             // Process through callback if set
             if (m_callback) {
@@ -134,11 +326,15 @@ LRESULT KeyboardHook::ProcessKey(int nCode, WPARAM wParam, LPARAM lParam) {
                 m_callback(event);
                 m_isProcessing = false;
 
-                // Clear buffer after processing word boundary keys
-                if (isBufferClearKey) {
-                    RustBridge::Instance().Clear();
+                uint64_t passThroughs = m_watchdog.GetStats().passThroughs;
+                m_watchdog.KeyDone(start, HookWatchdog::Clock::now());
+                if (m_watchdog.GetStats().passThroughs != passThroughs) {
+                    OutputDebugStringW(L"ViKey: keys over the time budget, passing keys through for a while\n");
                 }
 
+                // Space ends the word once the engine has seen it
+                m_keys.KeyDone(vkCode);
+
                 // Block original key if handled
                 if (event.handled) {
                     return 1;
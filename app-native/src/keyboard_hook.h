@@ -1,12 +1,18 @@
 // ViKey - Low-level Keyboard Hook
 // keyboard_hook.h
-// Uses SetWindowsHookEx with WH_KEYBOARD_LL
+// Uses SetWindowsHookEx with WH_KEYBOARD_LL, on a thread of its own
 
 #pragma once
 
 #include <windows.h>
+#include <atomic>
 #include <functional>
 #include <cstdint>
+#include <thread>
+#include "command_queue.h"
+#include "hook_watchdog.h"
+#include "key_handler.h"
+#include "key_repeat.h"
 
 // Unique marker for injected keys (prevents recursion) - "VNIM" in hex
 constexpr ULONG_PTR INJECTED_KEY_MARKER = 0x564E494D;
@@ -33,24 +39,48 @@ class KeyboardHook {
 public:
     static KeyboardHook& Instance();
 
-    // Start the keyboard hook
+    // Start the keyboard thread and install the hook on it. A low-level hook
+    // is serviced by its thread's message loop, so keys no longer wait for
+    // dialogs, tray icon drawing or anything else on the UI thread. When the
+    // thread is already running, installs the hook again (the watchdog does
+    // this after Windows has removed it).
     bool Start();
 
-    // Stop the keyboard hook
+    // Remove the hook and join the keyboard thread
     void Stop();
 
     // Check if hook is active
     bool IsActive() const { return m_hookId != nullptr; }
 
-    // Set callback for key events
+    // Set callback for key events; before Start()
     void SetCallback(KeyPressedCallback callback) { m_callback = callback; }
 
+    // Run `command` on the keyboard thread, before the next key. Everything
+    // the key callback touches (the engine, TextSender, per-app state) is
+    // changed this way. Runs it at once when the thread is not running.
+    void Post(CommandQueue::Command command);
+
+    // True on the keyboard thread (or anywhere while it is not running)
+    bool IsKeyboardThread() const;
+
 private:
     KeyboardHook();
     ~KeyboardHook();
     KeyboardHook(const KeyboardHook&) = delete;
     KeyboardHook& operator=(const KeyboardHook&) = delete;
 
+    // The keyboard thread: install the hook, then pump messages until Stop()
+    void Run(HANDLE started);
+
+    // (Re)install the hook; keyboard thread only
+    bool InstallHook();
+
+    // Watchdog inputs on the keyboard thread: raw input keys and a timer
+    friend LRESULT CALLBACK KeyboardThreadWndProc(HWND hWnd, UINT message, WPARAM wParam, LPARAM lParam);
+    bool CreateWatchdogWindow();
+    void OnRawInput(HRAWINPUT input);
+    void CheckHealth();
+
     // Process key event
     LRESULT ProcessKey(int nCode, WPARAM wParam, LPARAM lParam);
 
@@ -60,5 +90,16 @@ private:
 
     HHOOK m_hookId;
     bool m_isProcessing;
+    bool m_sawFirstKey;
     KeyPressedCallback m_callback;
+
+    std::thread m_thread;
+    std::atomic<DWORD> m_threadId;  // 0 while the keyboard thread is not running
+    CommandQueue m_commands;
+
+    // Keyboard thread only
+    HookWatchdog m_watchdog;
+    HWND m_watchdogWindow;  // message-only: raw keyboard input and the check timer
+    KeyRepeatTracker m_repeats;
+    KeyHandler m_keys;
 };
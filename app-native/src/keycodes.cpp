@@ -2,6 +2,7 @@
 // keycodes.cpp
 
 #include "keycodes.h"
+#include <cctype>
 
 // macOS keycodes (from core/src/data/keys.rs)
 namespace MacKeyCodes {
@@ -4,7 +4,6 @@
 
 #pragma once
 
-#include <windows.h>
 #include <cstdint>
 
 // Windows VK codes - Control keys
@@ -27,6 +27,10 @@
 #include "app_detector.h"
 #include "text_sender.h"
 #include "updater.h"
+#include "clipboard_win32.h"
+#include "startup_timeline.h"
+#include "binary_io.h"
+#include <memory>
 
 // Application name and class
 constexpr const wchar_t* APP_NAME = L"ViKey";
@@ -36,15 +40,42 @@ constexpr const wchar_t* MUTEX_NAME = L"Global\\ViKey_SingleInstance";
 // Custom messages
 constexpr UINT WM_TRAYICON_MSG = WM_USER + 1;
 
+// The startup update check waits until the desktop has settled
+constexpr UINT_PTR UPDATE_CHECK_TIMER = 1;
+constexpr UINT UPDATE_CHECK_DELAY_MS = 15000;
+
+// Startup work the first keystroke does not need, one step per
+// WM_DEFERRED_INIT, in this order
+enum DeferredInitStep : WPARAM {
+    DEFERRED_HOTKEYS,  // toggle and clipboard conversion hotkeys
+    DEFERRED_UI,       // dark mode, common controls and GDI+ for the tray and dialogs
+    DEFERRED_TRAY,
+    DEFERRED_WELCOME,  // balloon or settings dialog, update check timer
+    DEFERRED_DONE      // startup report
+};
+
 // Global variables
 HINSTANCE g_hInstance = nullptr;
 HWND g_hWnd = nullptr;
 ULONG_PTR g_gdiplusToken = 0;
 
+// --startup-trace: write the startup timeline as a Chrome trace to the data folder
+static bool g_writeStartupTrace = false;
+
+// Clipboard conversion hotkey: the worker never touches the UI, it posts
+// WM_CLIPBOARD_PROGRESS / WM_CLIPBOARD_DONE to the hidden window
+static Win32Clipboard g_clipboard;
+static std::unique_ptr<ClipboardConverter> g_clipboardConverter;
+
 // Forward declarations
 LRESULT CALLBACK WndProc(HWND hWnd, UINT message, WPARAM wParam, LPARAM lParam);
 bool InitInstance(HINSTANCE hInstance);
 void CleanupInstance();
+static void RunDeferredInit(WPARAM step);
+static void InitUserInterface();
+static void ReportStartup();
+static void ToggleClipboardConversion();
+static void OnClipboardConversionDone(const ClipboardConversionResult& result);
 
 // Entry point
 int APIENTRY wWinMain(_In_ HINSTANCE hInstance,
@@ -52,10 +83,22 @@ int APIENTRY wWinMain(_In_ HINSTANCE hInstance,
                       _In_ LPWSTR lpCmdLine,
                       _In_ int nCmdShow) {
     UNREFERENCED_PARAMETER(hPrevInstance);
-    UNREFERENCED_PARAMETER(lpCmdLine);
     UNREFERENCED_PARAMETER(nCmdShow);
 
+    // Startup timeline: measured from process creation, so the loader's
+    // share of the time to first key shows up too
+    StartupTimeline& timeline = StartupTimeline::Instance();
+    FILETIME created, exited, kernel, user, now;
+    if (GetProcessTimes(GetCurrentProcess(), &created, &exited, &kernel, &user)) {
+        GetSystemTimePreciseAsFileTime(&now);
+        auto ticks = [](const FILETIME& ft) { return (static_cast<int64_t>(ft.dwHighDateTime) << 32) | ft.dwLowDateTime; };
+        auto age = std::chrono::microseconds((ticks(now) - ticks(created)) / 10);
+        timeline.SetProcessStart(StartupTimeline::Clock::now() - age, "process start");
+    }
+    g_writeStartupTrace = lpCmdLine && wcsstr(lpCmdLine, L"--startup-trace") != nullptr;
+
     // Enable Per-Monitor DPI awareness (Windows 10 1703+)
+    timeline.Begin("dpi awareness");
     HMODULE hUser32 = GetModuleHandleW(L"user32.dll");
     if (hUser32) {
         typedef BOOL (WINAPI *SetProcessDpiAwarenessContextFunc)(DPI_AWARENESS_CONTEXT);
@@ -75,9 +118,7 @@ int APIENTRY wWinMain(_In_ HINSTANCE hInstance,
             }
         }
     }
-
-    // Initialize dark mode support (Windows 10 1809+)
-    InitDarkModeAPIs();
+    timeline.End();
 
     // Check for single instance
     HANDLE hMutex = CreateMutexW(nullptr, TRUE, MUTEX_NAME);
@@ -86,17 +127,7 @@ int APIENTRY wWinMain(_In_ HINSTANCE hInstance,
         return 0;
     }
 
-    // Initialize GDI+
-    Gdiplus::GdiplusStartupInput gdiplusStartupInput;
-    Gdiplus::GdiplusStartup(&g_gdiplusToken, &gdiplusStartupInput, nullptr);
-
-    // Initialize common controls
-    INITCOMMONCONTROLSEX icc = {};
-    icc.dwSize = sizeof(icc);
-    icc.dwICC = ICC_WIN95_CLASSES | ICC_LISTVIEW_CLASSES;
-    InitCommonControlsEx(&icc);
-
-    // Initialize application
+    // Initialize application: the keyboard hook first, the rest from the message loop
     if (!InitInstance(hInstance)) {
         CleanupInstance();
         if (hMutex) CloseHandle(hMutex);
@@ -118,8 +149,10 @@ int APIENTRY wWinMain(_In_ HINSTANCE hInstance,
 
 bool InitInstance(HINSTANCE hInstance) {
     g_hInstance = hInstance;
+    StartupTimeline& timeline = StartupTimeline::Instance();
 
     // Register window class
+    timeline.Begin("window");
     WNDCLASSEXW wcex = {};
     wcex.cbSize = sizeof(WNDCLASSEXW);
     wcex.lpfnWndProc = WndProc;
@@ -145,83 +178,231 @@ bool InitInstance(HINSTANCE hInstance) {
     if (!g_hWnd) {
         return false;
     }
+    timeline.End();
 
     // Load settings
+    timeline.Begin("settings");
     Settings::Instance().Load();
+    timeline.End();
+    timeline.Begin("app states");
     AppDetector::Instance().Load();
+    timeline.End();
 
     // Initialize IME processor
+    timeline.Begin("core.dll");
     if (!ImeProcessor::Instance().Initialize()) {
         MessageBoxW(nullptr, L"Failed to load core.dll", APP_NAME, MB_ICONERROR);
         return false;
     }
     ImeProcessor::Instance().ApplySettings();
+    timeline.End();
 
-    // Initialize tray icon
-    TrayIcon& tray = TrayIcon::Instance();
-    tray.Initialize(g_hWnd, hInstance);
+    // The English dictionary would otherwise be built by the first word typed
+    RustBridge::Instance().StartWarmup([]() { StartupTimeline::Instance().Mark("core warm"); });
 
-    tray.onToggleEnabled = []() {
-        ImeProcessor::Instance().ToggleEnabled();
-        Settings::Instance().enabled = ImeProcessor::Instance().IsEnabled();
-        Settings::Instance().Save();
-        UpdateUI();
-    };
+    // Start IME processor: the hook runs on its own thread from here, and
+    // settings changes reach it through KeyboardHook::Post
+    timeline.Begin("keyboard hook");
+    ImeProcessor::Instance().Start();
+    timeline.End();
 
-    tray.onSetMethod = [](InputMethod method) {
-        ImeProcessor::Instance().SetMethod(method);
-        Settings::Instance().method = method;
-        Settings::Instance().Save();
-        UpdateUI();
-    };
+    // Do the rest one step per message, so the UI thread stays responsive
+    // (and the tray icon appears) while startup finishes
+    PostMessage(g_hWnd, WM_DEFERRED_INIT, DEFERRED_HOTKEYS, 0);
+    return true;
+}
+
+static void RunDeferredInit(WPARAM step) {
+    switch (step) {
+    case DEFERRED_HOTKEYS: {
+        StartupPhase phase("hotkeys");
+
+        // Register global hotkey
+        HotkeyManager& hotkey = HotkeyManager::Instance();
+        hotkey.Register(g_hWnd);
+        hotkey.SetCallback([]() {
+            Settings::Instance().enabled = ImeProcessor::Instance().ToggleEnabled();
+            Settings::Instance().Save();
+            UpdateUI();
+        });
+
+        // Clipboard conversion runs on its own worker thread
+        g_clipboardConverter = std::make_unique<ClipboardConverter>(g_clipboard);
+        g_clipboardConverter->onProgress = [](uint32_t permille) {
+            static uint32_t lastPercent = 0;
+            uint32_t percent = permille / 10;
+            if (percent != lastPercent) {
+                lastPercent = percent;
+                PostMessage(g_hWnd, WM_CLIPBOARD_PROGRESS, percent, 0);
+            }
+        };
+        g_clipboardConverter->onFinished = [](const ClipboardConversionResult& result) {
+            auto* pResult = new ClipboardConversionResult(result);
+            if (!PostMessage(g_hWnd, WM_CLIPBOARD_DONE, 0, (LPARAM)pResult)) {
+                delete pResult;
+            }
+        };
+        hotkey.SetConvertCallback([]() { ToggleClipboardConversion(); });
+        break;
+    }
+
+    case DEFERRED_UI: {
+        StartupPhase phase("ui");
+        InitUserInterface();
+        break;
+    }
+
+    case DEFERRED_TRAY: {
+        StartupPhase phase("tray icon");
 
-    tray.onSettings = []() { ShowSettingsDialog(); };
-    tray.onAbout = []() { ShowAboutDialog(); };
-    tray.onExit = []() { PostMessage(g_hWnd, WM_CLOSE, 0, 0); };
-
-    // Register global hotkey
-    HotkeyManager& hotkey = HotkeyManager::Instance();
-    hotkey.Register(g_hWnd);
-    hotkey.SetCallback([]() {
-        ImeProcessor::Instance().ToggleEnabled();
-        Settings::Instance().enabled = ImeProcessor::Instance().IsEnabled();
-        Settings::Instance().Save();
+        // Initialize tray icon
+        TrayIcon& tray = TrayIcon::Instance();
+        tray.Initialize(g_hWnd, g_hInstance);
+
+        tray.onToggleEnabled = []() {
+            Settings::Instance().enabled = ImeProcessor::Instance().ToggleEnabled();
+            Settings::Instance().Save();
+            UpdateUI();
+        };
+
+        tray.onSetMethod = [](InputMethod method) {
+            ImeProcessor::Instance().SetMethod(method);
+            Settings::Instance().method = method;
+            Settings::Instance().Save();
+            UpdateUI();
+        };
+
+        tray.onSettings = []() { ShowSettingsDialog(); };
+        tray.onAbout = []() { ShowAboutDialog(); };
+        tray.onExit = []() { PostMessage(g_hWnd, WM_CLOSE, 0, 0); };
         UpdateUI();
-    });
+        break;
+    }
 
-    // Start IME processor
-    ImeProcessor::Instance().Start();
-    UpdateUI();
-
-    // Show Settings dialog or Toast on startup
-    if (Settings::Instance().silentStartup) {
-        const wchar_t* lang = Settings::Instance().enabled ? L"Ti\u1EBFng Vi\u1EC7t" : L"Ti\u1EBFng Anh";
-        wchar_t msg[128];
-        swprintf_s(msg, L"\u0110ang ch\u1EA1y \u1EDF ch\u1EBF \u0111\u1ED9 %s\nCtrl+Space \u0111\u1EC3 chuy\u1EC3n", lang);
-        tray.ShowBalloon(L"B\u1ED9 g\u00F5 ti\u1EBFng Vi\u1EC7t", msg);
-    } else {
-        PostMessage(g_hWnd, WM_COMMAND, IDM_SETTINGS, 0);
+    case DEFERRED_WELCOME: {
+        StartupPhase phase("welcome");
+
+        // Show Settings dialog or Toast on startup
+        if (Settings::Instance().silentStartup) {
+            const wchar_t* lang = Settings::Instance().enabled ? L"Ti\u1EBFng Vi\u1EC7t" : L"Ti\u1EBFng Anh";
+            wchar_t msg[128];
+            swprintf_s(msg, L"\u0110ang ch\u1EA1y \u1EDF ch\u1EBF \u0111\u1ED9 %s\nCtrl+Space \u0111\u1EC3 chuy\u1EC3n", lang);
+            TrayIcon::Instance().ShowBalloon(L"B\u1ED9 g\u00F5 ti\u1EBFng Vi\u1EC7t", msg);
+        } else {
+            PostMessage(g_hWnd, WM_COMMAND, IDM_SETTINGS, 0);
+        }
+
+        // Check for updates once startup is over (async)
+        if (Settings::Instance().checkForUpdates) {
+            SetTimer(g_hWnd, UPDATE_CHECK_TIMER, UPDATE_CHECK_DELAY_MS, nullptr);
+        }
+        break;
     }
 
-    // Check for updates on startup (async)
-    if (Settings::Instance().checkForUpdates) {
-        CheckForUpdatesOnStartup();
+    default:
+        ReportStartup();
+        return;
     }
+    PostMessage(g_hWnd, WM_DEFERRED_INIT, step + 1, 0);
+}
 
-    return true;
+// Needed by the tray icon and the dialogs only
+static void InitUserInterface() {
+    StartupTimeline& timeline = StartupTimeline::Instance();
+
+    // Initialize dark mode support (Windows 10 1809+)
+    timeline.Begin("dark mode");
+    InitDarkModeAPIs();
+    timeline.End();
+
+    // Initialize common controls
+    timeline.Begin("common controls");
+    INITCOMMONCONTROLSEX icc = {};
+    icc.dwSize = sizeof(icc);
+    icc.dwICC = ICC_WIN95_CLASSES | ICC_LISTVIEW_CLASSES;
+    InitCommonControlsEx(&icc);
+    timeline.End();
+
+    // Initialize GDI+ (tray icon rendering)
+    timeline.Begin("gdi+");
+    Gdiplus::GdiplusStartupInput gdiplusStartupInput;
+    Gdiplus::GdiplusStartup(&g_gdiplusToken, &gdiplusStartupInput, nullptr);
+    timeline.End();
+}
+
+// To the debugger output; with --startup-trace also as a Chrome trace
+static void ReportStartup() {
+    const StartupTimeline& timeline = StartupTimeline::Instance();
+    std::wstring summary = L"ViKey " + timeline.Summary();
+    OutputDebugStringW(summary.c_str());
+
+    if (g_writeStartupTrace) {
+        std::wstring path = Settings::DataFilePath(L"startup-trace.json");
+        if (!path.empty()) ReplaceFileContents(path, timeline.ChromeTraceJson());
+    }
 }
 
 void CleanupInstance() {
+    if (g_writeStartupTrace) ReportStartup();  // now with the first key
+    KillTimer(g_hWnd, UPDATE_CHECK_TIMER);
+    g_clipboardConverter.reset();  // cancels a running conversion and joins the worker
     ImeProcessor::Instance().Stop();
     if (g_hWnd) {
         HotkeyManager::Instance().Unregister(g_hWnd);
     }
     TrayIcon::Instance().Shutdown();
+    Settings::Instance().Flush();  // settings saved in the last moments are still queued
+    AppDetector::Instance().Flush();  // and per-app states recorded by the hook
     if (g_gdiplusToken) {
         Gdiplus::GdiplusShutdown(g_gdiplusToken);
     }
 }
 
+// Conversion hotkey: start converting the clipboard, or cancel a running conversion
+static void ToggleClipboardConversion() {
+    if (!g_clipboardConverter) return;
+    if (g_clipboardConverter->IsRunning()) {
+        g_clipboardConverter->Cancel();
+        return;
+    }
+
+    const Settings& settings = Settings::Instance();
+    auto encoding = [](int value, VietEncoding fallback) {
+        return (value >= 0 && value < VIET_ENCODING_COUNT) ? static_cast<VietEncoding>(value) : fallback;
+    };
+    VietEncoding from = encoding(settings.convertFrom, VietEncoding::VNI_Windows);
+    VietEncoding to = encoding(settings.convertTo, VietEncoding::Unicode);
+    if (g_clipboardConverter->Start(from, to, settings.convertDetect)) {
+        TrayIcon::Instance().SetTooltipText(L"\u0110ang chuy\u1EC3n m\u00E3 clipboard...");
+    }
+}
+
+static void OnClipboardConversionDone(const ClipboardConversionResult& result) {
+    UpdateUI();  // restores the tooltip
+
+    wchar_t msg[256];
+    switch (result.status) {
+    case JobStatus::Done:
+        swprintf_s(msg, L"%s \u2192 %s (%zu k\u00FD t\u1EF1)",
+                   EncodingConverter::GetEncodingName(result.from),
+                   EncodingConverter::GetEncodingName(result.to), result.chars);
+        break;
+    case JobStatus::Cancelled:
+        wcscpy_s(msg, L"\u0110\u00E3 hu\u1EF7");
+        break;
+    case JobStatus::Empty:
+        wcscpy_s(msg, L"Clipboard kh\u00F4ng c\u00F3 v\u0103n b\u1EA3n c\u1EA7n chuy\u1EC3n");
+        break;
+    case JobStatus::Superseded:
+        wcscpy_s(msg, L"Clipboard \u0111\u00E3 thay \u0111\u1ED5i trong l\u00FAc chuy\u1EC3n, gi\u1EEF nguy\u00EAn n\u1ED9i dung m\u1EDBi");
+        break;
+    default:
+        wcscpy_s(msg, L"Kh\u00F4ng \u0111\u1ECDc/ghi \u0111\u01B0\u1EE3c clipboard");
+        break;
+    }
+    TrayIcon::Instance().ShowBalloon(L"Chuy\u1EC3n m\u00E3 clipboard", msg);
+}
+
 void UpdateUI() {
     bool enabled = ImeProcessor::Instance().IsEnabled();
     InputMethod method = ImeProcessor::Instance().GetMethod();
@@ -257,18 +438,16 @@ LRESULT CALLBACK WndProc(HWND hWnd, UINT message, WPARAM wParam, LPARAM lParam)
 
         case IDM_ENC_UNICODE:
         case IDM_ENC_VNI:
-        case IDM_ENC_TCVN3: {
+        case IDM_ENC_TCVN3:
+        case IDM_ENC_VISCII:
+        case IDM_ENC_VIQR: {
             OutputEncoding enc = OutputEncoding::Unicode;
             if (LOWORD(wParam) == IDM_ENC_VNI) enc = OutputEncoding::VNI;
             else if (LOWORD(wParam) == IDM_ENC_TCVN3) enc = OutputEncoding::TCVN3;
+            else if (LOWORD(wParam) == IDM_ENC_VISCII) enc = OutputEncoding::VISCII;
+            else if (LOWORD(wParam) == IDM_ENC_VIQR) enc = OutputEncoding::VIQR;
 
-            TextSender::Instance().SetOutputEncoding(enc);
-
-            std::wstring currentApp = AppDetector::Instance().GetForegroundAppName();
-            if (!currentApp.empty()) {
-                AppDetector::Instance().SetAppEncoding(currentApp, static_cast<int>(enc));
-            }
-
+            ImeProcessor::Instance().SetAppEncoding(enc);
             UpdateUI();
             break;
         }
@@ -329,6 +508,33 @@ LRESULT CALLBACK WndProc(HWND hWnd, UINT message, WPARAM wParam, LPARAM lParam)
         HotkeyManager::Instance().ProcessHotkey(wParam);
         return 0;
 
+    case WM_DEFERRED_INIT:
+        RunDeferredInit(wParam);
+        return 0;
+
+    case WM_TIMER:
+        if (wParam == UPDATE_CHECK_TIMER) {
+            KillTimer(hWnd, UPDATE_CHECK_TIMER);
+            CheckForUpdatesOnStartup();
+        }
+        return 0;
+
+    case WM_CLIPBOARD_PROGRESS: {
+        wchar_t tip[64];
+        swprintf_s(tip, L"\u0110ang chuy\u1EC3n m\u00E3 clipboard... %u%%", static_cast<unsigned>(wParam));
+        TrayIcon::Instance().SetTooltipText(tip);
+        return 0;
+    }
+
+    case WM_CLIPBOARD_DONE: {
+        ClipboardConversionResult* pResult = reinterpret_cast<ClipboardConversionResult*>(lParam);
+        if (pResult) {
+            OnClipboardConversionDone(*pResult);
+            delete pResult;
+        }
+        return 0;
+    }
+
     case WM_DESTROY:
         PostQuitMessage(0);
         return 0;
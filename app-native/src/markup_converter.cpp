@@ -0,0 +1,688 @@
+// ViKey - Markup-Aware Converter Implementation
+// markup_converter.cpp
+// Streaming HTML/RTF tokenizer: markup is copied, text runs go through the codec
+
+#include "markup_converter.h"
+#include <algorithm>
+#include <cstdlib>
+
+namespace {
+
+constexpr size_t MAX_ENTITY = 32;     // longest "&...;" considered an entity
+constexpr size_t MAX_TAG_NAME = 16;   // enough for "script", "style" and "!--"
+constexpr size_t MAX_CONTROL = 32;    // RTF limits control words to 32 characters
+
+bool IsUtf8Encoding(VietEncoding enc) {
+    return enc == VietEncoding::Unicode || enc == VietEncoding::Unicode_Comp;
+}
+
+bool IsAsciiAlpha(uint32_t c) {
+    return (c | 0x20) >= 'a' && (c | 0x20) <= 'z';
+}
+
+bool IsAsciiDigit(uint32_t c) {
+    return c >= '0' && c <= '9';
+}
+
+int HexValue(uint32_t c) {
+    if (IsAsciiDigit(c)) return static_cast<int>(c - '0');
+    if ((c | 0x20) >= 'a' && (c | 0x20) <= 'f') return static_cast<int>((c | 0x20) - 'a' + 10);
+    return -1;
+}
+
+void AppendUtf8(std::string& out, uint32_t cp) {
+    if (cp < 0x80) {
+        out += static_cast<char>(cp);
+    } else if (cp < 0x800) {
+        out += static_cast<char>(0xC0 | (cp >> 6));
+        out += static_cast<char>(0x80 | (cp & 0x3F));
+    } else if (cp < 0x10000) {
+        out += static_cast<char>(0xE0 | (cp >> 12));
+        out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (cp & 0x3F));
+    } else {
+        out += static_cast<char>(0xF0 | (cp >> 18));
+        out += static_cast<char>(0x80 | ((cp >> 12) & 0x3F));
+        out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (cp & 0x3F));
+    }
+}
+
+void AppendDecimal(std::string& out, long value) {
+    char buf[24];
+    int n = 0;
+    bool negative = value < 0;
+    unsigned long v = negative ? 0UL - static_cast<unsigned long>(value) : static_cast<unsigned long>(value);
+    do {
+        buf[n++] = static_cast<char>('0' + v % 10);
+        v /= 10;
+    } while (v > 0);
+    if (negative) out += '-';
+    while (n > 0) out += buf[--n];
+}
+
+// RTF destinations whose content is not document text (tables, pictures,
+// embedded objects); they are copied whole. "{\*\..." groups are too.
+bool IsSkippedDestination(const std::string& word) {
+    static const char* const SKIPPED[] = {
+        "fonttbl", "colortbl", "stylesheet", "listtable", "listoverridetable", "rsidtbl",
+        "pict", "object", "objdata", "themedata", "colorschememapping", "datastore",
+        "latentstyles", "xmlnstbl", "filetbl", "revtbl", "generator",
+    };
+    for (const char* name : SKIPPED) {
+        if (word == name) return true;
+    }
+    return false;
+}
+
+}  // namespace
+
+MarkupConverter::MarkupConverter(MarkupFormat format, VietEncoding from, VietEncoding to)
+    : m_format(format),
+      m_from(from),
+      m_to(to),
+      m_utf8In(format != MarkupFormat::Rtf && IsUtf8Encoding(from)),
+      m_utf8Out(format != MarkupFormat::Rtf && IsUtf8Encoding(to)),
+      m_stream(EncodingConverter::CreateStream(from, to)) {
+    if (!m_stream) m_stream = EncodingConverter::CreateStream(VietEncoding::Unicode, VietEncoding::Unicode);
+}
+
+MarkupConverter::~MarkupConverter() = default;
+
+MarkupFormat MarkupConverter::FormatForPath(const std::string& path) {
+    size_t dot = path.find_last_of('.');
+    size_t slash = path.find_last_of("/\\");
+    if (dot == std::string::npos || (slash != std::string::npos && dot < slash)) return MarkupFormat::Text;
+
+    std::string ext = path.substr(dot + 1);
+    std::transform(ext.begin(), ext.end(), ext.begin(),
+                   [](unsigned char c) { return static_cast<char>(IsAsciiAlpha(c) ? (c | 0x20) : c); });
+    if (ext == "htm" || ext == "html" || ext == "xhtml") return MarkupFormat::Html;
+    if (ext == "rtf") return MarkupFormat::Rtf;
+    return MarkupFormat::Text;
+}
+
+void MarkupConverter::Feed(const char* data, size_t size, std::string& out) {
+    const unsigned char* p = reinterpret_cast<const unsigned char*>(data);
+    if (m_format == MarkupFormat::Rtf) {
+        FeedRtf(data, size, out);
+    } else {
+        m_wide.clear();
+        DecodeInput(p, size);
+        if (m_format == MarkupFormat::Html) {
+            FeedHtml(m_wide.data(), m_wide.size(), out);
+        } else {
+            PutText(m_wide.data(), m_wide.size());
+        }
+    }
+    WriteRun(out);
+}
+
+void MarkupConverter::Finish(std::string& out) {
+    if (m_format != MarkupFormat::Rtf) {
+        // A partial BOM or UTF-8 sequence at the very end is malformed input
+        m_wide.clear();
+        if (m_bomState > 0) {
+            static const unsigned char BOM[] = {0xEF, 0xBB, 0xBF};
+            int matched = m_bomState;
+            m_bomState = -1;
+            for (int i = 0; i < matched; i++) DecodeUtf8Byte(BOM[i]);
+        }
+        m_wide.append(static_cast<size_t>(m_utf8Count), static_cast<wchar_t>(0xFFFD));
+        m_utf8Need = 0;
+        m_utf8Count = 0;
+        if (m_format == MarkupFormat::Html) {
+            FeedHtml(m_wide.data(), m_wide.size(), out);
+            if (m_state == State::Entity) FinishEntity(out);
+        } else {
+            PutText(m_wide.data(), m_wide.size());
+        }
+    } else {
+        switch (m_state) {
+            case State::Backslash:
+                EndRun(out);
+                out += '\\';
+                break;
+            case State::ControlWord:
+            case State::ControlParam:
+                FinishControlWord(out);
+                break;
+            case State::HexEscape:
+                EndRun(out);
+                out += "\\'";
+                for (int i = 0; i < m_hexDigits; i++) out += "0123456789abcdef"[(m_hexValue >> (4 * (m_hexDigits - 1 - i))) & 0xF];
+                break;
+            default:
+                break;
+        }
+    }
+    m_state = State::Text;
+    EndRun(out);
+}
+
+// ---- Byte input (HTML and plain text) ----
+
+void MarkupConverter::DecodeInput(const unsigned char* p, size_t size) {
+    m_wide.reserve(m_wide.size() + size);
+    if (!m_utf8In) {
+        for (size_t i = 0; i < size; i++) m_wide += static_cast<wchar_t>(p[i]);
+        return;
+    }
+
+    size_t i = 0;
+    // Skip a UTF-8 BOM, which may itself arrive split across calls
+    while (m_bomState >= 0 && i < size) {
+        static const unsigned char BOM[] = {0xEF, 0xBB, 0xBF};
+        if (p[i] == BOM[m_bomState]) {
+            i++;
+            if (++m_bomState == 3) m_bomState = -1;
+            continue;
+        }
+        int matched = m_bomState;
+        m_bomState = -1;
+        for (int k = 0; k < matched; k++) DecodeUtf8Byte(BOM[k]);
+    }
+    for (; i < size; i++) {
+        if (p[i] < 0x80 && m_utf8Need == 0) {
+            m_wide += static_cast<wchar_t>(p[i]);
+        } else {
+            DecodeUtf8Byte(p[i]);
+        }
+    }
+}
+
+// Same rules as EncodingConverter::DecodeBytes: each byte of a malformed
+// sequence becomes U+FFFD
+void MarkupConverter::DecodeUtf8Byte(unsigned char b) {
+    if (m_utf8Need > 0) {
+        if ((b & 0xC0) == 0x80) {
+            m_utf8Cp = (m_utf8Cp << 6) | (b & 0x3F);
+            m_utf8Count++;
+            if (--m_utf8Need > 0) return;
+            if (m_utf8Cp > 0x10FFFF || (m_utf8Cp >= 0xD800 && m_utf8Cp <= 0xDFFF)) {
+                m_wide.append(static_cast<size_t>(m_utf8Count), static_cast<wchar_t>(0xFFFD));
+            } else if (sizeof(wchar_t) == 2 && m_utf8Cp >= 0x10000) {
+                uint32_t v = m_utf8Cp - 0x10000;
+                m_wide += static_cast<wchar_t>(0xD800 + (v >> 10));
+                m_wide += static_cast<wchar_t>(0xDC00 + (v & 0x3FF));
+            } else {
+                m_wide += static_cast<wchar_t>(m_utf8Cp);
+            }
+            m_utf8Count = 0;
+            return;
+        }
+        m_wide.append(static_cast<size_t>(m_utf8Count), static_cast<wchar_t>(0xFFFD));
+        m_utf8Need = 0;
+        m_utf8Count = 0;
+    }
+
+    if (b < 0x80) {
+        m_wide += static_cast<wchar_t>(b);
+        return;
+    }
+    int extra = (b >= 0xF0 && b < 0xF5) ? 3 : (b >= 0xE0 && b < 0xF0) ? 2 : (b >= 0xC2 && b < 0xE0) ? 1 : -1;
+    if (extra < 0) {
+        m_wide += static_cast<wchar_t>(0xFFFD);
+        return;
+    }
+    m_utf8Cp = b & (0x3F >> extra);
+    m_utf8Need = extra;
+    m_utf8Count = 1;
+}
+
+// ---- Text runs ----
+
+void MarkupConverter::PutText(const wchar_t* text, size_t len) {
+    if (len > 0) m_stream->Put(text, len, m_run);
+}
+
+void MarkupConverter::PutUnicode(uint32_t cp) {
+    if (sizeof(wchar_t) == 2 && cp >= 0x10000) {
+        uint32_t v = cp - 0x10000;
+        m_stream->PutUnicode(static_cast<wchar_t>(0xD800 + (v >> 10)), m_run);
+        m_stream->PutUnicode(static_cast<wchar_t>(0xDC00 + (v & 0x3FF)), m_run);
+    } else {
+        m_stream->PutUnicode(static_cast<wchar_t>(cp), m_run);
+    }
+}
+
+// Markup follows: finish the run so no letter spans it
+void MarkupConverter::EndRun(std::string& out) {
+    m_stream->Flush(m_run);
+    WriteRun(out);
+    m_escapeOpen = false;  // the markup after it ends any escape
+}
+
+void MarkupConverter::WriteRun(std::string& out) {
+    for (size_t i = 0; i < m_run.size(); i++) {
+        uint32_t c = static_cast<uint32_t>(m_run[i]);
+        if (sizeof(wchar_t) == 2 && c >= 0xD800 && c <= 0xDBFF && i + 1 < m_run.size()) {
+            uint32_t lo = static_cast<uint32_t>(m_run[i + 1]);
+            if (lo >= 0xDC00 && lo <= 0xDFFF) {
+                c = 0x10000 + ((c - 0xD800) << 10) + (lo - 0xDC00);
+                i++;
+            }
+        }
+        if (m_format == MarkupFormat::Rtf) {
+            WriteRtfChar(c, out);
+        } else {
+            WriteChar(c, out);
+        }
+    }
+    m_run.clear();
+}
+
+// HTML and plain text: UTF-8, or one byte per character for legacy targets.
+// A character the target cannot hold becomes a numeric entity in HTML and
+// '?' in plain text, as EncodingConverter::EncodeBytes does.
+void MarkupConverter::WriteChar(uint32_t c, std::string& out) {
+    if (m_utf8Out) {
+        AppendUtf8(out, c);
+    } else if (c < 0x100) {
+        out += static_cast<char>(c);
+    } else if (m_format == MarkupFormat::Html) {
+        out += "&#";
+        AppendDecimal(out, static_cast<long>(c));
+        out += ';';
+    } else {
+        out += '?';
+    }
+}
+
+// RTF text: \'xx for a byte of a legacy target, \uN for Unicode (UTF-16
+// units, signed) followed by the group's \uc count of '?' fallbacks
+void MarkupConverter::WriteRtfChar(uint32_t c, std::string& out) {
+    // Without fallback characters a digit or space right after \uN would be
+    // read as part of it: end the escape with its delimiter first
+    if (m_escapeOpen && (IsAsciiDigit(c) || c == ' ')) out += ' ';
+    m_escapeOpen = false;
+
+    if (c == '\\' || c == '{' || c == '}') {
+        out += '\\';
+        out += static_cast<char>(c);
+    } else if (c < 0x80) {
+        out += static_cast<char>(c);
+    } else if (c < 0x100 && !IsUtf8Encoding(m_to)) {
+        out += "\\'";
+        out += "0123456789abcdef"[c >> 4];
+        out += "0123456789abcdef"[c & 0xF];
+    } else {
+        auto unit = [&](uint32_t u) {
+            out += "\\u";
+            AppendDecimal(out, static_cast<long>(static_cast<int16_t>(static_cast<uint16_t>(u))));
+            out.append(static_cast<size_t>(m_uc), '?');
+        };
+        if (c >= 0x10000) {
+            uint32_t v = c - 0x10000;
+            unit(0xD800 + (v >> 10));
+            unit(0xDC00 + (v & 0x3FF));
+        } else {
+            unit(c);
+        }
+        m_escapeOpen = m_uc == 0;
+    }
+}
+
+// ---- HTML ----
+
+void MarkupConverter::FeedHtml(const wchar_t* text, size_t len, std::string& out) {
+    size_t i = 0;
+    while (i < len) {
+        wchar_t c = text[i];
+        switch (m_state) {
+            case State::Text: {
+                size_t start = i;
+                while (i < len && text[i] != L'<' && text[i] != L'&') i++;
+                PutText(text + start, i - start);
+                if (i == len) break;
+                if (text[i] == L'<') {
+                    EndRun(out);
+                    WriteChar('<', out);
+                    m_pending.clear();
+                    m_state = State::TagName;
+                } else {
+                    m_pending.assign(1, L'&');
+                    m_state = State::Entity;
+                }
+                i++;
+                break;
+            }
+
+            case State::Entity:
+                if (c == L';') {
+                    m_pending += c;
+                    i++;
+                    FinishEntity(out);
+                } else if ((c < 0x80 && (IsAsciiAlpha(c) || IsAsciiDigit(c) || c == L'#')) &&
+                           m_pending.size() < MAX_ENTITY) {
+                    m_pending += c;
+                    i++;
+                } else {
+                    FinishEntity(out);  // c is read again as text
+                }
+                break;
+
+            case State::TagName:
+                // "a < b" is text, not a tag
+                if (m_pending.empty() && !(c < 0x80 && (IsAsciiAlpha(c) || c == L'/' || c == L'!' || c == L'?'))) {
+                    m_state = State::Text;
+                    break;
+                }
+                if (c < 0x80 && (IsAsciiAlpha(c) || IsAsciiDigit(c) || c == L'/' || c == L'!' || c == L'-' ||
+                                 c == L'?' || c == L':') && m_pending.size() < MAX_TAG_NAME) {
+                    m_pending += static_cast<wchar_t>(IsAsciiAlpha(c) ? (c | 0x20) : c);
+                    WriteChar(static_cast<uint32_t>(c), out);
+                    i++;
+                    if (m_pending == L"!--") {
+                        m_commentDashes = 0;
+                        m_state = State::Comment;
+                    }
+                    break;
+                }
+                FinishTagName();
+                m_state = State::Tag;
+                break;
+
+            case State::Tag:
+                WriteChar(static_cast<uint32_t>(c), out);
+                i++;
+                if (c == L'"' || c == L'\'') {
+                    m_quote = c;
+                    m_state = State::TagQuoted;
+                } else if (c == L'>') {
+                    m_rawMatched = 0;
+                    m_state = m_rawEnd.empty() ? State::Text : State::RawText;
+                }
+                break;
+
+            case State::TagQuoted:
+                WriteChar(static_cast<uint32_t>(c), out);
+                i++;
+                if (c == m_quote) m_state = State::Tag;
+                break;
+
+            case State::Comment:
+                WriteChar(static_cast<uint32_t>(c), out);
+                i++;
+                if (c == L'>' && m_commentDashes >= 2) {
+                    m_state = State::Text;
+                } else {
+                    m_commentDashes = (c == L'-') ? m_commentDashes + 1 : 0;
+                }
+                break;
+
+            case State::RawText: {
+                // Script and style bodies are copied until their end tag
+                WriteChar(static_cast<uint32_t>(c), out);
+                i++;
+                wchar_t lower = (c < 0x80 && IsAsciiAlpha(c)) ? static_cast<wchar_t>(c | 0x20) : c;
+                if (lower == m_rawEnd[m_rawMatched]) {
+                    if (++m_rawMatched == m_rawEnd.size()) {
+                        m_rawEnd.clear();
+                        m_state = State::Tag;
+                    }
+                } else {
+                    m_rawMatched = (c == L'<') ? 1 : 0;
+                }
+                break;
+            }
+
+            default:
+                m_state = State::Text;
+                break;
+        }
+    }
+}
+
+void MarkupConverter::FinishTagName() {
+    if (m_pending == L"script") {
+        m_rawEnd = L"</script";
+    } else if (m_pending == L"style") {
+        m_rawEnd = L"</style";
+    }
+    m_pending.clear();
+}
+
+// Numeric references to non-ASCII characters are text; anything else
+// (named entities, &#60; and friends, a stray '&') is kept as written
+void MarkupConverter::FinishEntity(std::string& out) {
+    uint32_t cp = 0;
+    bool numeric = m_pending.size() > 3 && m_pending[1] == L'#' && m_pending.back() == L';';
+    if (numeric) {
+        bool hex = m_pending[2] == L'x' || m_pending[2] == L'X';
+        size_t first = hex ? 3 : 2;
+        numeric = first < m_pending.size() - 1;
+        for (size_t k = first; numeric && k + 1 < m_pending.size(); k++) {
+            int digit = hex ? HexValue(m_pending[k]) : (IsAsciiDigit(m_pending[k]) ? m_pending[k] - L'0' : -1);
+            if (digit < 0 || cp > 0x10FFFF) {
+                numeric = false;
+            } else {
+                cp = cp * (hex ? 16 : 10) + static_cast<uint32_t>(digit);
+            }
+        }
+    }
+
+    if (numeric && cp >= 0x80 && cp <= 0x10FFFF && !(cp >= 0xD800 && cp <= 0xDFFF)) {
+        PutUnicode(cp);
+    } else {
+        EndRun(out);
+        for (wchar_t c : m_pending) WriteChar(static_cast<uint32_t>(c), out);
+    }
+    m_pending.clear();
+    m_state = State::Text;
+}
+
+// ---- RTF ----
+
+void MarkupConverter::FeedRtf(const char* data, size_t size, std::string& out) {
+    const unsigned char* p = reinterpret_cast<const unsigned char*>(data);
+    size_t i = 0;
+    while (i < size) {
+        if (m_binaryLeft > 0) {
+            // \binN: N raw bytes of picture or object data
+            size_t n = std::min(static_cast<size_t>(m_binaryLeft), size - i);
+            out.append(data + i, n);
+            m_binaryLeft -= static_cast<long>(n);
+            i += n;
+            continue;
+        }
+
+        unsigned char b = p[i];
+        switch (m_state) {
+            case State::Text: {
+                if (b == '\\') {
+                    m_state = State::Backslash;
+                    i++;
+                } else if (b == '{') {
+                    EndRun(out);
+                    out += '{';
+                    m_ucStack.push_back(m_uc);
+                    m_depth++;
+                    m_destinationStart = true;
+                    m_fallbackSkip = 0;
+                    i++;
+                } else if (b == '}') {
+                    EndRun(out);
+                    out += '}';
+                    if (!m_ucStack.empty()) {
+                        m_uc = m_ucStack.back();
+                        m_ucStack.pop_back();
+                    }
+                    if (m_skipDepth == m_depth) m_skipDepth = 0;
+                    if (m_depth > 0) m_depth--;
+                    m_destinationStart = false;
+                    m_fallbackSkip = 0;
+                    i++;
+                } else if (b == '\r' || b == '\n') {
+                    // Line breaks are not text in RTF and may fall inside a word;
+                    // the run goes on across them
+                    WriteRun(out);
+                    out += static_cast<char>(b);
+                    m_escapeOpen = false;
+                    i++;
+                } else if (m_fallbackSkip > 0) {
+                    RtfTextByte(b, out);
+                    i++;
+                } else if (m_skipDepth > 0) {
+                    size_t start = i;
+                    while (i < size && p[i] != '\\' && p[i] != '{' && p[i] != '}') i++;
+                    out.append(data + start, i - start);
+                    m_destinationStart = false;
+                } else {
+                    size_t start = i;
+                    while (i < size && p[i] != '\\' && p[i] != '{' && p[i] != '}' && p[i] != '\r' && p[i] != '\n') i++;
+                    m_wide.assign(p + start, p + i);
+                    PutText(m_wide.data(), m_wide.size());
+                    m_destinationStart = false;
+                }
+                break;
+            }
+
+            case State::Backslash:
+                i++;
+                if (IsAsciiAlpha(b)) {
+                    m_word.assign(1, static_cast<char>(b));
+                    m_param.clear();
+                    m_state = State::ControlWord;
+                } else if (b == '\'') {
+                    m_hexDigits = 0;
+                    m_hexValue = 0;
+                    m_state = State::HexEscape;
+                } else if (b == '\\' || b == '{' || b == '}') {
+                    m_state = State::Text;
+                    if (m_skipDepth > 0) {
+                        out += '\\';
+                        out += static_cast<char>(b);
+                    } else {
+                        RtfTextByte(b, out);
+                    }
+                } else {
+                    // Control symbol (\~ \- \* ...) or "\<newline>" (a paragraph)
+                    m_state = State::Text;
+                    EndRun(out);
+                    out += '\\';
+                    out += static_cast<char>(b);
+                    if (b == '*') {
+                        if (m_destinationStart && m_skipDepth == 0) m_skipDepth = m_depth;
+                    } else {
+                        m_destinationStart = false;
+                    }
+                    m_fallbackSkip = 0;
+                }
+                break;
+
+            case State::ControlWord:
+                if (IsAsciiAlpha(b) && m_word.size() < MAX_CONTROL) {
+                    m_word += static_cast<char>(b);
+                    i++;
+                } else if (IsAsciiDigit(b) || b == '-') {
+                    m_param.assign(1, static_cast<char>(b));
+                    m_state = State::ControlParam;
+                    i++;
+                } else {
+                    bool copied = FinishControlWord(out);
+                    if (b == ' ') {
+                        // The delimiter belongs to the control word: copied with
+                        // it, or dropped with a \uN that became text
+                        if (copied) out += ' ';
+                        i++;
+                    }
+                }
+                break;
+
+            case State::ControlParam:
+                if (IsAsciiDigit(b) && m_param.size() < 12) {
+                    m_param += static_cast<char>(b);
+                    i++;
+                } else {
+                    bool copied = FinishControlWord(out);
+                    if (b == ' ') {
+                        if (copied) out += ' ';
+                        i++;
+                    }
+                }
+                break;
+
+            case State::HexEscape: {
+                int digit = HexValue(b);
+                if (digit < 0) {
+                    // Malformed: keep what was written
+                    EndRun(out);
+                    out += "\\'";
+                    if (m_hexDigits == 1) out += "0123456789abcdef"[m_hexValue];
+                    m_state = State::Text;
+                    break;
+                }
+                i++;
+                m_hexValue = (m_hexValue << 4) | static_cast<unsigned>(digit);
+                if (++m_hexDigits == 2) {
+                    m_state = State::Text;
+                    if (m_skipDepth > 0) {
+                        out += "\\'";
+                        out += "0123456789abcdef"[m_hexValue >> 4];
+                        out += "0123456789abcdef"[m_hexValue & 0xF];
+                    } else {
+                        RtfTextByte(static_cast<unsigned char>(m_hexValue), out);
+                    }
+                }
+                break;
+            }
+
+            default:
+                m_state = State::Text;
+                break;
+        }
+    }
+}
+
+// One character of document text: a plain byte, \'xx or an escaped \ { }
+void MarkupConverter::RtfTextByte(unsigned char b, std::string& out) {
+    m_destinationStart = false;
+    if (m_skipDepth > 0) {
+        out += static_cast<char>(b);
+    } else if (m_fallbackSkip > 0) {
+        m_fallbackSkip--;  // stands in for the preceding \uN
+    } else {
+        wchar_t c = static_cast<wchar_t>(b);
+        PutText(&c, 1);
+    }
+}
+
+bool MarkupConverter::FinishControlWord(std::string& out) {
+    m_state = State::Text;
+    bool hasParam = !m_param.empty() && m_param != "-";
+    long param = hasParam ? std::strtol(m_param.c_str(), nullptr, 10) : 0;
+
+    if (m_skipDepth == 0 && m_word == "u" && hasParam) {
+        // \uN: a signed UTF-16 unit, then \uc fallback characters to drop
+        uint32_t unit = static_cast<uint32_t>(param < 0 ? param + 65536 : param) & 0xFFFF;
+        m_fallbackSkip = m_uc;
+        m_destinationStart = false;
+        if (unit >= 0xD800 && unit <= 0xDBFF) {
+            m_highSurrogate = unit;
+            return false;
+        }
+        uint32_t cp = unit;
+        if (unit >= 0xDC00 && unit <= 0xDFFF && m_highSurrogate != 0) {
+            cp = 0x10000 + ((m_highSurrogate - 0xD800) << 10) + (unit - 0xDC00);
+        }
+        m_highSurrogate = 0;
+        PutUnicode(cp);
+        return false;
+    }
+
+    EndRun(out);
+    out += '\\';
+    out += m_word;
+    out += m_param;
+
+    if (m_word == "uc" && hasParam) {
+        m_uc = static_cast<int>(std::max(0L, std::min(param, 16L)));
+    } else if (m_word == "bin" && hasParam && param > 0) {
+        m_binaryLeft = param;
+    }
+    if (m_destinationStart && m_skipDepth == 0 && IsSkippedDestination(m_word)) m_skipDepth = m_depth;
+    m_destinationStart = false;
+    m_fallbackSkip = 0;
+    return true;
+}
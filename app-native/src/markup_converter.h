@@ -0,0 +1,107 @@
+// ViKey - Markup-Aware Converter
+// markup_converter.h
+// Streams HTML and RTF documents through a codec, converting only their text
+
+#pragma once
+
+#include "encoding_converter.h"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Document formats MarkupConverter understands
+enum class MarkupFormat {
+    Text = 0,  // no markup: every character is text
+    Html = 1,  // tags, comments and script/style bodies pass through
+    Rtf = 2    // control words and groups pass through
+};
+
+// Converts a byte stream between VietEncodings in bounded memory. Markup is
+// copied as it is; text runs go through a TranscodeStream. Numeric HTML
+// entities (&#NNNN; &#xHHHH;) and RTF \uN escapes are decoded as Unicode;
+// RTF \'xx escapes are bytes of the source encoding. Characters the target
+// cannot hold are written back as entities (HTML) or \uN escapes (RTF).
+// Input may be split at any byte; the output does not depend on where.
+class MarkupConverter {
+public:
+    MarkupConverter(MarkupFormat format, VietEncoding from, VietEncoding to);
+    ~MarkupConverter();
+
+    // Convert the next piece of input; output is appended to out
+    void Feed(const char* data, size_t size, std::string& out);
+
+    // End of input: write out anything still pending
+    void Finish(std::string& out);
+
+    // Format from a file name extension (.htm, .html, .xhtml, .rtf)
+    static MarkupFormat FormatForPath(const std::string& path);
+
+private:
+    enum class State {
+        Text,
+        // HTML
+        TagName, Tag, TagQuoted, Comment, RawText, Entity,
+        // RTF
+        Backslash, ControlWord, ControlParam, HexEscape
+    };
+
+    void FeedHtml(const wchar_t* text, size_t len, std::string& out);
+    void FeedRtf(const char* data, size_t size, std::string& out);
+
+    void DecodeInput(const unsigned char* p, size_t size);
+    void DecodeUtf8Byte(unsigned char b);
+
+    void PutText(const wchar_t* text, size_t len);
+    void PutUnicode(uint32_t cp);
+    void EndRun(std::string& out);
+    void WriteRun(std::string& out);
+    void WriteChar(uint32_t c, std::string& out);
+    void WriteRtfChar(uint32_t c, std::string& out);
+
+    void FinishEntity(std::string& out);
+    void FinishTagName();
+    void RtfTextByte(unsigned char b, std::string& out);
+    // False if the control word became text (\uN) rather than markup in out
+    bool FinishControlWord(std::string& out);
+
+    MarkupFormat m_format;
+    VietEncoding m_from;
+    VietEncoding m_to;
+    bool m_utf8In;   // source bytes are UTF-8
+    bool m_utf8Out;  // target bytes are UTF-8
+    std::unique_ptr<TranscodeStream> m_stream;
+
+    State m_state = State::Text;
+    std::wstring m_run;      // converted text not yet written
+    std::wstring m_wide;     // decoded input of the current Feed()
+    std::wstring m_pending;  // markup held until it is understood (entity, tag name, control word)
+
+    // Byte input
+    uint32_t m_utf8Cp = 0;
+    int m_utf8Need = 0;   // continuation bytes still expected
+    int m_utf8Count = 0;  // bytes of the sequence read so far
+    int m_bomState = 0;  // UTF-8 BOM bytes matched so far; -1 once past the start
+
+    // HTML
+    wchar_t m_quote = 0;
+    std::wstring m_rawEnd;  // "</script" or "</style" while in RawText
+    size_t m_rawMatched = 0;
+    int m_commentDashes = 0;
+
+    // RTF
+    std::vector<int> m_ucStack;  // \ucN of each open group
+    int m_uc = 1;
+    int m_fallbackSkip = 0;      // fallback characters still to drop after \uN
+    int m_skipDepth = 0;         // depth of a destination passed through whole; 0 = none
+    int m_depth = 0;
+    bool m_destinationStart = false;  // right after '{' or "{\*"
+    std::string m_word;   // control word being read
+    std::string m_param;  // ... and its numeric parameter
+    int m_hexDigits = 0;
+    unsigned m_hexValue = 0;
+    long m_binaryLeft = 0;
+    uint32_t m_highSurrogate = 0;
+    bool m_escapeOpen = false;  // out ends with a \uN written without fallback characters
+};
@@ -54,6 +54,8 @@
 #define IDC_BTN_CONVERT           444
 #define IDC_BTN_SWAP              445
 #define IDC_BTN_COPY              446
+#define IDC_BTN_DETECT            447
+#define IDC_STATIC_DETECT         448
 
 // Settings Dialog Controls
 #define IDC_CHECK_ENABLED     400
@@ -104,6 +106,9 @@
 // Custom messages
 #define WM_TRAYICON           (WM_USER + 1)
 #define WM_TOGGLE_IME         (WM_USER + 2)
+#define WM_CLIPBOARD_PROGRESS (WM_USER + 3)  // wParam = percent converted
+#define WM_CLIPBOARD_DONE     (WM_USER + 4)  // lParam = ClipboardConversionResult*, receiver deletes
+#define WM_DEFERRED_INIT      (WM_USER + 5)  // wParam = next startup step
 
 // Update Dialog Controls
 #define IDD_UPDATE            305
@@ -115,6 +120,8 @@
 #define IDC_CHECK_DISABLE_UPDATE 465
 #define IDC_CHECK_AUTO_UPDATE 466
 #define IDM_CHECK_UPDATE      217
+#define IDM_ENC_VISCII        218
+#define IDM_ENC_VIQR          219
 
 // String IDs
 #define IDS_APP_TITLE         1000
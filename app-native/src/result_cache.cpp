@@ -0,0 +1,111 @@
+// ViKey - Word Result Cache Implementation
+// result_cache.cpp
+
+#include "result_cache.h"
+#include <algorithm>
+
+// macOS keycodes (core/src/data/keys.rs), all below 64
+static constexpr uint16_t LETTER_KEYS[] = {
+    0, 11, 8, 2, 14, 3, 5, 4, 34, 38, 40, 37, 46,     // A-M
+    45, 31, 35, 12, 15, 1, 17, 32, 9, 13, 7, 16, 6};  // N-Z
+static constexpr uint16_t DIGIT_KEYS[] = {29, 18, 19, 20, 21, 23, 22, 26, 28, 25};  // 0-9
+
+template <size_t N>
+static constexpr uint64_t KeySet(const uint16_t (&keys)[N]) {
+    uint64_t set = 0;
+    for (uint16_t key : keys) set |= 1ull << key;
+    return set;
+}
+
+static constexpr uint64_t LETTERS = KeySet(LETTER_KEYS);
+static constexpr uint64_t DIGITS = KeySet(DIGIT_KEYS);
+
+bool ResultCache::IsCacheable(uint32_t stroke) {
+    uint32_t keycode = stroke & 0xFFFF;
+    bool shift = (stroke & (1u << 17)) != 0;
+    if (keycode >= 64) return false;
+    uint64_t bit = 1ull << keycode;
+    return (LETTERS & bit) || (!shift && (DIGITS & bit));
+}
+
+ResultCache::ResultCache(size_t maxEntries)
+    : m_maxEntries(maxEntries > 0 ? maxEntries : 1) {
+    m_word.reserve(MAX_WORD);
+}
+
+uint64_t ResultCache::Mix(uint64_t hash, uint32_t stroke) {
+    hash = (hash ^ stroke) * 0x9E3779B97F4A7C15ull;
+    return hash ^ (hash >> 29);
+}
+
+void ResultCache::SetConfig(uint64_t configHash) {
+    m_config = configHash;
+    Break();
+}
+
+void ResultCache::Anchor() {
+    m_inWord = true;
+    m_word.clear();
+    m_wordHash = Mix(m_config, 0xA0C4);
+}
+
+void ResultCache::Break() {
+    m_inWord = false;
+    m_word.clear();
+}
+
+bool ResultCache::Continues(uint32_t stroke) const {
+    return m_inWord && m_word.size() < MAX_WORD && IsCacheable(stroke);
+}
+
+bool ResultCache::Matches(const Entry& entry, uint32_t stroke) const {
+    return entry.config == m_config &&
+           entry.strokes.size() == m_word.size() + 1 &&
+           entry.strokes.back() == stroke &&
+           std::equal(m_word.begin(), m_word.end(), entry.strokes.begin());
+}
+
+const CachedResult* ResultCache::Lookup(uint32_t stroke) {
+    if (!Continues(stroke)) return nullptr;
+
+    uint64_t hash = Mix(m_wordHash, stroke);
+    auto it = m_entries.find(hash);
+    if (it == m_entries.end() || !Matches(it->second, stroke)) {
+        m_stats.misses++;
+        return nullptr;
+    }
+    m_stats.hits++;
+    m_word.push_back(stroke);
+    m_wordHash = hash;
+    m_pending.push_back(stroke);
+    return &it->second.result;
+}
+
+void ResultCache::Record(uint32_t stroke, CachedResult result) {
+    if (!Continues(stroke)) {
+        Break();
+        return;
+    }
+
+    m_word.push_back(stroke);
+    m_wordHash = Mix(m_wordHash, stroke);
+    if (m_entries.size() >= m_maxEntries && m_entries.find(m_wordHash) == m_entries.end()) {
+        // Everyday typing needs a few thousand syllables; refill from scratch
+        m_entries.clear();
+        m_stats.flushes++;
+    }
+    Entry& entry = m_entries[m_wordHash];
+    entry.config = m_config;
+    entry.strokes = m_word;
+    entry.result = std::move(result);
+}
+
+void ResultCache::PendingReplayed() {
+    m_stats.replayed += m_pending.size();
+    m_pending.clear();
+}
+
+void ResultCache::Clear() {
+    m_entries.clear();
+    Break();
+}
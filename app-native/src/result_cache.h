@@ -0,0 +1,101 @@
+// ViKey - Word Result Cache
+// result_cache.h
+// Memoizes the engine's result for each keystroke of a word, keyed by the
+// engine settings and the keys typed since the buffer was last cleared
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+// One key's result, as the hook uses it
+struct CachedResult {
+    uint8_t action = 0;
+    uint8_t backspace = 0;
+    uint8_t flags = 0;
+    std::vector<uint32_t> chars;
+};
+
+// After a clear, the engine's answer to a letter or digit depends only on the
+// settings and the letters and digits typed since. Nothing else a clear leaves
+// behind is read by those keys, except auto-capitalize's pending capital: the
+// owner keeps the cache off while that setting is on. Backspace, ESC, Space
+// and punctuation do read older state (the previous word, the shortcut
+// prefix), so they always go to the engine and end the cached word.
+//
+// A hit is answered without the engine, which falls behind: the strokes it
+// has not seen are kept in Pending(), and the owner replays them (ime_replay)
+// before it calls the engine for anything else.
+class ResultCache {
+public:
+    static constexpr size_t DEFAULT_MAX_ENTRIES = 8192;
+    static constexpr size_t MAX_WORD = 32;  // longer words are not cached
+
+    // A keystroke as ime_replay takes it: keycode | caps << 16 | shift << 17
+    static uint32_t Stroke(uint16_t keycode, bool caps, bool shift) {
+        return keycode | (caps ? 1u << 16 : 0u) | (shift ? 1u << 17 : 0u);
+    }
+
+    // Letters, and digits without Shift (VNI marks; Shift+digit is a symbol)
+    static bool IsCacheable(uint32_t stroke);
+
+    explicit ResultCache(size_t maxEntries = DEFAULT_MAX_ENTRIES);
+
+    // Select the settings results are looked up for. Entries made under other
+    // settings stay, for when those come back. Ends the current word.
+    void SetConfig(uint64_t configHash);
+
+    // The engine was just cleared and has seen every stroke: a word starts
+    void Anchor();
+
+    // The engine's state no longer follows from the strokes since the last
+    // Anchor(): nothing is looked up or stored until the next one
+    void Break();
+
+    // The result for the next stroke of the current word, or null. A hit adds
+    // the stroke to the word and to Pending().
+    const CachedResult* Lookup(uint32_t stroke);
+
+    // The engine, up to date, answered `stroke` with `result`: remember it if
+    // the stroke continues a cacheable word, else end the word
+    void Record(uint32_t stroke, CachedResult result);
+
+    // Strokes answered by Lookup() that the engine has not seen, in order
+    const std::vector<uint32_t>& Pending() const { return m_pending; }
+    void PendingReplayed();
+
+    // Drop every entry (the shortcut table changed)
+    void Clear();
+
+    size_t Size() const { return m_entries.size(); }
+
+    struct Stats {
+        uint64_t hits = 0;
+        uint64_t misses = 0;    // cacheable strokes that went to the engine
+        uint64_t replayed = 0;  // strokes passed to PendingReplayed()
+        uint64_t flushes = 0;   // times the cache filled up and was emptied
+    };
+    const Stats& GetStats() const { return m_stats; }
+
+private:
+    struct Entry {
+        uint64_t config;
+        std::vector<uint32_t> strokes;  // the word up to and including this key
+        CachedResult result;
+    };
+
+    static uint64_t Mix(uint64_t hash, uint32_t stroke);
+    bool Continues(uint32_t stroke) const;
+    bool Matches(const Entry& entry, uint32_t stroke) const;
+
+    const size_t m_maxEntries;
+    uint64_t m_config = 0;
+    bool m_inWord = false;
+    std::vector<uint32_t> m_word;  // strokes since Anchor()
+    uint64_t m_wordHash = 0;
+    std::vector<uint32_t> m_pending;
+    std::unordered_map<uint64_t, Entry> m_entries;  // by Mix() of config and word
+    Stats m_stats;
+};
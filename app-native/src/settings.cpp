@@ -3,10 +3,14 @@
 // Project: ViKey | Author: Trần Công Sinh | https://github.com/kmis8x/ViKey
 
 #include "settings.h"
+#include "settings_file.h"
+#include "settings_json.h"
+#include "settings_registry.h"
+#include <shlobj.h>
 #include <shlwapi.h>
-#include <sstream>
 #include <vector>
 
+#pragma comment(lib, "shell32.lib")
 #pragma comment(lib, "shlwapi.lib")
 
 Settings& Settings::Instance() {
@@ -14,6 +18,18 @@ Settings& Settings::Instance() {
     return instance;
 }
 
+std::wstring Settings::DataFilePath(const wchar_t* fileName) {
+    wchar_t appData[MAX_PATH];
+    if (FAILED(SHGetFolderPathW(nullptr, CSIDL_APPDATA | CSIDL_FLAG_CREATE, nullptr, 0, appData))) {
+        return L"";
+    }
+    std::wstring dir = std::wstring(appData) + L"\\ViKey";
+    if (!CreateDirectoryW(dir.c_str(), nullptr) && GetLastError() != ERROR_ALREADY_EXISTS) {
+        return L"";
+    }
+    return dir + L"\\" + fileName;
+}
+
 Settings::Settings()
     : enabled(true)
     , method(InputMethod::Telex)
@@ -27,99 +43,195 @@ Settings::Settings()
     , bracketShortcut(false)
     , slowMode(false)
     , clipboardMode(false)
+    , resultCache(false)
     , smartSwitch(false)
     , autoStart(false)
     , silentStartup(false)
-    , checkForUpdates(true) {
+    , checkForUpdates(true)
+    , convertFrom(1)  // VNI Windows
+    , convertTo(0)    // Unicode
+    , convertDetect(true) {
+    // Ctrl+Shift+F9, as in most Vietnamese input tools
+    convertHotkey.shift = true;
+    convertHotkey.vkCode = VK_F9;
+
+    std::wstring path = DataFilePath(L"settings.dat");
+    if (!path.empty()) {
+        m_storage = std::make_unique<FileSettingsStorage>(path);
+        m_fileStorage = true;
+    } else {
+        m_storage = std::make_unique<RegistrySettingsStorage>(REGISTRY_PATH);
+    }
+    m_persister = std::make_unique<SettingsPersister>(*m_storage);
 }
 
-// Batch registry helpers (single key open for all reads/writes)
-static bool ReadBool(HKEY hKey, const wchar_t* name, bool defaultValue) {
-    DWORD value = 0, size = sizeof(value), type = REG_DWORD;
-    if (RegQueryValueExW(hKey, name, nullptr, &type, (LPBYTE)&value, &size) == ERROR_SUCCESS)
-        return value != 0;
+// Typed lookups in the loaded values; a missing or mistyped value gets the default
+static bool ReadBool(const PersistedValues& values, const wchar_t* name, bool defaultValue) {
+    auto it = values.find(name);
+    if (it != values.end() && it->second.kind == PersistedValue::Kind::Number)
+        return it->second.number != 0;
     return defaultValue;
 }
 
-static int ReadInt(HKEY hKey, const wchar_t* name, int defaultValue) {
-    DWORD value = 0, size = sizeof(value), type = REG_DWORD;
-    if (RegQueryValueExW(hKey, name, nullptr, &type, (LPBYTE)&value, &size) == ERROR_SUCCESS)
-        return static_cast<int>(value);
+static int ReadInt(const PersistedValues& values, const wchar_t* name, int defaultValue) {
+    auto it = values.find(name);
+    if (it != values.end() && it->second.kind == PersistedValue::Kind::Number)
+        return static_cast<int>(it->second.number);
     return defaultValue;
 }
 
-static void WriteBool(HKEY hKey, const wchar_t* name, bool value) {
-    DWORD dw = value ? 1 : 0;
-    RegSetValueExW(hKey, name, 0, REG_DWORD, (LPBYTE)&dw, sizeof(dw));
+static std::wstring ReadString(const PersistedValues& values, const wchar_t* name) {
+    auto it = values.find(name);
+    if (it != values.end() && it->second.kind == PersistedValue::Kind::String)
+        return it->second.text;
+    return L"";
 }
 
-static void WriteInt(HKEY hKey, const wchar_t* name, int value) {
-    DWORD dw = static_cast<DWORD>(value);
-    RegSetValueExW(hKey, name, 0, REG_DWORD, (LPBYTE)&dw, sizeof(dw));
+PersistedValues Settings::ReadStoredValues() {
+    PersistedValues values;
+    if (m_storage->ReadAll(values) || !m_fileStorage) return values;
+
+    // No settings file yet (or an unreadable one): take over what an older
+    // version left in the registry, once. The registry key is left as it was.
+    RegistrySettingsStorage registry(REGISTRY_PATH);
+    if (registry.ReadAll(values) && !values.empty()) {
+        std::vector<PersistedWrite> batch;
+        batch.reserve(values.size());
+        for (const auto& item : values) batch.push_back({item.first, item.second});
+        m_storage->Write(batch);
+    }
+    return values;
 }
 
 void Settings::Load() {
-    HKEY hKey;
-    if (RegOpenKeyExW(HKEY_CURRENT_USER, REGISTRY_PATH, 0, KEY_READ, &hKey) == ERROR_SUCCESS) {
-        enabled = ReadBool(hKey, L"Enabled", true);
-        int methodInt = ReadInt(hKey, L"Method", 0);
-        method = (methodInt >= 0 && methodInt <= 1) ? static_cast<InputMethod>(methodInt) : InputMethod::Telex;
-        modernTone = ReadBool(hKey, L"ModernTone", true);
-        englishAutoRestore = ReadBool(hKey, L"EnglishAutoRestore", true);
-        autoCapitalize = ReadBool(hKey, L"AutoCapitalize", false);
-        escRestore = ReadBool(hKey, L"EscRestore", true);
-        freeTone = ReadBool(hKey, L"FreeTone", false);
-        allowForeignConsonants = ReadBool(hKey, L"AllowForeignConsonants", false);
-        skipWShortcut = ReadBool(hKey, L"SkipWTextShortcut", false);
-        bracketShortcut = ReadBool(hKey, L"BracketTextShortcut", false);
-        slowMode = ReadBool(hKey, L"SlowMode", false);
-        clipboardMode = ReadBool(hKey, L"ClipboardMode", false);
-        smartSwitch = ReadBool(hKey, L"SmartSwitch", false);
-        silentStartup = ReadBool(hKey, L"SilentStartup", false);
-        shortcutsEnabled = ReadBool(hKey, L"ShortcutsEnabled", true);
-        checkForUpdates = ReadBool(hKey, L"CheckForUpdates", true);
-        toggleHotkey.ctrl = ReadBool(hKey, L"HotkeyCtrl", true);
-        toggleHotkey.shift = ReadBool(hKey, L"HotkeyShift", false);
-        toggleHotkey.alt = ReadBool(hKey, L"HotkeyAlt", false);
-        toggleHotkey.win = ReadBool(hKey, L"HotkeyWin", false);
-        toggleHotkey.vkCode = static_cast<UINT>(ReadInt(hKey, L"HotkeyKey", VK_SPACE));
-        RegCloseKey(hKey);
-    }
+    const PersistedValues values = ReadStoredValues();
+    enabled = ReadBool(values, L"Enabled", true);
+    int methodInt = ReadInt(values, L"Method", 0);
+    method = (methodInt >= 0 && methodInt <= 1) ? static_cast<InputMethod>(methodInt) : InputMethod::Telex;
+    modernTone = ReadBool(values, L"ModernTone", true);
+    englishAutoRestore = ReadBool(values, L"EnglishAutoRestore", true);
+    autoCapitalize = ReadBool(values, L"AutoCapitalize", false);
+    escRestore = ReadBool(values, L"EscRestore", true);
+    freeTone = ReadBool(values, L"FreeTone", false);
+    allowForeignConsonants = ReadBool(values, L"AllowForeignConsonants", false);
+    skipWShortcut = ReadBool(values, L"SkipWTextShortcut", false);
+    bracketShortcut = ReadBool(values, L"BracketTextShortcut", false);
+    slowMode = ReadBool(values, L"SlowMode", false);
+    clipboardMode = ReadBool(values, L"ClipboardMode", false);
+    resultCache = ReadBool(values, L"ResultCache", false);
+    smartSwitch = ReadBool(values, L"SmartSwitch", false);
+    silentStartup = ReadBool(values, L"SilentStartup", false);
+    shortcutsEnabled = ReadBool(values, L"ShortcutsEnabled", true);
+    checkForUpdates = ReadBool(values, L"CheckForUpdates", true);
+    toggleHotkey.ctrl = ReadBool(values, L"HotkeyCtrl", true);
+    toggleHotkey.shift = ReadBool(values, L"HotkeyShift", false);
+    toggleHotkey.alt = ReadBool(values, L"HotkeyAlt", false);
+    toggleHotkey.win = ReadBool(values, L"HotkeyWin", false);
+    toggleHotkey.vkCode = static_cast<UINT>(ReadInt(values, L"HotkeyKey", VK_SPACE));
+    convertHotkey.ctrl = ReadBool(values, L"ConvertHotkeyCtrl", true);
+    convertHotkey.shift = ReadBool(values, L"ConvertHotkeyShift", true);
+    convertHotkey.alt = ReadBool(values, L"ConvertHotkeyAlt", false);
+    convertHotkey.win = ReadBool(values, L"ConvertHotkeyWin", false);
+    convertHotkey.vkCode = static_cast<UINT>(ReadInt(values, L"ConvertHotkeyKey", VK_F9));
+    convertFrom = ReadInt(values, L"ConvertFrom", 1);
+    convertTo = ReadInt(values, L"ConvertTo", 0);
+    convertDetect = ReadBool(values, L"ConvertDetect", true);
     autoStart = GetAutoStart();
-    LoadShortcuts();
-    LoadExcludedApps();
+    m_savedAutoStart = autoStart;
+    LoadShortcuts(ReadString(values, L"TextShortcuts"));
+    LoadExcludedApps(ReadString(values, L"ExcludedApps"));
+    StageValues(true);
+    SettingsStore::Instance().Publish(MakeSnapshot());
 }
 
+// Queues the values with the persister, which writes the changed ones to the
+// settings file on its own thread a moment later. Rapid toggles cost one write.
 void Settings::Save() {
-    HKEY hKey;
-    if (RegCreateKeyExW(HKEY_CURRENT_USER, REGISTRY_PATH, 0, nullptr,
-                        REG_OPTION_NON_VOLATILE, KEY_WRITE, nullptr, &hKey, nullptr) == ERROR_SUCCESS) {
-        WriteBool(hKey, L"Enabled", enabled);
-        WriteInt(hKey, L"Method", static_cast<int>(method));
-        WriteBool(hKey, L"ModernTone", modernTone);
-        WriteBool(hKey, L"EnglishAutoRestore", englishAutoRestore);
-        WriteBool(hKey, L"AutoCapitalize", autoCapitalize);
-        WriteBool(hKey, L"EscRestore", escRestore);
-        WriteBool(hKey, L"FreeTone", freeTone);
-        WriteBool(hKey, L"AllowForeignConsonants", allowForeignConsonants);
-        WriteBool(hKey, L"SkipWTextShortcut", skipWShortcut);
-        WriteBool(hKey, L"BracketTextShortcut", bracketShortcut);
-        WriteBool(hKey, L"SlowMode", slowMode);
-        WriteBool(hKey, L"ClipboardMode", clipboardMode);
-        WriteBool(hKey, L"SmartSwitch", smartSwitch);
-        WriteBool(hKey, L"SilentStartup", silentStartup);
-        WriteBool(hKey, L"ShortcutsEnabled", shortcutsEnabled);
-        WriteBool(hKey, L"CheckForUpdates", checkForUpdates);
-        WriteBool(hKey, L"HotkeyCtrl", toggleHotkey.ctrl);
-        WriteBool(hKey, L"HotkeyShift", toggleHotkey.shift);
-        WriteBool(hKey, L"HotkeyAlt", toggleHotkey.alt);
-        WriteBool(hKey, L"HotkeyWin", toggleHotkey.win);
-        WriteInt(hKey, L"HotkeyKey", static_cast<int>(toggleHotkey.vkCode));
-        RegCloseKey(hKey);
+    StageValues(false);
+    if (autoStart != m_savedAutoStart) {
+        SetAutoStart(autoStart);
+        m_savedAutoStart = autoStart;
     }
-    SetAutoStart(autoStart);
-    SaveShortcuts();
-    SaveExcludedApps();
+    SettingsStore::Instance().Publish(MakeSnapshot());
+}
+
+void Settings::Flush() {
+    m_persister->Flush();
+}
+
+// Hand every stored value to the persister, which drops the unchanged ones.
+// stored: the values were just loaded and need no write.
+void Settings::StageValues(bool stored) {
+    SettingsPersister& persister = *m_persister;
+    auto put = [&](const wchar_t* name, PersistedValue value) {
+        if (stored) persister.SetStored(name, std::move(value));
+        else persister.Set(name, std::move(value));
+    };
+    auto flag = [](bool value) { return PersistedValue::Number(value ? 1 : 0); };
+    auto number = [](int value) { return PersistedValue::Number(static_cast<uint32_t>(value)); };
+
+    put(L"Enabled", flag(enabled));
+    put(L"Method", number(static_cast<int>(method)));
+    put(L"ModernTone", flag(modernTone));
+    put(L"EnglishAutoRestore", flag(englishAutoRestore));
+    put(L"AutoCapitalize", flag(autoCapitalize));
+    put(L"EscRestore", flag(escRestore));
+    put(L"FreeTone", flag(freeTone));
+    put(L"AllowForeignConsonants", flag(allowForeignConsonants));
+    put(L"SkipWTextShortcut", flag(skipWShortcut));
+    put(L"BracketTextShortcut", flag(bracketShortcut));
+    put(L"SlowMode", flag(slowMode));
+    put(L"ClipboardMode", flag(clipboardMode));
+    put(L"ResultCache", flag(resultCache));
+    put(L"SmartSwitch", flag(smartSwitch));
+    put(L"SilentStartup", flag(silentStartup));
+    put(L"ShortcutsEnabled", flag(shortcutsEnabled));
+    put(L"CheckForUpdates", flag(checkForUpdates));
+    put(L"HotkeyCtrl", flag(toggleHotkey.ctrl));
+    put(L"HotkeyShift", flag(toggleHotkey.shift));
+    put(L"HotkeyAlt", flag(toggleHotkey.alt));
+    put(L"HotkeyWin", flag(toggleHotkey.win));
+    put(L"HotkeyKey", number(static_cast<int>(toggleHotkey.vkCode)));
+    put(L"ConvertHotkeyCtrl", flag(convertHotkey.ctrl));
+    put(L"ConvertHotkeyShift", flag(convertHotkey.shift));
+    put(L"ConvertHotkeyAlt", flag(convertHotkey.alt));
+    put(L"ConvertHotkeyWin", flag(convertHotkey.win));
+    put(L"ConvertHotkeyKey", number(static_cast<int>(convertHotkey.vkCode)));
+    put(L"ConvertFrom", number(convertFrom));
+    put(L"ConvertTo", number(convertTo));
+    put(L"ConvertDetect", flag(convertDetect));
+
+    // The lists are only re-serialized when they actually changed
+    if (stored || shortcuts != m_savedShortcuts) {
+        put(L"TextShortcuts", PersistedValue::String(SerializeShortcuts()));
+        m_savedShortcuts = shortcuts;
+    }
+    if (stored || excludedApps != m_savedExcludedApps) {
+        put(L"ExcludedApps", PersistedValue::String(SerializeExcludedApps()));
+        m_savedExcludedApps = excludedApps;
+    }
+}
+
+SettingsSnapshot Settings::MakeSnapshot() const {
+    SettingsSnapshot s;
+    s.enabled = enabled;
+    s.method = method;
+    s.modernTone = modernTone;
+    s.englishAutoRestore = englishAutoRestore;
+    s.autoCapitalize = autoCapitalize;
+    s.escRestore = escRestore;
+    s.freeTone = freeTone;
+    s.allowForeignConsonants = allowForeignConsonants;
+    s.skipWShortcut = skipWShortcut;
+    s.bracketShortcut = bracketShortcut;
+    s.slowMode = slowMode;
+    s.clipboardMode = clipboardMode;
+    s.resultCache = resultCache;
+    s.smartSwitch = smartSwitch;
+    s.shortcutsEnabled = shortcutsEnabled;
+    s.shortcuts = shortcuts;
+    s.excludedApps = excludedApps;
+    return s;
 }
 
 std::vector<TextShortcut> Settings::DefaultShortcuts() {
@@ -147,37 +259,6 @@ std::vector<TextShortcut> Settings::DefaultShortcuts() {
     };
 }
 
-std::wstring Settings::GetString(const wchar_t* name, const wchar_t* defaultValue) {
-    HKEY hKey;
-    if (RegOpenKeyExW(HKEY_CURRENT_USER, REGISTRY_PATH, 0, KEY_READ, &hKey) != ERROR_SUCCESS) {
-        return defaultValue;
-    }
-
-    wchar_t buffer[4096] = {0};
-    DWORD size = sizeof(buffer);
-    DWORD type = REG_SZ;
-    std::wstring result = defaultValue;
-
-    if (RegQueryValueExW(hKey, name, nullptr, &type, (LPBYTE)buffer, &size) == ERROR_SUCCESS) {
-        result = buffer;
-    }
-
-    RegCloseKey(hKey);
-    return result;
-}
-
-void Settings::SetString(const wchar_t* name, const std::wstring& value) {
-    HKEY hKey;
-    if (RegCreateKeyExW(HKEY_CURRENT_USER, REGISTRY_PATH, 0, nullptr,
-                        REG_OPTION_NON_VOLATILE, KEY_WRITE, nullptr, &hKey, nullptr) != ERROR_SUCCESS) {
-        return;
-    }
-
-    RegSetValueExW(hKey, name, 0, REG_SZ,
-                   (LPBYTE)value.c_str(), static_cast<DWORD>((value.length() + 1) * sizeof(wchar_t)));
-    RegCloseKey(hKey);
-}
-
 bool Settings::GetAutoStart() const {
     HKEY hKey;
     if (RegOpenKeyExW(HKEY_CURRENT_USER, STARTUP_PATH, 0, KEY_READ, &hKey) != ERROR_SUCCESS) {
@@ -211,8 +292,7 @@ void Settings::SetAutoStart(bool enabled) {
     RegCloseKey(hKey);
 }
 
-void Settings::LoadShortcuts() {
-    std::wstring json = GetString(L"TextShortcuts", L"");
+void Settings::LoadShortcuts(const std::wstring& json) {
     if (json.empty()) {
         shortcuts = DefaultShortcuts();
         return;
@@ -244,18 +324,17 @@ void Settings::LoadShortcuts() {
     }
 }
 
-void Settings::SaveShortcuts() {
+std::wstring Settings::SerializeShortcuts() const {
     // Simple serialization: key1|value1;key2|value2;...
     std::wstring json;
     for (const auto& s : shortcuts) {
         if (!json.empty()) json += L';';
         json += s.key + L'|' + s.value;
     }
-    SetString(L"TextShortcuts", json);
+    return json;
 }
 
-void Settings::LoadExcludedApps() {
-    std::wstring list = GetString(L"ExcludedApps", L"");
+void Settings::LoadExcludedApps(const std::wstring& list) {
     excludedApps.clear();
     if (list.empty()) return;
 
@@ -272,227 +351,211 @@ void Settings::LoadExcludedApps() {
     }
 }
 
-void Settings::SaveExcludedApps() {
+std::wstring Settings::SerializeExcludedApps() const {
     std::wstring list;
     for (size_t i = 0; i < excludedApps.size(); i++) {
         if (i > 0) list += L'|';
         list += excludedApps[i];
     }
-    SetString(L"ExcludedApps", list);
+    return list;
 }
 
-// JSON helpers
-static std::wstring EscapeJsonString(const std::wstring& s) {
-    std::wstring result;
-    result.reserve(s.size());
-    for (wchar_t c : s) {
-        if (c == L'\\') result += L"\\\\";
-        else if (c == L'"') result += L"\\\"";
-        else result += c;
-    }
-    return result;
+// JSON Export/Import (Feature 5)
+static void WriteHotkeyJson(JsonWriter& writer, const HotkeyConfig& hotkey) {
+    writer.BeginObject();
+    writer.Key("ctrl");
+    writer.Bool(hotkey.ctrl);
+    writer.Key("shift");
+    writer.Bool(hotkey.shift);
+    writer.Key("alt");
+    writer.Bool(hotkey.alt);
+    writer.Key("win");
+    writer.Bool(hotkey.win);
+    writer.Key("key");
+    writer.Int(hotkey.vkCode);
+    writer.EndObject();
 }
 
-static void WriteShortcutsJsonArray(std::wstringstream& ss, const std::vector<TextShortcut>& shortcuts) {
-    for (size_t i = 0; i < shortcuts.size(); i++) {
-        ss << L"    {\"key\": \"" << EscapeJsonString(shortcuts[i].key)
-           << L"\", \"value\": \"" << EscapeJsonString(shortcuts[i].value) << L"\"}";
-        if (i < shortcuts.size() - 1) ss << L",";
-        ss << L"\n";
+std::wstring Settings::ExportToJson() const {
+    JsonWriter writer;
+    writer.Reserve(1024 + shortcuts.size() * 48);
+    writer.BeginObject();
+    writer.Key("version");
+    writer.Int(SETTINGS_JSON_VERSION);
+
+    writer.Key("settings");
+    writer.BeginObject();
+    writer.Key("enabled");
+    writer.Bool(enabled);
+    writer.Key("method");
+    writer.Int(static_cast<int>(method));
+    writer.Key("modernTone");
+    writer.Bool(modernTone);
+    writer.Key("englishAutoRestore");
+    writer.Bool(englishAutoRestore);
+    writer.Key("autoCapitalize");
+    writer.Bool(autoCapitalize);
+    writer.Key("escRestore");
+    writer.Bool(escRestore);
+    writer.Key("freeTone");
+    writer.Bool(freeTone);
+    writer.Key("allowForeignConsonants");
+    writer.Bool(allowForeignConsonants);
+    writer.Key("skipWShortcut");
+    writer.Bool(skipWShortcut);
+    writer.Key("bracketShortcut");
+    writer.Bool(bracketShortcut);
+    writer.Key("slowMode");
+    writer.Bool(slowMode);
+    writer.Key("clipboardMode");
+    writer.Bool(clipboardMode);
+    writer.Key("resultCache");
+    writer.Bool(resultCache);
+    writer.Key("smartSwitch");
+    writer.Bool(smartSwitch);
+    writer.Key("autoStart");
+    writer.Bool(autoStart);
+    writer.Key("silentStartup");
+    writer.Bool(silentStartup);
+    writer.Key("convertFrom");
+    writer.Int(convertFrom);
+    writer.Key("convertTo");
+    writer.Int(convertTo);
+    writer.Key("convertDetect");
+    writer.Bool(convertDetect);
+    writer.EndObject();
+
+    writer.Key("hotkey");
+    WriteHotkeyJson(writer, toggleHotkey);
+    writer.Key("convertHotkey");
+    WriteHotkeyJson(writer, convertHotkey);
+
+    writer.Key("excludedApps");
+    writer.BeginArray();
+    for (const auto& app : excludedApps) writer.String(app);
+    writer.EndArray();
+
+    writer.Key("shortcuts");
+    writer.BeginArray();
+    WriteShortcutsJson(writer, shortcuts);
+    writer.EndArray();
+
+    writer.EndObject();
+    return writer.Take();
+}
+
+// Members missing from the file get their defaults, as on a fresh install
+template <typename CharT>
+static void ReadHotkeyJson(BasicJsonReader<CharT>& reader, HotkeyConfig& hotkey, const HotkeyConfig& defaults) {
+    hotkey = defaults;
+    if (!reader.BeginObject()) return;
+    while (reader.NextKey()) {
+        int vk = 0;
+        if (reader.KeyIs("ctrl")) reader.ReadBool(hotkey.ctrl);
+        else if (reader.KeyIs("shift")) reader.ReadBool(hotkey.shift);
+        else if (reader.KeyIs("alt")) reader.ReadBool(hotkey.alt);
+        else if (reader.KeyIs("win")) reader.ReadBool(hotkey.win);
+        else if (reader.KeyIs("key") && reader.ReadInt(vk) && vk > 0 && vk < 0xFF) hotkey.vkCode = static_cast<UINT>(vk);
     }
 }
 
-// Forward declaration (defined after ExportShortcutsToJson)
-static std::wstring ExtractJsonString(const std::wstring& json, const std::wstring& key);
-
-static std::vector<TextShortcut> ParseShortcutsJsonArray(const std::wstring& json, const std::wstring& key) {
-    std::vector<TextShortcut> result;
-    size_t shortcutsPos = json.find(L"\"" + key + L"\":");
-    if (shortcutsPos == std::wstring::npos) return result;
-    size_t arrStart = json.find(L"[", shortcutsPos);
-    size_t arrEnd = json.find(L"]", arrStart);
-    if (arrStart == std::wstring::npos || arrEnd == std::wstring::npos) return result;
-    std::wstring arrSection = json.substr(arrStart, arrEnd - arrStart + 1);
-    size_t pos = 0;
-    while ((pos = arrSection.find(L"{", pos)) != std::wstring::npos) {
-        size_t objEnd = arrSection.find(L"}", pos);
-        if (objEnd == std::wstring::npos) break;
-        std::wstring obj = arrSection.substr(pos, objEnd - pos + 1);
-        std::wstring k = ExtractJsonString(obj, L"key");
-        std::wstring v = ExtractJsonString(obj, L"value");
-        if (!k.empty() && !v.empty()) {
-            result.push_back({k, v});
+template <typename CharT>
+static void ReadSettingsJson(BasicJsonReader<CharT>& reader, Settings& s) {
+    s.enabled = true;
+    s.method = InputMethod::Telex;
+    s.modernTone = true;
+    s.englishAutoRestore = true;
+    s.autoCapitalize = false;
+    s.escRestore = true;
+    s.freeTone = false;
+    s.allowForeignConsonants = false;
+    s.skipWShortcut = false;
+    s.bracketShortcut = false;
+    s.slowMode = false;
+    s.clipboardMode = false;
+    s.resultCache = false;
+    s.smartSwitch = false;
+    s.autoStart = false;
+    s.silentStartup = false;
+    s.convertFrom = 1;
+    s.convertTo = 0;
+    s.convertDetect = true;
+
+    if (!reader.BeginObject()) return;
+    while (reader.NextKey()) {
+        int methodInt = 0;
+        if (reader.KeyIs("enabled")) reader.ReadBool(s.enabled);
+        else if (reader.KeyIs("method")) {
+            if (reader.ReadInt(methodInt) && methodInt >= 0 && methodInt <= 1) s.method = static_cast<InputMethod>(methodInt);
         }
-        pos = objEnd + 1;
+        else if (reader.KeyIs("modernTone")) reader.ReadBool(s.modernTone);
+        else if (reader.KeyIs("englishAutoRestore")) reader.ReadBool(s.englishAutoRestore);
+        else if (reader.KeyIs("autoCapitalize")) reader.ReadBool(s.autoCapitalize);
+        else if (reader.KeyIs("escRestore")) reader.ReadBool(s.escRestore);
+        else if (reader.KeyIs("freeTone")) reader.ReadBool(s.freeTone);
+        else if (reader.KeyIs("allowForeignConsonants")) reader.ReadBool(s.allowForeignConsonants);
+        else if (reader.KeyIs("skipWShortcut")) reader.ReadBool(s.skipWShortcut);
+        else if (reader.KeyIs("bracketShortcut")) reader.ReadBool(s.bracketShortcut);
+        else if (reader.KeyIs("slowMode")) reader.ReadBool(s.slowMode);
+        else if (reader.KeyIs("clipboardMode")) reader.ReadBool(s.clipboardMode);
+        else if (reader.KeyIs("resultCache")) reader.ReadBool(s.resultCache);
+        else if (reader.KeyIs("smartSwitch")) reader.ReadBool(s.smartSwitch);
+        else if (reader.KeyIs("autoStart")) reader.ReadBool(s.autoStart);
+        else if (reader.KeyIs("silentStartup")) reader.ReadBool(s.silentStartup);
+        else if (reader.KeyIs("convertFrom")) reader.ReadInt(s.convertFrom);
+        else if (reader.KeyIs("convertTo")) reader.ReadInt(s.convertTo);
+        else if (reader.KeyIs("convertDetect")) reader.ReadBool(s.convertDetect);
     }
-    return result;
 }
 
-// JSON Export/Import (Feature 5)
-std::wstring Settings::ExportToJson() const {
-    std::wstringstream ss;
-    ss << L"{\n";
-    ss << L"  \"version\": 1,\n";
-    ss << L"  \"settings\": {\n";
-    ss << L"    \"enabled\": " << (enabled ? L"true" : L"false") << L",\n";
-    ss << L"    \"method\": " << static_cast<int>(method) << L",\n";
-    ss << L"    \"modernTone\": " << (modernTone ? L"true" : L"false") << L",\n";
-    ss << L"    \"englishAutoRestore\": " << (englishAutoRestore ? L"true" : L"false") << L",\n";
-    ss << L"    \"autoCapitalize\": " << (autoCapitalize ? L"true" : L"false") << L",\n";
-    ss << L"    \"escRestore\": " << (escRestore ? L"true" : L"false") << L",\n";
-    ss << L"    \"freeTone\": " << (freeTone ? L"true" : L"false") << L",\n";
-    ss << L"    \"allowForeignConsonants\": " << (allowForeignConsonants ? L"true" : L"false") << L",\n";
-    ss << L"    \"skipWShortcut\": " << (skipWShortcut ? L"true" : L"false") << L",\n";
-    ss << L"    \"bracketShortcut\": " << (bracketShortcut ? L"true" : L"false") << L",\n";
-    ss << L"    \"slowMode\": " << (slowMode ? L"true" : L"false") << L",\n";
-    ss << L"    \"clipboardMode\": " << (clipboardMode ? L"true" : L"false") << L",\n";
-    ss << L"    \"smartSwitch\": " << (smartSwitch ? L"true" : L"false") << L",\n";
-    ss << L"    \"autoStart\": " << (autoStart ? L"true" : L"false") << L",\n";
-    ss << L"    \"silentStartup\": " << (silentStartup ? L"true" : L"false") << L"\n";
-    ss << L"  },\n";
-    ss << L"  \"hotkey\": {\n";
-    ss << L"    \"ctrl\": " << (toggleHotkey.ctrl ? L"true" : L"false") << L",\n";
-    ss << L"    \"shift\": " << (toggleHotkey.shift ? L"true" : L"false") << L",\n";
-    ss << L"    \"alt\": " << (toggleHotkey.alt ? L"true" : L"false") << L",\n";
-    ss << L"    \"win\": " << (toggleHotkey.win ? L"true" : L"false") << L",\n";
-    ss << L"    \"key\": " << toggleHotkey.vkCode << L"\n";
-    ss << L"  },\n";
-    ss << L"  \"excludedApps\": [\n";
-    for (size_t i = 0; i < excludedApps.size(); i++) {
-        ss << L"    \"" << excludedApps[i] << L"\"";
-        if (i < excludedApps.size() - 1) ss << L",";
-        ss << L"\n";
+// Two linear passes: the first validates the whole document, so a malformed
+// or foreign file changes nothing
+template <typename CharT>
+static bool ImportSettingsJson(BasicJsonReader<CharT>& reader, Settings& s) {
+    BasicJsonReader<CharT> scan = reader;
+    int version = 0;
+    bool hasSettings = false;
+    if (!scan.BeginObject()) return false;
+    while (scan.NextKey()) {
+        if (scan.KeyIs("version")) scan.ReadInt(version);
+        else if (scan.KeyIs("settings")) hasSettings = scan.Peek() == JsonType::Object;
     }
-    ss << L"  ],\n";
-    ss << L"  \"shortcuts\": [\n";
-    WriteShortcutsJsonArray(ss, shortcuts);
-    ss << L"  ]\n";
-    ss << L"}\n";
-    return ss.str();
-}
-
-// Simple JSON parser helpers
-static std::wstring ExtractJsonString(const std::wstring& json, const std::wstring& key) {
-    std::wstring searchKey = L"\"" + key + L"\":";
-    size_t pos = json.find(searchKey);
-    if (pos == std::wstring::npos) return L"";
-    pos += searchKey.length();
-    while (pos < json.length() && (json[pos] == L' ' || json[pos] == L'\t')) pos++;
-    if (pos >= json.length()) return L"";
-    if (json[pos] == L'"') {
-        pos++;
-        std::wstring result;
-        while (pos < json.length() && json[pos] != L'"') {
-            if (json[pos] == L'\\' && pos + 1 < json.length()) {
-                pos++;
-                if (json[pos] == L'n') result += L'\n';
-                else if (json[pos] == L't') result += L'\t';
-                else result += json[pos];
-            } else {
-                result += json[pos];
+    if (!scan.AtEnd() || version != SETTINGS_JSON_VERSION || !hasSettings) return false;
+
+    HotkeyConfig convertDefaults;
+    convertDefaults.shift = true;
+    convertDefaults.vkCode = VK_F9;
+
+    std::vector<std::wstring> apps;
+    std::vector<TextShortcut> shortcuts;
+    reader.BeginObject();
+    while (reader.NextKey()) {
+        if (reader.KeyIs("settings")) {
+            ReadSettingsJson(reader, s);
+        } else if (reader.KeyIs("hotkey")) {
+            ReadHotkeyJson(reader, s.toggleHotkey, HotkeyConfig());
+        } else if (reader.KeyIs("convertHotkey")) {
+            ReadHotkeyJson(reader, s.convertHotkey, convertDefaults);
+        } else if (reader.KeyIs("excludedApps")) {
+            if (reader.BeginArray()) {
+                std::wstring app;
+                while (reader.NextElement()) {
+                    if (reader.ReadString(app) && !app.empty()) apps.push_back(std::move(app));
+                }
             }
-            pos++;
+        } else if (reader.KeyIs("shortcuts")) {
+            ReadShortcutsJson(reader, shortcuts);
         }
-        return result;
     }
-    return L"";
-}
 
-static bool ExtractJsonBool(const std::wstring& json, const std::wstring& key, bool defaultVal) {
-    std::wstring searchKey = L"\"" + key + L"\":";
-    size_t pos = json.find(searchKey);
-    if (pos == std::wstring::npos) return defaultVal;
-    pos += searchKey.length();
-    while (pos < json.length() && (json[pos] == L' ' || json[pos] == L'\t')) pos++;
-    if (pos + 4 <= json.length() && json.substr(pos, 4) == L"true") return true;
-    if (pos + 5 <= json.length() && json.substr(pos, 5) == L"false") return false;
-    return defaultVal;
-}
-
-static int ExtractJsonInt(const std::wstring& json, const std::wstring& key, int defaultVal) {
-    std::wstring searchKey = L"\"" + key + L"\":";
-    size_t pos = json.find(searchKey);
-    if (pos == std::wstring::npos) return defaultVal;
-    pos += searchKey.length();
-    while (pos < json.length() && (json[pos] == L' ' || json[pos] == L'\t')) pos++;
-    std::wstring numStr;
-    while (pos < json.length() && (json[pos] >= L'0' && json[pos] <= L'9')) {
-        numStr += json[pos++];
-    }
-    if (numStr.empty()) return defaultVal;
-    return std::stoi(numStr);
+    s.excludedApps = std::move(apps);
+    s.shortcuts = shortcuts.empty() ? Settings::DefaultShortcuts() : std::move(shortcuts);
+    return true;
 }
 
 bool Settings::ImportFromJson(const std::wstring& json) {
-    // Check version
-    int version = ExtractJsonInt(json, L"version", 0);
-    if (version != 1) return false;
-
-    // Find settings section
-    size_t settingsPos = json.find(L"\"settings\":");
-    if (settingsPos == std::wstring::npos) return false;
-    size_t settingsEnd = json.find(L"}", settingsPos);
-    if (settingsEnd == std::wstring::npos) return false;
-    std::wstring settingsSection = json.substr(settingsPos, settingsEnd - settingsPos + 1);
-
-    enabled = ExtractJsonBool(settingsSection, L"enabled", true);
-    int methodInt = ExtractJsonInt(settingsSection, L"method", 0);
-    method = (methodInt >= 0 && methodInt <= 1) ? static_cast<InputMethod>(methodInt) : InputMethod::Telex;
-    modernTone = ExtractJsonBool(settingsSection, L"modernTone", true);
-    englishAutoRestore = ExtractJsonBool(settingsSection, L"englishAutoRestore", true);
-    autoCapitalize = ExtractJsonBool(settingsSection, L"autoCapitalize", false);
-    escRestore = ExtractJsonBool(settingsSection, L"escRestore", true);
-    freeTone = ExtractJsonBool(settingsSection, L"freeTone", false);
-    allowForeignConsonants = ExtractJsonBool(settingsSection, L"allowForeignConsonants", false);
-    skipWShortcut = ExtractJsonBool(settingsSection, L"skipWShortcut", false);
-    bracketShortcut = ExtractJsonBool(settingsSection, L"bracketShortcut", false);
-    slowMode = ExtractJsonBool(settingsSection, L"slowMode", false);
-    clipboardMode = ExtractJsonBool(settingsSection, L"clipboardMode", false);
-    smartSwitch = ExtractJsonBool(settingsSection, L"smartSwitch", false);
-    autoStart = ExtractJsonBool(settingsSection, L"autoStart", false);
-    silentStartup = ExtractJsonBool(settingsSection, L"silentStartup", false);
-
-    // Find hotkey section
-    size_t hotkeyPos = json.find(L"\"hotkey\":");
-    if (hotkeyPos != std::wstring::npos) {
-        size_t hotkeyEnd = json.find(L"}", hotkeyPos);
-        if (hotkeyEnd == std::wstring::npos) return false;
-        std::wstring hotkeySection = json.substr(hotkeyPos, hotkeyEnd - hotkeyPos + 1);
-        toggleHotkey.ctrl = ExtractJsonBool(hotkeySection, L"ctrl", true);
-        toggleHotkey.shift = ExtractJsonBool(hotkeySection, L"shift", false);
-        toggleHotkey.alt = ExtractJsonBool(hotkeySection, L"alt", false);
-        toggleHotkey.win = ExtractJsonBool(hotkeySection, L"win", false);
-        toggleHotkey.vkCode = static_cast<UINT>(ExtractJsonInt(hotkeySection, L"key", VK_SPACE));
-    }
-
-    // Find excludedApps array
-    excludedApps.clear();
-    size_t excludedPos = json.find(L"\"excludedApps\":");
-    if (excludedPos != std::wstring::npos) {
-        size_t arrStart = json.find(L"[", excludedPos);
-        size_t arrEnd = json.find(L"]", arrStart);
-        if (arrStart != std::wstring::npos && arrEnd != std::wstring::npos) {
-            std::wstring arrSection = json.substr(arrStart + 1, arrEnd - arrStart - 1);
-            size_t pos = 0;
-            while ((pos = arrSection.find(L"\"", pos)) != std::wstring::npos) {
-                size_t endQuote = arrSection.find(L"\"", pos + 1);
-                if (endQuote == std::wstring::npos) break;
-                std::wstring app = arrSection.substr(pos + 1, endQuote - pos - 1);
-                if (!app.empty()) {
-                    excludedApps.push_back(app);
-                }
-                pos = endQuote + 1;
-            }
-        }
-    }
-
-    // Find shortcuts array
-    shortcuts = ParseShortcutsJsonArray(json, L"shortcuts");
-    if (shortcuts.empty()) {
-        shortcuts = DefaultShortcuts();
-    }
-
-    return true;
+    JsonReader reader(json.data(), json.size());
+    return ImportSettingsJson(reader, *this);
 }
 
 // Common file I/O helpers (DRY: shared by settings + shortcuts export/import)
@@ -507,33 +570,22 @@ static bool WriteWideStringToFile(const wchar_t* path, const std::wstring& conte
     return true;
 }
 
-static std::wstring ReadWideStringFromFile(const wchar_t* path) {
+// Raw file bytes; the JSON reader decodes UTF-8 or UTF-16 from them in place
+static bool ReadFileBytes(const wchar_t* path, std::vector<char>& buffer) {
     HANDLE hFile = CreateFileW(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
-    if (hFile == INVALID_HANDLE_VALUE) return L"";
+    if (hFile == INVALID_HANDLE_VALUE) return false;
     DWORD fileSize = GetFileSize(hFile, nullptr);
     if (fileSize == INVALID_FILE_SIZE || fileSize < 4) {
         CloseHandle(hFile);
-        return L"";
-    }
-    std::vector<BYTE> buffer(fileSize + 2);
-    DWORD bytesRead;
-    if (!ReadFile(hFile, buffer.data(), fileSize, &bytesRead, nullptr)) {
-        CloseHandle(hFile);
-        return L"";
+        return false;
     }
+    buffer.resize(fileSize);
+    DWORD bytesRead = 0;
+    BOOL ok = ReadFile(hFile, buffer.data(), fileSize, &bytesRead, nullptr);
     CloseHandle(hFile);
-    buffer[bytesRead] = 0;
-    buffer[bytesRead + 1] = 0;
-    if (buffer[0] == 0xFF && buffer[1] == 0xFE) {
-        return reinterpret_cast<const wchar_t*>(buffer.data() + 2);
-    }
-    int wideLen = MultiByteToWideChar(CP_UTF8, 0, reinterpret_cast<const char*>(buffer.data()), bytesRead, nullptr, 0);
-    if (wideLen > 0) {
-        std::wstring result(wideLen, 0);
-        MultiByteToWideChar(CP_UTF8, 0, reinterpret_cast<const char*>(buffer.data()), bytesRead, &result[0], wideLen);
-        return result;
-    }
-    return L"";
+    if (!ok) return false;
+    buffer.resize(bytesRead);
+    return true;
 }
 
 bool Settings::ExportToFile(const wchar_t* path) {
@@ -541,34 +593,25 @@ bool Settings::ExportToFile(const wchar_t* path) {
 }
 
 bool Settings::ImportFromFile(const wchar_t* path) {
-    std::wstring json = ReadWideStringFromFile(path);
-    if (json.empty()) return false;
-    if (!Instance().ImportFromJson(json)) return false;
+    std::vector<char> bytes;
+    if (!ReadFileBytes(path, bytes)) return false;
+    bool ok = WithJsonFileReader(bytes.data(), bytes.size(), [](auto& reader) {
+        return ImportSettingsJson(reader, Instance());
+    });
+    if (!ok) return false;
     Instance().Save();
     return true;
 }
 
 // Export shortcuts only to JSON
 std::wstring Settings::ExportShortcutsToJson() const {
-    std::wstringstream ss;
-    ss << L"{\n";
-    ss << L"  \"version\": 1,\n";
-    ss << L"  \"shortcuts\": [\n";
-    WriteShortcutsJsonArray(ss, shortcuts);
-    ss << L"  ]\n";
-    ss << L"}\n";
-    return ss.str();
+    return ExportShortcutsJson(shortcuts);
 }
 
 // Import shortcuts only from JSON
 bool Settings::ImportShortcutsFromJson(const std::wstring& json) {
-    int version = ExtractJsonInt(json, L"version", 0);
-    if (version != 1) return false;
-
-    auto newShortcuts = ParseShortcutsJsonArray(json, L"shortcuts");
-    if (newShortcuts.empty()) return false;
-    shortcuts = newShortcuts;
-    return true;
+    JsonReader reader(json.data(), json.size());
+    return ImportShortcutsJson(reader, shortcuts);
 }
 
 bool Settings::ExportShortcutsToFile(const wchar_t* path) {
@@ -576,9 +619,12 @@ bool Settings::ExportShortcutsToFile(const wchar_t* path) {
 }
 
 bool Settings::ImportShortcutsFromFile(const wchar_t* path) {
-    std::wstring json = ReadWideStringFromFile(path);
-    if (json.empty()) return false;
-    if (!Instance().ImportShortcutsFromJson(json)) return false;
+    std::vector<char> bytes;
+    if (!ReadFileBytes(path, bytes)) return false;
+    bool ok = WithJsonFileReader(bytes.data(), bytes.size(), [](auto& reader) {
+        return ImportShortcutsJson(reader, Instance().shortcuts);
+    });
+    if (!ok) return false;
     Instance().Save();
     return true;
 }
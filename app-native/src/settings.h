@@ -1,13 +1,18 @@
 // ViKey - Settings Manager
 // settings.h
-// Persists user settings to Windows Registry
+// Persists user settings to a single file under %APPDATA%\ViKey (the registry
+// when that folder is unavailable). This object belongs to the UI thread;
+// other threads read the published SettingsSnapshot instead.
 
 #pragma once
 
 #include <windows.h>
+#include <memory>
 #include <string>
 #include <vector>
 #include "rust_bridge.h"
+#include "settings_persister.h"
+#include "settings_snapshot.h"
 #include "shortcut_manager.h"
 
 // Hotkey configuration for language toggle
@@ -33,12 +38,20 @@ class Settings {
 public:
     static Settings& Instance();
 
-    // Load all settings from registry
+    // Load all settings with one read of the settings file. The first run
+    // without one imports the registry values of older versions into it.
     void Load();
 
-    // Save all settings to registry
+    // Publish the settings to SettingsStore and queue the changed values for
+    // a background write to storage (coalesced over a short window)
     void Save();
 
+    // Write queued changes now and wait for them; call before exiting
+    void Flush();
+
+    // Engine-facing copy of the current values
+    SettingsSnapshot MakeSnapshot() const;
+
     // Settings properties
     bool enabled;
     InputMethod method;
@@ -52,6 +65,7 @@ public:
     bool bracketShortcut;
     bool slowMode;
     bool clipboardMode;  // Use clipboard for text injection (for stubborn apps)
+    bool resultCache;    // Answer retyped words from the bridge's result cache (off by default)
     bool smartSwitch;    // Remember IME state per app (Feature 2)
     bool autoStart;
     bool silentStartup;  // Hide Settings on startup, show Toast notification instead
@@ -61,9 +75,19 @@ public:
     std::vector<std::wstring> excludedApps;  // Apps to auto-disable (Feature 3)
     HotkeyConfig toggleHotkey;  // Configurable toggle hotkey
 
+    // Clipboard conversion hotkey: converts the clipboard text in place
+    HotkeyConfig convertHotkey;
+    int convertFrom;     // VietEncoding of the clipboard text
+    int convertTo;       // VietEncoding to convert it to
+    bool convertDetect;  // Detect the source encoding, falling back to convertFrom
+
     // Get default shortcuts
     static std::vector<TextShortcut> DefaultShortcuts();
 
+    // A file in the %APPDATA%\ViKey folder (created if needed), or empty
+    // when that folder is unavailable
+    static std::wstring DataFilePath(const wchar_t* fileName);
+
     // Auto-start management
     void SetAutoStart(bool enabled);
     bool GetAutoStart() const;
@@ -86,19 +110,34 @@ private:
     Settings(const Settings&) = delete;
     Settings& operator=(const Settings&) = delete;
 
-    // Registry helpers
-    std::wstring GetString(const wchar_t* name, const wchar_t* defaultValue);
-    void SetString(const wchar_t* name, const std::wstring& value);
+    // Stored values of the current backend, migrating registry values into
+    // an empty settings file first
+    PersistedValues ReadStoredValues();
+
+    // Queue every stored value with m_persister (stored: already in storage)
+    void StageValues(bool stored);
 
     // Shortcut serialization
-    void LoadShortcuts();
-    void SaveShortcuts();
+    void LoadShortcuts(const std::wstring& list);
+    std::wstring SerializeShortcuts() const;
 
     // Excluded apps serialization (Feature 3)
-    void LoadExcludedApps();
-    void SaveExcludedApps();
+    void LoadExcludedApps(const std::wstring& list);
+    std::wstring SerializeExcludedApps() const;
 
     static constexpr const wchar_t* REGISTRY_PATH = L"SOFTWARE\\ViKey";
     static constexpr const wchar_t* STARTUP_PATH = L"SOFTWARE\\Microsoft\\Windows\\CurrentVersion\\Run";
     static constexpr const wchar_t* APP_NAME = L"ViKey";
+
+    // settings.dat under %APPDATA%\ViKey, or the registry key; see Load()
+    std::unique_ptr<SettingsStorage> m_storage;
+    bool m_fileStorage = false;
+
+    // Write-behind to m_storage; see Save()
+    std::unique_ptr<SettingsPersister> m_persister;
+
+    // What the last Save() queued, so unchanged lists are not re-serialized
+    std::vector<TextShortcut> m_savedShortcuts;
+    std::vector<std::wstring> m_savedExcludedApps;
+    bool m_savedAutoStart = false;
 };
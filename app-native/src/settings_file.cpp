@@ -0,0 +1,101 @@
+// ViKey - Single-File Settings Storage Implementation
+// settings_file.cpp
+
+#include "settings_file.h"
+#include "binary_io.h"
+#include <cstring>
+
+static const char FILE_MAGIC[4] = {'V', 'K', 'S', 0x1A};
+static const size_t HEADER_SIZE = 16;
+
+std::string EncodeSettingsFile(const PersistedValues& values) {
+    size_t size = HEADER_SIZE + 4;
+    for (const auto& item : values) {
+        size += 1 + 2 + 2 * Utf16Length(item.first) + 4;
+        if (item.second.kind == PersistedValue::Kind::String) size += 2 * Utf16Length(item.second.text);
+    }
+
+    std::string file(size, '\0');
+    char* const payload = &file[HEADER_SIZE];
+    char* out = PutU32(payload, static_cast<uint32_t>(values.size()));
+    for (const auto& item : values) {
+        const PersistedValue& value = item.second;
+        bool isString = value.kind == PersistedValue::Kind::String;
+        *out++ = static_cast<char>(isString ? 1 : 0);
+        out = PutU16(out, static_cast<uint32_t>(Utf16Length(item.first)));
+        out = PutText(out, item.first);
+        if (isString) {
+            out = PutU32(out, static_cast<uint32_t>(Utf16Length(value.text)));
+            out = PutText(out, value.text);
+        } else {
+            out = PutU32(out, value.number);
+        }
+    }
+
+    size_t payloadSize = out - payload;
+    char* header = &file[0];
+    std::memcpy(header, FILE_MAGIC, sizeof(FILE_MAGIC));
+    header = PutU16(header + sizeof(FILE_MAGIC), SETTINGS_FILE_FORMAT);
+    header = PutU16(header, 0);
+    header = PutU32(header, static_cast<uint32_t>(payloadSize));
+    PutU32(header, Crc32(payload, payloadSize));
+    return file;
+}
+
+bool DecodeSettingsFile(const char* data, size_t size, PersistedValues& values) {
+    if (size < HEADER_SIZE || std::memcmp(data, FILE_MAGIC, sizeof(FILE_MAGIC)) != 0) return false;
+
+    ByteReader header(data + sizeof(FILE_MAGIC), HEADER_SIZE - sizeof(FILE_MAGIC));
+    uint32_t format = 0, reserved = 0, payloadSize = 0, crc = 0;
+    header.U16(format);
+    header.U16(reserved);
+    header.U32(payloadSize);
+    header.U32(crc);
+    if (format != SETTINGS_FILE_FORMAT || reserved != 0 || payloadSize != size - HEADER_SIZE) return false;
+
+    const char* payload = data + HEADER_SIZE;
+    if (Crc32(payload, payloadSize) != crc) return false;
+
+    PersistedValues decoded;
+    ByteReader reader(payload, payloadSize);
+    uint32_t count = 0;
+    if (!reader.U32(count)) return false;
+    std::wstring name;
+    for (uint32_t i = 0; i < count; i++) {
+        uint32_t kind = 0, nameUnits = 0, number = 0;
+        if (!reader.U8(kind) || kind > 1 || !reader.U16(nameUnits) || !reader.Text(nameUnits, name)) return false;
+        if (!reader.U32(number)) return false;
+        PersistedValue value;
+        if (kind == 1) {
+            value.kind = PersistedValue::Kind::String;
+            if (!reader.Text(number, value.text)) return false;
+        } else {
+            value.number = number;
+        }
+        decoded[name] = std::move(value);
+    }
+    if (!reader.AtEnd()) return false;
+
+    values = std::move(decoded);
+    return true;
+}
+
+bool FileSettingsStorage::ReadAll(PersistedValues& values) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!Load()) return false;
+    values = m_values;
+    return true;
+}
+
+bool FileSettingsStorage::Load() {
+    m_loaded = true;
+    std::string bytes;
+    return ReadWholeFile(m_path, bytes) && DecodeSettingsFile(bytes.data(), bytes.size(), m_values);
+}
+
+bool FileSettingsStorage::Write(const std::vector<PersistedWrite>& batch) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!m_loaded) Load();  // keep the values this batch does not touch
+    for (const auto& write : batch) m_values[write.name] = write.value;
+    return ReplaceFileContents(m_path, EncodeSettingsFile(m_values));
+}
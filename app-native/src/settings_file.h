@@ -0,0 +1,43 @@
+// ViKey - Single-File Settings Storage
+// settings_file.h
+// SettingsStorage over one checksummed binary file: read and verified in one
+// go at startup, replaced through a temporary file and a rename on every write
+
+#pragma once
+
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include "settings_persister.h"
+
+// File layout, all integers little-endian:
+//   header   "VKS" 0x1A, u16 format, u16 reserved, u32 payload size, u32 CRC-32 of payload
+//   payload  u32 count, then per value:
+//            u8 kind (0 number, 1 string), u16 name length, name (UTF-16 units),
+//            u32 number | u32 text length, text (UTF-16 units)
+constexpr uint16_t SETTINGS_FILE_FORMAT = 1;
+
+std::string EncodeSettingsFile(const PersistedValues& values);
+
+// False, leaving values untouched, when the data is not a complete file of a
+// known format or its checksum does not match
+bool DecodeSettingsFile(const char* data, size_t size, PersistedValues& values);
+
+class FileSettingsStorage : public SettingsStorage {
+public:
+    explicit FileSettingsStorage(std::filesystem::path path) : m_path(std::move(path)) {}
+
+    // False when the file is missing or damaged
+    bool ReadAll(PersistedValues& values) override;
+
+    // Rewrites the whole file: every known value plus the batch
+    bool Write(const std::vector<PersistedWrite>& batch) override;
+
+private:
+    bool Load();  // m_mutex held
+
+    std::filesystem::path m_path;
+    std::mutex m_mutex;        // ReadAll() on the UI thread, Write() on the persister's
+    PersistedValues m_values;  // the file's contents as last read or written
+    bool m_loaded = false;     // the file has been read (Write() before ReadAll() keeps it)
+};
@@ -0,0 +1,70 @@
+// ViKey - Settings JSON Format Implementation
+// settings_json.cpp
+
+#include "settings_json.h"
+
+void WriteShortcutsJson(JsonWriter& writer, const std::vector<TextShortcut>& shortcuts) {
+    for (const auto& s : shortcuts) {
+        writer.BeginInlineObject();
+        writer.Key("key");
+        writer.String(s.key);
+        writer.Key("value");
+        writer.String(s.value);
+        writer.EndObject();
+    }
+}
+
+template <typename CharT>
+bool ReadShortcutsJson(BasicJsonReader<CharT>& reader, std::vector<TextShortcut>& out) {
+    if (!reader.BeginArray()) return false;
+    while (reader.NextElement()) {
+        // Decode straight into the new entry; drop it again if incomplete
+        out.emplace_back();
+        TextShortcut& s = out.back();
+        if (reader.BeginObject()) {
+            while (reader.NextKey()) {
+                if (reader.KeyIs("key")) reader.ReadString(s.key);
+                else if (reader.KeyIs("value")) reader.ReadString(s.value);
+            }
+        }
+        if (s.key.empty() || s.value.empty()) out.pop_back();
+    }
+    return !reader.Failed();
+}
+
+std::wstring ExportShortcutsJson(const std::vector<TextShortcut>& shortcuts) {
+    JsonWriter writer;
+    writer.Reserve(64 + shortcuts.size() * 48);
+    writer.BeginObject();
+    writer.Key("version");
+    writer.Int(SETTINGS_JSON_VERSION);
+    writer.Key("shortcuts");
+    writer.BeginArray();
+    WriteShortcutsJson(writer, shortcuts);
+    writer.EndArray();
+    writer.EndObject();
+    return writer.Take();
+}
+
+// One pass: version and shortcuts are collected together and only committed
+// once the whole document has parsed
+template <typename CharT>
+bool ImportShortcutsJson(BasicJsonReader<CharT>& reader, std::vector<TextShortcut>& out) {
+    int version = 0;
+    std::vector<TextShortcut> shortcuts;
+    if (!reader.BeginObject()) return false;
+    while (reader.NextKey()) {
+        if (reader.KeyIs("version")) reader.ReadInt(version);
+        else if (reader.KeyIs("shortcuts")) ReadShortcutsJson(reader, shortcuts);
+    }
+    if (!reader.AtEnd() || version != SETTINGS_JSON_VERSION || shortcuts.empty()) return false;
+    out = std::move(shortcuts);
+    return true;
+}
+
+template bool ReadShortcutsJson(BasicJsonReader<char>&, std::vector<TextShortcut>&);
+template bool ReadShortcutsJson(BasicJsonReader<char16_t>&, std::vector<TextShortcut>&);
+template bool ReadShortcutsJson(BasicJsonReader<wchar_t>&, std::vector<TextShortcut>&);
+template bool ImportShortcutsJson(BasicJsonReader<char>&, std::vector<TextShortcut>&);
+template bool ImportShortcutsJson(BasicJsonReader<char16_t>&, std::vector<TextShortcut>&);
+template bool ImportShortcutsJson(BasicJsonReader<wchar_t>&, std::vector<TextShortcut>&);
@@ -0,0 +1,47 @@
+// ViKey - Settings JSON Format
+// settings_json.h
+// Pieces of the settings export format that do not need Win32: the shortcut
+// list, the version check and opening an exported file's bytes
+
+#pragma once
+
+#include "json_reader.h"
+#include "json_writer.h"
+#include "shortcut_manager.h"
+#include <string>
+#include <vector>
+
+// "version" written by every export and required by every import
+constexpr int SETTINGS_JSON_VERSION = 1;
+
+// Write shortcuts as the elements of the array the writer is in
+void WriteShortcutsJson(JsonWriter& writer, const std::vector<TextShortcut>& shortcuts);
+
+// Read an array of {"key": ..., "value": ...} objects, appending to out.
+// Entries with an empty or missing key or value are dropped.
+template <typename CharT>
+bool ReadShortcutsJson(BasicJsonReader<CharT>& reader, std::vector<TextShortcut>& out);
+
+// Shortcuts-only document: {"version": 1, "shortcuts": [...]}
+std::wstring ExportShortcutsJson(const std::vector<TextShortcut>& shortcuts);
+
+// Replaces out only when the document is valid and has at least one shortcut
+template <typename CharT>
+bool ImportShortcutsJson(BasicJsonReader<CharT>& reader, std::vector<TextShortcut>& out);
+
+// Run fn with a reader over a file's raw bytes: UTF-16LE with a BOM (what the
+// exports write) or UTF-8 with or without one. No transcoding copy is made.
+template <typename Fn>
+bool WithJsonFileReader(const char* data, size_t size, Fn&& fn) {
+    const unsigned char* b = reinterpret_cast<const unsigned char*>(data);
+    if (size >= 2 && b[0] == 0xFF && b[1] == 0xFE) {
+        Utf16JsonReader reader(reinterpret_cast<const char16_t*>(data + 2), (size - 2) / 2);
+        return fn(reader);
+    }
+    if (size >= 3 && b[0] == 0xEF && b[1] == 0xBB && b[2] == 0xBF) {
+        data += 3;
+        size -= 3;
+    }
+    Utf8JsonReader reader(data, size);
+    return fn(reader);
+}
@@ -0,0 +1,128 @@
+// ViKey - Settings Persister Implementation
+// settings_persister.cpp
+
+#include "settings_persister.h"
+
+SettingsPersister::SettingsPersister(SettingsStorage& storage, std::chrono::milliseconds debounce)
+    : m_storage(storage), m_debounce(debounce) {
+    m_worker = std::thread(&SettingsPersister::Work, this);
+}
+
+SettingsPersister::~SettingsPersister() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_flushRequested++;
+        m_stop = true;
+    }
+    m_wake.notify_one();
+    m_worker.join();
+}
+
+void SettingsPersister::Set(const wchar_t* name, PersistedValue value) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stats.sets++;
+    auto it = m_entries.find(name);
+    if (it == m_entries.end()) {
+        it = m_entries.emplace(name, Entry()).first;
+    } else if (it->second.value == value) {
+        m_stats.unchanged++;
+        return;
+    }
+
+    Entry& entry = it->second;
+    entry.value = std::move(value);
+    if (entry.dirty) return;  // already in the pending batch
+    entry.dirty = true;
+    if (m_dirtyCount++ == 0) {
+        m_deadline = std::chrono::steady_clock::now() + m_debounce;
+        m_wake.notify_one();
+    }
+}
+
+void SettingsPersister::SetStored(const wchar_t* name, PersistedValue value) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Entry& entry = m_entries[name];
+    entry.value = value;
+    entry.stored = std::move(value);
+    entry.known = true;
+    if (entry.dirty) {
+        entry.dirty = false;
+        m_dirtyCount--;
+    }
+}
+
+void SettingsPersister::Flush() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    uint64_t ticket = ++m_flushRequested;
+    m_wake.notify_one();
+    m_written.wait(lock, [&]() { return m_flushDone >= ticket; });
+}
+
+SettingsPersister::Stats SettingsPersister::GetStats() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_stats;
+}
+
+std::vector<PersistedWrite> SettingsPersister::TakeDirty() {
+    std::vector<PersistedWrite> batch;
+    batch.reserve(m_dirtyCount);
+    for (auto& item : m_entries) {
+        Entry& entry = item.second;
+        if (!entry.dirty) continue;
+        entry.dirty = false;
+        if (entry.known && entry.value == entry.stored) continue;  // changed and changed back
+        batch.push_back({item.first, entry.value});
+    }
+    m_dirtyCount = 0;
+    return batch;
+}
+
+void SettingsPersister::Work() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    for (;;) {
+        bool flushing = m_flushDone < m_flushRequested;
+        if (!flushing) {
+            if (m_stop) return;
+            if (m_dirtyCount == 0) {
+                m_wake.wait(lock);
+                continue;
+            }
+            if (std::chrono::steady_clock::now() < m_deadline) {
+                m_wake.wait_until(lock, m_deadline);
+                continue;
+            }
+        }
+
+        // Storage I/O happens outside the lock, so Set() never waits on the registry
+        uint64_t ticket = m_flushRequested;
+        std::vector<PersistedWrite> batch = TakeDirty();
+        if (!batch.empty()) {
+            lock.unlock();
+            bool ok = m_storage.Write(batch);
+            lock.lock();
+
+            m_stats.values += batch.size();
+            m_stats.batches++;
+            if (ok) {
+                for (auto& write : batch) {
+                    Entry& entry = m_entries.find(write.name)->second;
+                    entry.stored = std::move(write.value);
+                    entry.known = true;
+                }
+            } else {
+                // Retry after another window, unless a newer value replaced it meanwhile
+                m_stats.failures++;
+                for (auto& write : batch) {
+                    auto it = m_entries.find(write.name);
+                    if (it->second.dirty || it->second.value != write.value) continue;
+                    it->second.dirty = true;
+                    if (m_dirtyCount++ == 0) m_deadline = std::chrono::steady_clock::now() + m_debounce;
+                }
+            }
+        }
+        if (flushing) {
+            m_flushDone = ticket;
+            m_written.notify_all();
+        }
+    }
+}
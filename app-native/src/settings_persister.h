@@ -0,0 +1,130 @@
+// ViKey - Settings Persister
+// settings_persister.h
+// Dirty tracking and coalescing write-behind of named settings values on a
+// background thread
+
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// One persisted value: a DWORD or a string, as the registry stores them
+struct PersistedValue {
+    enum class Kind { Number, String };
+
+    Kind kind = Kind::Number;
+    uint32_t number = 0;
+    std::wstring text;
+
+    static PersistedValue Number(uint32_t value) {
+        PersistedValue v;
+        v.number = value;
+        return v;
+    }
+    static PersistedValue String(std::wstring value) {
+        PersistedValue v;
+        v.kind = Kind::String;
+        v.text = std::move(value);
+        return v;
+    }
+
+    bool operator==(const PersistedValue& other) const {
+        return kind == other.kind && number == other.number && text == other.text;
+    }
+    bool operator!=(const PersistedValue& other) const { return !(*this == other); }
+};
+
+struct PersistedWrite {
+    std::wstring name;
+    PersistedValue value;
+};
+
+// Everything a storage holds, by name (std::less<>: find() by const wchar_t*)
+using PersistedValues = std::map<std::wstring, PersistedValue, std::less<>>;
+
+// Where values live: a single file (settings_file.h) or the registry key
+// (settings_registry.h) in the app; tests and benchmarks also use memory.
+class SettingsStorage {
+public:
+    virtual ~SettingsStorage() = default;
+
+    // Every stored value in one call; false when nothing could be read
+    virtual bool ReadAll(PersistedValues& values) = 0;
+
+    // Store a batch of changed values; called on the persister's thread
+    virtual bool Write(const std::vector<PersistedWrite>& batch) = 0;
+};
+
+// Remembers the last value of every name and writes only the names whose
+// value changed; a value toggled back within the window is not written.
+// Changes are collected for one debounce window, starting at the first
+// unsaved change, and written as a single batch on a worker thread, so a
+// burst of Save() calls costs one storage write. Set() and Flush() may be
+// called from any thread.
+class SettingsPersister {
+public:
+    static constexpr std::chrono::milliseconds DEFAULT_DEBOUNCE{250};
+
+    explicit SettingsPersister(SettingsStorage& storage, std::chrono::milliseconds debounce = DEFAULT_DEBOUNCE);
+    ~SettingsPersister();  // flushes
+
+    // Record a value; it is written later unless it equals the last one
+    void Set(const wchar_t* name, PersistedValue value);
+    void Set(const wchar_t* name, bool value) { Set(name, PersistedValue::Number(value ? 1 : 0)); }
+    void Set(const wchar_t* name, int value) { Set(name, PersistedValue::Number(static_cast<uint32_t>(value))); }
+    void Set(const wchar_t* name, std::wstring value) { Set(name, PersistedValue::String(std::move(value))); }
+    void Set(const wchar_t* name, const wchar_t* value) = delete;  // would silently pick Set(bool)
+
+    // Record a value the storage already holds (just loaded): never written
+    void SetStored(const wchar_t* name, PersistedValue value);
+
+    // Write pending changes now and wait until they are stored
+    void Flush();
+
+    struct Stats {
+        uint64_t sets = 0;        // Set() calls
+        uint64_t unchanged = 0;   // ...that matched the last value and were dropped
+        uint64_t values = 0;      // values handed to the storage
+        uint64_t batches = 0;     // SettingsStorage::Write() calls
+        uint64_t failures = 0;    // batches the storage rejected
+    };
+    Stats GetStats() const;
+
+private:
+    SettingsPersister(const SettingsPersister&) = delete;
+    SettingsPersister& operator=(const SettingsPersister&) = delete;
+
+    struct Entry {
+        PersistedValue value;   // latest Set()
+        PersistedValue stored;  // what the storage holds, if known
+        bool known = false;     // stored is valid
+        bool dirty = false;
+    };
+
+    void Work();
+    std::vector<PersistedWrite> TakeDirty();  // m_mutex held
+
+    SettingsStorage& m_storage;
+    const std::chrono::milliseconds m_debounce;
+
+    mutable std::mutex m_mutex;
+    std::condition_variable m_wake;     // worker: new change, flush or stop
+    std::condition_variable m_written;  // Flush(): a batch finished
+    std::map<std::wstring, Entry, std::less<>> m_entries;  // std::less<>: find() by const wchar_t*
+    size_t m_dirtyCount = 0;
+    std::chrono::steady_clock::time_point m_deadline;  // when the pending batch is due
+    uint64_t m_flushRequested = 0;  // Flush() tickets handed out
+    uint64_t m_flushDone = 0;       // tickets covered by a finished write
+    bool m_stop = false;
+    Stats m_stats;
+
+    std::thread m_worker;
+};
@@ -0,0 +1,71 @@
+// ViKey - Registry Settings Storage Implementation
+// settings_registry.cpp
+
+#include "settings_registry.h"
+#include <cstring>
+#include <vector>
+
+bool RegistrySettingsStorage::ReadAll(PersistedValues& values) {
+    HKEY hKey;
+    if (RegOpenKeyExW(HKEY_CURRENT_USER, m_keyPath.c_str(), 0, KEY_READ, &hKey) != ERROR_SUCCESS) {
+        return false;
+    }
+
+    // Buffers sized once for the longest name and value, so no string is cut short
+    DWORD count = 0, maxName = 0, maxData = 0;
+    if (RegQueryInfoKeyW(hKey, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+                         &count, &maxName, &maxData, nullptr, nullptr) != ERROR_SUCCESS) {
+        RegCloseKey(hKey);
+        return false;
+    }
+    std::vector<wchar_t> name(maxName + 1);
+    std::vector<BYTE> data(maxData + sizeof(wchar_t));
+
+    PersistedValues read;
+    for (DWORD index = 0; index < count; index++) {
+        DWORD nameSize = maxName + 1;
+        DWORD dataSize = maxData;
+        DWORD type = 0;
+        if (RegEnumValueW(hKey, index, name.data(), &nameSize, nullptr, &type, data.data(), &dataSize) != ERROR_SUCCESS) {
+            continue;
+        }
+        if (type == REG_DWORD && dataSize == sizeof(DWORD)) {
+            DWORD dw;
+            memcpy(&dw, data.data(), sizeof(dw));
+            read[std::wstring(name.data(), nameSize)] = PersistedValue::Number(dw);
+        } else if (type == REG_SZ || type == REG_EXPAND_SZ) {
+            std::wstring text(reinterpret_cast<const wchar_t*>(data.data()), dataSize / sizeof(wchar_t));
+            while (!text.empty() && text.back() == L'\0') text.pop_back();
+            read[std::wstring(name.data(), nameSize)] = PersistedValue::String(std::move(text));
+        }
+    }
+
+    RegCloseKey(hKey);
+    values = std::move(read);
+    return true;
+}
+
+bool RegistrySettingsStorage::Write(const std::vector<PersistedWrite>& batch) {
+    HKEY hKey;
+    if (RegCreateKeyExW(HKEY_CURRENT_USER, m_keyPath.c_str(), 0, nullptr,
+                        REG_OPTION_NON_VOLATILE, KEY_WRITE, nullptr, &hKey, nullptr) != ERROR_SUCCESS) {
+        return false;
+    }
+
+    bool ok = true;
+    for (const auto& write : batch) {
+        LSTATUS status;
+        if (write.value.kind == PersistedValue::Kind::Number) {
+            DWORD dw = write.value.number;
+            status = RegSetValueExW(hKey, write.name.c_str(), 0, REG_DWORD, (LPBYTE)&dw, sizeof(dw));
+        } else {
+            const std::wstring& text = write.value.text;
+            status = RegSetValueExW(hKey, write.name.c_str(), 0, REG_SZ, (LPBYTE)text.c_str(),
+                                    static_cast<DWORD>((text.length() + 1) * sizeof(wchar_t)));
+        }
+        ok = ok && status == ERROR_SUCCESS;
+    }
+
+    RegCloseKey(hKey);
+    return ok;
+}
@@ -0,0 +1,22 @@
+// ViKey - Registry Settings Storage
+// settings_registry.h
+// SettingsStorage over one registry key (REG_DWORD and REG_SZ values)
+
+#pragma once
+
+#include <windows.h>
+#include "settings_persister.h"
+
+class RegistrySettingsStorage : public SettingsStorage {
+public:
+    explicit RegistrySettingsStorage(const wchar_t* keyPath) : m_keyPath(keyPath) {}
+
+    // One key open and one enumeration for every value
+    bool ReadAll(PersistedValues& values) override;
+
+    // Opens the key once per batch
+    bool Write(const std::vector<PersistedWrite>& batch) override;
+
+private:
+    std::wstring m_keyPath;
+};
@@ -0,0 +1,27 @@
+// ViKey - Settings Snapshot Implementation
+// settings_snapshot.cpp
+
+#include "settings_snapshot.h"
+
+SettingsStore& SettingsStore::Instance() {
+    static SettingsStore instance;
+    return instance;
+}
+
+SettingsStore::SettingsStore() : m_current(std::make_shared<const SettingsSnapshot>()) {}
+
+uint64_t SettingsStore::Publish(SettingsSnapshot snapshot) {
+    std::lock_guard<std::mutex> lock(m_publishMutex);
+    snapshot.version = m_version.load(std::memory_order_relaxed) + 1;
+    std::shared_ptr<const SettingsSnapshot> next = std::make_shared<const SettingsSnapshot>(std::move(snapshot));
+
+    // Pointer first, then version: a reader that sees the new version is
+    // guaranteed to load this snapshot or a later one
+    std::atomic_store_explicit(&m_current, next, std::memory_order_release);
+    m_version.store(next->version, std::memory_order_release);
+    return next->version;
+}
+
+std::shared_ptr<const SettingsSnapshot> SettingsStore::Current() const {
+    return std::atomic_load_explicit(&m_current, std::memory_order_acquire);
+}
@@ -0,0 +1,83 @@
+// ViKey - Settings Snapshot
+// settings_snapshot.h
+// Immutable, versioned copy of the engine-facing settings, published by the UI
+// and read without locks from the keystroke path
+
+#pragma once
+
+#include "input_method.h"
+#include "shortcut_manager.h"
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Everything the keystroke path and ApplySettings read. Never modified once
+// published; a new Save() publishes a new snapshot instead.
+struct SettingsSnapshot {
+    uint64_t version = 0;  // assigned by SettingsStore::Publish, starts at 1
+
+    bool enabled = true;
+    InputMethod method = InputMethod::Telex;
+    bool modernTone = true;
+    bool englishAutoRestore = true;
+    bool autoCapitalize = false;
+    bool escRestore = true;
+    bool freeTone = false;
+    bool allowForeignConsonants = false;
+    bool skipWShortcut = false;
+    bool bracketShortcut = false;
+    bool slowMode = false;
+    bool clipboardMode = false;
+    bool resultCache = false;
+    bool smartSwitch = false;
+    bool shortcutsEnabled = true;
+    std::vector<TextShortcut> shortcuts;
+    std::vector<std::wstring> excludedApps;
+};
+
+// Holds the current snapshot. Writers (the UI thread) publish whole new
+// snapshots; readers take a reference-counted pointer, so a snapshot stays
+// valid for as long as a keystroke is using it.
+class SettingsStore {
+public:
+    static SettingsStore& Instance();
+
+    SettingsStore();
+
+    // Publish a new snapshot; returns its version
+    uint64_t Publish(SettingsSnapshot snapshot);
+
+    // Current snapshot (never null). Any thread.
+    std::shared_ptr<const SettingsSnapshot> Current() const;
+
+    // Version of the current snapshot; one atomic load
+    uint64_t Version() const { return m_version.load(std::memory_order_acquire); }
+
+    // Per-thread cache for the hot path. Get() is a single atomic load while
+    // nothing changed and only touches the shared pointer after a Publish().
+    // One Reader per thread; it is not itself thread-safe.
+    class Reader {
+    public:
+        explicit Reader(const SettingsStore& store = SettingsStore::Instance()) : m_store(store) {}
+
+        const SettingsSnapshot& Get() {
+            if (!m_cached || m_store.Version() != m_cached->version) m_cached = m_store.Current();
+            return *m_cached;
+        }
+
+    private:
+        const SettingsStore& m_store;
+        std::shared_ptr<const SettingsSnapshot> m_cached;
+    };
+
+private:
+    SettingsStore(const SettingsStore&) = delete;
+    SettingsStore& operator=(const SettingsStore&) = delete;
+
+    std::shared_ptr<const SettingsSnapshot> m_current;  // accessed only through std::atomic_load/store
+    std::atomic<uint64_t> m_version{0};
+    std::mutex m_publishMutex;  // serializes writers; readers never take it
+};
@@ -12,6 +12,9 @@
 struct TextShortcut {
     std::wstring key;
     std::wstring value;
+
+    bool operator==(const TextShortcut& other) const { return key == other.key && value == other.value; }
+    bool operator!=(const TextShortcut& other) const { return !(*this == other); }
 };
 
 class ShortcutManager {
@@ -0,0 +1,65 @@
+// ViKey - Single-Byte Codec Tables
+// single_byte_tables.h
+// Shared table layout for 8-bit Vietnamese encodings (TCVN3, VISCII)
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace SingleByte {
+
+// One byte that does not decode to the character of the same value
+struct BytePair {
+    uint8_t byte;
+    char16_t unicode;
+};
+
+// Unicode -> byte covers the two blocks holding Vietnamese letters
+constexpr uint32_t LATIN_FIRST = 0x00C0;    // À .. ư
+constexpr size_t LATIN_SIZE = 0x0100;
+constexpr uint32_t EXT_FIRST = 0x1EA0;      // Ạ .. ỹ
+constexpr size_t EXT_SIZE = 0x0060;
+
+struct Tables {
+    std::array<char16_t, 256> decode;        // byte -> Unicode
+    std::array<uint8_t, LATIN_SIZE> latin;   // Unicode -> byte, 0 = pass through
+    std::array<uint8_t, EXT_SIZE> extended;
+
+    wchar_t Decode(wchar_t c) const {
+        uint32_t b = static_cast<uint32_t>(c);
+        return (b < 0x100) ? static_cast<wchar_t>(decode[b]) : c;
+    }
+
+    wchar_t Encode(wchar_t c) const {
+        uint32_t u = static_cast<uint32_t>(c);
+        uint8_t b = 0;
+        if (u - LATIN_FIRST < LATIN_SIZE) {
+            b = latin[u - LATIN_FIRST];
+        } else if (u - EXT_FIRST < EXT_SIZE) {
+            b = extended[u - EXT_FIRST];
+        }
+        return b ? static_cast<wchar_t>(b) : c;
+    }
+};
+
+// Bytes not listed decode to themselves. Where a byte is listed twice the
+// later pair wins.
+template <size_t N>
+constexpr Tables BuildTables(const std::array<BytePair, N>& pairs) {
+    Tables t{};
+    for (size_t b = 0; b < t.decode.size(); b++) t.decode[b] = static_cast<char16_t>(b);
+    for (const auto& p : pairs) {
+        t.decode[p.byte] = p.unicode;
+        uint32_t c = p.unicode;
+        if (c - LATIN_FIRST < LATIN_SIZE) {
+            t.latin[c - LATIN_FIRST] = p.byte;
+        } else if (c - EXT_FIRST < EXT_SIZE) {
+            t.extended[c - EXT_FIRST] = p.byte;
+        }
+    }
+    return t;
+}
+
+}  // namespace SingleByte
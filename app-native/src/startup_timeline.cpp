@@ -0,0 +1,143 @@
+// ViKey - Startup Timeline Implementation
+// startup_timeline.cpp
+
+#include "startup_timeline.h"
+#include "json_writer.h"
+#include <cstring>
+#include <cwchar>
+
+StartupTimeline& StartupTimeline::Instance() {
+    static StartupTimeline instance;
+    return instance;
+}
+
+StartupTimeline::StartupTimeline() : m_origin(Clock::now()) {
+    m_threads.push_back(std::this_thread::get_id());
+}
+
+int64_t StartupTimeline::Micros(Clock::time_point t) const {
+    return std::chrono::duration_cast<std::chrono::microseconds>(t - m_origin).count();
+}
+
+uint32_t StartupTimeline::ThreadIndex() {
+    std::thread::id id = std::this_thread::get_id();
+    for (size_t i = 0; i < m_threads.size(); i++) {
+        if (m_threads[i] == id) return static_cast<uint32_t>(i + 1);
+    }
+    m_threads.push_back(id);
+    return static_cast<uint32_t>(m_threads.size());
+}
+
+void StartupTimeline::SetProcessStart(Clock::time_point start, const char* phase) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (start >= m_origin) return;
+    int64_t duration = std::chrono::duration_cast<std::chrono::microseconds>(m_origin - start).count();
+    m_events.insert(m_events.begin(), {phase, 0, duration, 0, 1, false});
+    m_starts.insert(m_starts.begin(), start);
+    for (size_t& open : m_open) open++;
+    m_origin = start;
+}
+
+void StartupTimeline::Begin(const char* name) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_open.push_back(m_events.size());
+    m_events.push_back({name, 0, -1, static_cast<int>(m_open.size()) - 1, ThreadIndex(), false});
+    m_starts.push_back(Clock::now());
+}
+
+void StartupTimeline::End() {
+    Clock::time_point now = Clock::now();
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_open.empty()) return;
+    size_t index = m_open.back();
+    m_open.pop_back();
+    m_events[index].duration = std::chrono::duration_cast<std::chrono::microseconds>(now - m_starts[index]).count();
+}
+
+void StartupTimeline::Mark(const char* name) {
+    Clock::time_point now = Clock::now();
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_events.push_back({name, 0, -1, 0, ThreadIndex(), true});
+    m_starts.push_back(now);
+}
+
+int64_t StartupTimeline::MarkedAt(const char* name) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (size_t i = 0; i < m_events.size(); i++) {
+        if (m_events[i].mark && std::strcmp(m_events[i].name, name) == 0) return Micros(m_starts[i]);
+    }
+    return -1;
+}
+
+std::vector<StartupTimeline::Event> StartupTimeline::Events() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::vector<Event> events = m_events;
+    for (size_t i = 0; i < events.size(); i++) events[i].start = Micros(m_starts[i]);
+    return events;
+}
+
+static std::wstring Widen(const char* ascii) {
+    return std::wstring(ascii, ascii + std::strlen(ascii));
+}
+
+std::string StartupTimeline::ChromeTraceJson() const {
+    std::vector<Event> events = Events();
+    JsonWriter json;
+    json.BeginObject();
+    json.Key("displayTimeUnit");
+    json.String(L"ms");
+    json.Key("traceEvents");
+    json.BeginArray();
+    for (const Event& event : events) {
+        if (!event.mark && event.duration < 0) continue;  // still open
+        json.BeginInlineObject();
+        json.Key("name");
+        json.String(Widen(event.name));
+        json.Key("cat");
+        json.String(L"startup");
+        json.Key("ph");
+        json.String(event.mark ? L"i" : L"X");
+        json.Key("ts");
+        json.Int(event.start);
+        if (event.mark) {
+            json.Key("s");
+            json.String(L"p");
+        } else {
+            json.Key("dur");
+            json.Int(event.duration);
+        }
+        json.Key("pid");
+        json.Int(1);
+        json.Key("tid");
+        json.Int(event.thread);
+        json.EndObject();
+    }
+    json.EndArray();
+    json.EndObject();
+
+    // Names are ASCII, and so is everything else written
+    const std::wstring& text = json.Str();
+    return std::string(text.begin(), text.end());
+}
+
+std::wstring StartupTimeline::Summary() const {
+    auto millis = [](int64_t micros) { return micros / 1000.0; };
+    std::vector<Event> events = Events();
+    wchar_t line[160];
+    std::wstring summary = L"startup:";
+    for (const char* mark : {HOOK_READY, FIRST_KEY}) {
+        int64_t at = MarkedAt(mark);
+        if (at < 0) continue;
+        std::swprintf(line, sizeof(line) / sizeof(line[0]), L" %ls at %.1f ms", Widen(mark).c_str(), millis(at));
+        summary += line;
+    }
+    summary += L"\n";
+
+    for (const Event& event : events) {
+        if (event.mark || event.duration < 0) continue;
+        std::swprintf(line, sizeof(line) / sizeof(line[0]), L"%9.1f ms  %*ls%ls\n", millis(event.duration),
+                      event.depth * 2, L"", Widen(event.name).c_str());
+        summary += line;
+    }
+    return summary;
+}
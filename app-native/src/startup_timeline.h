@@ -0,0 +1,86 @@
+// ViKey - Startup Timeline
+// startup_timeline.h
+// Records how long each startup phase takes, for the debug log and as a
+// Chrome trace (chrome://tracing, ui.perfetto.dev)
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+class StartupTimeline {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    // Marks the startup report is built around
+    static constexpr const char* HOOK_READY = "hook ready";  // keys reach the IME from here
+    static constexpr const char* FIRST_KEY = "first key";
+
+    static StartupTimeline& Instance();
+
+    StartupTimeline();  // the origin is now
+
+    // Move the origin back to process creation and record the time before
+    // the entry point as a phase
+    void SetProcessStart(Clock::time_point start, const char* phase);
+
+    // Phases nest. Begin()/End() belong to the startup thread; Mark() may
+    // come from any thread. Names are string literals and are not copied.
+    void Begin(const char* name);
+    void End();
+    void Mark(const char* name);
+
+    // Microseconds from the origin to the first mark of that name; -1 if none
+    int64_t MarkedAt(const char* name) const;
+
+    struct Event {
+        const char* name;
+        int64_t start;     // microseconds from the origin
+        int64_t duration;  // -1 while a phase is open
+        int depth;         // nesting level of a phase
+        uint32_t thread;   // 1 for the thread that created the timeline, then in order of appearance
+        bool mark;         // a point in time rather than a phase
+    };
+    std::vector<Event> Events() const;
+
+    // {"traceEvents": [...]} with one complete event per phase and an
+    // instant event per mark, in UTF-8
+    std::string ChromeTraceJson() const;
+
+    // One line per phase, indented by depth, after a line with the marks
+    std::wstring Summary() const;
+
+private:
+    StartupTimeline(const StartupTimeline&) = delete;
+    StartupTimeline& operator=(const StartupTimeline&) = delete;
+
+    int64_t Micros(Clock::time_point t) const;
+    uint32_t ThreadIndex();  // m_mutex held
+
+    mutable std::mutex m_mutex;
+    Clock::time_point m_origin;
+    std::vector<Event> m_events;
+    std::vector<Clock::time_point> m_starts;  // by event, as recorded
+    std::vector<size_t> m_open;               // phases begun and not yet ended
+    std::vector<std::thread::id> m_threads;
+};
+
+// Times its scope as a phase of the startup timeline
+class StartupPhase {
+public:
+    explicit StartupPhase(const char* name, StartupTimeline& timeline = StartupTimeline::Instance())
+        : m_timeline(timeline) {
+        m_timeline.Begin(name);
+    }
+    ~StartupPhase() { m_timeline.End(); }
+
+private:
+    StartupPhase(const StartupPhase&) = delete;
+    StartupPhase& operator=(const StartupPhase&) = delete;
+
+    StartupTimeline& m_timeline;
+};
@@ -0,0 +1,85 @@
+// ViKey - TCVN3 (ABC) Tables
+// tcvn3_tables.h
+// Compile-time TCVN3 <-> Unicode lookup tables (see single_byte_tables.h)
+
+#pragma once
+
+#include "single_byte_tables.h"
+
+namespace Tcvn3Tables {
+
+// The 134 Vietnamese letters outside ASCII, small then capital; TCVN3_VIET
+// holds the byte of each at the same index. Small letters and the plain
+// capitals Ă Â Ê Ô Ơ Ư Đ are the ABC layout; capitals with a tone take the
+// remaining high bytes and twelve C0 control codes, as in TCVN 5712:1993.
+inline constexpr wchar_t UNICODE_VIET[] =
+    L"àảãáạăằẳẵắặâầẩẫấậèẻẽéẹêềểễếệìỉĩíịòỏõóọôồổỗốộơờởỡớợùủũúụưừửữứựỳỷỹýỵđ"
+    L"ÀẢÃÁẠĂẰẲẴẮẶÂẦẨẪẤẬÈẺẼÉẸÊỀỂỄẾỆÌỈĨÍỊÒỎÕÓỌÔỒỔỖỐỘƠỜỞỠỚỢÙỦŨÚỤƯỪỬỮỨỰỲỶỸÝỴĐ";
+
+inline constexpr unsigned char TCVN3_VIET[] = {
+    0xB5, 0xB6, 0xB7, 0xB8, 0xB9,        // àảãáạ
+    0xA8, 0xBB, 0xBC, 0xBD, 0xBE, 0xC6,  // ăằẳẵắặ
+    0xA9, 0xC7, 0xC8, 0xC9, 0xCA, 0xCB,  // âầẩẫấậ
+    0xCC, 0xCE, 0xCF, 0xD0, 0xD1,        // èẻẽéẹ
+    0xAA, 0xD2, 0xD3, 0xD4, 0xD5, 0xD6,  // êềểễếệ
+    0xD7, 0xD8, 0xDC, 0xDD, 0xDE,        // ìỉĩíị
+    0xDF, 0xE1, 0xE2, 0xE3, 0xE4,        // òỏõóọ
+    0xAB, 0xE5, 0xE6, 0xE7, 0xE8, 0xE9,  // ôồổỗốộ
+    0xAC, 0xEA, 0xEB, 0xEC, 0xED, 0xEE,  // ơờởỡớợ
+    0xEF, 0xF1, 0xF2, 0xF3, 0xF4,        // ùủũúụ
+    0xAD, 0xF5, 0xF6, 0xF7, 0xF8, 0xF9,  // ưừửữứự
+    0xFA, 0xFB, 0xFC, 0xFD, 0xFE,        // ỳỷỹýỵ
+    0xAE,                                // đ
+    // Capitals
+    0x80, 0x81, 0x82, 0x83, 0x84,        // ÀẢÃÁẠ
+    0xA1, 0xAF, 0xBA, 0xBF, 0xC0, 0x85,  // ĂẰẲẴẮẶ
+    0xA2, 0xC1, 0xC2, 0xC3, 0xC4, 0x86,  // ÂẦẨẪẤẬ
+    0x87, 0x88, 0x89, 0x8A, 0x8B,        // ÈẺẼÉẸ
+    0xA3, 0xC5, 0xCD, 0xD9, 0xDA, 0x8C,  // ÊỀỂỄẾỆ
+    0x8D, 0x8E, 0x8F, 0x90, 0x91,        // ÌỈĨÍỊ
+    0x92, 0x93, 0x94, 0x95, 0x96,        // ÒỎÕÓỌ
+    0xA4, 0xDB, 0xE0, 0xF0, 0xFF, 0x97,  // ÔỒỔỖỐỘ
+    0xA5, 0x98, 0x99, 0x9A, 0x9B, 0x9C,  // ƠỜỞỠỚỢ
+    0x9D, 0x9E, 0x9F, 0x01, 0x02,        // ÙỦŨÚỤ
+    0xA6, 0x04, 0x05, 0x06, 0x11, 0x12,  // ƯỪỬỮỨỰ
+    0x13, 0x14, 0x15, 0x16, 0x17,        // ỲỶỸÝỴ
+    0xA7,                                // Đ
+};
+
+// Bytes that are tone marks on their own; they decode but nothing encodes to them
+inline constexpr SingleByte::BytePair COMBINING_TONES[] = {
+    {0xB0, 0x0300}, {0xB1, 0x0309}, {0xB2, 0x0303}, {0xB3, 0x0301}, {0xB4, 0x0323},
+};
+
+constexpr size_t LETTER_COUNT = sizeof(TCVN3_VIET);
+constexpr size_t MARK_COUNT = sizeof(COMBINING_TONES) / sizeof(COMBINING_TONES[0]);
+static_assert(sizeof(UNICODE_VIET) / sizeof(wchar_t) - 1 == LETTER_COUNT, "one byte per letter");
+static_assert(LETTER_COUNT == 134, "every Vietnamese letter outside ASCII");
+
+constexpr std::array<SingleByte::BytePair, LETTER_COUNT + MARK_COUNT> BuildPairs() {
+    std::array<SingleByte::BytePair, LETTER_COUNT + MARK_COUNT> pairs{};
+    size_t n = 0;
+    for (size_t i = 0; i < LETTER_COUNT; i++) pairs[n++] = {TCVN3_VIET[i], static_cast<char16_t>(UNICODE_VIET[i])};
+    for (const auto& p : COMBINING_TONES) pairs[n++] = p;
+    return pairs;
+}
+
+constexpr bool BytesAreUnique() {
+    auto pairs = BuildPairs();
+    bool seen[256] = {};
+    for (const auto& p : pairs) {
+        if (seen[p.byte]) return false;
+        seen[p.byte] = true;
+    }
+    return true;
+}
+static_assert(BytesAreUnique(), "each byte decodes to one character");
+
+inline constexpr SingleByte::Tables kTables = SingleByte::BuildTables(BuildPairs());
+
+static_assert(kTables.decode[0xB5] == 0x00E0, "0xB5 must decode to à");
+static_assert(kTables.extended[0x1EA1 - SingleByte::EXT_FIRST] == 0xB9, "ạ must encode to 0xB9");
+static_assert(kTables.latin[0x0110 - SingleByte::LATIN_FIRST] == 0xA7, "Đ must encode to 0xA7");
+static_assert(kTables.latin[0x00F4 - SingleByte::LATIN_FIRST] == 0xAB, "ô must encode to 0xAB");
+
+}  // namespace Tcvn3Tables
@@ -43,8 +43,13 @@ void TextSender::SendText(const std::wstring& text, int backspaces) {
     // Convert text if needed (Feature 8: App Encoding Memory)
     std::wstring outputText = text;
     if (m_outputEncoding != OutputEncoding::Unicode && !text.empty()) {
-        VietEncoding targetEnc = (m_outputEncoding == OutputEncoding::VNI) ?
-            VietEncoding::VNI_Windows : VietEncoding::TCVN3;
+        VietEncoding targetEnc = VietEncoding::TCVN3;
+        switch (m_outputEncoding) {
+            case OutputEncoding::VNI:    targetEnc = VietEncoding::VNI_Windows; break;
+            case OutputEncoding::VISCII: targetEnc = VietEncoding::VISCII; break;
+            case OutputEncoding::VIQR:   targetEnc = VietEncoding::VIQR; break;
+            default: break;
+        }
         outputText = EncodingConverter::Instance().Convert(text, VietEncoding::Unicode, targetEnc);
     }
 
@@ -11,7 +11,9 @@
 enum class OutputEncoding {
     Unicode = 0,
     VNI = 1,
-    TCVN3 = 2
+    TCVN3 = 2,
+    VISCII = 3,
+    VIQR = 4
 };
 
 class TextSender {
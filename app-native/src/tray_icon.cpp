@@ -101,6 +101,13 @@ void TrayIcon::UpdateTooltip(bool vietnamese, InputMethod method) {
     Shell_NotifyIconW(NIM_MODIFY, &m_nid);
 }
 
+void TrayIcon::SetTooltipText(const wchar_t* text) {
+    if (!m_initialized) return;
+
+    wcsncpy_s(m_nid.szTip, text, _TRUNCATE);
+    Shell_NotifyIconW(NIM_MODIFY, &m_nid);
+}
+
 void TrayIcon::UpdateMenu(bool vietnamese, InputMethod method) {
     if (!m_hMenu) return;
 
@@ -25,6 +25,9 @@ public:
     // Update tooltip text
     void UpdateTooltip(bool vietnamese, InputMethod method);
 
+    // Replace the tooltip with a status line (until the next UpdateTooltip)
+    void SetTooltipText(const wchar_t* text);
+
     // Update menu checkmarks
     void UpdateMenu(bool vietnamese, InputMethod method);
 
@@ -3,6 +3,7 @@
 // Checks for updates from GitHub releases using WinHTTP
 
 #include "updater.h"
+#include "json_reader.h"
 #include "rust_bridge.h"
 #include <winhttp.h>
 #include <shellapi.h>
@@ -185,35 +186,35 @@ UpdateInfo Updater::ParseReleaseJson(const std::string& json) {
     UpdateInfo info = {};
     info.available = false;
 
-    // Simple JSON parsing (no external library needed)
-    // Looking for: "tag_name": "v1.2.3"
-
-    // Find tag_name
-    size_t tagPos = json.find("\"tag_name\"");
-    if (tagPos == std::string::npos) {
-        info.error = L"Không thể đọc thông tin phiên bản";
+    // Single pass over the UTF-8 response; only the three fields we show are decoded
+    std::wstring tag;
+    Utf8JsonReader reader(json.data(), json.size());
+    if (reader.BeginObject()) {
+        while (reader.NextKey()) {
+            if (reader.KeyIs("tag_name")) reader.ReadString(tag);
+            else if (reader.KeyIs("html_url")) reader.ReadString(info.downloadUrl);
+            else if (reader.KeyIs("body")) reader.ReadString(info.releaseNotes);
+        }
+    }
+    if (reader.Failed()) {
+        info.error = L"L\u1ED7i ph\u00E2n t\u00EDch d\u1EEF li\u1EC7u";
         return info;
     }
-
-    // Find the version string after tag_name
-    size_t colonPos = json.find(':', tagPos);
-    size_t quoteStart = json.find('"', colonPos);
-    size_t quoteEnd = json.find('"', quoteStart + 1);
-
-    if (quoteStart == std::string::npos || quoteEnd == std::string::npos) {
-        info.error = L"Lỗi phân tích dữ liệu";
+    if (tag.empty()) {
+        info.error = L"Kh\u00F4ng th\u1EC3 \u0111\u1ECDc th\u00F4ng tin phi\u00EAn b\u1EA3n";
         return info;
     }
 
-    std::string tagName = json.substr(quoteStart + 1, quoteEnd - quoteStart - 1);
-
     // Remove 'v' prefix if present
-    if (!tagName.empty() && tagName[0] == 'v') {
-        tagName = tagName.substr(1);
-    }
+    if (tag[0] == L'v') tag.erase(0, 1);
+    info.latestVersion = tag;
 
-    // Convert to wide string
-    info.latestVersion = std::wstring(tagName.begin(), tagName.end());
+    // Release notes: just the first 200 chars
+    if (info.releaseNotes.size() > 200) info.releaseNotes.resize(200);
+
+    // Version tags are ASCII; the FFI compares them as narrow strings
+    std::string tagName;
+    for (wchar_t c : tag) tagName += (c < 0x80) ? static_cast<char>(c) : '?';
 
     // Check if update is available using Rust FFI
     if (LoadVersionFunction() && g_versionHasUpdate) {
@@ -224,43 +225,6 @@ UpdateInfo Updater::ParseReleaseJson(const std::string& json) {
         info.available = (tagName > std::string(VIKEY_VERSION_A));
     }
 
-    // Find html_url for download
-    size_t htmlUrlPos = json.find("\"html_url\"");
-    if (htmlUrlPos != std::string::npos) {
-        size_t urlColonPos = json.find(':', htmlUrlPos);
-        size_t urlQuoteStart = json.find('"', urlColonPos);
-        size_t urlQuoteEnd = json.find('"', urlQuoteStart + 1);
-
-        if (urlQuoteStart != std::string::npos && urlQuoteEnd != std::string::npos) {
-            std::string url = json.substr(urlQuoteStart + 1, urlQuoteEnd - urlQuoteStart - 1);
-            info.downloadUrl = std::wstring(url.begin(), url.end());
-        }
-    }
-
-    // Find body (release notes) - just get first 200 chars
-    size_t bodyPos = json.find("\"body\"");
-    if (bodyPos != std::string::npos) {
-        size_t bodyColonPos = json.find(':', bodyPos);
-        size_t bodyQuoteStart = json.find('"', bodyColonPos);
-        size_t bodyQuoteEnd = json.find('"', bodyQuoteStart + 1);
-
-        if (bodyQuoteStart != std::string::npos && bodyQuoteEnd != std::string::npos) {
-            size_t maxLen = 200;
-            size_t bodyLen = bodyQuoteEnd - bodyQuoteStart - 1;
-            std::string body = json.substr(bodyQuoteStart + 1, bodyLen < maxLen ? bodyLen : maxLen);
-
-            // Convert escaped newlines
-            size_t pos = 0;
-            while ((pos = body.find("\\n", pos)) != std::string::npos) {
-                body.replace(pos, 2, "\n");
-                pos += 1;
-            }
-
-            // Convert to wide string (simple ASCII conversion)
-            info.releaseNotes = std::wstring(body.begin(), body.end());
-        }
-    }
-
     return info;
 }
 
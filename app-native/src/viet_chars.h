@@ -0,0 +1,63 @@
+// ViKey - Vietnamese Letter Tables
+// viet_chars.h
+// Compile-time description of every precomposed Vietnamese letter, shared by the codecs
+
+#pragma once
+
+#include <cstdint>
+
+namespace VietChars {
+
+// Vowel shape modifier (the part of the letter that is not the tone)
+enum class Shape : uint8_t {
+    None = 0,
+    Breve = 1,       // ă
+    Circumflex = 2,  // â ê ô
+    Horn = 3         // ơ ư
+};
+
+// Tone marks, in the column order of kVowelGroups
+enum class Tone : uint8_t {
+    None = 0,
+    Grave = 1,   // huyền
+    Hook = 2,    // hỏi
+    Tilde = 3,   // ngã
+    Acute = 4,   // sắc
+    Dot = 5      // nặng
+};
+
+constexpr int TONE_COUNT = 6;
+constexpr int GROUP_COUNT = 12;
+
+struct VowelGroup {
+    char base;                     // ASCII base letter (lowercase)
+    Shape shape;
+    char32_t forms[TONE_COUNT];    // lowercase code point for each Tone
+};
+
+// a ă â e ê i o ô ơ u ư y, each with the six tones
+constexpr VowelGroup kVowelGroups[GROUP_COUNT] = {
+    {'a', Shape::None,       {0x0061, 0x00E0, 0x1EA3, 0x00E3, 0x00E1, 0x1EA1}},
+    {'a', Shape::Breve,      {0x0103, 0x1EB1, 0x1EB3, 0x1EB5, 0x1EAF, 0x1EB7}},
+    {'a', Shape::Circumflex, {0x00E2, 0x1EA7, 0x1EA9, 0x1EAB, 0x1EA5, 0x1EAD}},
+    {'e', Shape::None,       {0x0065, 0x00E8, 0x1EBB, 0x1EBD, 0x00E9, 0x1EB9}},
+    {'e', Shape::Circumflex, {0x00EA, 0x1EC1, 0x1EC3, 0x1EC5, 0x1EBF, 0x1EC7}},
+    {'i', Shape::None,       {0x0069, 0x00EC, 0x1EC9, 0x0129, 0x00ED, 0x1ECB}},
+    {'o', Shape::None,       {0x006F, 0x00F2, 0x1ECF, 0x00F5, 0x00F3, 0x1ECD}},
+    {'o', Shape::Circumflex, {0x00F4, 0x1ED3, 0x1ED5, 0x1ED7, 0x1ED1, 0x1ED9}},
+    {'o', Shape::Horn,       {0x01A1, 0x1EDD, 0x1EDF, 0x1EE1, 0x1EDB, 0x1EE3}},
+    {'u', Shape::None,       {0x0075, 0x00F9, 0x1EE7, 0x0169, 0x00FA, 0x1EE5}},
+    {'u', Shape::Horn,       {0x01B0, 0x1EEB, 0x1EED, 0x1EEF, 0x1EE9, 0x1EF1}},
+    {'y', Shape::None,       {0x0079, 0x1EF3, 0x1EF7, 0x1EF9, 0x00FD, 0x1EF5}},
+};
+
+constexpr char32_t LOWER_D_STROKE = 0x0111;  // đ
+constexpr char32_t UPPER_D_STROKE = 0x0110;  // Đ
+
+// Uppercase of a lowercase letter from the tables above. Latin-1 letters sit
+// 0x20 below their lowercase form; Latin Extended ones immediately before it.
+constexpr char32_t ToUpper(char32_t lower) {
+    return lower < 0x100 ? lower - 0x20 : lower - 1;
+}
+
+}  // namespace VietChars
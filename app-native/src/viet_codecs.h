@@ -0,0 +1,258 @@
+// ViKey - Codec Registry
+// viet_codecs.h
+// One codec per VietEncoding, with a common streaming interface
+
+#pragma once
+
+#include "encoding_converter.h"
+#include "tcvn3_tables.h"
+#include "viet_normalizer_tables.h"
+#include "viqr_tables.h"
+#include "viscii_tables.h"
+#include "vni_tables.h"
+#include <cstdint>
+#include <string>
+
+// Every codec provides:
+//   Decoder  - Put(c, sink) / Flush(sink): reads the encoding, calls
+//              sink.Put() with Unicode (NFC) characters
+//   Encoder  - constructed on the output string; Put(c) appends the encoded
+//              form of one Unicode character, Flush() ends the text
+// Decoders are stateful where one character spans several inputs (VNI pairs,
+// NFD marks). Transcode<From, To> wires one codec's decoder straight into
+// another's encoder, so a pair converts in a single pass with no
+// intermediate string.
+namespace VietCodecs {
+
+struct Unicode {
+    static constexpr VietEncoding id = VietEncoding::Unicode;
+
+    struct Decoder {
+        template <typename Sink> void Put(wchar_t c, Sink& sink) { sink.Put(c); }
+        template <typename Sink> void Flush(Sink&) {}
+    };
+
+    struct Encoder {
+        explicit Encoder(std::wstring& out) : m_out(out) {}
+        void Put(wchar_t c) { m_out += c; }
+        void Flush() {}
+        std::wstring& m_out;
+    };
+};
+
+struct VniWindows {
+    static constexpr VietEncoding id = VietEncoding::VNI_Windows;
+
+    using Decoder = VniTables::Decoder;
+
+    struct Encoder {
+        explicit Encoder(std::wstring& out) : m_out(out) {}
+        void Put(wchar_t c) { VniTables::EncodeChar(c, m_out); }
+        void Flush() {}
+        std::wstring& m_out;
+    };
+};
+
+// 8-bit encodings: one table lookup per character each way
+template <VietEncoding Id, const SingleByte::Tables& Tables>
+struct SingleByteCodec {
+    static constexpr VietEncoding id = Id;
+
+    struct Decoder {
+        template <typename Sink> void Put(wchar_t c, Sink& sink) { sink.Put(Tables.Decode(c)); }
+        template <typename Sink> void Flush(Sink&) {}
+    };
+
+    struct Encoder {
+        explicit Encoder(std::wstring& out) : m_out(out) {}
+        void Put(wchar_t c) { m_out += Tables.Encode(c); }
+        void Flush() {}
+        std::wstring& m_out;
+    };
+};
+
+using Tcvn3 = SingleByteCodec<VietEncoding::TCVN3, Tcvn3Tables::kTables>;
+using Viscii = SingleByteCodec<VietEncoding::VISCII, VisciiTables::kTables>;
+
+struct Composite {
+    static constexpr VietEncoding id = VietEncoding::Unicode_Comp;
+
+    using Decoder = NormalizerTables::Composer;
+    using Encoder = NormalizerTables::Decomposer;
+};
+
+struct Viqr {
+    static constexpr VietEncoding id = VietEncoding::VIQR;
+
+    using Decoder = ViqrTables::Decoder;
+    using Encoder = ViqrTables::Encoder;
+};
+
+// UTF-8 held one byte per wchar_t, e.g. UTF-8 text that was read as ANSI.
+// Bytes that do not form valid UTF-8 pass through unchanged.
+struct Utf8Bytes {
+    static constexpr VietEncoding id = VietEncoding::UTF8_Bytes;
+
+    class Decoder {
+    public:
+        template <typename Sink>
+        void Put(wchar_t ch, Sink& sink) {
+            uint32_t b = static_cast<uint32_t>(ch);
+            if (m_need > 0) {
+                if (b < 0x100 && (b & 0xC0) == 0x80) {
+                    m_cp = (m_cp << 6) | (b & 0x3F);
+                    m_bytes[m_count++] = ch;
+                    if (--m_need == 0) Complete(sink);
+                    return;
+                }
+                PassThrough(sink);
+            }
+
+            if (b >= 0xC2 && b < 0xF5) {
+                m_need = (b >= 0xF0) ? 3 : (b >= 0xE0) ? 2 : 1;
+                m_cp = b & (0x3F >> m_need);
+                m_bytes[0] = ch;
+                m_count = 1;
+            } else {
+                sink.Put(ch);
+            }
+        }
+
+        template <typename Sink>
+        void Flush(Sink& sink) {
+            if (m_count > 0) PassThrough(sink);
+        }
+
+    private:
+        template <typename Sink>
+        void Complete(Sink& sink) {
+            static constexpr uint32_t MIN_CP[5] = {0, 0, 0x80, 0x800, 0x10000};
+            if (m_cp < MIN_CP[m_count] || m_cp > 0x10FFFF || (m_cp >= 0xD800 && m_cp <= 0xDFFF)) {
+                PassThrough(sink);
+                return;
+            }
+            if (sizeof(wchar_t) == 2 && m_cp >= 0x10000) {
+                uint32_t v = m_cp - 0x10000;
+                sink.Put(static_cast<wchar_t>(0xD800 + (v >> 10)));
+                sink.Put(static_cast<wchar_t>(0xDC00 + (v & 0x3FF)));
+            } else {
+                sink.Put(static_cast<wchar_t>(m_cp));
+            }
+            m_count = 0;
+        }
+
+        template <typename Sink>
+        void PassThrough(Sink& sink) {
+            for (int i = 0; i < m_count; i++) sink.Put(m_bytes[i]);
+            m_count = 0;
+            m_need = 0;
+        }
+
+        uint32_t m_cp = 0;
+        int m_need = 0;
+        int m_count = 0;
+        wchar_t m_bytes[4] = {};
+    };
+
+    class Encoder {
+    public:
+        explicit Encoder(std::wstring& out) : m_out(out) {}
+
+        void Put(wchar_t ch) {
+            uint32_t c = static_cast<uint32_t>(ch);
+            if (sizeof(wchar_t) == 2) {
+                if (m_high != 0) {
+                    uint32_t high = m_high;
+                    m_high = 0;
+                    if (c >= 0xDC00 && c <= 0xDFFF) {
+                        Append(0x10000 + ((high - 0xD800) << 10) + (c - 0xDC00));
+                        return;
+                    }
+                    Append(high);
+                }
+                if (c >= 0xD800 && c <= 0xDBFF) {
+                    m_high = c;
+                    return;
+                }
+            }
+            Append(c);
+        }
+
+        void Flush() {
+            if (m_high != 0) Append(m_high);
+            m_high = 0;
+        }
+
+    private:
+        void Append(uint32_t c) {
+            if (c < 0x80) {
+                m_out += static_cast<wchar_t>(c);
+            } else if (c < 0x800) {
+                m_out += static_cast<wchar_t>(0xC0 | (c >> 6));
+                m_out += static_cast<wchar_t>(0x80 | (c & 0x3F));
+            } else if (c < 0x10000) {
+                m_out += static_cast<wchar_t>(0xE0 | (c >> 12));
+                m_out += static_cast<wchar_t>(0x80 | ((c >> 6) & 0x3F));
+                m_out += static_cast<wchar_t>(0x80 | (c & 0x3F));
+            } else {
+                m_out += static_cast<wchar_t>(0xF0 | (c >> 18));
+                m_out += static_cast<wchar_t>(0x80 | ((c >> 12) & 0x3F));
+                m_out += static_cast<wchar_t>(0x80 | ((c >> 6) & 0x3F));
+                m_out += static_cast<wchar_t>(0x80 | (c & 0x3F));
+            }
+        }
+
+        std::wstring& m_out;
+        uint32_t m_high = 0;  // pending UTF-16 high surrogate
+    };
+};
+
+// Registry order; must match the VietEncoding values
+template <typename... Codecs> struct CodecList {};
+using AllCodecs = CodecList<Unicode, VniWindows, Tcvn3, Composite, Viscii, Viqr, Utf8Bytes>;
+
+constexpr size_t CODEC_COUNT = VIET_ENCODING_COUNT;
+
+// Fused single-pass conversion; appends to out
+template <typename From, typename To>
+void Transcode(const wchar_t* text, size_t len, std::wstring& out) {
+    out.reserve(out.size() + len + len / 2);
+    typename To::Encoder encoder(out);
+    typename From::Decoder decoder;
+    for (size_t i = 0; i < len; i++) decoder.Put(text[i], encoder);
+    decoder.Flush(encoder);
+    encoder.Flush();
+}
+
+// Streaming form of Transcode. The encoder writes to m_out; each call swaps
+// the caller's string in for its duration, so output is appended in place.
+template <typename From, typename To>
+class StreamTranscoder : public TranscodeStream {
+public:
+    void Put(const wchar_t* text, size_t len, std::wstring& out) override {
+        m_out.swap(out);
+        for (size_t i = 0; i < len; i++) m_decoder.Put(text[i], m_encoder);
+        m_out.swap(out);
+    }
+
+    void PutUnicode(wchar_t c, std::wstring& out) override {
+        m_out.swap(out);
+        m_decoder.Flush(m_encoder);
+        m_encoder.Put(c);
+        m_out.swap(out);
+    }
+
+    void Flush(std::wstring& out) override {
+        m_out.swap(out);
+        m_decoder.Flush(m_encoder);
+        m_encoder.Flush();
+        m_out.swap(out);
+    }
+
+private:
+    std::wstring m_out;
+    typename To::Encoder m_encoder{m_out};
+    typename From::Decoder m_decoder;
+};
+
+}  // namespace VietCodecs
@@ -0,0 +1,35 @@
+// ViKey - Unicode Normalizer for Vietnamese Implementation
+// viet_normalizer.cpp
+// Project: ViKey | Author: Trần Công Sinh | https://github.com/kmis8x/ViKey
+
+#include "viet_normalizer.h"
+#include "viet_normalizer_tables.h"
+
+using namespace NormalizerTables;
+
+namespace {
+
+struct AppendSink {
+    std::wstring& out;
+    void Put(wchar_t c) { out += c; }
+};
+
+}  // namespace
+
+unsigned VietNormalizer::CombiningClass(wchar_t c) {
+    return Ccc(static_cast<uint32_t>(c));
+}
+
+void VietNormalizer::ToNfd(const wchar_t* text, size_t len, std::wstring& out) {
+    out.reserve(out.size() + len + len / 2);
+    Decomposer decomposer(out);
+    for (size_t i = 0; i < len; i++) decomposer.Put(text[i]);
+}
+
+void VietNormalizer::ToNfc(const wchar_t* text, size_t len, std::wstring& out) {
+    out.reserve(out.size() + len);
+    AppendSink sink{out};
+    Composer composer;
+    for (size_t i = 0; i < len; i++) composer.Put(text[i], sink);
+    composer.Flush(sink);
+}
@@ -0,0 +1,24 @@
+// ViKey - Unicode Normalizer for Vietnamese
+// viet_normalizer.h
+// Portable NFC/NFD for Latin letters with Vietnamese (and common Latin) marks
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+// Covers every precomposed Latin letter (U+00C0-024F, U+1E00-1EFF) whose
+// canonical decomposition is an ASCII letter plus the combining marks
+// U+0300-0304, 0306-030C, 031B, 0323, 0327 and 0328. That includes all 134
+// Vietnamese letters. Characters outside this range are passed through and
+// treated as starters.
+namespace VietNormalizer {
+    // Append the NFD (decomposed, canonically ordered) form of text to out
+    void ToNfd(const wchar_t* text, size_t len, std::wstring& out);
+
+    // Append the NFC (composed) form of text to out
+    void ToNfc(const wchar_t* text, size_t len, std::wstring& out);
+
+    // Canonical combining class of a covered mark, 0 for everything else
+    unsigned CombiningClass(wchar_t c);
+}
@@ -0,0 +1,368 @@
+// ViKey - Unicode Normalizer Tables
+// viet_normalizer_tables.h
+// Compile-time decomposition/composition tables and streaming NFC/NFD steppers
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+
+namespace NormalizerTables {
+
+struct MarkInfo {
+    char16_t mark;
+    uint8_t ccc;  // canonical combining class
+};
+
+inline constexpr MarkInfo kMarks[] = {
+    {0x0300, 230}, {0x0301, 230}, {0x0302, 230}, {0x0303, 230}, {0x0304, 230},
+    {0x0306, 230}, {0x0307, 230}, {0x0308, 230}, {0x0309, 230}, {0x030A, 230},
+    {0x030B, 230}, {0x030C, 230}, {0x031B, 216}, {0x0323, 220}, {0x0327, 202},
+    {0x0328, 202},
+};
+
+// Canonical (single-step) decompositions: composite = first + mark.
+// Taken from UnicodeData.txt for every letter in the covered range.
+struct CanonicalPair {
+    char16_t composite;
+    char16_t first;
+    char16_t mark;
+};
+
+inline constexpr CanonicalPair kCanonicalPairs[] = {
+    {0x00C0, 0x0041, 0x0300}, {0x00C1, 0x0041, 0x0301}, {0x00C2, 0x0041, 0x0302}, {0x00C3, 0x0041, 0x0303},
+    {0x00C4, 0x0041, 0x0308}, {0x00C5, 0x0041, 0x030A}, {0x00C7, 0x0043, 0x0327}, {0x00C8, 0x0045, 0x0300},
+    {0x00C9, 0x0045, 0x0301}, {0x00CA, 0x0045, 0x0302}, {0x00CB, 0x0045, 0x0308}, {0x00CC, 0x0049, 0x0300},
+    {0x00CD, 0x0049, 0x0301}, {0x00CE, 0x0049, 0x0302}, {0x00CF, 0x0049, 0x0308}, {0x00D1, 0x004E, 0x0303},
+    {0x00D2, 0x004F, 0x0300}, {0x00D3, 0x004F, 0x0301}, {0x00D4, 0x004F, 0x0302}, {0x00D5, 0x004F, 0x0303},
+    {0x00D6, 0x004F, 0x0308}, {0x00D9, 0x0055, 0x0300}, {0x00DA, 0x0055, 0x0301}, {0x00DB, 0x0055, 0x0302},
+    {0x00DC, 0x0055, 0x0308}, {0x00DD, 0x0059, 0x0301}, {0x00E0, 0x0061, 0x0300}, {0x00E1, 0x0061, 0x0301},
+    {0x00E2, 0x0061, 0x0302}, {0x00E3, 0x0061, 0x0303}, {0x00E4, 0x0061, 0x0308}, {0x00E5, 0x0061, 0x030A},
+    {0x00E7, 0x0063, 0x0327}, {0x00E8, 0x0065, 0x0300}, {0x00E9, 0x0065, 0x0301}, {0x00EA, 0x0065, 0x0302},
+    {0x00EB, 0x0065, 0x0308}, {0x00EC, 0x0069, 0x0300}, {0x00ED, 0x0069, 0x0301}, {0x00EE, 0x0069, 0x0302},
+    {0x00EF, 0x0069, 0x0308}, {0x00F1, 0x006E, 0x0303}, {0x00F2, 0x006F, 0x0300}, {0x00F3, 0x006F, 0x0301},
+    {0x00F4, 0x006F, 0x0302}, {0x00F5, 0x006F, 0x0303}, {0x00F6, 0x006F, 0x0308}, {0x00F9, 0x0075, 0x0300},
+    {0x00FA, 0x0075, 0x0301}, {0x00FB, 0x0075, 0x0302}, {0x00FC, 0x0075, 0x0308}, {0x00FD, 0x0079, 0x0301},
+    {0x00FF, 0x0079, 0x0308}, {0x0100, 0x0041, 0x0304}, {0x0101, 0x0061, 0x0304}, {0x0102, 0x0041, 0x0306},
+    {0x0103, 0x0061, 0x0306}, {0x0104, 0x0041, 0x0328}, {0x0105, 0x0061, 0x0328}, {0x0106, 0x0043, 0x0301},
+    {0x0107, 0x0063, 0x0301}, {0x0108, 0x0043, 0x0302}, {0x0109, 0x0063, 0x0302}, {0x010A, 0x0043, 0x0307},
+    {0x010B, 0x0063, 0x0307}, {0x010C, 0x0043, 0x030C}, {0x010D, 0x0063, 0x030C}, {0x010E, 0x0044, 0x030C},
+    {0x010F, 0x0064, 0x030C}, {0x0112, 0x0045, 0x0304}, {0x0113, 0x0065, 0x0304}, {0x0114, 0x0045, 0x0306},
+    {0x0115, 0x0065, 0x0306}, {0x0116, 0x0045, 0x0307}, {0x0117, 0x0065, 0x0307}, {0x0118, 0x0045, 0x0328},
+    {0x0119, 0x0065, 0x0328}, {0x011A, 0x0045, 0x030C}, {0x011B, 0x0065, 0x030C}, {0x011C, 0x0047, 0x0302},
+    {0x011D, 0x0067, 0x0302}, {0x011E, 0x0047, 0x0306}, {0x011F, 0x0067, 0x0306}, {0x0120, 0x0047, 0x0307},
+    {0x0121, 0x0067, 0x0307}, {0x0122, 0x0047, 0x0327}, {0x0123, 0x0067, 0x0327}, {0x0124, 0x0048, 0x0302},
+    {0x0125, 0x0068, 0x0302}, {0x0128, 0x0049, 0x0303}, {0x0129, 0x0069, 0x0303}, {0x012A, 0x0049, 0x0304},
+    {0x012B, 0x0069, 0x0304}, {0x012C, 0x0049, 0x0306}, {0x012D, 0x0069, 0x0306}, {0x012E, 0x0049, 0x0328},
+    {0x012F, 0x0069, 0x0328}, {0x0130, 0x0049, 0x0307}, {0x0134, 0x004A, 0x0302}, {0x0135, 0x006A, 0x0302},
+    {0x0136, 0x004B, 0x0327}, {0x0137, 0x006B, 0x0327}, {0x0139, 0x004C, 0x0301}, {0x013A, 0x006C, 0x0301},
+    {0x013B, 0x004C, 0x0327}, {0x013C, 0x006C, 0x0327}, {0x013D, 0x004C, 0x030C}, {0x013E, 0x006C, 0x030C},
+    {0x0143, 0x004E, 0x0301}, {0x0144, 0x006E, 0x0301}, {0x0145, 0x004E, 0x0327}, {0x0146, 0x006E, 0x0327},
+    {0x0147, 0x004E, 0x030C}, {0x0148, 0x006E, 0x030C}, {0x014C, 0x004F, 0x0304}, {0x014D, 0x006F, 0x0304},
+    {0x014E, 0x004F, 0x0306}, {0x014F, 0x006F, 0x0306}, {0x0150, 0x004F, 0x030B}, {0x0151, 0x006F, 0x030B},
+    {0x0154, 0x0052, 0x0301}, {0x0155, 0x0072, 0x0301}, {0x0156, 0x0052, 0x0327}, {0x0157, 0x0072, 0x0327},
+    {0x0158, 0x0052, 0x030C}, {0x0159, 0x0072, 0x030C}, {0x015A, 0x0053, 0x0301}, {0x015B, 0x0073, 0x0301},
+    {0x015C, 0x0053, 0x0302}, {0x015D, 0x0073, 0x0302}, {0x015E, 0x0053, 0x0327}, {0x015F, 0x0073, 0x0327},
+    {0x0160, 0x0053, 0x030C}, {0x0161, 0x0073, 0x030C}, {0x0162, 0x0054, 0x0327}, {0x0163, 0x0074, 0x0327},
+    {0x0164, 0x0054, 0x030C}, {0x0165, 0x0074, 0x030C}, {0x0168, 0x0055, 0x0303}, {0x0169, 0x0075, 0x0303},
+    {0x016A, 0x0055, 0x0304}, {0x016B, 0x0075, 0x0304}, {0x016C, 0x0055, 0x0306}, {0x016D, 0x0075, 0x0306},
+    {0x016E, 0x0055, 0x030A}, {0x016F, 0x0075, 0x030A}, {0x0170, 0x0055, 0x030B}, {0x0171, 0x0075, 0x030B},
+    {0x0172, 0x0055, 0x0328}, {0x0173, 0x0075, 0x0328}, {0x0174, 0x0057, 0x0302}, {0x0175, 0x0077, 0x0302},
+    {0x0176, 0x0059, 0x0302}, {0x0177, 0x0079, 0x0302}, {0x0178, 0x0059, 0x0308}, {0x0179, 0x005A, 0x0301},
+    {0x017A, 0x007A, 0x0301}, {0x017B, 0x005A, 0x0307}, {0x017C, 0x007A, 0x0307}, {0x017D, 0x005A, 0x030C},
+    {0x017E, 0x007A, 0x030C}, {0x01A0, 0x004F, 0x031B}, {0x01A1, 0x006F, 0x031B}, {0x01AF, 0x0055, 0x031B},
+    {0x01B0, 0x0075, 0x031B}, {0x01CD, 0x0041, 0x030C}, {0x01CE, 0x0061, 0x030C}, {0x01CF, 0x0049, 0x030C},
+    {0x01D0, 0x0069, 0x030C}, {0x01D1, 0x004F, 0x030C}, {0x01D2, 0x006F, 0x030C}, {0x01D3, 0x0055, 0x030C},
+    {0x01D4, 0x0075, 0x030C}, {0x01D5, 0x00DC, 0x0304}, {0x01D6, 0x00FC, 0x0304}, {0x01D7, 0x00DC, 0x0301},
+    {0x01D8, 0x00FC, 0x0301}, {0x01D9, 0x00DC, 0x030C}, {0x01DA, 0x00FC, 0x030C}, {0x01DB, 0x00DC, 0x0300},
+    {0x01DC, 0x00FC, 0x0300}, {0x01DE, 0x00C4, 0x0304}, {0x01DF, 0x00E4, 0x0304}, {0x01E0, 0x0226, 0x0304},
+    {0x01E1, 0x0227, 0x0304}, {0x01E6, 0x0047, 0x030C}, {0x01E7, 0x0067, 0x030C}, {0x01E8, 0x004B, 0x030C},
+    {0x01E9, 0x006B, 0x030C}, {0x01EA, 0x004F, 0x0328}, {0x01EB, 0x006F, 0x0328}, {0x01EC, 0x01EA, 0x0304},
+    {0x01ED, 0x01EB, 0x0304}, {0x01F0, 0x006A, 0x030C}, {0x01F4, 0x0047, 0x0301}, {0x01F5, 0x0067, 0x0301},
+    {0x01F8, 0x004E, 0x0300}, {0x01F9, 0x006E, 0x0300}, {0x01FA, 0x00C5, 0x0301}, {0x01FB, 0x00E5, 0x0301},
+    {0x021E, 0x0048, 0x030C}, {0x021F, 0x0068, 0x030C}, {0x0226, 0x0041, 0x0307}, {0x0227, 0x0061, 0x0307},
+    {0x0228, 0x0045, 0x0327}, {0x0229, 0x0065, 0x0327}, {0x022A, 0x00D6, 0x0304}, {0x022B, 0x00F6, 0x0304},
+    {0x022C, 0x00D5, 0x0304}, {0x022D, 0x00F5, 0x0304}, {0x022E, 0x004F, 0x0307}, {0x022F, 0x006F, 0x0307},
+    {0x0230, 0x022E, 0x0304}, {0x0231, 0x022F, 0x0304}, {0x0232, 0x0059, 0x0304}, {0x0233, 0x0079, 0x0304},
+    {0x1E02, 0x0042, 0x0307}, {0x1E03, 0x0062, 0x0307}, {0x1E04, 0x0042, 0x0323}, {0x1E05, 0x0062, 0x0323},
+    {0x1E08, 0x00C7, 0x0301}, {0x1E09, 0x00E7, 0x0301}, {0x1E0A, 0x0044, 0x0307}, {0x1E0B, 0x0064, 0x0307},
+    {0x1E0C, 0x0044, 0x0323}, {0x1E0D, 0x0064, 0x0323}, {0x1E10, 0x0044, 0x0327}, {0x1E11, 0x0064, 0x0327},
+    {0x1E14, 0x0112, 0x0300}, {0x1E15, 0x0113, 0x0300}, {0x1E16, 0x0112, 0x0301}, {0x1E17, 0x0113, 0x0301},
+    {0x1E1C, 0x0228, 0x0306}, {0x1E1D, 0x0229, 0x0306}, {0x1E1E, 0x0046, 0x0307}, {0x1E1F, 0x0066, 0x0307},
+    {0x1E20, 0x0047, 0x0304}, {0x1E21, 0x0067, 0x0304}, {0x1E22, 0x0048, 0x0307}, {0x1E23, 0x0068, 0x0307},
+    {0x1E24, 0x0048, 0x0323}, {0x1E25, 0x0068, 0x0323}, {0x1E26, 0x0048, 0x0308}, {0x1E27, 0x0068, 0x0308},
+    {0x1E28, 0x0048, 0x0327}, {0x1E29, 0x0068, 0x0327}, {0x1E2E, 0x00CF, 0x0301}, {0x1E2F, 0x00EF, 0x0301},
+    {0x1E30, 0x004B, 0x0301}, {0x1E31, 0x006B, 0x0301}, {0x1E32, 0x004B, 0x0323}, {0x1E33, 0x006B, 0x0323},
+    {0x1E36, 0x004C, 0x0323}, {0x1E37, 0x006C, 0x0323}, {0x1E38, 0x1E36, 0x0304}, {0x1E39, 0x1E37, 0x0304},
+    {0x1E3E, 0x004D, 0x0301}, {0x1E3F, 0x006D, 0x0301}, {0x1E40, 0x004D, 0x0307}, {0x1E41, 0x006D, 0x0307},
+    {0x1E42, 0x004D, 0x0323}, {0x1E43, 0x006D, 0x0323}, {0x1E44, 0x004E, 0x0307}, {0x1E45, 0x006E, 0x0307},
+    {0x1E46, 0x004E, 0x0323}, {0x1E47, 0x006E, 0x0323}, {0x1E4C, 0x00D5, 0x0301}, {0x1E4D, 0x00F5, 0x0301},
+    {0x1E4E, 0x00D5, 0x0308}, {0x1E4F, 0x00F5, 0x0308}, {0x1E50, 0x014C, 0x0300}, {0x1E51, 0x014D, 0x0300},
+    {0x1E52, 0x014C, 0x0301}, {0x1E53, 0x014D, 0x0301}, {0x1E54, 0x0050, 0x0301}, {0x1E55, 0x0070, 0x0301},
+    {0x1E56, 0x0050, 0x0307}, {0x1E57, 0x0070, 0x0307}, {0x1E58, 0x0052, 0x0307}, {0x1E59, 0x0072, 0x0307},
+    {0x1E5A, 0x0052, 0x0323}, {0x1E5B, 0x0072, 0x0323}, {0x1E5C, 0x1E5A, 0x0304}, {0x1E5D, 0x1E5B, 0x0304},
+    {0x1E60, 0x0053, 0x0307}, {0x1E61, 0x0073, 0x0307}, {0x1E62, 0x0053, 0x0323}, {0x1E63, 0x0073, 0x0323},
+    {0x1E64, 0x015A, 0x0307}, {0x1E65, 0x015B, 0x0307}, {0x1E66, 0x0160, 0x0307}, {0x1E67, 0x0161, 0x0307},
+    {0x1E68, 0x1E62, 0x0307}, {0x1E69, 0x1E63, 0x0307}, {0x1E6A, 0x0054, 0x0307}, {0x1E6B, 0x0074, 0x0307},
+    {0x1E6C, 0x0054, 0x0323}, {0x1E6D, 0x0074, 0x0323}, {0x1E78, 0x0168, 0x0301}, {0x1E79, 0x0169, 0x0301},
+    {0x1E7A, 0x016A, 0x0308}, {0x1E7B, 0x016B, 0x0308}, {0x1E7C, 0x0056, 0x0303}, {0x1E7D, 0x0076, 0x0303},
+    {0x1E7E, 0x0056, 0x0323}, {0x1E7F, 0x0076, 0x0323}, {0x1E80, 0x0057, 0x0300}, {0x1E81, 0x0077, 0x0300},
+    {0x1E82, 0x0057, 0x0301}, {0x1E83, 0x0077, 0x0301}, {0x1E84, 0x0057, 0x0308}, {0x1E85, 0x0077, 0x0308},
+    {0x1E86, 0x0057, 0x0307}, {0x1E87, 0x0077, 0x0307}, {0x1E88, 0x0057, 0x0323}, {0x1E89, 0x0077, 0x0323},
+    {0x1E8A, 0x0058, 0x0307}, {0x1E8B, 0x0078, 0x0307}, {0x1E8C, 0x0058, 0x0308}, {0x1E8D, 0x0078, 0x0308},
+    {0x1E8E, 0x0059, 0x0307}, {0x1E8F, 0x0079, 0x0307}, {0x1E90, 0x005A, 0x0302}, {0x1E91, 0x007A, 0x0302},
+    {0x1E92, 0x005A, 0x0323}, {0x1E93, 0x007A, 0x0323}, {0x1E97, 0x0074, 0x0308}, {0x1E98, 0x0077, 0x030A},
+    {0x1E99, 0x0079, 0x030A}, {0x1EA0, 0x0041, 0x0323}, {0x1EA1, 0x0061, 0x0323}, {0x1EA2, 0x0041, 0x0309},
+    {0x1EA3, 0x0061, 0x0309}, {0x1EA4, 0x00C2, 0x0301}, {0x1EA5, 0x00E2, 0x0301}, {0x1EA6, 0x00C2, 0x0300},
+    {0x1EA7, 0x00E2, 0x0300}, {0x1EA8, 0x00C2, 0x0309}, {0x1EA9, 0x00E2, 0x0309}, {0x1EAA, 0x00C2, 0x0303},
+    {0x1EAB, 0x00E2, 0x0303}, {0x1EAC, 0x1EA0, 0x0302}, {0x1EAD, 0x1EA1, 0x0302}, {0x1EAE, 0x0102, 0x0301},
+    {0x1EAF, 0x0103, 0x0301}, {0x1EB0, 0x0102, 0x0300}, {0x1EB1, 0x0103, 0x0300}, {0x1EB2, 0x0102, 0x0309},
+    {0x1EB3, 0x0103, 0x0309}, {0x1EB4, 0x0102, 0x0303}, {0x1EB5, 0x0103, 0x0303}, {0x1EB6, 0x1EA0, 0x0306},
+    {0x1EB7, 0x1EA1, 0x0306}, {0x1EB8, 0x0045, 0x0323}, {0x1EB9, 0x0065, 0x0323}, {0x1EBA, 0x0045, 0x0309},
+    {0x1EBB, 0x0065, 0x0309}, {0x1EBC, 0x0045, 0x0303}, {0x1EBD, 0x0065, 0x0303}, {0x1EBE, 0x00CA, 0x0301},
+    {0x1EBF, 0x00EA, 0x0301}, {0x1EC0, 0x00CA, 0x0300}, {0x1EC1, 0x00EA, 0x0300}, {0x1EC2, 0x00CA, 0x0309},
+    {0x1EC3, 0x00EA, 0x0309}, {0x1EC4, 0x00CA, 0x0303}, {0x1EC5, 0x00EA, 0x0303}, {0x1EC6, 0x1EB8, 0x0302},
+    {0x1EC7, 0x1EB9, 0x0302}, {0x1EC8, 0x0049, 0x0309}, {0x1EC9, 0x0069, 0x0309}, {0x1ECA, 0x0049, 0x0323},
+    {0x1ECB, 0x0069, 0x0323}, {0x1ECC, 0x004F, 0x0323}, {0x1ECD, 0x006F, 0x0323}, {0x1ECE, 0x004F, 0x0309},
+    {0x1ECF, 0x006F, 0x0309}, {0x1ED0, 0x00D4, 0x0301}, {0x1ED1, 0x00F4, 0x0301}, {0x1ED2, 0x00D4, 0x0300},
+    {0x1ED3, 0x00F4, 0x0300}, {0x1ED4, 0x00D4, 0x0309}, {0x1ED5, 0x00F4, 0x0309}, {0x1ED6, 0x00D4, 0x0303},
+    {0x1ED7, 0x00F4, 0x0303}, {0x1ED8, 0x1ECC, 0x0302}, {0x1ED9, 0x1ECD, 0x0302}, {0x1EDA, 0x01A0, 0x0301},
+    {0x1EDB, 0x01A1, 0x0301}, {0x1EDC, 0x01A0, 0x0300}, {0x1EDD, 0x01A1, 0x0300}, {0x1EDE, 0x01A0, 0x0309},
+    {0x1EDF, 0x01A1, 0x0309}, {0x1EE0, 0x01A0, 0x0303}, {0x1EE1, 0x01A1, 0x0303}, {0x1EE2, 0x01A0, 0x0323},
+    {0x1EE3, 0x01A1, 0x0323}, {0x1EE4, 0x0055, 0x0323}, {0x1EE5, 0x0075, 0x0323}, {0x1EE6, 0x0055, 0x0309},
+    {0x1EE7, 0x0075, 0x0309}, {0x1EE8, 0x01AF, 0x0301}, {0x1EE9, 0x01B0, 0x0301}, {0x1EEA, 0x01AF, 0x0300},
+    {0x1EEB, 0x01B0, 0x0300}, {0x1EEC, 0x01AF, 0x0309}, {0x1EED, 0x01B0, 0x0309}, {0x1EEE, 0x01AF, 0x0303},
+    {0x1EEF, 0x01B0, 0x0303}, {0x1EF0, 0x01AF, 0x0323}, {0x1EF1, 0x01B0, 0x0323}, {0x1EF2, 0x0059, 0x0300},
+    {0x1EF3, 0x0079, 0x0300}, {0x1EF4, 0x0059, 0x0323}, {0x1EF5, 0x0079, 0x0323}, {0x1EF6, 0x0059, 0x0309},
+    {0x1EF7, 0x0079, 0x0309}, {0x1EF8, 0x0059, 0x0303}, {0x1EF9, 0x0079, 0x0303},
+
+};
+
+constexpr size_t PAIR_COUNT = sizeof(kCanonicalPairs) / sizeof(kCanonicalPairs[0]);
+
+// ---- Combining classes, indexed by c - 0x0300 ----
+
+constexpr char16_t MARK_FIRST = 0x0300;
+constexpr size_t MARK_RANGE = 0x0070;
+
+constexpr std::array<uint8_t, MARK_RANGE> BuildMarkClasses() {
+    std::array<uint8_t, MARK_RANGE> t{};
+    for (const auto& m : kMarks) t[m.mark - MARK_FIRST] = m.ccc;
+    return t;
+}
+
+inline constexpr auto kMarkClass = BuildMarkClasses();
+
+constexpr uint8_t Ccc(uint32_t c) {
+    return (c - MARK_FIRST < MARK_RANGE) ? kMarkClass[c - MARK_FIRST] : 0;
+}
+
+// ---- Full decompositions, direct-indexed over the two covered blocks ----
+
+constexpr int MAX_DECOMPOSITION = 4;
+
+struct Decomposition {
+    char16_t chars[MAX_DECOMPOSITION];
+    uint8_t length;  // 0 = not decomposable
+};
+
+constexpr uint32_t LATIN_FIRST = 0x00C0;
+constexpr size_t LATIN_SIZE = 0x0190;   // U+00C0-024F
+constexpr uint32_t EXT_FIRST = 0x1E00;
+constexpr size_t EXT_SIZE = 0x0100;     // U+1E00-1EFF
+
+struct DecompositionTables {
+    std::array<Decomposition, LATIN_SIZE> latin;
+    std::array<Decomposition, EXT_SIZE> extended;
+
+    constexpr Decomposition* Find(uint32_t c) {
+        if (c - LATIN_FIRST < LATIN_SIZE) return &latin[c - LATIN_FIRST];
+        if (c - EXT_FIRST < EXT_SIZE) return &extended[c - EXT_FIRST];
+        return nullptr;
+    }
+};
+
+constexpr DecompositionTables BuildDecompositions() {
+    DecompositionTables t{};
+    // A composite's first element may itself be a composite (ệ = ẹ + U+0302);
+    // expanding in a few passes reaches the full decomposition whatever the order.
+    for (int pass = 0; pass < MAX_DECOMPOSITION; pass++) {
+        for (const auto& p : kCanonicalPairs) {
+            Decomposition d{};
+            const Decomposition* first = t.Find(p.first);
+            if (first && first->length > 0) {
+                for (int i = 0; i < first->length; i++) d.chars[i] = first->chars[i];
+                d.length = first->length;
+            } else {
+                d.chars[0] = p.first;
+                d.length = 1;
+            }
+            d.chars[d.length++] = p.mark;
+            *t.Find(p.composite) = d;
+        }
+    }
+    return t;
+}
+
+inline constexpr DecompositionTables kDecompositions = BuildDecompositions();
+
+inline const Decomposition* FindDecomposition(uint32_t c) {
+    if (c - LATIN_FIRST < LATIN_SIZE) return &kDecompositions.latin[c - LATIN_FIRST];
+    if (c - EXT_FIRST < EXT_SIZE) return &kDecompositions.extended[c - EXT_FIRST];
+    return nullptr;
+}
+
+// ---- Composition: open-addressing hash of (first, mark) -> composite ----
+
+constexpr size_t COMPOSE_SLOTS = 1024;  // power of two, load factor ~0.4
+
+struct ComposeEntry {
+    uint32_t key;  // first << 16 | mark, 0 = empty
+    char16_t composite;
+};
+
+constexpr uint32_t PairKey(uint32_t first, uint32_t mark) {
+    return (first << 16) | mark;
+}
+
+constexpr size_t PairSlot(uint32_t key) {
+    return static_cast<size_t>((key * 2654435761u) >> 22) & (COMPOSE_SLOTS - 1);
+}
+
+constexpr std::array<ComposeEntry, COMPOSE_SLOTS> BuildComposeTable() {
+    std::array<ComposeEntry, COMPOSE_SLOTS> t{};
+    for (const auto& p : kCanonicalPairs) {
+        uint32_t key = PairKey(p.first, p.mark);
+        size_t slot = PairSlot(key);
+        while (t[slot].key != 0) slot = (slot + 1) & (COMPOSE_SLOTS - 1);
+        t[slot] = {key, p.composite};
+    }
+    return t;
+}
+
+inline constexpr auto kCompose = BuildComposeTable();
+
+inline uint32_t Compose(uint32_t first, uint32_t mark) {
+    if (first > 0xFFFF) return 0;
+    uint32_t key = PairKey(first, mark);
+    for (size_t slot = PairSlot(key);; slot = (slot + 1) & (COMPOSE_SLOTS - 1)) {
+        if (kCompose[slot].key == key) return kCompose[slot].composite;
+        if (kCompose[slot].key == 0) return 0;
+    }
+}
+
+static_assert(PAIR_COUNT < COMPOSE_SLOTS / 2, "compose table too full");
+static_assert(kDecompositions.extended[0x1EC7 - EXT_FIRST].length == 3, "ệ decomposes to e + U+0323 + U+0302");
+static_assert(kDecompositions.extended[0x1EC7 - EXT_FIRST].chars[1] == 0x0323, "dot below sorts before circumflex");
+
+// Append c to out, moving a combining mark left past marks of higher class
+// (canonical ordering). Never reorders before floor.
+inline void AppendOrdered(std::wstring& out, wchar_t c, size_t floor) {
+    uint8_t cc = Ccc(static_cast<uint32_t>(c));
+    out += c;
+    if (cc == 0) return;
+    size_t k = out.size() - 1;
+    while (k > floor && Ccc(static_cast<uint32_t>(out[k - 1])) > cc) {
+        std::swap(out[k], out[k - 1]);
+        k--;
+    }
+}
+
+inline void AppendDecomposed(std::wstring& out, wchar_t c, size_t floor) {
+    const Decomposition* d = FindDecomposition(static_cast<uint32_t>(c));
+    if (d && d->length > 0) {
+        for (int i = 0; i < d->length; i++) AppendOrdered(out, static_cast<wchar_t>(d->chars[i]), floor);
+    } else {
+        AppendOrdered(out, c, floor);
+    }
+}
+
+// ---- Streaming steppers (used by VietNormalizer and the fused transcoders) ----
+
+// Appends the NFD form of characters to out. Marks are only reordered within
+// what this decomposer appended, never into text that was already in out.
+class Decomposer {
+public:
+    explicit Decomposer(std::wstring& out) : m_out(out), m_floor(out.size()) {}
+
+    void Put(wchar_t c) {
+        // Fast path: ASCII and anything below the first precomposed letter
+        if (static_cast<uint32_t>(c) < LATIN_FIRST) {
+            m_out += c;
+            return;
+        }
+        AppendDecomposed(m_out, c, m_floor);
+    }
+
+    void Flush() {}
+
+private:
+    std::wstring& m_out;
+    size_t m_floor;
+};
+
+// Feeds characters in; passes the NFC form to sink.Put(). A starter is held
+// until the next starter arrives, since following marks may combine with it.
+class Composer {
+public:
+    template <typename Sink>
+    void Put(wchar_t c, Sink& sink) {
+        if (Ccc(static_cast<uint32_t>(c)) == 0) {
+            Flush(sink);
+            m_starter = c;
+            m_haveStarter = true;
+            return;
+        }
+        // First mark after a starter: switch to the decomposed segment
+        if (m_segment.empty() && m_haveStarter) AppendDecomposed(m_segment, m_starter, 0);
+        AppendDecomposed(m_segment, c, 0);
+    }
+
+    template <typename Sink>
+    void Flush(Sink& sink) {
+        if (m_segment.empty()) {
+            // Fast path: a starter with no marks after it is already composed
+            // (every covered precomposed letter is its own NFC form)
+            if (m_haveStarter) sink.Put(m_starter);
+        } else {
+            size_t length = Recompose();
+            for (size_t j = 0; j < length; j++) sink.Put(m_segment[j]);
+            m_segment.clear();
+        }
+        m_haveStarter = false;
+    }
+
+private:
+    // Compose the ordered segment in place; returns its new length
+    size_t Recompose() {
+        bool haveStarter = Ccc(static_cast<uint32_t>(m_segment[0])) == 0;
+        uint32_t starter = static_cast<uint32_t>(m_segment[0]);
+        uint8_t lastCcc = 0;  // class of the last mark left uncombined
+        size_t length = 1;
+
+        for (size_t j = 1; j < m_segment.size(); j++) {
+            uint32_t ch = static_cast<uint32_t>(m_segment[j]);
+            uint8_t cc = Ccc(ch);
+            if (haveStarter && (lastCcc == 0 || lastCcc < cc)) {
+                uint32_t composite = Compose(starter, ch);
+                if (composite != 0) {
+                    starter = composite;
+                    m_segment[0] = static_cast<wchar_t>(composite);
+                    continue;
+                }
+            }
+            lastCcc = cc;
+            m_segment[length++] = static_cast<wchar_t>(ch);
+        }
+        return length;
+    }
+
+    std::wstring m_segment;  // decomposed starter + marks, canonically ordered
+    wchar_t m_starter = 0;
+    bool m_haveStarter = false;
+};
+
+}  // namespace NormalizerTables
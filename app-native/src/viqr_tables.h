@@ -0,0 +1,275 @@
+// ViKey - VIQR Tables
+// viqr_tables.h
+// VIQR (RFC 1456) mnemonic spelling: compile-time DFA and streaming steppers
+
+#pragma once
+
+#include "viet_chars.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// VIQR spells a letter as its ASCII base followed by mnemonics:
+//   shape  ( breve   ^ circumflex   + horn
+//   tone   ` grave   ? hook   ~ tilde   ' acute   . dot below
+//   dd / DD for đ / Đ
+// "Vie^.t" = "Việt". A backslash makes the next mnemonic literal ("a\." is
+// "a."). The decoder is a DFA whose states are the letters a mnemonic may
+// still modify; both shape-then-tone and tone-then-shape orders are accepted.
+namespace ViqrTables {
+
+using namespace VietChars;
+
+constexpr char SHAPE_CHARS[4] = {0, '(', '^', '+'};                // by Shape
+constexpr char TONE_CHARS[TONE_COUNT] = {0, '`', '?', '~', '\'', '.'};  // by Tone
+
+// Mnemonic classes: 1..3 shapes, 4..8 tones, 9 = the second d of đ
+constexpr int SHAPE_CLASS = 0;
+constexpr int TONE_CLASS = 3;
+constexpr int STROKE_CLASS = 9;
+constexpr int MARK_CLASSES = 10;
+
+constexpr std::array<uint8_t, 128> BuildMarkClasses() {
+    std::array<uint8_t, 128> t{};
+    for (int s = 1; s < 4; s++) t[static_cast<uint8_t>(SHAPE_CHARS[s])] = static_cast<uint8_t>(SHAPE_CLASS + s);
+    for (int k = 1; k < TONE_COUNT; k++) t[static_cast<uint8_t>(TONE_CHARS[k])] = static_cast<uint8_t>(TONE_CLASS + k);
+    t['d'] = t['D'] = STROKE_CLASS;
+    return t;
+}
+
+inline constexpr auto kMarkClass = BuildMarkClasses();
+
+// ---- States: every vowel letter (group x tone x case), then d D đ Đ ----
+
+constexpr int VOWEL_STATES = GROUP_COUNT * TONE_COUNT * 2;
+constexpr int STATE_COUNT = VOWEL_STATES + 4;
+constexpr uint8_t STATE_d = VOWEL_STATES + 1;
+constexpr uint8_t STATE_D = VOWEL_STATES + 2;
+constexpr uint8_t STATE_d_STROKE = VOWEL_STATES + 3;
+constexpr uint8_t STATE_D_STROKE = VOWEL_STATES + 4;
+
+constexpr uint8_t VowelState(int group, int tone, bool upper) {
+    return static_cast<uint8_t>(1 + (group * TONE_COUNT + tone) * 2 + (upper ? 1 : 0));
+}
+
+struct Dfa {
+    std::array<char16_t, STATE_COUNT + 1> letter;                     // letter held in each state
+    std::array<std::array<uint8_t, MARK_CLASSES>, STATE_COUNT + 1> next;  // 0 = does not combine
+    std::array<uint8_t, 128> start;                                   // ASCII letter -> state
+};
+
+constexpr Dfa BuildDfa() {
+    Dfa t{};
+    for (int g = 0; g < GROUP_COUNT; g++) {
+        const VowelGroup& group = kVowelGroups[g];
+        for (int tone = 0; tone < TONE_COUNT; tone++) {
+            for (int upper = 0; upper < 2; upper++) {
+                uint8_t s = VowelState(g, tone, upper != 0);
+                char32_t lower = group.forms[tone];
+                t.letter[s] = static_cast<char16_t>(upper ? ToUpper(lower) : lower);
+
+                if (tone == 0) {
+                    for (int k = 1; k < TONE_COUNT; k++) t.next[s][TONE_CLASS + k] = VowelState(g, k, upper != 0);
+                }
+                if (group.shape == Shape::None) {
+                    for (int h = 0; h < GROUP_COUNT; h++) {
+                        const VowelGroup& shaped = kVowelGroups[h];
+                        if (shaped.base == group.base && shaped.shape != Shape::None) {
+                            t.next[s][SHAPE_CLASS + static_cast<int>(shaped.shape)] = VowelState(h, tone, upper != 0);
+                        }
+                    }
+                }
+                if (group.shape == Shape::None && tone == 0) {
+                    char base = group.base;
+                    t.start[static_cast<uint8_t>(upper ? base - 0x20 : base)] = s;
+                }
+            }
+        }
+    }
+
+    t.letter[STATE_d] = 'd';
+    t.letter[STATE_D] = 'D';
+    t.letter[STATE_d_STROKE] = static_cast<char16_t>(LOWER_D_STROKE);
+    t.letter[STATE_D_STROKE] = static_cast<char16_t>(UPPER_D_STROKE);
+    t.next[STATE_d][STROKE_CLASS] = STATE_d_STROKE;
+    t.next[STATE_D][STROKE_CLASS] = STATE_D_STROKE;
+    t.start['d'] = STATE_d;
+    t.start['D'] = STATE_D;
+    return t;
+}
+
+inline constexpr Dfa kDfa = BuildDfa();
+
+static_assert(kDfa.letter[kDfa.next[kDfa.next[kDfa.start['e']][SHAPE_CLASS + 2]][TONE_CLASS + 5]] == 0x1EC7,
+              "e ^ . must spell ệ");
+static_assert(kDfa.letter[kDfa.next[kDfa.next[kDfa.start['O']][TONE_CLASS + 4]][SHAPE_CLASS + 3]] == 0x1EDA,
+              "O ' + must spell Ớ");
+
+// ---- Encoder: letter -> spelling, over the two blocks holding Vietnamese letters ----
+
+constexpr uint32_t LATIN_FIRST = 0x00C0;
+constexpr size_t LATIN_SIZE = 0x0100;
+constexpr uint32_t EXT_FIRST = 0x1EA0;
+constexpr size_t EXT_SIZE = 0x0060;
+
+struct Spelling {
+    char chars[3];
+    uint8_t length;  // 0 = not a Vietnamese letter
+    uint8_t state;   // DFA state the spelling leaves the decoder in
+};
+
+struct SpellingTables {
+    std::array<Spelling, LATIN_SIZE> latin;
+    std::array<Spelling, EXT_SIZE> extended;
+
+    constexpr Spelling* Find(uint32_t c) {
+        if (c - LATIN_FIRST < LATIN_SIZE) return &latin[c - LATIN_FIRST];
+        if (c - EXT_FIRST < EXT_SIZE) return &extended[c - EXT_FIRST];
+        return nullptr;
+    }
+};
+
+constexpr SpellingTables BuildSpellings() {
+    SpellingTables t{};
+    for (int g = 0; g < GROUP_COUNT; g++) {
+        const VowelGroup& group = kVowelGroups[g];
+        for (int tone = 0; tone < TONE_COUNT; tone++) {
+            for (int upper = 0; upper < 2; upper++) {
+                char32_t lower = group.forms[tone];
+                Spelling* sp = t.Find(upper ? ToUpper(lower) : lower);
+                if (!sp) continue;  // plain ASCII vowel
+                sp->chars[sp->length++] = upper ? static_cast<char>(group.base - 0x20) : group.base;
+                if (group.shape != Shape::None) sp->chars[sp->length++] = SHAPE_CHARS[static_cast<int>(group.shape)];
+                if (tone != 0) sp->chars[sp->length++] = TONE_CHARS[tone];
+                sp->state = VowelState(g, tone, upper != 0);
+            }
+        }
+    }
+    *t.Find(LOWER_D_STROKE) = {{'d', 'd', 0}, 2, STATE_d_STROKE};
+    *t.Find(UPPER_D_STROKE) = {{'D', 'D', 0}, 2, STATE_D_STROKE};
+    return t;
+}
+
+inline constexpr SpellingTables kSpellings = BuildSpellings();
+
+inline const Spelling* FindSpelling(uint32_t c) {
+    if (c - LATIN_FIRST < LATIN_SIZE) return &kSpellings.latin[c - LATIN_FIRST];
+    if (c - EXT_FIRST < EXT_SIZE) return &kSpellings.extended[c - EXT_FIRST];
+    return nullptr;
+}
+
+// Characters a backslash makes literal
+inline bool IsEscapable(uint32_t c) {
+    return c < 0x80 && (kMarkClass[c] != 0 || c == '\\');
+}
+
+// True when ASCII c would be read as a mnemonic for the letter in state
+inline bool Combines(unsigned state, uint32_t c) {
+    return state != 0 && c < 0x80 && kMarkClass[c] != 0 && kDfa.next[state][kMarkClass[c]] != 0;
+}
+
+// ---- Streaming steppers (used by the fused transcoders) ----
+
+// Feeds VIQR text in; passes Unicode letters to sink.Put()
+class Decoder {
+public:
+    template <typename Sink>
+    void Put(wchar_t ch, Sink& sink) {
+        uint32_t c = static_cast<uint32_t>(ch);
+        if (m_escape) {
+            m_escape = false;
+            if (IsEscapable(c)) {
+                sink.Put(ch);
+                return;
+            }
+            sink.Put(L'\\');
+        }
+
+        if (m_state != 0) {
+            if (Combines(m_state, c)) {
+                m_state = kDfa.next[m_state][kMarkClass[c]];
+                return;
+            }
+            sink.Put(static_cast<wchar_t>(kDfa.letter[m_state]));
+            m_state = 0;
+        }
+
+        if (c == '\\') {
+            m_escape = true;
+        } else if (c < 0x80 && kDfa.start[c] != 0) {
+            m_state = kDfa.start[c];
+        } else {
+            sink.Put(ch);
+        }
+    }
+
+    template <typename Sink>
+    void Flush(Sink& sink) {
+        if (m_state != 0) sink.Put(static_cast<wchar_t>(kDfa.letter[m_state]));
+        if (m_escape) sink.Put(L'\\');
+        m_state = 0;
+        m_escape = false;
+    }
+
+private:
+    unsigned m_state = 0;
+    bool m_escape = false;
+};
+
+// Appends the VIQR spelling of Unicode text to out. It tracks the state the
+// decoder will be in, and adds a backslash wherever a literal character
+// would otherwise be read as a mnemonic, so decoding gives the input back.
+class Encoder {
+public:
+    explicit Encoder(std::wstring& out) : m_out(out) {}
+
+    void Put(wchar_t ch) {
+        uint32_t c = static_cast<uint32_t>(ch);
+        if (m_backslash) {
+            // Hold a backslash back until we know whether it needs escaping
+            m_backslash = false;
+            m_out += L'\\';
+            if (IsEscapable(c)) m_out += L'\\';
+        }
+
+        if (c == '\\') {
+            m_backslash = true;
+            m_state = 0;
+            return;
+        }
+
+        if (c < 0x80) {
+            bool escape = Combines(m_state, c);
+            if (escape) m_out += L'\\';
+            m_out += ch;
+            m_state = escape ? 0 : kDfa.start[c];
+            return;
+        }
+
+        const Spelling* sp = FindSpelling(c);
+        if (sp && sp->length > 0) {
+            // Only a plain d/D can absorb the first letter of a spelling
+            // ("d" + "dd"); escape that d instead
+            if (Combines(m_state, static_cast<uint32_t>(sp->chars[0]))) m_out.insert(m_out.size() - 1, 1, L'\\');
+            for (int i = 0; i < sp->length; i++) m_out += static_cast<wchar_t>(sp->chars[i]);
+            m_state = sp->state;
+            return;
+        }
+
+        m_out += ch;
+        m_state = 0;
+    }
+
+    void Flush() {
+        if (m_backslash) m_out += L'\\';
+        m_backslash = false;
+    }
+
+private:
+    std::wstring& m_out;
+    unsigned m_state = 0;
+    bool m_backslash = false;
+};
+
+}  // namespace ViqrTables
@@ -0,0 +1,28 @@
+// ViKey - VNI Windows Codec Implementation
+// vni_codec.cpp
+// Project: ViKey | Author: Trần Công Sinh | https://github.com/kmis8x/ViKey
+
+#include "vni_codec.h"
+#include "vni_tables.h"
+
+namespace {
+
+struct AppendSink {
+    std::wstring& out;
+    void Put(wchar_t c) { out += c; }
+};
+
+}  // namespace
+
+void VniCodec::Decode(const wchar_t* text, size_t len, std::wstring& out) {
+    out.reserve(out.size() + len);
+    AppendSink sink{out};
+    VniTables::Decoder decoder;
+    for (size_t i = 0; i < len; i++) decoder.Put(text[i], sink);
+    decoder.Flush(sink);
+}
+
+void VniCodec::Encode(const wchar_t* text, size_t len, std::wstring& out) {
+    out.reserve(out.size() + len + len / 2);
+    for (size_t i = 0; i < len; i++) VniTables::EncodeChar(text[i], out);
+}
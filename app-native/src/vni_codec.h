@@ -0,0 +1,21 @@
+// ViKey - VNI Windows Codec
+// vni_codec.h
+// VNI Windows <-> Unicode, including the base letter + diacritic byte pairs
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+// VNI text is held one byte per wchar_t, like the other legacy encodings.
+// Most accented vowels are two bytes: the base letter followed by a diacritic
+// byte ("ế" = 'e' 0xE1). Decoding runs a table-driven state machine whose
+// tables are generated at compile time from VietChars, in a single pass.
+namespace VniCodec {
+    // Append the Unicode (NFC) form of VNI input to out
+    void Decode(const wchar_t* text, size_t len, std::wstring& out);
+
+    // Append the VNI form of Unicode (NFC) input to out.
+    // Characters VNI cannot represent pass through unchanged.
+    void Encode(const wchar_t* text, size_t len, std::wstring& out);
+}
@@ -0,0 +1,204 @@
+// ViKey - VNI Windows Tables
+// vni_tables.h
+// Compile-time VNI tables and the streaming encoder/decoder built on them
+
+#pragma once
+
+#include "viet_chars.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace VniTables {
+
+using namespace VietChars;
+
+// Diacritic bytes (lowercase; the uppercase byte is always 0x20 lower)
+constexpr uint8_t TONE_MARKS[TONE_COUNT] = {0x00, 0xF8, 0xFB, 0xF5, 0xF9, 0xEF};
+constexpr uint8_t BREVE_MARKS[TONE_COUNT] = {0xEA, 0xE8, 0xFA, 0xFC, 0xE9, 0xEB};
+constexpr uint8_t CIRCUMFLEX_MARKS[TONE_COUNT] = {0xE2, 0xE0, 0xE5, 0xE3, 0xE1, 0xE4};
+
+// Letters VNI stores as a single byte
+constexpr uint8_t I_LETTERS[TONE_COUNT] = {'i', 0xEC, 0xE6, 0xF3, 0xED, 0xF2};
+constexpr uint8_t O_HORN = 0xF4;    // ơ, also the base for ờ ở ỡ ớ ợ
+constexpr uint8_t U_HORN = 0xF6;    // ư, also the base for ừ ử ữ ứ ự
+constexpr uint8_t Y_DOT = 0xEE;     // ỵ
+constexpr uint8_t D_STROKE = 0xF1;  // đ
+
+// Lead byte plus optional diacritic byte (mark == 0 for single-byte letters)
+struct Sequence {
+    uint8_t lead;
+    uint8_t mark;
+};
+
+struct Letter {
+    char32_t codePoint;
+    Sequence vni;
+};
+
+constexpr Sequence LowerSequence(const VowelGroup& g, int tone) {
+    if (g.base == 'i') return {I_LETTERS[tone], 0};
+    if (g.base == 'y' && tone == static_cast<int>(Tone::Dot)) return {Y_DOT, 0};
+
+    uint8_t lead = static_cast<uint8_t>(g.base);
+    if (g.shape == Shape::Horn) lead = (g.base == 'o') ? O_HORN : U_HORN;
+
+    switch (g.shape) {
+        case Shape::Breve: return {lead, BREVE_MARKS[tone]};
+        case Shape::Circumflex: return {lead, CIRCUMFLEX_MARKS[tone]};
+        default: return {lead, TONE_MARKS[tone]};
+    }
+}
+
+constexpr Sequence UpperSequence(Sequence s) {
+    return {static_cast<uint8_t>(s.lead - 0x20), static_cast<uint8_t>(s.mark ? s.mark - 0x20 : 0)};
+}
+
+constexpr int LETTER_COUNT = GROUP_COUNT * TONE_COUNT * 2 + 2;
+
+constexpr std::array<Letter, LETTER_COUNT> BuildLetters() {
+    std::array<Letter, LETTER_COUNT> letters{};
+    int n = 0;
+    for (const auto& g : kVowelGroups) {
+        for (int tone = 0; tone < TONE_COUNT; tone++) {
+            Sequence lower = LowerSequence(g, tone);
+            letters[n++] = {g.forms[tone], lower};
+            letters[n++] = {ToUpper(g.forms[tone]), UpperSequence(lower)};
+        }
+    }
+    letters[n++] = {LOWER_D_STROKE, {D_STROKE, 0}};
+    letters[n++] = {UPPER_D_STROKE, {static_cast<uint8_t>(D_STROKE - 0x20), 0}};
+    return letters;
+}
+
+inline constexpr auto kLetters = BuildLetters();
+
+// ---- Encoder: code point -> packed (lead | mark << 8), 0 = pass through ----
+
+constexpr char32_t LATIN_FIRST = 0x00C0;    // À .. ư
+constexpr size_t LATIN_SIZE = 0x0100;
+constexpr char32_t EXT_FIRST = 0x1EA0;      // Ạ .. ỹ
+constexpr size_t EXT_SIZE = 0x0060;
+
+struct EncodeTables {
+    std::array<uint16_t, LATIN_SIZE> latin;
+    std::array<uint16_t, EXT_SIZE> extended;
+};
+
+constexpr EncodeTables BuildEncodeTables() {
+    EncodeTables t{};
+    for (const auto& letter : kLetters) {
+        uint16_t packed = static_cast<uint16_t>(letter.vni.lead | (letter.vni.mark << 8));
+        if (letter.codePoint >= LATIN_FIRST && letter.codePoint < LATIN_FIRST + LATIN_SIZE) {
+            t.latin[letter.codePoint - LATIN_FIRST] = packed;
+        } else if (letter.codePoint >= EXT_FIRST && letter.codePoint < EXT_FIRST + EXT_SIZE) {
+            t.extended[letter.codePoint - EXT_FIRST] = packed;
+        }
+    }
+    return t;
+}
+
+inline constexpr EncodeTables kEncode = BuildEncodeTables();
+
+// ---- Decoder: DFA over bytes ----
+// State 0 is idle; states 1..BASE_COUNT mean "holding a base letter that a
+// diacritic byte may still modify". combine[state][byte] is the letter the
+// pair decodes to, or 0 when the byte does not attach to that base.
+
+constexpr int BASE_COUNT = 14;  // a e o u y ơ ư, both cases
+
+struct DecodeTables {
+    std::array<uint8_t, 256> baseState;                       // 0 = not a base
+    std::array<char16_t, 256> single;                         // byte decoded on its own
+    std::array<std::array<char16_t, 256>, BASE_COUNT + 1> combine;
+};
+
+constexpr DecodeTables BuildDecodeTables() {
+    DecodeTables t{};
+    for (int b = 0; b < 256; b++) t.single[b] = static_cast<char16_t>(b);
+
+    int states = 0;
+    for (const auto& letter : kLetters) {
+        const Sequence& s = letter.vni;
+        if (s.mark == 0) {
+            t.single[s.lead] = static_cast<char16_t>(letter.codePoint);
+            continue;
+        }
+        if (t.baseState[s.lead] == 0) t.baseState[s.lead] = static_cast<uint8_t>(++states);
+        auto& row = t.combine[t.baseState[s.lead]];
+        row[s.mark] = static_cast<char16_t>(letter.codePoint);
+
+        // Also accept the diacritic in the other case ("VIEät" after a careless
+        // caps toggle); the base decides the letter case. A base only ever
+        // takes diacritics of its own case, so this never shadows a real pair.
+        row[s.mark ^ 0x20] = static_cast<char16_t>(letter.codePoint);
+    }
+    return t;
+}
+
+inline constexpr DecodeTables kDecode = BuildDecodeTables();
+
+static_assert(kDecode.combine[kDecode.baseState['e']][0xE4] == 0x1EC7, "e + 0xE4 must decode to ệ");
+static_assert(kDecode.combine[kDecode.baseState[O_HORN]][0xF8] == 0x1EDD, "0xF4 + 0xF8 must decode to ờ");
+static_assert(kDecode.combine[kDecode.baseState['A']][0xF9] == 0x00C1, "mixed-case pair keeps the base case");
+static_assert(kEncode.extended[0x1EC7 - EXT_FIRST] == ('e' | (0xE4 << 8)), "ệ must encode to e + 0xE4");
+
+// ---- Streaming steppers (used by VniCodec and the fused transcoders) ----
+
+// Feeds VNI bytes in; passes decoded Unicode characters to sink.Put()
+class Decoder {
+public:
+    template <typename Sink>
+    void Put(wchar_t ch, Sink& sink) {
+        uint32_t c = static_cast<uint32_t>(ch);
+        if (m_state != 0) {
+            char16_t combined = (c < 0x100) ? kDecode.combine[m_state][c] : 0;
+            m_state = 0;
+            if (combined != 0) {
+                sink.Put(static_cast<wchar_t>(combined));
+                return;
+            }
+            sink.Put(m_held);
+        }
+
+        if (c >= 0x100) {
+            sink.Put(ch);
+        } else if (kDecode.baseState[c] != 0) {
+            m_state = kDecode.baseState[c];
+            m_held = static_cast<wchar_t>(kDecode.single[c]);
+        } else {
+            sink.Put(static_cast<wchar_t>(kDecode.single[c]));
+        }
+    }
+
+    template <typename Sink>
+    void Flush(Sink& sink) {
+        if (m_state != 0) sink.Put(m_held);
+        m_state = 0;
+    }
+
+private:
+    unsigned m_state = 0;
+    wchar_t m_held = 0;
+};
+
+// Append the VNI form of one Unicode character to out
+inline void EncodeChar(wchar_t ch, std::wstring& out) {
+    uint32_t c = static_cast<uint32_t>(ch);
+    uint16_t packed = 0;
+    if (c - LATIN_FIRST < LATIN_SIZE) {
+        packed = kEncode.latin[c - LATIN_FIRST];
+    } else if (c - EXT_FIRST < EXT_SIZE) {
+        packed = kEncode.extended[c - EXT_FIRST];
+    }
+
+    if (packed == 0) {
+        out += ch;
+        return;
+    }
+    out += static_cast<wchar_t>(packed & 0xFF);
+    if (packed >> 8) out += static_cast<wchar_t>(packed >> 8);
+}
+
+}  // namespace VniTables
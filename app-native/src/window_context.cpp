@@ -0,0 +1,81 @@
+// ViKey - Per-Window Contexts Implementation
+// window_context.cpp
+
+#include "window_context.h"
+#include <iterator>
+
+// Heap bytes behind a string: none while it fits in the small-string buffer
+static size_t HeapBytes(const std::wstring& text) {
+    const char* data = reinterpret_cast<const char*>(text.data());
+    const char* self = reinterpret_cast<const char*>(&text);
+    bool inlined = data >= self && data < self + sizeof(text);
+    return inlined ? 0 : (text.capacity() + 1) * sizeof(wchar_t);
+}
+
+WindowContextStore::WindowContextStore(size_t maxContexts, size_t maxBytes)
+    : m_maxContexts(maxContexts > 0 ? maxContexts : 1), m_maxBytes(maxBytes) {
+    m_index.reserve(m_maxContexts + 1);
+}
+
+size_t WindowContextStore::EntryBytes(const WindowContext& context) {
+    // A list node is the entry plus two links; an index node is the key,
+    // the iterator, a link and the cached hash
+    size_t listNode = sizeof(Entry) + 2 * sizeof(void*);
+    size_t indexNode = sizeof(WindowKey) + sizeof(EntryList::iterator) + sizeof(void*) + sizeof(size_t);
+    return listNode + indexNode + HeapBytes(context.app) + context.engineSnapshot.capacity();
+}
+
+size_t WindowContextStore::MemoryUsage() const {
+    return m_entryBytes + m_index.bucket_count() * sizeof(void*);
+}
+
+const WindowContext* WindowContextStore::Find(const WindowKey& key) {
+    auto it = m_index.find(key);
+    if (it == m_index.end()) {
+        m_stats.misses++;
+        return nullptr;
+    }
+    m_stats.hits++;
+    m_entries.splice(m_entries.begin(), m_entries, it->second);
+    return &it->second->context;
+}
+
+void WindowContextStore::Put(const WindowKey& key, WindowContext context) {
+    size_t bytes = EntryBytes(context);
+    auto it = m_index.find(key);
+    if (it != m_index.end()) {
+        Entry& entry = *it->second;
+        m_entryBytes = m_entryBytes - entry.bytes + bytes;
+        entry.context = std::move(context);
+        entry.bytes = bytes;
+        m_entries.splice(m_entries.begin(), m_entries, it->second);
+    } else {
+        m_entries.push_front({key, std::move(context), bytes});
+        m_index.emplace(key, m_entries.begin());
+        m_entryBytes += bytes;
+    }
+
+    while (m_entries.size() > 1 && (m_entries.size() > m_maxContexts || MemoryUsage() > m_maxBytes)) {
+        Remove(std::prev(m_entries.end()));
+        m_stats.evictions++;
+    }
+}
+
+bool WindowContextStore::Erase(const WindowKey& key) {
+    auto it = m_index.find(key);
+    if (it == m_index.end()) return false;
+    Remove(it->second);
+    return true;
+}
+
+void WindowContextStore::Clear() {
+    m_entries.clear();
+    m_index.clear();
+    m_entryBytes = 0;
+}
+
+void WindowContextStore::Remove(EntryList::iterator it) {
+    m_entryBytes -= it->bytes;
+    m_index.erase(it->key);
+    m_entries.erase(it);
+}
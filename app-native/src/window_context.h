@@ -0,0 +1,98 @@
+// ViKey - Per-Window Contexts
+// window_context.h
+// IME state remembered per foreground window, in a store bounded by count
+// and by memory with least-recently-used eviction
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// A top-level window. HWND values are recycled, so the owning process is
+// part of the key: a new window that reuses a handle in another process
+// starts with a fresh context.
+struct WindowKey {
+    uint64_t window = 0;   // HWND value
+    uint32_t process = 0;  // process id
+
+    bool operator==(const WindowKey& other) const { return window == other.window && process == other.process; }
+};
+
+struct WindowKeyHash {
+    size_t operator()(const WindowKey& key) const {
+        uint64_t h = key.window * 0x9E3779B97F4A7C15ull ^ key.process;
+        return static_cast<size_t>(h ^ (h >> 32));
+    }
+};
+
+// How text reaches the window (TextSender modes)
+enum class InjectionProfile : uint8_t {
+    Fast = 0,      // one batched SendInput
+    Slow = 1,      // events one by one, for terminals
+    Clipboard = 2  // clipboard + Ctrl+V, for stubborn apps
+};
+
+struct WindowContext {
+    std::wstring app;       // executable name, for per-app state
+    bool enabled = false;   // IME mode while the window was focused
+    bool excluded = false;  // on the exclusion list when first seen
+    int encoding = 0;       // OutputEncoding
+    InjectionProfile injection = InjectionProfile::Fast;
+    std::vector<uint8_t> engineSnapshot;  // the engine's word in progress; opaque here
+};
+
+class WindowContextStore {
+public:
+    static constexpr size_t DEFAULT_MAX_CONTEXTS = 256;
+    static constexpr size_t DEFAULT_MAX_BYTES = 256 * 1024;
+
+    explicit WindowContextStore(size_t maxContexts = DEFAULT_MAX_CONTEXTS, size_t maxBytes = DEFAULT_MAX_BYTES);
+
+    // The window's context, now the most recently used; null if not stored
+    const WindowContext* Find(const WindowKey& key);
+
+    // Store or replace a window's context as the most recently used one, then
+    // evict least recently used contexts until both bounds hold again. The
+    // newest context is always kept, even if it alone is over maxBytes.
+    void Put(const WindowKey& key, WindowContext context);
+
+    bool Erase(const WindowKey& key);
+    void Clear();
+
+    size_t Size() const { return m_entries.size(); }
+
+    // Estimated bytes held: entries with their list and index nodes, the heap
+    // blocks of app names and snapshots, and the index's bucket array
+    size_t MemoryUsage() const;
+
+    // What one context costs in MemoryUsage()
+    static size_t EntryBytes(const WindowContext& context);
+
+    struct Stats {
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        uint64_t evictions = 0;
+    };
+    const Stats& GetStats() const { return m_stats; }
+
+private:
+    struct Entry {
+        WindowKey key;
+        WindowContext context;
+        size_t bytes;  // EntryBytes(context) when stored
+    };
+    using EntryList = std::list<Entry>;  // most recently used first
+
+    void Remove(EntryList::iterator it);
+
+    const size_t m_maxContexts;
+    const size_t m_maxBytes;
+    EntryList m_entries;
+    std::unordered_map<WindowKey, EntryList::iterator, WindowKeyHash> m_index;
+    size_t m_entryBytes = 0;  // sum of Entry::bytes
+    Stats m_stats;
+};
@@ -0,0 +1,97 @@
+// ViKey - Stand-in Rust Core for Tests
+// fake_core.h
+// A CoreApi over functions that record every call. Unless a test queues
+// other answers, a key is answered with one character (keycode + 'a') and a
+// mask that passes Space through.
+
+#pragma once
+
+#include <deque>
+#include <string>
+#include <vector>
+#include "core_engine.h"
+#include "result_cache.h"
+
+// macOS keycodes the fake core treats specially
+static const uint16_t FAKE_KEY_SPACE = 49;
+
+struct FakeCore {
+    std::vector<uint32_t> keys;      // strokes sent to ime_key_ext
+    std::vector<uint32_t> replayed;  // strokes sent to ime_replay
+    std::deque<NativeResult> answers;  // the next keys' results, else the default
+    int clears = 0;
+    int clearAlls = 0;
+    int freed = 0;
+};
+inline FakeCore g_core;
+
+inline NativeResult FakeAnswer(ImeAction action, uint8_t backspace, const std::u32string& text, uint8_t flags = 0) {
+    NativeResult result = {};
+    result.action = static_cast<uint8_t>(action);
+    result.backspace = backspace;
+    result.count = static_cast<uint8_t>(text.size());
+    result.flags = flags;
+    for (size_t i = 0; i < text.size(); i++) result.chars[i] = text[i];
+    return result;
+}
+
+inline void FakeInit() {}
+inline void FakeClear() { g_core.clears++; }
+inline void FakeClearAll() { g_core.clearAlls++; }
+inline void FakeFree(NativeResult* result) { g_core.freed++; delete result; }
+inline void FakeMethod(uint8_t) {}
+inline void FakeFlag(bool) {}
+
+inline NativeResult* FakeKeyExt(uint16_t key, bool caps, bool, bool shift) {
+    g_core.keys.push_back(ResultCache::Stroke(key, caps, shift));
+    if (!g_core.answers.empty()) {
+        NativeResult* result = new NativeResult(g_core.answers.front());
+        g_core.answers.pop_front();
+        return result;
+    }
+    NativeResult* result = new NativeResult(FakeAnswer(ImeAction::Send, 0, std::u32string(1, U'a' + key),
+                                                       ImeResult::FLAG_KEY_CONSUMED | ImeResult::FLAG_PASSTHROUGH_MASK));
+    result->passthrough[FAKE_KEY_SPACE >> 6] = 1ull << (FAKE_KEY_SPACE & 63);
+    return result;
+}
+
+inline NativeResult* FakeKey(uint16_t key, bool caps, bool ctrl) {
+    return FakeKeyExt(key, caps, ctrl, false);
+}
+
+inline void FakeReplay(const uint32_t* strokes, int64_t len) {
+    g_core.replayed.insert(g_core.replayed.end(), strokes, strokes + len);
+}
+
+// A fresh fake core (g_core is reset)
+inline CoreApi FakeCoreApi() {
+    g_core = FakeCore();
+    CoreApi api;
+    api.ime_init = FakeInit;
+    api.ime_clear = FakeClear;
+    api.ime_clear_all = FakeClearAll;
+    api.ime_free = FakeFree;
+    api.ime_method = FakeMethod;
+    api.ime_enabled = FakeFlag;
+    api.ime_modern = FakeFlag;
+    api.ime_english_auto_restore = FakeFlag;
+    api.ime_auto_capitalize = FakeFlag;
+    api.ime_skip_w_shortcut = FakeFlag;
+    api.ime_bracket_shortcut = FakeFlag;
+    api.ime_esc_restore = FakeFlag;
+    api.ime_free_tone = FakeFlag;
+    api.ime_allow_foreign_consonants = FakeFlag;
+    api.ime_key = FakeKey;
+    api.ime_key_ext = FakeKeyExt;
+    api.ime_replay = FakeReplay;
+    return api;
+}
+
+// `engine` over a fresh fake core, set up as the app sets up RustBridge
+inline void StartFakeEngine(CoreEngine& engine, const SettingsSnapshot& settings = SettingsSnapshot()) {
+    engine.Bind(FakeCoreApi());
+    engine.SetEnabled(settings.enabled);
+    engine.SetMethod(settings.method);
+    engine.ApplySettings(settings);
+    engine.ClearAll();
+}
@@ -0,0 +1,257 @@
+// ViKey - App State Journal Tests
+// test_app_state_journal.cpp
+// Replay, torn-tail recovery, compaction and concurrent recording
+
+#include "app_state_journal.h"
+#include "binary_io.h"
+#include "test_common.h"
+
+namespace fs = std::filesystem;
+
+static fs::path TestPath(const char* name) {
+    fs::path path = fs::temp_directory_path() / (std::string("vikey_test_") + name + ".journal");
+    fs::remove(path);
+    return path;
+}
+
+static bool SameState(const AppStateMap& a, const AppStateMap& b) {
+    if (a.size() != b.size()) return false;
+    for (const auto& item : a) {
+        auto it = b.find(item.first);
+        if (it == b.end() || it->second.enabled != item.second.enabled || it->second.encoding != item.second.encoding) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static void TestReplay() {
+    fs::path path = TestPath("replay");
+    {
+        AppStateJournal journal(path);
+        AppStateMap states;
+        CHECK(!journal.Load(states));  // no file yet
+        journal.RecordEnabled(L"notepad.exe", true);
+        journal.RecordEnabled(L"code.exe", true);
+        journal.RecordEncoding(L"winword.exe", 2);
+        journal.RecordEnabled(L"code.exe", false);
+        journal.RecordEnabled(L"mstsc.exe", true);
+        journal.RecordClear(L"mstsc.exe");
+        journal.RecordEnabled(L"tiếng việt.exe", true);
+    }
+
+    AppStateJournal journal(path);
+    AppStateMap states;
+    CHECK(journal.Load(states));
+    CHECK_EQ(states.size(), 4u);
+    CHECK(states[L"notepad.exe"].enabled);
+    CHECK(!states[L"code.exe"].enabled);
+    CHECK(!states[L"winword.exe"].enabled && states[L"winword.exe"].encoding == 2);
+    CHECK(states.count(L"mstsc.exe") == 0);
+    CHECK(states[L"tiếng việt.exe"].enabled);
+    fs::remove(path);
+}
+
+static void TestAppendsBetweenStarts() {
+    fs::path path = TestPath("appends");
+    {
+        AppStateJournal journal(path);
+        AppStateMap states;
+        journal.Load(states);
+        journal.RecordEnabled(L"a.exe", true);
+    }
+    {
+        AppStateJournal journal(path);
+        AppStateMap states;
+        CHECK(journal.Load(states));
+        journal.RecordEnabled(L"b.exe", true);
+        journal.Flush();
+
+        // The second start appended to the file rather than rewriting it
+        AppStateJournal::Stats stats = journal.GetStats();
+        CHECK_EQ(stats.appended, 1u);
+        CHECK_EQ(stats.compactions, 0u);
+    }
+    AppStateJournal journal(path);
+    AppStateMap states;
+    CHECK(journal.Load(states));
+    CHECK(states.size() == 2 && states[L"a.exe"].enabled && states[L"b.exe"].enabled);
+    fs::remove(path);
+}
+
+static void TestTornTailIsDropped() {
+    fs::path path = TestPath("torn");
+    {
+        AppStateJournal journal(path);
+        AppStateMap states;
+        journal.Load(states);
+        journal.RecordEnabled(L"a.exe", true);
+        journal.Flush();
+        journal.RecordEnabled(L"b.exe", true);
+    }
+    std::string bytes;
+    CHECK(ReadWholeFile(path, bytes));
+    size_t full = bytes.size();
+
+    // Every cut inside the last record loses that record only
+    size_t lastRecord = 1 + 2 + 2 * 5 + 4 + 4;
+    for (size_t cut = 1; cut < lastRecord; cut++) {
+        CHECK(ReplaceFileContents(path, bytes.substr(0, full - cut)));
+        AppStateJournal journal(path);
+        AppStateMap states;
+        CHECK(journal.Load(states));
+        CHECK(states.size() == 1 && states[L"a.exe"].enabled);
+    }
+
+    // A flipped bit fails the record's checksum
+    std::string flipped = bytes;
+    flipped[full - 6] ^= 0x01;
+    CHECK(ReplaceFileContents(path, flipped));
+    {
+        AppStateJournal journal(path);
+        AppStateMap states;
+        CHECK(journal.Load(states));
+        CHECK_EQ(states.size(), 1u);
+
+        // The next write replaces the damaged file instead of appending after it
+        journal.RecordEnabled(L"c.exe", false);
+        journal.Flush();
+        CHECK_EQ(journal.GetStats().compactions, 1u);
+    }
+    AppStateJournal journal(path);
+    AppStateMap states;
+    CHECK(journal.Load(states));
+    CHECK(states.size() == 2 && states[L"a.exe"].enabled && !states[L"c.exe"].enabled);
+    fs::remove(path);
+}
+
+static void TestCompaction() {
+    fs::path path = TestPath("compact");
+    AppStateMap expected;
+    {
+        AppStateJournal journal(path, 64);
+        AppStateMap states;
+        journal.Load(states);
+
+        // Focus bouncing between a few apps, as smart switch records it
+        for (int i = 0; i < 1000; i++) {
+            std::wstring app = L"app" + std::to_wstring(i % 5) + L".exe";
+            journal.RecordEnabled(app, i % 3 == 0);
+            expected[app].enabled = i % 3 == 0;
+            if (i % 100 == 0) {
+                journal.RecordEncoding(app, i % 4);
+                expected[app].encoding = i % 4;
+            }
+            if (i % 10 == 0) journal.Flush();  // a batch per focus change
+        }
+        journal.Flush();
+        CHECK(journal.GetStats().compactions > 0);
+    }
+
+    // The file stays near one record per app, and replays to the same state
+    std::string bytes;
+    CHECK(ReadWholeFile(path, bytes));
+    CHECK(bytes.size() < 8 + 64 * 30);
+    AppStateJournal journal(path);
+    AppStateMap states;
+    CHECK(journal.Load(states));
+    CHECK(SameState(states, expected));
+    fs::remove(path);
+}
+
+// No Flush(): the writer's tick picks the record up
+static void TestWrittenOnTick() {
+    fs::path path = TestPath("tick");
+    AppStateJournal journal(path);
+    AppStateMap states;
+    journal.Load(states);
+    journal.RecordEnabled(L"notepad.exe", true);
+
+    auto start = std::chrono::steady_clock::now();
+    while (journal.GetStats().compactions == 0 && std::chrono::steady_clock::now() - start < std::chrono::seconds(5)) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    CHECK(std::chrono::steady_clock::now() - start < AppStateJournal::WRITE_INTERVAL * 4);
+    AppStateMap read;
+    CHECK(AppStateJournal(path).Load(read));
+    CHECK(read.size() == 1 && read[L"notepad.exe"].enabled);
+    fs::remove(path);
+}
+
+// A Load() that comes later than the writer's first tick must still see the
+// file: the writer may not snapshot its empty state over it
+static void TestSlowLoad() {
+    fs::path path = TestPath("slow_load");
+    {
+        AppStateJournal journal(path);
+        AppStateMap states;
+        journal.Load(states);
+        journal.RecordEnabled(L"notepad.exe", true);
+        journal.RecordEncoding(L"winword.exe", 2);
+    }
+
+    {
+        AppStateJournal journal(path);
+        std::this_thread::sleep_for(AppStateJournal::WRITE_INTERVAL * 2);
+        CHECK_EQ(journal.GetStats().compactions, 0u);
+        AppStateMap states;
+        CHECK(journal.Load(states));
+        CHECK_EQ(states.size(), 2u);
+        journal.RecordEnabled(L"excel.exe", true);
+    }
+
+    AppStateJournal journal(path);
+    AppStateMap states;
+    CHECK(journal.Load(states));
+    CHECK_EQ(states.size(), 3u);
+    CHECK(states[L"notepad.exe"].enabled);
+    CHECK_EQ(states[L"winword.exe"].encoding, 2);
+    CHECK(states[L"excel.exe"].enabled);
+    fs::remove(path);
+}
+
+// The hook thread and the UI thread recording while the writer flushes
+static void TestConcurrentRecording() {
+    fs::path path = TestPath("concurrent");
+    const int THREADS = 4;
+    const int RECORDS = 5000;
+    {
+        AppStateJournal journal(path, 128);
+        AppStateMap states;
+        journal.Load(states);
+        std::vector<std::thread> threads;
+        for (int t = 0; t < THREADS; t++) {
+            threads.emplace_back([&, t]() {
+                std::wstring app = L"thread" + std::to_wstring(t) + L".exe";
+                for (int i = 1; i <= RECORDS; i++) {
+                    journal.RecordEncoding(app, i);
+                    if (i % 1000 == 0) journal.Flush();
+                }
+            });
+        }
+        for (auto& thread : threads) thread.join();
+        journal.Flush();
+        CHECK_EQ(journal.GetStats().records, static_cast<uint64_t>(THREADS * RECORDS));
+        CHECK_EQ(journal.GetStats().failures, 0u);
+    }
+
+    AppStateJournal journal(path);
+    AppStateMap states;
+    CHECK(journal.Load(states));
+    CHECK_EQ(states.size(), static_cast<size_t>(THREADS));
+    for (int t = 0; t < THREADS; t++) {
+        CHECK_EQ(states[L"thread" + std::to_wstring(t) + L".exe"].encoding, RECORDS);
+    }
+    fs::remove(path);
+}
+
+int main() {
+    TestReplay();
+    TestAppendsBetweenStarts();
+    TestTornTailIsDropped();
+    TestCompaction();
+    TestWrittenOnTick();
+    TestSlowLoad();
+    TestConcurrentRecording();
+    return TestResult("test_app_state_journal");
+}
@@ -0,0 +1,202 @@
+// ViKey - Clipboard Converter Tests
+// test_clipboard_converter.cpp
+// Chunked conversion jobs and the background worker against an in-memory clipboard
+
+#include "clipboard_converter.h"
+#include "test_common.h"
+#include <chrono>
+#include <vector>
+
+// In-memory stand-in for the Win32 clipboard
+class MemoryClipboard : public ClipboardAccess {
+public:
+    bool ReadText(std::wstring& text) override {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_hasText) return false;
+        text = m_text;
+        return true;
+    }
+
+    bool WriteText(const std::wstring& text) override {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_text = text;
+        m_hasText = true;
+        m_sequence++;
+        writes++;
+        return true;
+    }
+
+    uint32_t SequenceNumber() override {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_sequence;
+    }
+
+    std::wstring Text() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_text;
+    }
+
+    std::atomic<int> writes{0};
+
+private:
+    std::mutex m_mutex;
+    std::wstring m_text;
+    bool m_hasText = false;
+    uint32_t m_sequence = 1;
+};
+
+static const std::wstring SAMPLE =
+    L"Tiếng Việt là ngôn ngữ chính thức của Việt Nam. Đường vô xứ Nghệ quanh quanh.\n";
+
+static std::wstring Repeat(const std::wstring& text, size_t times) {
+    std::wstring out;
+    for (size_t i = 0; i < times; i++) out += text;
+    return out;
+}
+
+static std::wstring Convert(const std::wstring& text, VietEncoding from, VietEncoding to) {
+    return EncodingConverter::Instance().Convert(text, from, to);
+}
+
+static void TestJobChunking() {
+    const std::wstring unicode = Repeat(SAMPLE, 20);
+    const VietEncoding pairs[][2] = {
+        {VietEncoding::Unicode, VietEncoding::VNI_Windows},
+        {VietEncoding::VNI_Windows, VietEncoding::Unicode},
+        {VietEncoding::TCVN3, VietEncoding::VIQR},
+        {VietEncoding::Unicode_Comp, VietEncoding::Unicode},
+    };
+    for (const auto& pair : pairs) {
+        std::wstring source = Convert(unicode, VietEncoding::Unicode, pair[0]);
+        std::wstring expected = Convert(source, pair[0], pair[1]);
+
+        // Chunk boundaries land inside VNI pairs and NFD sequences
+        for (size_t chunk : {size_t(1), size_t(3), size_t(7), size_t(1000), ConversionJob::DEFAULT_CHUNK_CHARS}) {
+            ConversionJob job(source, pair[0], pair[1], chunk);
+            CHECK(job.Run() == JobStatus::Done);
+            CHECK(job.Result() == expected);
+            CHECK_EQ(job.Permille(), 1000u);
+        }
+    }
+}
+
+static void TestJobProgressAndCancel() {
+    ConversionJob job(Repeat(SAMPLE, 50), VietEncoding::Unicode, VietEncoding::TCVN3, 100);
+    uint32_t last = 0;
+    bool monotonic = true;
+    int steps = 0;
+    while (job.Step()) {
+        monotonic = monotonic && job.Permille() >= last;
+        last = job.Permille();
+        if (++steps == 5) job.Cancel();
+    }
+    CHECK(monotonic);
+    CHECK(job.Status() == JobStatus::Cancelled);
+    CHECK(last > 0 && last < 1000);
+    CHECK(job.Result().empty());
+    CHECK(!job.Step());
+}
+
+static void TestClipboardRoundTrip() {
+    MemoryClipboard clipboard;
+    const std::wstring vni = Convert(Repeat(SAMPLE, 100), VietEncoding::Unicode, VietEncoding::VNI_Windows);
+    clipboard.WriteText(vni);
+
+    ClipboardConverter converter(clipboard);
+    converter.SetChunkChars(257);
+    std::vector<uint32_t> progress;
+    ClipboardConversionResult finished;
+    converter.onProgress = [&](uint32_t permille) { progress.push_back(permille); };
+    converter.onFinished = [&](const ClipboardConversionResult& result) { finished = result; };
+
+    // Detection overrides the configured source
+    CHECK(converter.Start(VietEncoding::TCVN3, VietEncoding::Unicode, true));
+    converter.Wait();
+    CHECK(!converter.IsRunning());
+    CHECK(finished.status == JobStatus::Done);
+    CHECK(finished.from == VietEncoding::VNI_Windows);
+    CHECK_EQ(finished.chars, vni.size());
+    CHECK(clipboard.Text() == Repeat(SAMPLE, 100));
+    CHECK(!progress.empty() && progress.back() == 1000);
+    for (size_t i = 1; i < progress.size(); i++) CHECK(progress[i] > progress[i - 1]);
+
+    // Already in the target encoding: left alone
+    int writes = clipboard.writes;
+    CHECK(converter.Start(VietEncoding::Unicode, VietEncoding::Unicode, false));
+    converter.Wait();
+    CHECK(finished.status == JobStatus::Empty);
+    CHECK_EQ(clipboard.writes.load(), writes);
+}
+
+static void TestEmptyClipboard() {
+    MemoryClipboard clipboard;
+    ClipboardConverter converter(clipboard);
+    JobStatus status = JobStatus::Running;
+    converter.onFinished = [&](const ClipboardConversionResult& result) { status = result.status; };
+    CHECK(converter.Start(VietEncoding::VNI_Windows, VietEncoding::Unicode, false));
+    converter.Wait();
+    CHECK(status == JobStatus::Empty);
+}
+
+static void TestCancelAndSupersede() {
+    MemoryClipboard clipboard;
+    const std::wstring source = Convert(Repeat(SAMPLE, 200), VietEncoding::Unicode, VietEncoding::TCVN3);
+    clipboard.WriteText(source);
+
+    // Cancel from the progress callback, i.e. mid-job on the worker thread
+    {
+        ClipboardConverter converter(clipboard);
+        converter.SetChunkChars(64);
+        JobStatus status = JobStatus::Running;
+        converter.onProgress = [&](uint32_t permille) {
+            if (permille > 100) converter.Cancel();
+        };
+        converter.onFinished = [&](const ClipboardConversionResult& result) { status = result.status; };
+        CHECK(converter.Start(VietEncoding::TCVN3, VietEncoding::Unicode, false));
+        converter.Wait();
+        CHECK(status == JobStatus::Cancelled);
+        CHECK(clipboard.Text() == source);
+    }
+
+    // The user copies something else while the job runs: the new text wins
+    {
+        ClipboardConverter converter(clipboard);
+        converter.SetChunkChars(64);
+        JobStatus status = JobStatus::Running;
+        bool copied = false;
+        converter.onProgress = [&](uint32_t) {
+            if (!copied) clipboard.WriteText(L"mới");
+            copied = true;
+        };
+        converter.onFinished = [&](const ClipboardConversionResult& result) { status = result.status; };
+        CHECK(converter.Start(VietEncoding::TCVN3, VietEncoding::Unicode, false));
+        converter.Wait();
+        CHECK(status == JobStatus::Superseded);
+        CHECK(clipboard.Text() == L"mới");
+    }
+
+    // One job at a time; destroying the converter cancels and joins
+    {
+        clipboard.WriteText(source);
+        ClipboardConverter converter(clipboard);
+        converter.SetChunkChars(64);
+        std::atomic<bool> started{false};
+        converter.onProgress = [&](uint32_t) {
+            started = true;
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        };
+        CHECK(converter.Start(VietEncoding::TCVN3, VietEncoding::Unicode, false));
+        while (!started) std::this_thread::yield();
+        CHECK(!converter.Start(VietEncoding::TCVN3, VietEncoding::Unicode, false));
+    }
+    CHECK(clipboard.Text() == source);
+}
+
+int main() {
+    TestJobChunking();
+    TestJobProgressAndCancel();
+    TestClipboardRoundTrip();
+    TestEmptyClipboard();
+    TestCancelAndSupersede();
+    return TestResult("test_clipboard_converter");
+}
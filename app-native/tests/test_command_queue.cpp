@@ -0,0 +1,174 @@
+// ViKey - Command Queue Tests
+// test_command_queue.cpp
+// Order, capacity, many producers, and key latency on a dedicated thread
+// while the thread that posts commands is busy
+
+#include "command_queue.h"
+#include "test_common.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+using Clock = std::chrono::steady_clock;
+
+static void TestRunsInOrder() {
+    CommandQueue queue;
+    CHECK(queue.Empty());
+    CHECK_EQ(queue.Drain(), 0u);
+
+    std::vector<int> ran;
+    for (int i = 0; i < 10; i++) CHECK(queue.Post([&ran, i]() { ran.push_back(i); }));
+    CHECK(!queue.Empty());
+    CHECK_EQ(queue.Drain(), 10u);
+    CHECK(queue.Empty());
+    CHECK_EQ(ran.size(), 10u);
+    for (int i = 0; i < 10; i++) CHECK_EQ(ran[i], i);
+
+    // A command that posts another: the new one runs in the same drain
+    ran.clear();
+    queue.Post([&]() { queue.Post([&ran]() { ran.push_back(2); }); ran.push_back(1); });
+    CHECK_EQ(queue.Drain(), 2u);
+    CHECK(ran == std::vector<int>({1, 2}));
+}
+
+static void TestFull() {
+    CommandQueue queue(3);
+    CHECK_EQ(queue.Capacity(), 4u);
+
+    int ran = 0;
+    for (int lap = 0; lap < 100; lap++) {
+        for (int i = 0; i < 4; i++) CHECK(queue.Post([&ran]() { ran++; }));
+        CHECK(!queue.Post([&ran]() { ran += 1000; }));
+        CHECK_EQ(queue.Drain(), 4u);
+    }
+    CHECK_EQ(ran, 400);
+
+    // A command's captures are released once it has run
+    auto shared = std::make_shared<int>(0);
+    queue.Post([shared]() {});
+    CHECK_EQ(shared.use_count(), 2);
+    queue.Drain();
+    CHECK_EQ(shared.use_count(), 1);
+}
+
+static void TestManyProducers() {
+    const int producers = 4;
+    const int perProducer = 20000;
+    CommandQueue queue(64);
+
+    std::vector<int> last(producers, -1);
+    int outOfOrder = 0;
+    int total = 0;
+    std::vector<std::thread> threads;
+    for (int p = 0; p < producers; p++) {
+        threads.emplace_back([&, p]() {
+            for (int i = 0; i < perProducer; i++) {
+                auto command = [&, p, i]() {
+                    if (i != last[p] + 1) outOfOrder++;
+                    last[p] = i;
+                    total++;
+                };
+                while (!queue.Post(command)) std::this_thread::yield();
+            }
+        });
+    }
+    while (total < producers * perProducer) {
+        if (queue.Drain() == 0) std::this_thread::yield();
+    }
+    for (auto& t : threads) t.join();
+
+    CHECK_EQ(outOfOrder, 0);
+    CHECK_EQ(total, producers * perProducer);
+    CHECK(queue.Empty());
+}
+
+// Keys arrive every millisecond for `run`; the thread that services them also
+// runs `busy`-long UI work every `period`, or leaves that to another thread
+// that posts a settings command after each piece. Returns each key's wait.
+static std::vector<double> KeyLatencies(bool dedicated, std::chrono::milliseconds busy,
+                                        std::chrono::milliseconds period, std::chrono::milliseconds run) {
+    CommandQueue keys(4096);
+    CommandQueue commands;
+    std::vector<double> waits;
+    std::atomic<bool> stop(false);
+    std::atomic<int> settingsApplied(0);
+
+    auto uiWork = [&](Clock::time_point& next) {
+        if (Clock::now() < next) return false;
+        Clock::time_point until = Clock::now() + busy;
+        while (Clock::now() < until) {}  // a modal dialog, an icon being drawn
+        next += period;
+        return true;
+    };
+
+    std::thread source([&]() {
+        Clock::time_point next = Clock::now();
+        Clock::time_point end = next + run;
+        while (next < end) {
+            while (Clock::now() < next) std::this_thread::yield();
+            Clock::time_point arrived = Clock::now();
+            keys.Post([&waits, arrived]() {
+                waits.push_back(std::chrono::duration<double, std::milli>(Clock::now() - arrived).count());
+            });
+            next += std::chrono::milliseconds(1);
+        }
+        stop = true;
+    });
+
+    std::thread ui;
+    if (dedicated) {
+        ui = std::thread([&]() {
+            Clock::time_point next = Clock::now();
+            while (!stop) {
+                if (uiWork(next)) commands.Post([&]() { settingsApplied++; });
+                else std::this_thread::yield();
+            }
+        });
+    }
+
+    // The thread the hook runs on
+    Clock::time_point next = Clock::now();
+    while (!stop || !keys.Empty()) {
+        size_t ran = commands.Drain() + keys.Drain();
+        if (!dedicated && uiWork(next)) continue;
+        if (ran == 0) std::this_thread::yield();
+    }
+    source.join();
+    if (ui.joinable()) ui.join();
+    commands.Drain();
+    if (dedicated) CHECK(settingsApplied > 0);
+    return waits;
+}
+
+static double Percentile(std::vector<double> v, double p) {
+    if (v.empty()) return 0;
+    size_t i = static_cast<size_t>(p * (v.size() - 1));
+    std::nth_element(v.begin(), v.begin() + i, v.end());
+    return v[i];
+}
+
+static void TestHookLatencyWhileUiBusy() {
+    using std::chrono::milliseconds;
+
+    // UI busy 60 ms out of every 150: on the UI thread, keys queue up behind it
+    std::vector<double> shared = KeyLatencies(false, milliseconds(60), milliseconds(150), milliseconds(600));
+    std::vector<double> dedicated = KeyLatencies(true, milliseconds(60), milliseconds(150), milliseconds(600));
+    std::printf("key wait p50/p99/max (ms): UI thread %.2f/%.2f/%.2f, own thread %.2f/%.2f/%.2f\n",
+                Percentile(shared, 0.5), Percentile(shared, 0.99), Percentile(shared, 1.0),
+                Percentile(dedicated, 0.5), Percentile(dedicated, 0.99), Percentile(dedicated, 1.0));
+
+    CHECK(shared.size() > 500 && dedicated.size() > 500);
+    CHECK(Percentile(shared, 0.99) > 40.0);
+    // Flat on its own thread: far below the UI's busy time even on a loaded machine
+    CHECK(Percentile(dedicated, 0.99) < 15.0);
+}
+
+int main() {
+    TestRunsInOrder();
+    TestFull();
+    TestManyProducers();
+    TestHookLatencyWhileUiBusy();
+    return TestResult("test_command_queue");
+}
@@ -0,0 +1,33 @@
+// ViKey - Minimal Test Harness
+// test_common.h
+// CHECK macros for the native unit tests (one executable per test file)
+
+#pragma once
+
+#include <cstdio>
+#include <string>
+
+inline int& TestFailureCount() {
+    static int failures = 0;
+    return failures;
+}
+
+#define CHECK(cond)                                                              \
+    do {                                                                         \
+        if (!(cond)) {                                                           \
+            std::fprintf(stderr, "%s:%d: CHECK failed: %s\n", __FILE__, __LINE__, #cond); \
+            TestFailureCount()++;                                                \
+        }                                                                        \
+    } while (0)
+
+#define CHECK_EQ(a, b) CHECK((a) == (b))
+
+// Exit code for main(): 0 when every CHECK passed
+inline int TestResult(const char* name) {
+    if (TestFailureCount() == 0) {
+        std::printf("%s: all checks passed\n", name);
+        return 0;
+    }
+    std::printf("%s: %d check(s) failed\n", name, TestFailureCount());
+    return 1;
+}
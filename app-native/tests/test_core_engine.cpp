@@ -0,0 +1,133 @@
+// ViKey - Core Engine Session Tests
+// test_core_engine.cpp
+// The result cache and the passthrough mask over a stand-in core that records
+// every call (fake_core.h)
+
+#include "core_engine.h"
+#include "fake_core.h"
+#include "test_common.h"
+
+// macOS keycodes used below
+static const uint16_t KEY_A = 0, KEY_S = 1, KEY_SPACE = 49;
+
+static void Start(CoreEngine& engine, bool resultCache) {
+    SettingsSnapshot settings;
+    settings.resultCache = resultCache;
+    StartFakeEngine(engine, settings);
+}
+
+// "as", Space, as the hook sends a word
+static void TypeWord(CoreEngine& engine) {
+    CHECK(engine.ProcessKeyExt(KEY_A, false, false, false).GetText() == L"a");
+    CHECK(engine.ProcessKeyExt(KEY_S, false, false, false).GetText() == L"b");
+    engine.ProcessKeyExt(KEY_SPACE, false, false, false);
+    engine.Clear();
+}
+
+static void TestCacheOffByDefault() {
+    CoreEngine engine;
+    Start(engine, SettingsSnapshot().resultCache);
+    TypeWord(engine);
+    TypeWord(engine);
+    CHECK_EQ(g_core.keys.size(), 6u);
+    CHECK_EQ(engine.GetResultCacheStats().hits, 0u);
+    CHECK(g_core.replayed.empty());
+    CHECK_EQ(g_core.freed, 6);
+}
+
+static void TestHitsReplayBeforeNextCall() {
+    CoreEngine engine;
+    Start(engine, true);
+    TypeWord(engine);
+    CHECK_EQ(g_core.keys.size(), 3u);
+
+    // The same word again: its letters never reach the core...
+    CHECK(engine.ProcessKeyExt(KEY_A, false, false, false).GetText() == L"a");
+    CHECK(engine.ProcessKeyExt(KEY_S, false, false, false).GetText() == L"b");
+    CHECK_EQ(g_core.keys.size(), 3u);
+    CHECK_EQ(engine.GetResultCacheStats().hits, 2u);
+    CHECK(g_core.replayed.empty());
+
+    // ...until the next call into it, which replays them first
+    int clears = g_core.clears;
+    engine.ProcessKeyExt(KEY_SPACE, false, false, false);
+    CHECK_EQ(g_core.replayed.size(), 2u);
+    CHECK_EQ(g_core.replayed[0], ResultCache::Stroke(KEY_A, false, false));
+    CHECK_EQ(g_core.replayed[1], ResultCache::Stroke(KEY_S, false, false));
+    CHECK_EQ(g_core.keys.size(), 4u);
+    engine.Clear();
+    CHECK_EQ(g_core.clears, clears + 1);
+
+    // Ctrl always goes to the core
+    engine.ProcessKeyExt(KEY_A, false, true, false);
+    CHECK_EQ(g_core.keys.size(), 5u);
+}
+
+static void TestCacheWaitsForSettings() {
+    CoreEngine engine;
+    engine.Bind(FakeCoreApi());
+    engine.SetResultCacheEnabled(true);
+    engine.SetEnabled(true);
+    engine.SetMethod(InputMethod::Telex);  // the other options never set
+    engine.ClearAll();
+    TypeWord(engine);
+    TypeWord(engine);
+    CHECK_EQ(g_core.keys.size(), 6u);
+    CHECK_EQ(engine.GetResultCacheStats().hits, 0u);
+
+    // Auto-capitalize keeps it off too
+    SettingsSnapshot settings;
+    settings.resultCache = true;
+    settings.autoCapitalize = true;
+    engine.ApplySettings(settings);
+    engine.ClearAll();
+    TypeWord(engine);
+    TypeWord(engine);
+    CHECK_EQ(g_core.keys.size(), 12u);
+    CHECK_EQ(engine.GetResultCacheStats().hits, 0u);
+}
+
+static void TestPassthroughMask() {
+    CoreEngine engine;
+    Start(engine, false);
+    CHECK(!engine.IsPassthrough(KEY_SPACE));
+    engine.ProcessKeyExt(KEY_A, false, false, false);
+    CHECK(engine.IsPassthrough(KEY_SPACE));
+    CHECK(!engine.IsPassthrough(KEY_A));
+    CHECK(!engine.IsPassthrough(200));
+
+    // Any other call into the core withdraws it
+    engine.SetModernTone(false);
+    CHECK(!engine.IsPassthrough(KEY_SPACE));
+    engine.ProcessKeyExt(KEY_A, false, false, false);
+    engine.Clear();
+    CHECK(!engine.IsPassthrough(KEY_SPACE));
+    engine.ProcessKeyExt(KEY_A, false, false, false);
+    engine.Bind(FakeCoreApi());
+    CHECK(!engine.IsPassthrough(KEY_SPACE));
+
+    // So does a cache hit: the mask described the core's last key
+    Start(engine, true);
+    TypeWord(engine);
+    engine.ProcessKeyExt(KEY_A, false, false, false);
+    CHECK_EQ(engine.GetResultCacheStats().hits, 1u);
+    CHECK(!engine.IsPassthrough(KEY_SPACE));
+}
+
+static void TestUnboundEngine() {
+    CoreEngine engine;
+    engine.ClearAll();
+    engine.SetModernTone(true);
+    CHECK(engine.Snapshot().empty());
+    CHECK(engine.ProcessKeyExt(KEY_A, false, false, false).action == ImeAction::None);
+    CHECK(!engine.IsPassthrough(KEY_SPACE));
+}
+
+int main() {
+    TestCacheOffByDefault();
+    TestHitsReplayBeforeNextCall();
+    TestCacheWaitsForSettings();
+    TestPassthroughMask();
+    TestUnboundEngine();
+    return TestResult("test_core_engine");
+}
@@ -0,0 +1,71 @@
+// ViKey - Encoding Detection Tests
+// test_detect.cpp
+// Detect/DetectBytes must rank the true encoding first for ordinary prose
+
+#include "encoding_converter.h"
+#include "test_common.h"
+
+static const VietEncoding ENCODINGS[] = {
+    VietEncoding::Unicode, VietEncoding::VNI_Windows, VietEncoding::TCVN3, VietEncoding::Unicode_Comp,
+    VietEncoding::VISCII, VietEncoding::VIQR, VietEncoding::UTF8_Bytes,
+};
+
+// Deliberately different from the detector's own model text
+static const wchar_t* const SAMPLES[] = {
+    L"Tiếng Việt là ngôn ngữ chính thức của nước Cộng hòa Xã hội chủ nghĩa Việt Nam.",
+    L"Trăm năm trong cõi người ta, chữ tài chữ mệnh khéo là ghét nhau.",
+    L"Đường vô xứ Nghệ quanh quanh, non xanh nước biếc như tranh họa đồ.",
+    L"Hôm qua em đến trường, mẹ dắt tay từng bước; hôm nay mẹ lên nương, một mình em tới lớp.",
+    L"Công ty sẽ thông báo kết quả phỏng vấn qua thư điện tử trong vòng bảy ngày làm việc.",
+};
+
+static void TestRanksTrueEncodingFirst() {
+    EncodingConverter& conv = EncodingConverter::Instance();
+    for (const wchar_t* sample : SAMPLES) {
+        for (VietEncoding enc : ENCODINGS) {
+            std::wstring text = conv.Convert(sample, VietEncoding::Unicode, enc);
+            std::string bytes = EncodingConverter::EncodeBytes(text, enc);
+
+            auto fromText = EncodingConverter::Detect(text.data(), text.size());
+            auto fromBytes = EncodingConverter::DetectBytes(bytes.data(), bytes.size());
+            CHECK(fromText.size() == VIET_ENCODING_COUNT);
+            CHECK(fromBytes.size() == VIET_ENCODING_COUNT);
+            CHECK(fromText[0].encoding == enc);
+            // On disk, UTF-8 bytes are simply a UTF-8 file
+            CHECK(fromBytes[0].encoding == (enc == VietEncoding::UTF8_Bytes ? VietEncoding::Unicode : enc));
+            CHECK(fromBytes[0].confidence > 0.8f);
+        }
+    }
+}
+
+static void TestLargeSampleIsWindowed() {
+    std::wstring unicode;
+    while (unicode.size() < 2 * 1024 * 1024) unicode += SAMPLES[unicode.size() % 5];
+    std::wstring tcvn3 = EncodingConverter::Instance().Convert(unicode, VietEncoding::Unicode, VietEncoding::TCVN3);
+    std::string bytes = EncodingConverter::EncodeBytes(tcvn3, VietEncoding::TCVN3);
+    CHECK(EncodingConverter::DetectBytes(bytes.data(), bytes.size())[0].encoding == VietEncoding::TCVN3);
+
+    bytes = EncodingConverter::EncodeBytes(unicode, VietEncoding::Unicode);
+    CHECK(EncodingConverter::DetectBytes(bytes.data(), bytes.size())[0].encoding == VietEncoding::Unicode);
+}
+
+static void TestNoEvidence() {
+    const char ascii[] = "Plain ASCII text has nothing to tell the encodings apart.";
+    auto guesses = EncodingConverter::DetectBytes(ascii, sizeof(ascii) - 1);
+    CHECK(guesses.size() == VIET_ENCODING_COUNT);
+    for (const auto& g : guesses) CHECK(g.confidence == 0.0f);
+    CHECK(EncodingConverter::DetectBytes("", 0)[0].confidence == 0.0f);
+}
+
+static void TestAsciiPunctuationIsNotViqr() {
+    const char text[] = "Is it? Yes. Don't stop: e.g. the end... (really) a^2 + b^2 = c^2.";
+    CHECK(EncodingConverter::DetectBytes(text, sizeof(text) - 1)[0].confidence == 0.0f);
+}
+
+int main() {
+    TestRanksTrueEncodingFirst();
+    TestLargeSampleIsWindowed();
+    TestNoEvidence();
+    TestAsciiPunctuationIsNotViqr();
+    return TestResult("test_detect");
+}
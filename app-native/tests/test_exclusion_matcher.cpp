@@ -0,0 +1,138 @@
+// ViKey - Exclusion Matcher Tests
+// test_exclusion_matcher.cpp
+// Rule kinds, case folding, interning and the bounded per-app verdict cache
+
+#include "exclusion_matcher.h"
+#include "test_common.h"
+
+static bool Excluded(ExclusionMatcher& matcher, const wchar_t* path) {
+    return matcher.IsExcluded(matcher.Intern(FoldCase(path)));
+}
+
+static void TestHelpers() {
+    CHECK(FoldCase(L"C:\\Program Files\\NotePad.EXE") == L"c:\\program files\\notepad.exe");
+    CHECK(AppNameFromPath(L"c:\\windows\\notepad.exe") == L"notepad.exe");
+    CHECK(AppNameFromPath(L"c:/tools/putty.exe") == L"putty.exe");
+    CHECK(AppNameFromPath(L"notepad.exe") == L"notepad.exe");
+}
+
+static void TestNames() {
+    ExclusionMatcher matcher;
+    matcher.Compile({L"Notepad.exe", L"  mstsc.exe ", L"", L"   "});
+    CHECK_EQ(matcher.RuleCount(), 2u);
+
+    // A plain name matches the executable anywhere, as the old list did
+    CHECK(Excluded(matcher, L"C:\\Windows\\System32\\NOTEPAD.EXE"));
+    CHECK(Excluded(matcher, L"notepad.exe"));
+    CHECK(Excluded(matcher, L"c:\\windows\\system32\\mstsc.exe"));
+    CHECK(!Excluded(matcher, L"c:\\tools\\notepad.exe.bak"));
+    CHECK(!Excluded(matcher, L"c:\\notepad.exe\\code.exe"));
+    CHECK(!Excluded(matcher, L""));
+}
+
+static void TestPatterns() {
+    ExclusionMatcher matcher;
+    matcher.Compile({
+        L"putty*.exe",                // name pattern
+        L"vim?.exe",                  // one character
+        L"kitty*",                    // name prefix
+        L"*\\JetBrains\\*",           // path pattern
+        L"C:/Games/",                 // folder, written with forward slashes
+        L"d:\\tools\\keepass.exe",    // one exact path
+    });
+
+    CHECK(Excluded(matcher, L"c:\\apps\\putty.exe"));
+    CHECK(Excluded(matcher, L"c:\\apps\\puttytel-64.exe"));
+    CHECK(!Excluded(matcher, L"c:\\apps\\putty.com"));
+    CHECK(Excluded(matcher, L"c:\\apps\\vim9.exe"));
+    CHECK(!Excluded(matcher, L"c:\\apps\\vim.exe"));
+    CHECK(!Excluded(matcher, L"c:\\apps\\vim10.exe"));
+    CHECK(Excluded(matcher, L"c:\\apps\\kitty.exe"));
+    CHECK(Excluded(matcher, L"C:\\Program Files\\JetBrains\\IntelliJ IDEA\\bin\\idea64.exe"));
+    CHECK(!Excluded(matcher, L"c:\\program files\\jetbrainsfoo\\idea64.exe"));
+    CHECK(Excluded(matcher, L"c:\\games\\steam\\game.exe"));
+    CHECK(!Excluded(matcher, L"c:\\gamesx\\game.exe"));
+    CHECK(Excluded(matcher, L"D:\\Tools\\KeePass.exe"));
+    CHECK(!Excluded(matcher, L"c:\\tools\\keepass.exe"));
+
+    // Path rules need the path: a bare name only meets the name rules
+    CHECK(!Excluded(matcher, L"idea64.exe"));
+    CHECK(Excluded(matcher, L"putty.exe"));
+}
+
+static void TestGlobBacktracking() {
+    ExclusionMatcher matcher;
+    matcher.Compile({L"*a*b*c.exe", L"*\\x\\*\\y\\*"});
+    CHECK(Excluded(matcher, L"aaabbbc.exe"));
+    CHECK(Excluded(matcher, L"zabzbzc.exe"));
+    CHECK(!Excluded(matcher, L"acb.exe"));
+    CHECK(Excluded(matcher, L"c:\\x\\x\\q\\y\\app.exe"));
+    CHECK(!Excluded(matcher, L"c:\\x\\y.exe"));
+
+    matcher.Compile({L"*"});
+    CHECK(Excluded(matcher, L"anything.exe"));
+}
+
+static void TestInterningAndCache() {
+    ExclusionMatcher matcher;
+    AppId notepad = matcher.Intern(L"c:\\windows\\notepad.exe");
+    AppId code = matcher.Intern(L"c:\\code\\code.exe");
+    CHECK(notepad != code);
+    CHECK_EQ(matcher.Intern(L"c:\\windows\\notepad.exe"), notepad);
+
+    // Verdicts cached before a Compile() are dropped by it
+    CHECK(!matcher.IsExcluded(notepad));
+    matcher.Compile({L"notepad.exe"});
+    CHECK(matcher.IsExcluded(notepad));
+    CHECK(!matcher.IsExcluded(code));
+    matcher.Compile({L"code*"});
+    CHECK(!matcher.IsExcluded(notepad));
+    CHECK(matcher.IsExcluded(code));
+
+    // Ids stay valid across many interned apps (the map rehashes)
+    for (int i = 0; i < 1000; i++) matcher.Intern(L"c:\\apps\\app" + std::to_wstring(i) + L".exe");
+    CHECK(matcher.IsExcluded(code));
+    CHECK(!matcher.IsExcluded(notepad));
+    CHECK(!matcher.IsExcluded(static_cast<AppId>(5000)));
+}
+
+// A long session meets many executables; the table stays bounded and the
+// verdicts stay right after it starts over
+static void TestAppTableIsBounded() {
+    ExclusionMatcher matcher;
+    matcher.Compile({L"tool*"});
+    for (size_t i = 0; i < ExclusionMatcher::MAX_APPS * 3; i++) {
+        std::wstring path = (i % 2 ? L"c:\\apps\\tool" : L"c:\\apps\\app") + std::to_wstring(i) + L".exe";
+        CHECK_EQ(matcher.IsExcluded(matcher.Intern(path)), i % 2 == 1);
+        CHECK(matcher.AppCount() <= ExclusionMatcher::MAX_APPS);
+    }
+    CHECK(Excluded(matcher, L"c:\\apps\\tool.exe"));
+    CHECK(!Excluded(matcher, L"c:\\apps\\notepad.exe"));
+}
+
+// The cached answer always agrees with a fresh match
+static void TestCacheAgreesWithMatches() {
+    std::vector<std::wstring> rules;
+    for (int i = 0; i < 300; i++) rules.push_back(L"app" + std::to_wstring(i * 7) + L".exe");
+    rules.push_back(L"tool*");
+    rules.push_back(L"*\\vendor\\*");
+    ExclusionMatcher matcher;
+    matcher.Compile(rules);
+    for (int i = 0; i < 2000; i++) {
+        std::wstring path = i % 3 == 0 ? L"c:\\vendor\\" : L"c:\\apps\\";
+        path += (i % 5 == 0 ? L"tool" : L"app") + std::to_wstring(i) + L".exe";
+        CHECK_EQ(matcher.IsExcluded(matcher.Intern(path)), matcher.Matches(path));
+        CHECK_EQ(matcher.IsExcluded(matcher.Intern(path)), matcher.Matches(path));
+    }
+}
+
+int main() {
+    TestHelpers();
+    TestNames();
+    TestPatterns();
+    TestGlobBacktracking();
+    TestInterningAndCache();
+    TestAppTableIsBounded();
+    TestCacheAgreesWithMatches();
+    return TestResult("test_exclusion_matcher");
+}
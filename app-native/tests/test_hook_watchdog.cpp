@@ -0,0 +1,186 @@
+// ViKey - Keyboard Hook Watchdog Tests
+// test_hook_watchdog.cpp
+// Budget overruns, pass-through and hook loss, on a fake clock
+
+#include "hook_watchdog.h"
+#include "test_common.h"
+
+using namespace std::chrono;
+using Clock = HookWatchdog::Clock;
+
+// Time only moves when a test says so
+struct FakeClock {
+    Clock::time_point now = Clock::time_point() + hours(1);
+    Clock::time_point Advance(Clock::duration d) { return now += d; }
+};
+
+// One admitted key whose callback takes `took`
+static bool Key(HookWatchdog& watchdog, FakeClock& clock, Clock::duration took) {
+    Clock::time_point start = clock.now;
+    watchdog.HookEvent(start);
+    if (!watchdog.Admit(start)) return false;
+    watchdog.KeyDone(start, clock.Advance(took));
+    return true;
+}
+
+static void TestWithinBudget() {
+    FakeClock clock;
+    HookWatchdog watchdog;
+    for (int i = 0; i < 1000; i++) {
+        CHECK(Key(watchdog, clock, microseconds(300)));
+        clock.Advance(milliseconds(80));
+    }
+    CHECK_EQ(watchdog.GetStats().keys, 1000u);
+    CHECK_EQ(watchdog.GetStats().overruns, 0u);
+    CHECK(watchdog.GetStats().worst == microseconds(300));
+    CHECK(watchdog.Check(clock.now) == HookWatchdog::Action::None);
+}
+
+static void TestOverrunsPassThrough() {
+    HookWatchdog::Config config;
+    config.budget = milliseconds(50);
+    config.overrunsToPassThrough = 2;
+    config.overrunWindow = seconds(10);
+    config.passThroughFor = seconds(5);
+    FakeClock clock;
+    HookWatchdog watchdog(config);
+
+    // One slow key is tolerated
+    CHECK(Key(watchdog, clock, milliseconds(120)));
+    CHECK_EQ(watchdog.GetStats().overruns, 1u);
+    CHECK(!watchdog.IsPassingThrough(clock.now));
+
+    // A second one soon after: keys bypass the IME for a while
+    clock.Advance(seconds(3));
+    CHECK(Key(watchdog, clock, milliseconds(90)));
+    CHECK(watchdog.IsPassingThrough(clock.now));
+    CHECK_EQ(watchdog.GetStats().passThroughs, 1u);
+    for (int i = 0; i < 10; i++) {
+        clock.Advance(milliseconds(400));
+        CHECK(!Key(watchdog, clock, milliseconds(1)));
+    }
+    CHECK_EQ(watchdog.GetStats().passedThrough, 10u);
+
+    // Then the IME is back, with a clean slate
+    clock.Advance(seconds(1));
+    CHECK(Key(watchdog, clock, milliseconds(60)));
+    CHECK(!watchdog.IsPassingThrough(clock.now));
+
+    // Exactly on budget is not an overrun
+    CHECK(Key(watchdog, clock, milliseconds(50)));
+    CHECK_EQ(watchdog.GetStats().overruns, 3u);
+    CHECK(watchdog.GetStats().worst == milliseconds(120));
+}
+
+static void TestOverrunsFarApart() {
+    HookWatchdog::Config config;
+    config.budget = milliseconds(50);
+    config.overrunWindow = seconds(10);
+    FakeClock clock;
+    HookWatchdog watchdog(config);
+
+    for (int i = 0; i < 5; i++) {
+        CHECK(Key(watchdog, clock, milliseconds(200)));
+        clock.Advance(seconds(11));
+    }
+    CHECK_EQ(watchdog.GetStats().overruns, 5u);
+    CHECK_EQ(watchdog.GetStats().passThroughs, 0u);
+}
+
+static void TestBudgetFromHookTimeout() {
+    CHECK(HookWatchdog::Config().budget == milliseconds(225));
+    CHECK(HookWatchdog::BudgetFor(Clock::duration::zero()) == milliseconds(225));
+    CHECK(HookWatchdog::BudgetFor(milliseconds(200)) == milliseconds(150));
+    CHECK(HookWatchdog::BudgetFor(milliseconds(1000)) == milliseconds(750));
+    CHECK(HookWatchdog::BudgetFor(seconds(5)) == milliseconds(750));  // Windows caps it at 1 s
+}
+
+static void TestClipboardSendsStayAdmitted() {
+    FakeClock clock;
+    HookWatchdog watchdog;
+
+    // Clipboard mode, typed at speed for a minute: each edit sleeps 20 ms per
+    // backspace plus about 100 ms around Ctrl+V (TextSender); the longest,
+    // 5 backspaces, is a SendTextClipboard rewrite. Other keys are quick.
+    for (int i = 0; i < 600; i++) {
+        int backspaces = (i / 3) % 6;
+        Clock::duration took = i % 3 ? microseconds(300) : milliseconds(100 + 20 * backspaces);
+        CHECK(Key(watchdog, clock, took));
+        clock.Advance(milliseconds(80));
+    }
+    CHECK_EQ(watchdog.GetStats().overruns, 0u);
+    CHECK_EQ(watchdog.GetStats().passThroughs, 0u);
+    CHECK(watchdog.GetStats().worst == milliseconds(200));
+
+    // Slower than that still risks the hook
+    CHECK(Key(watchdog, clock, milliseconds(280)));
+    CHECK(Key(watchdog, clock, milliseconds(280)));
+    CHECK(watchdog.IsPassingThrough(clock.now));
+}
+
+static void TestHookAlive() {
+    FakeClock clock;
+    HookWatchdog watchdog;
+    watchdog.Installed(clock.now);
+
+    // Raw input follows each key the hook saw, sometimes a little late
+    for (int i = 0; i < 100; i++) {
+        watchdog.HookEvent(clock.Advance(milliseconds(120)));
+        watchdog.SystemKey(clock.Advance(milliseconds(i % 2 ? 1 : 300)));
+        CHECK(watchdog.Check(clock.now) == HookWatchdog::Action::None);
+    }
+
+    // Long idle periods are not a loss
+    clock.Advance(hours(2));
+    CHECK(watchdog.Check(clock.now) == HookWatchdog::Action::None);
+    CHECK_EQ(watchdog.GetStats().losses, 0u);
+}
+
+static void TestHookLost() {
+    HookWatchdog::Config config;
+    config.lossGrace = seconds(1);
+    config.lossKeys = 2;
+    FakeClock clock;
+    HookWatchdog watchdog(config);
+    watchdog.Installed(clock.now);
+    watchdog.HookEvent(clock.Advance(seconds(1)));
+
+    // Windows dropped the hook: keys keep coming, the hook sees none
+    clock.Advance(seconds(5));
+    watchdog.SystemKey(clock.now);
+    CHECK(watchdog.Check(clock.Advance(seconds(2))) == HookWatchdog::Action::None);  // a single key
+    watchdog.SystemKey(clock.Advance(milliseconds(100)));
+    CHECK(watchdog.Check(clock.now) == HookWatchdog::Action::Reinstall);
+    CHECK_EQ(watchdog.GetStats().losses, 1u);
+
+    // Still reported until the hook is back
+    CHECK(watchdog.Check(clock.Advance(seconds(1))) == HookWatchdog::Action::Reinstall);
+    watchdog.Installed(clock.now);
+    CHECK(watchdog.Check(clock.now) == HookWatchdog::Action::None);
+
+    // Working again
+    for (int i = 0; i < 10; i++) {
+        watchdog.HookEvent(clock.Advance(milliseconds(150)));
+        watchdog.SystemKey(clock.Advance(milliseconds(2)));
+    }
+    CHECK(watchdog.Check(clock.Advance(seconds(3))) == HookWatchdog::Action::None);
+
+    // A burst right after the hook died is caught once the grace has passed
+    watchdog.HookEvent(clock.now);
+    for (int i = 0; i < 20; i++) watchdog.SystemKey(clock.Advance(milliseconds(100)));
+    CHECK(watchdog.Check(clock.now) == HookWatchdog::Action::None);
+    for (int i = 0; i < 15; i++) watchdog.SystemKey(clock.Advance(milliseconds(100)));
+    CHECK(watchdog.Check(clock.now) == HookWatchdog::Action::Reinstall);
+    CHECK_EQ(watchdog.GetStats().losses, 3u);
+}
+
+int main() {
+    TestWithinBudget();
+    TestOverrunsPassThrough();
+    TestOverrunsFarApart();
+    TestBudgetFromHookTimeout();
+    TestClipboardSendsStayAdmitted();
+    TestHookAlive();
+    TestHookLost();
+    return TestResult("test_hook_watchdog");
+}
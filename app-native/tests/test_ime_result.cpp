@@ -0,0 +1,49 @@
+// ViKey - Engine Key Result Tests
+// test_ime_result.cpp
+// Which results block the typed key, and their text
+
+#include "ime_result.h"
+#include "test_common.h"
+
+static ImeResult Result(ImeAction action, uint8_t backspace, const std::u32string& text, uint8_t flags = 0) {
+    return ImeResult(action, backspace, static_cast<uint8_t>(text.size()), flags,
+                     reinterpret_cast<const uint32_t*>(text.data()), text.size());
+}
+
+static void TestBlocksKey() {
+    // Text to send replaces the key
+    CHECK(Result(ImeAction::Send, 1, U"â").BlocksKey());
+
+    // So does an empty Send: the engine absorbed the key (the second w of
+    // "nuwow" leaves nothing to type)
+    ImeResult absorbed = Result(ImeAction::Send, 0, U"");
+    CHECK(absorbed.BlocksKey());
+    CHECK(absorbed.GetText().empty());
+    CHECK(Result(ImeAction::Send, 2, U"").BlocksKey());
+
+    // A consumed key without an action
+    CHECK(Result(ImeAction::None, 0, U"", ImeResult::FLAG_KEY_CONSUMED).BlocksKey());
+
+    // Anything else reaches the application
+    CHECK(!ImeResult::Empty().BlocksKey());
+    CHECK(!Result(ImeAction::None, 0, U"", ImeResult::FLAG_PASSTHROUGH_MASK).BlocksKey());
+    CHECK(!Result(ImeAction::Restore, 0, U"").BlocksKey());
+}
+
+static void TestText() {
+    CHECK(Result(ImeAction::Send, 0, U"Việt").GetText() == L"Việt");
+
+    // Outside the BMP: a surrogate pair, as SendInput takes it
+    std::wstring emoji = Result(ImeAction::Send, 0, U"\U0001F600").GetText();
+    CHECK_EQ(emoji.size(), 2u);
+    CHECK(emoji[0] == 0xD83D && emoji[1] == 0xDE00);
+
+    // count bounds the text; NULs are skipped
+    CHECK(Result(ImeAction::Send, 0, std::u32string(U"a\0b", 3)).GetText() == L"ab");
+}
+
+int main() {
+    TestBlocksKey();
+    TestText();
+    return TestResult("test_ime_result");
+}
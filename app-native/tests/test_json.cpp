@@ -0,0 +1,293 @@
+// ViKey - JSON Reader/Writer Tests
+// test_json.cpp
+// Pull parser over UTF-8/UTF-16/wchar_t input, writer escaping and layout,
+// and the shortcut export format built on them
+
+#include "settings_json.h"
+#include "test_common.h"
+#include <climits>
+
+// The reader points into text, which must outlive it
+static JsonReader Reader(const std::wstring& text) {
+    return JsonReader(text.data(), text.size());
+}
+
+static void TestReadValues() {
+    const std::wstring doc =
+        L"{ \"b\": true, \"f\": false, \"i\": -42, \"s\": \"x\", \"n\": null,\n"
+        L"  \"o\": {\"deep\": [1, {\"x\": [[]]}, \"}]\"]}, \"a\": [1, 2, 3], \"last\": 7 }";
+    JsonReader reader = Reader(doc);
+    bool b = false, f = true;
+    int i = 0, last = 0;
+    std::wstring s;
+    std::vector<int> a;
+    CHECK(reader.Peek() == JsonType::Object);
+    CHECK(reader.BeginObject());
+    while (reader.NextKey()) {
+        if (reader.KeyIs("b")) CHECK(reader.ReadBool(b));
+        else if (reader.KeyIs("f")) CHECK(reader.ReadBool(f));
+        else if (reader.KeyIs("i")) CHECK(reader.ReadInt(i));
+        else if (reader.KeyIs("s")) CHECK(reader.ReadString(s));
+        else if (reader.KeyIs("last")) CHECK(reader.ReadInt(last));
+        else if (reader.KeyIs("a")) {
+            CHECK(reader.BeginArray());
+            int v = 0;
+            while (reader.NextElement()) {
+                if (reader.ReadInt(v)) a.push_back(v);
+            }
+        }
+        // "n" and "o" are never read: NextKey() skips them
+    }
+    CHECK(!reader.Failed());
+    CHECK(reader.AtEnd());
+    CHECK(b && !f);
+    CHECK_EQ(i, -42);
+    CHECK(s == L"x");
+    CHECK((a == std::vector<int>{1, 2, 3}));
+    CHECK_EQ(last, 7);
+}
+
+static void TestTypeMismatchAndRange() {
+    const std::wstring doc =
+        L"{\"a\": \"1\", \"b\": 2147483648, \"c\": -2147483648, \"d\": 1.5, \"e\": 1e3, \"f\": [true], \"g\": 3}";
+    JsonReader reader = Reader(doc);
+    int a = -1, b = -1, c = -1, d = -1, e = -1, f = -1, g = -1;
+    CHECK(reader.BeginObject());
+    while (reader.NextKey()) {
+        if (reader.KeyIs("a")) CHECK(!reader.ReadInt(a));  // string, skipped
+        else if (reader.KeyIs("b")) CHECK(!reader.ReadInt(b));  // overflows int
+        else if (reader.KeyIs("c")) CHECK(reader.ReadInt(c));
+        else if (reader.KeyIs("d")) CHECK(!reader.ReadInt(d));
+        else if (reader.KeyIs("e")) CHECK(!reader.ReadInt(e));
+        else if (reader.KeyIs("f")) CHECK(!reader.ReadInt(f));  // whole array skipped
+        else if (reader.KeyIs("g")) CHECK(reader.ReadInt(g));
+    }
+    CHECK(reader.AtEnd());
+    CHECK(a == -1 && b == -1 && d == -1 && e == -1 && f == -1);
+    CHECK_EQ(c, INT_MIN);
+    CHECK_EQ(g, 3);
+
+    // Hundreds of digits: no overflow, no exception
+    std::wstring huge = L"[" + std::wstring(400, L'9') + L"]";
+    JsonReader hugeReader = Reader(huge);
+    CHECK(hugeReader.BeginArray());
+    while (hugeReader.NextElement()) CHECK(!hugeReader.ReadInt(g));
+    CHECK(hugeReader.AtEnd());
+}
+
+static void TestStringEscapes() {
+    const std::wstring doc =
+        L"[\"a\\\"b\\\\c\\/d\\n\\t\\r\\b\\f\", \"\\u0110\\u1ec7\", \"\\ud83d\\ude00\", \"\\udc00x\", \"Vi\u1EC7t\"]";
+    JsonReader reader = Reader(doc);
+    std::vector<std::wstring> values;
+    std::wstring s;
+    CHECK(reader.BeginArray());
+    while (reader.NextElement()) {
+        if (reader.ReadString(s)) values.push_back(s);
+    }
+    CHECK(reader.AtEnd());
+    CHECK_EQ(values.size(), 5u);
+    CHECK(values[0] == L"a\"b\\c/d\n\t\r\b\f");
+    CHECK(values[1] == L"\u0110\u1EC7");
+    std::wstring emoji;
+    if (sizeof(wchar_t) == 2) {
+        emoji = {static_cast<wchar_t>(0xD83D), static_cast<wchar_t>(0xDE00)};
+    } else {
+        emoji = {static_cast<wchar_t>(0x1F600)};
+    }
+    CHECK(values[2] == emoji);
+    CHECK(values[3] == L"\uFFFDx");
+    CHECK(values[4] == L"Vi\u1EC7t");
+
+    // Escaped keys still match by their decoded name
+    const std::wstring escapedKey = L"{\"k\\u0065y\": 1}";
+    JsonReader keys = Reader(escapedKey);
+    CHECK(keys.BeginObject());
+    CHECK(keys.NextKey());
+    CHECK(keys.KeyIs("key"));
+    CHECK(!keys.KeyIs("ke"));
+    CHECK(keys.Key() == L"key");
+    CHECK(!keys.NextKey());
+    CHECK(keys.AtEnd());
+}
+
+static bool Parses(const std::wstring& text) {
+    JsonReader reader = Reader(text);
+    reader.SkipValue();
+    return reader.AtEnd();
+}
+
+static void TestMalformed() {
+    CHECK(Parses(L"  {\"a\": [1, 2, {\"b\": null}], \"c\": \"]}\"}  "));
+    CHECK(Parses(L"[]"));
+    CHECK(Parses(L"{}"));
+    CHECK(Parses(L"-0.5e+10"));
+
+    const wchar_t* bad[] = {
+        L"", L"{", L"[1, 2", L"{\"a\" 1}", L"{\"a\": 1,}", L"[1,]", L"[,1]", L"{,}",
+        L"{\"a\": 1 \"b\": 2}", L"[01]", L"[1.]", L"[-]", L"[tru]", L"[nul]", L"[\"abc]",
+        L"[\"a\nb\"]", L"[\"\\x\"]", L"[\"\\u12g4\"]", L"{\"a\": }", L"[1] 2", L"{'a': 1}",
+    };
+    for (const wchar_t* text : bad) {
+        if (Parses(text)) std::fprintf(stderr, "accepted malformed: %ls\n", text);
+        CHECK(!Parses(text));
+    }
+
+    // The error reports where parsing stopped
+    const std::wstring doubleComma = L"{\"a\": [1, 2,, 3]}";
+    JsonReader reader = Reader(doubleComma);
+    reader.SkipValue();
+    CHECK(reader.Failed());
+    CHECK_EQ(reader.ErrorOffset(), 12u);
+    CHECK(std::string(reader.Error()).size() > 0);
+
+    // Nesting limit instead of unbounded recursion
+    std::wstring deep(JsonReader::MAX_DEPTH, L'[');
+    deep += std::wstring(JsonReader::MAX_DEPTH, L']');
+    CHECK(Parses(deep));
+    CHECK(!Parses(L"[" + deep + L"]"));
+    CHECK(!Parses(std::wstring(100000, L'[')));
+}
+
+static void TestUtf8AndUtf16Input() {
+    // "Việt" as UTF-8, plus a malformed byte that becomes U+FFFD
+    const std::string utf8 = "{\"name\": \"Vi\xE1\xBB\x87t \xFF!\"}";
+    Utf8JsonReader reader(utf8.data(), utf8.size());
+    std::wstring name;
+    CHECK(reader.BeginObject());
+    while (reader.NextKey()) {
+        if (reader.KeyIs("name")) CHECK(reader.ReadString(name));
+    }
+    CHECK(reader.AtEnd());
+    CHECK(name == L"Vi\u1EC7t \uFFFD!");
+
+    // Same document as UTF-16LE file bytes and as BOM-prefixed UTF-8
+    const std::u16string utf16 = u"\uFEFF{\"name\": \"Vi\u1EC7t \U0001F600\"}";
+    std::string fileBytes;
+    for (char16_t c : utf16) {
+        fileBytes += static_cast<char>(c & 0xFF);
+        fileBytes += static_cast<char>(c >> 8);
+    }
+    std::wstring fromFile;
+    bool ok = WithJsonFileReader(fileBytes.data(), fileBytes.size(), [&](auto& r) {
+        if (!r.BeginObject()) return false;
+        while (r.NextKey()) {
+            if (r.KeyIs("name")) r.ReadString(fromFile);
+        }
+        return r.AtEnd();
+    });
+    CHECK(ok);
+    std::wstring expected = L"Vi\u1EC7t ";
+    if (sizeof(wchar_t) == 2) {
+        expected += static_cast<wchar_t>(0xD83D);
+        expected += static_cast<wchar_t>(0xDE00);
+    } else {
+        expected += static_cast<wchar_t>(0x1F600);
+    }
+    CHECK(fromFile == expected);
+
+    const std::string bomUtf8 = "\xEF\xBB\xBF[\"Vi\xE1\xBB\x87t\"]";
+    std::wstring element;
+    ok = WithJsonFileReader(bomUtf8.data(), bomUtf8.size(), [&](auto& r) {
+        if (!r.BeginArray()) return false;
+        while (r.NextElement()) r.ReadString(element);
+        return r.AtEnd();
+    });
+    CHECK(ok);
+    CHECK(element == L"Vi\u1EC7t");
+}
+
+static void TestWriter() {
+    JsonWriter writer;
+    writer.BeginObject();
+    writer.Key("version");
+    writer.Int(1);
+    writer.Key("flag");
+    writer.Bool(false);
+    writer.Key("empty");
+    writer.BeginArray();
+    writer.EndArray();
+    writer.Key("list");
+    writer.BeginArray();
+    writer.String(L"a\"b\\c\nd\x01");
+    writer.BeginInlineObject();
+    writer.Key("k");
+    writer.Null();
+    writer.Key("v");
+    writer.BeginArray();
+    writer.Int(-5);
+    writer.Int(6);
+    writer.EndArray();
+    writer.EndObject();
+    writer.EndArray();
+    writer.EndObject();
+
+    const std::wstring expected =
+        L"{\n"
+        L"  \"version\": 1,\n"
+        L"  \"flag\": false,\n"
+        L"  \"empty\": [],\n"
+        L"  \"list\": [\n"
+        L"    \"a\\\"b\\\\c\\nd\\u0001\",\n"
+        L"    {\"k\": null, \"v\": [-5, 6]}\n"
+        L"  ]\n"
+        L"}\n";
+    CHECK(writer.Str() == expected);
+    CHECK(Parses(writer.Str()));
+}
+
+static void TestShortcutsRoundTrip() {
+    // Values the old find()-based import split in the wrong place
+    std::vector<TextShortcut> shortcuts = {
+        {L"vn", L"Vi\u1EC7t Nam"},
+        {L"br", L"a ] b } c { d ["},
+        {L"q", L"say \"hi\", \\o/"},
+        {L"nl", L"line1\nline2\ttab"},
+        {L"key\"", L"\"key\": \"value\""},
+    };
+    std::wstring json = ExportShortcutsJson(shortcuts);
+
+    std::vector<TextShortcut> imported;
+    JsonReader reader = Reader(json);
+    CHECK(ImportShortcutsJson(reader, imported));
+    CHECK_EQ(imported.size(), shortcuts.size());
+    for (size_t i = 0; i < shortcuts.size() && i < imported.size(); i++) {
+        CHECK(imported[i].key == shortcuts[i].key);
+        CHECK(imported[i].value == shortcuts[i].value);
+    }
+
+    // Incomplete entries dropped; unknown members and other types ignored
+    const std::wstring loose =
+        L"{\"shortcuts\": [{\"key\": \"a\"}, {\"value\": \"b\"}, 3, {\"key\": \"c\", \"value\": \"d\", \"x\": {}}],"
+        L" \"version\": 1, \"extra\": [1]}";
+    JsonReader looseReader = Reader(loose);
+    CHECK(ImportShortcutsJson(looseReader, imported));
+    CHECK_EQ(imported.size(), 1u);
+    CHECK(imported.size() == 1 && imported[0].key == L"c" && imported[0].value == L"d");
+
+    // Rejected documents leave the list alone
+    const wchar_t* rejected[] = {
+        L"{\"version\": 2, \"shortcuts\": [{\"key\": \"a\", \"value\": \"b\"}]}",
+        L"{\"shortcuts\": [{\"key\": \"a\", \"value\": \"b\"}]}",
+        L"{\"version\": 1, \"shortcuts\": []}",
+        L"{\"version\": 1, \"shortcuts\": [{\"key\": \"a\", \"value\": \"b\"}]",
+        L"[{\"version\": 1}]",
+    };
+    for (const wchar_t* text : rejected) {
+        std::wstring doc = text;
+        JsonReader r = Reader(doc);
+        CHECK(!ImportShortcutsJson(r, imported));
+        CHECK_EQ(imported.size(), 1u);
+    }
+}
+
+int main() {
+    TestReadValues();
+    TestTypeMismatchAndRange();
+    TestStringEscapes();
+    TestMalformed();
+    TestUtf8AndUtf16Input();
+    TestWriter();
+    TestShortcutsRoundTrip();
+    return TestResult("test_json");
+}
@@ -0,0 +1,143 @@
+// ViKey - Key Handling Tests
+// test_key_handler.cpp
+// Which keys reach the engine, how its answers become edits and blocked keys,
+// and when the word ends, over a stand-in core (fake_core.h)
+
+#include "fake_core.h"
+#include "key_handler.h"
+#include "keycodes.h"
+#include "shortcut_manager.h"
+#include "test_common.h"
+
+static const int VK_A = VK_A_KEY, VK_S = VK_A_KEY + 18, VK_F1 = 0x70;
+
+static void TestAdmit() {
+    CoreEngine engine;
+    StartFakeEngine(engine);
+    KeyHandler keys(engine);
+
+    // Letters, digits, Backspace, ESC and Space go to the IME
+    CHECK(keys.Admit(VK_A, false, false));
+    CHECK(keys.Admit(VK_0_KEY, false, false));
+    CHECK(keys.Admit(VK_BACK_KEY, false, false));
+    CHECK(keys.Admit(VK_ESCAPE_KEY, false, false));
+    CHECK(keys.Admit(VK_SPACE_KEY, false, false));
+    CHECK_EQ(g_core.clears, 0);
+
+    // Keys the IME has no use for pass without touching the word
+    CHECK(!keys.Admit(VK_F1, false, false));
+    CHECK(!keys.Admit(VK_SHIFT_KEY, false, false));
+    CHECK(!keys.Admit(VK_A, false, true));  // Alt+A
+    CHECK_EQ(g_core.clears, 0);
+
+    // Ctrl, Ctrl combinations and word boundaries other than Space end it
+    CHECK(!keys.Admit(VK_CONTROL_KEY, true, false));
+    CHECK(!keys.Admit(VK_A, true, false));
+    CHECK(!keys.Admit(VK_RETURN_KEY, false, false));
+    CHECK(!keys.Admit(VK_TAB_KEY, false, false));
+    CHECK(!keys.Admit(VK_LEFT_KEY, false, false));
+    CHECK_EQ(g_core.clears, 5);
+    CHECK(g_core.keys.empty());
+}
+
+static void TestEngineAnswers() {
+    CoreEngine engine;
+    StartFakeEngine(engine);
+    KeyHandler keys(engine);
+    TextEdit edit;
+
+    // Text to send blocks the key
+    CHECK(keys.OnKeyPressed(VK_A, false, false, edit));
+    CHECK(edit.text == L"a" && edit.backspaces == 0 && !edit.viaClipboard);
+
+    // An empty Send blocks it too, with nothing to type
+    g_core.answers.push_back(FakeAnswer(ImeAction::Send, 0, U""));
+    CHECK(keys.OnKeyPressed(VK_A, false, false, edit));
+    CHECK(edit.Empty());
+
+    // A consumed key, and one the engine lets through
+    g_core.answers.push_back(FakeAnswer(ImeAction::None, 0, U"", ImeResult::FLAG_KEY_CONSUMED));
+    CHECK(keys.OnKeyPressed(VK_A, false, false, edit));
+    CHECK(edit.Empty());
+    g_core.answers.push_back(FakeAnswer(ImeAction::None, 0, U""));
+    CHECK(!keys.OnKeyPressed(VK_A, false, false, edit));
+    CHECK(edit.Empty());
+
+    // Long replacements are pasted
+    g_core.answers.push_back(FakeAnswer(ImeAction::Send, 4, U"ươ"));
+    CHECK(keys.OnKeyPressed(VK_A, false, false, edit));
+    CHECK(edit.text == L"ươ" && edit.backspaces == 4 && !edit.viaClipboard);
+    g_core.answers.push_back(FakeAnswer(ImeAction::Send, 5, U"Việt Nam "));
+    CHECK(keys.OnKeyPressed(VK_SPACE_KEY, false, false, edit));
+    CHECK(edit.viaClipboard);
+    g_core.answers.push_back(FakeAnswer(ImeAction::Send, 1, U"không có gì đâu!"));
+    CHECK(keys.OnKeyPressed(VK_A, false, false, edit));
+    CHECK(edit.viaClipboard);
+    CHECK_EQ(g_core.keys.size(), 7u);
+}
+
+static void TestKeyState() {
+    CoreEngine engine;
+    StartFakeEngine(engine);
+    KeyHandler keys(engine);
+    TextEdit edit;
+
+    // Caps is Shift XOR Caps Lock; Shift is passed as well (VNI symbols)
+    uint16_t a = KeyCodes::ToMacKeycode(VK_A);
+    keys.OnKeyPressed(VK_A, true, false, edit);
+    keys.OnKeyPressed(VK_A, false, true, edit);
+    keys.OnKeyPressed(VK_A, true, true, edit);
+    CHECK_EQ(g_core.keys[0], ResultCache::Stroke(a, true, true));
+    CHECK_EQ(g_core.keys[1], ResultCache::Stroke(a, true, false));
+    CHECK_EQ(g_core.keys[2], ResultCache::Stroke(a, false, true));
+
+    // The last answer's mask covers Space: it never reaches the engine
+    CHECK(!keys.OnKeyPressed(VK_SPACE_KEY, false, false, edit));
+    CHECK(edit.Empty());
+    CHECK_EQ(g_core.keys.size(), 3u);
+
+    // Keys with no engine keycode
+    CHECK(!keys.OnKeyPressed(VK_F1, false, false, edit));
+    CHECK_EQ(g_core.keys.size(), 3u);
+}
+
+static void TestWordEnds() {
+    CoreEngine engine;
+    StartFakeEngine(engine);
+    KeyHandler keys(engine);
+    TextEdit edit;
+    ShortcutManager& shortcuts = ShortcutManager::Instance();
+    shortcuts.Clear();
+
+    // The shortcut buffer follows the typed characters
+    keys.OnKeyPressed(VK_A, false, false, edit);
+    keys.OnKeyPressed(VK_S, false, false, edit);
+    CHECK(shortcuts.CurrentBuffer() == "as");
+    keys.OnKeyPressed(VK_BACK_KEY, false, false, edit);
+    CHECK(shortcuts.CurrentBuffer() == "a");
+
+    // Space ends the word after the engine has seen it, letters do not
+    keys.KeyDone(VK_A);
+    CHECK_EQ(g_core.clears, 0);
+    keys.KeyDone(VK_SPACE_KEY);
+    CHECK_EQ(g_core.clears, 1);
+
+    // Pass-through forgets the word; a native repeat forgets the history too
+    keys.OnKeyPressed(VK_A, false, false, edit);
+    keys.Reset();
+    CHECK_EQ(g_core.clears, 2);
+    CHECK(shortcuts.CurrentBuffer().empty());
+    int clearAlls = g_core.clearAlls;
+    keys.OnKeyPressed(VK_A, false, false, edit);
+    keys.Resync();
+    CHECK_EQ(g_core.clearAlls, clearAlls + 1);
+    CHECK(shortcuts.CurrentBuffer().empty());
+}
+
+int main() {
+    TestAdmit();
+    TestEngineAnswers();
+    TestKeyState();
+    TestWordEnds();
+    return TestResult("test_key_handler");
+}
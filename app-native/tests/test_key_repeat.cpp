@@ -0,0 +1,88 @@
+// ViKey - Auto-repeat Tracker Tests
+// test_key_repeat.cpp
+// Presses and repeats, resync on release or interruption, stuck keys, and
+// the hook's clock wrapping
+
+#include "key_repeat.h"
+#include "test_common.h"
+
+static const uint8_t VK_A = 'A', VK_B = 'B', VK_BACK = 0x08, VK_SHIFT = 0x10;
+
+static void TestPressesAndRepeats() {
+    KeyRepeatTracker keys;
+    CHECK(!keys.KeyDown(VK_A, 1000));
+    CHECK(!keys.KeyUp(VK_A));
+    CHECK(!keys.KeyDown(VK_A, 1100));  // typed twice, not held
+    CHECK(!keys.KeyUp(VK_A));
+
+    // Held: the first down is a press, then the typematic delay, then repeats
+    CHECK(!keys.KeyDown(VK_BACK, 2000));
+    CHECK(keys.KeyDown(VK_BACK, 2500));
+    for (uint32_t t = 2533; t < 3500; t += 33) CHECK(keys.KeyDown(VK_BACK, t));
+
+    // Repeats the engine saw need no resync
+    CHECK(!keys.KeyUp(VK_BACK));
+    CHECK(!keys.TakeResync());
+    CHECK_EQ(keys.GetStats().presses, 3u);
+    CHECK_EQ(keys.GetStats().repeats, 31u);
+    CHECK_EQ(keys.GetStats().resyncs, 0u);
+}
+
+static void TestResyncOnRelease() {
+    KeyRepeatTracker keys;
+    CHECK(!keys.KeyDown(VK_SHIFT, 0));
+    CHECK(!keys.KeyDown(VK_A, 10));
+    for (uint32_t t = 500; t < 1000; t += 33) {
+        CHECK(keys.KeyDown(VK_A, t));
+        keys.Bypassed(VK_A);
+    }
+    CHECK_EQ(keys.GetStats().bypassed, 16u);
+
+    // Releasing another key changes nothing; releasing the held one resyncs once
+    CHECK(!keys.KeyUp(VK_SHIFT));
+    CHECK(keys.KeyUp(VK_A));
+    CHECK(!keys.TakeResync());
+    CHECK(!keys.KeyDown(VK_A, 1200));
+    CHECK(!keys.KeyUp(VK_A));
+    CHECK_EQ(keys.GetStats().resyncs, 1u);
+}
+
+static void TestResyncWhenInterrupted() {
+    KeyRepeatTracker keys;
+    keys.KeyDown(VK_A, 0);
+    CHECK(keys.KeyDown(VK_A, 500));
+    keys.Bypassed(VK_A);
+
+    // B pressed while A is still held: Windows repeats B from now on, and B
+    // must reach an engine that has forgotten A's run
+    CHECK(!keys.KeyDown(VK_B, 520));
+    CHECK(keys.TakeResync());
+    CHECK(!keys.TakeResync());
+    CHECK(!keys.KeyUp(VK_A));
+
+    CHECK(keys.KeyDown(VK_B, 1020));
+    keys.Bypassed(VK_B);
+    CHECK(keys.KeyUp(VK_B));
+    CHECK_EQ(keys.GetStats().resyncs, 2u);
+}
+
+static void TestMissedKeyUp() {
+    KeyRepeatTracker keys;
+    keys.KeyDown(VK_A, 1000);
+    // No key-up arrived; a press much later is not a repeat
+    CHECK(!keys.KeyDown(VK_A, 1000 + KeyRepeatTracker::MAX_REPEAT_GAP_MS + 1));
+    CHECK(keys.KeyDown(VK_A, 1000 + KeyRepeatTracker::MAX_REPEAT_GAP_MS + 40));
+
+    // The hook's clock wraps after 49.7 days
+    keys.KeyUp(VK_A);
+    CHECK(!keys.KeyDown(VK_B, 0xFFFFFF00u));
+    CHECK(keys.KeyDown(VK_B, 0x00000100u));  // 512 ms later
+}
+
+int main() {
+    TestPressesAndRepeats();
+    TestResyncOnRelease();
+    TestResyncWhenInterrupted();
+    TestMissedKeyUp();
+    return TestResult("test_key_repeat");
+}
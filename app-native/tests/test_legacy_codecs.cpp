@@ -0,0 +1,119 @@
+// ViKey - Legacy Codec Tests
+// test_legacy_codecs.cpp
+// TCVN3, VISCII, VIQR and UTF-8 byte codecs: known sequences and round trips
+
+#include "encoding_converter.h"
+#include "test_common.h"
+
+static const std::wstring LETTERS =
+    L"aàảãáạăằẳẵắặâầẩẫấậeèẻẽéẹêềểễếệiìỉĩíịoòỏõóọôồổỗốộơờởỡớợuùủũúụưừửữứựyỳỷỹýỵđ"
+    L"AÀẢÃÁẠĂẰẲẴẮẶÂẦẨẪẤẬEÈẺẼÉẸÊỀỂỄẾỆIÌỈĨÍỊOÒỎÕÓỌÔỒỔỖỐỘƠỜỞỠỚỢUÙỦŨÚỤƯỪỬỮỨỰYỲỶỸÝỴĐ";
+
+static std::wstring Convert(const std::wstring& text, VietEncoding from, VietEncoding to) {
+    return EncodingConverter::Instance().Convert(text, from, to);
+}
+
+static void TestTcvn3() {
+    CHECK(Convert(L"Việt Nam", VietEncoding::Unicode, VietEncoding::TCVN3) == L"Vi\xD6t Nam");
+    CHECK(Convert(L"ẹé", VietEncoding::Unicode, VietEncoding::TCVN3) == L"\xD1\xD0");
+    CHECK(Convert(L"ôơư ÔƠƯ Đđ", VietEncoding::Unicode, VietEncoding::TCVN3) == L"\xAB\xAC\xAD \xA4\xA5\xA6 \xA7\xAE");
+    CHECK(Convert(L"\xD0\xD1\xA7", VietEncoding::TCVN3, VietEncoding::Unicode) == L"éẹĐ");
+    // Capitals with a tone: the gaps between small letters, and C0 controls
+    CHECK(Convert(L"\x80\xFF\x01\x17", VietEncoding::TCVN3, VietEncoding::Unicode) == L"ÀỐÚỴ");
+
+    // Every letter has its own byte, so the round trip is exact
+    std::wstring tcvn3 = Convert(LETTERS, VietEncoding::Unicode, VietEncoding::TCVN3);
+    CHECK(tcvn3.size() == LETTERS.size());
+    bool seen[256] = {};
+    size_t distinct = 0;
+    for (wchar_t c : tcvn3) {
+        CHECK(static_cast<uint32_t>(c) < 0x100);
+        if (static_cast<uint32_t>(c) < 0x100 && !seen[c]) {
+            seen[c] = true;
+            distinct++;
+        }
+    }
+    CHECK_EQ(distinct, LETTERS.size());
+    CHECK(Convert(tcvn3, VietEncoding::TCVN3, VietEncoding::Unicode) == LETTERS);
+    for (wchar_t c : LETTERS) {
+        std::wstring one(1, c);
+        CHECK(Convert(Convert(one, VietEncoding::Unicode, VietEncoding::TCVN3), VietEncoding::TCVN3,
+                      VietEncoding::Unicode) == one);
+    }
+}
+
+static void TestViscii() {
+    CHECK(Convert(L"Việt Nam", VietEncoding::Unicode, VietEncoding::VISCII) == L"Vi\xAEt Nam");
+    CHECK(Convert(L"Đ", VietEncoding::Unicode, VietEncoding::VISCII) == L"\xD0");
+    // Six letters live in C0 control positions
+    CHECK(Convert(L"\x02\x05\x06\x14\x19\x1E", VietEncoding::VISCII, VietEncoding::Unicode) == L"ẲẴẪỶỸỴ");
+
+    // Every letter has its own byte, so the round trip is exact
+    std::wstring viscii = Convert(LETTERS, VietEncoding::Unicode, VietEncoding::VISCII);
+    CHECK(viscii.size() == LETTERS.size());
+    for (wchar_t c : viscii) CHECK(static_cast<uint32_t>(c) < 0x100);
+    CHECK(Convert(viscii, VietEncoding::VISCII, VietEncoding::Unicode) == LETTERS);
+
+    // Characters VISCII cannot hold pass through
+    CHECK(Convert(L"€", VietEncoding::Unicode, VietEncoding::VISCII) == L"€");
+}
+
+static void TestViqrSpellings() {
+    CHECK(Convert(L"Việt Nam", VietEncoding::Unicode, VietEncoding::VIQR) == L"Vie^.t Nam");
+    CHECK(Convert(L"người Đà Nẵng", VietEncoding::Unicode, VietEncoding::VIQR) == L"ngu+o+`i DDa` Na(~ng");
+
+    CHECK(Convert(L"Vie^.t", VietEncoding::VIQR, VietEncoding::Unicode) == L"Việt");
+    CHECK(Convert(L"Vie.^t", VietEncoding::VIQR, VietEncoding::Unicode) == L"Việt");  // tone first
+    CHECK(Convert(L"ddu+o+`ng", VietEncoding::VIQR, VietEncoding::Unicode) == L"đường");
+    CHECK(Convert(L"a\\. b\\?", VietEncoding::VIQR, VietEncoding::Unicode) == L"a. b?");
+    CHECK(Convert(L"e^^", VietEncoding::VIQR, VietEncoding::Unicode) == L"ê^");
+}
+
+static void TestViqrRoundTrip() {
+    // Literal mnemonics after letters, backslashes and d before đ all need escapes
+    const wchar_t* const tricky[] = {
+        L"dđ", L"ddd", L"Dđ", L"a.", L"Ha? Vâng.", L"\\.", L"a\\", L"\\\\", L"o+", L"u'", L"ê^", L"cd", L"",
+    };
+    for (const wchar_t* s : tricky) {
+        std::wstring viqr = Convert(s, VietEncoding::Unicode, VietEncoding::VIQR);
+        CHECK(Convert(viqr, VietEncoding::VIQR, VietEncoding::Unicode) == s);
+    }
+    CHECK(Convert(L"a.", VietEncoding::Unicode, VietEncoding::VIQR) == L"a\\.");
+    CHECK(Convert(L"dđ", VietEncoding::Unicode, VietEncoding::VIQR) == L"\\ddd");
+
+    for (wchar_t c : LETTERS) {
+        std::wstring one(1, c);
+        std::wstring viqr = Convert(one, VietEncoding::Unicode, VietEncoding::VIQR);
+        for (wchar_t b : viqr) CHECK(static_cast<uint32_t>(b) < 0x80);
+        CHECK(Convert(viqr, VietEncoding::VIQR, VietEncoding::Unicode) == one);
+    }
+    CHECK(Convert(Convert(LETTERS, VietEncoding::Unicode, VietEncoding::VIQR), VietEncoding::VIQR,
+                  VietEncoding::Unicode) == LETTERS);
+}
+
+static void TestUtf8Bytes() {
+    // "Việt" saved as UTF-8 and read back one byte per character
+    CHECK(Convert(L"Vi\xE1\xBB\x87t", VietEncoding::UTF8_Bytes, VietEncoding::Unicode) == L"Việt");
+    CHECK(Convert(L"Việt", VietEncoding::Unicode, VietEncoding::UTF8_Bytes) == L"Vi\xE1\xBB\x87t");
+    CHECK(Convert(LETTERS, VietEncoding::Unicode, VietEncoding::UTF8_Bytes).size() > LETTERS.size());
+    CHECK(Convert(Convert(LETTERS, VietEncoding::Unicode, VietEncoding::UTF8_Bytes), VietEncoding::UTF8_Bytes,
+                  VietEncoding::Unicode) == LETTERS);
+
+    // Invalid, overlong and surrogate sequences are left as they are
+    CHECK(Convert(L"\xE1x\xBB", VietEncoding::UTF8_Bytes, VietEncoding::Unicode) == L"\xE1x\xBB");
+    CHECK(Convert(L"\xC0\xAF", VietEncoding::UTF8_Bytes, VietEncoding::Unicode) == L"\xC0\xAF");
+    CHECK(Convert(L"\xE0\x80\x80", VietEncoding::UTF8_Bytes, VietEncoding::Unicode) == L"\xE0\x80\x80");
+    CHECK(Convert(L"\xED\xA0\x80", VietEncoding::UTF8_Bytes, VietEncoding::Unicode) == L"\xED\xA0\x80");
+
+    // A broken sequence does not swallow the lead byte that follows it
+    CHECK(Convert(L"\xE1\xC3\xA1", VietEncoding::UTF8_Bytes, VietEncoding::Unicode) == L"\xE1\u00E1");
+}
+
+int main() {
+    TestTcvn3();
+    TestViscii();
+    TestViqrSpellings();
+    TestViqrRoundTrip();
+    TestUtf8Bytes();
+    return TestResult("test_legacy_codecs");
+}
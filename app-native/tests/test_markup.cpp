@@ -0,0 +1,199 @@
+// ViKey - Markup Converter Tests
+// test_markup.cpp
+// HTML and RTF streaming conversion: markup kept, text runs and escapes converted
+
+#include "markup_converter.h"
+#include "test_common.h"
+#include <algorithm>
+
+// Convert input fed in pieces of chunk bytes (0 = all at once)
+static std::string Run(MarkupFormat format, VietEncoding from, VietEncoding to, const std::string& input,
+                       size_t chunk = 0) {
+    MarkupConverter converter(format, from, to);
+    std::string out;
+    if (chunk == 0) chunk = input.size() + 1;
+    for (size_t i = 0; i < input.size(); i += chunk) {
+        converter.Feed(input.data() + i, std::min(chunk, input.size() - i), out);
+    }
+    converter.Finish(out);
+    return out;
+}
+
+// Bytes of a Unicode string in enc, as a file would hold them
+static std::string Bytes(const std::wstring& text, VietEncoding enc) {
+    std::wstring converted = EncodingConverter::Instance().Convert(text, VietEncoding::Unicode, enc);
+    return EncodingConverter::EncodeBytes(converted, enc);
+}
+
+static std::string RtfHex(const std::string& bytes) {
+    std::string out;
+    for (unsigned char b : bytes) {
+        if (b < 0x80) {
+            out += static_cast<char>(b);
+        } else {
+            out += "\\'";
+            out += "0123456789abcdef"[b >> 4];
+            out += "0123456789abcdef"[b & 0xF];
+        }
+    }
+    return out;
+}
+
+static void TestHtmlMarkup() {
+    const VietEncoding U = VietEncoding::Unicode;
+    const VietEncoding T = VietEncoding::TCVN3;
+    const VietEncoding V = VietEncoding::VNI_Windows;
+
+    CHECK(Run(MarkupFormat::Html, U, T, Bytes(L"<p title=\"a<b\">Việt Nam</p>", U)) ==
+          "<p title=\"a<b\">" + Bytes(L"Việt Nam", T) + "</p>");
+
+    // Between two legacy encodings markup bytes are copied as they are
+    const std::string t = Bytes(L"Việt", T);
+    const std::string v = Bytes(L"Việt", V);
+    CHECK(Run(MarkupFormat::Html, T, V, "<a href=\"" + t + "\">" + t + "</a><!-- " + t + " -->") ==
+          "<a href=\"" + t + "\">" + v + "</a><!-- " + t + " -->");
+    CHECK(Run(MarkupFormat::Html, T, V, "<script>if (a<b) s = \"" + t + "\";</script>" + t) ==
+          "<script>if (a<b) s = \"" + t + "\";</script>" + v);
+    CHECK(Run(MarkupFormat::Html, T, V, "<STYLE>p{font:" + t + "}</Style>" + t) ==
+          "<STYLE>p{font:" + t + "}</Style>" + v);
+
+    // A '<' that does not open a tag is text
+    CHECK(Run(MarkupFormat::Html, T, V, "1 < 2 " + t) == "1 < 2 " + v);
+}
+
+static void TestHtmlEntities() {
+    const VietEncoding U = VietEncoding::Unicode;
+    const VietEncoding T = VietEncoding::TCVN3;
+
+    // Numeric references are text; they are written in the target encoding
+    CHECK(Run(MarkupFormat::Html, U, T, "Vi&#7879;t Vi&#x1EC7;t") == Bytes(L"Việt Việt", T));
+    CHECK(Run(MarkupFormat::Html, U, U, "Vi&#7879;t") == Bytes(L"Việt", U));
+
+    // Named, ASCII and malformed references are kept as written
+    CHECK(Run(MarkupFormat::Html, U, T, "a &amp; b &#60; &#xZZ; & c &#55296;") == "a &amp; b &#60; &#xZZ; & c &#55296;");
+
+    // A reference that cannot be held by the target stays a reference
+    CHECK(Run(MarkupFormat::Html, U, T, Bytes(L"5 €", U)) == "5 &#8364;");
+    CHECK(Run(MarkupFormat::Html, U, T, "5 &#8364;") == "5 &#8364;");
+}
+
+static void TestChunking() {
+    const VietEncoding U = VietEncoding::Unicode;
+    const VietEncoding V = VietEncoding::VNI_Windows;
+
+    const std::string html = Bytes(L"\xFEFF<html><body class='x'>Tiếng <b>Việt</b> &#7879;&amp; "
+                                   L"<!-- c -- d --> <script>a</script>người</body></html>", U);
+    const std::string expected = Run(MarkupFormat::Html, U, V, html);
+    CHECK(expected.compare(0, 6, "<html>") == 0);  // BOM dropped
+    for (size_t chunk = 1; chunk < 8; chunk++) CHECK(Run(MarkupFormat::Html, U, V, html, chunk) == expected);
+
+    // VNI pairs split across pieces still combine
+    const std::string vni = Bytes(L"Tiếng Việt người", V);
+    for (size_t chunk = 1; chunk < 5; chunk++) {
+        CHECK(Run(MarkupFormat::Text, V, U, vni, chunk) == Bytes(L"Tiếng Việt người", U));
+    }
+
+    const std::string rtf = "{\\rtf1{\\fonttbl{\\f0 Vie\xE4t;}}\\uc1 Vi\\u7879?t Vie\\'e4t\\par}";
+    const std::string rtfExpected = Run(MarkupFormat::Rtf, V, U, rtf);
+    for (size_t chunk = 1; chunk < 6; chunk++) CHECK(Run(MarkupFormat::Rtf, V, U, rtf, chunk) == rtfExpected);
+}
+
+static void TestPlainText() {
+    const VietEncoding U = VietEncoding::Unicode;
+    const VietEncoding T = VietEncoding::TCVN3;
+
+    // No markup: "<b>" is text like any other
+    CHECK(Run(MarkupFormat::Text, U, T, Bytes(L"<b>Việt</b> &#7879;", U)) == Bytes(L"<b>Việt</b> &#7879;", T));
+
+    // Malformed UTF-8 becomes U+FFFD, which TCVN3 writes as '?'
+    CHECK(Run(MarkupFormat::Text, U, T, "a\xE1\xBB") == "a??");
+    CHECK(Run(MarkupFormat::Text, U, U, "a\xC3", 1) == "a\xEF\xBF\xBD");
+}
+
+static void TestRtf() {
+    const VietEncoding U = VietEncoding::Unicode;
+    const VietEncoding T = VietEncoding::TCVN3;
+    const VietEncoding V = VietEncoding::VNI_Windows;
+
+    // \'xx escapes are bytes of the source encoding; Unicode targets get \uN
+    CHECK(Run(MarkupFormat::Rtf, T, U, "{\\rtf1 Vi" + RtfHex(Bytes(L"ệ", T)) + "t}") == "{\\rtf1 Vi\\u7879?t}");
+    CHECK(Run(MarkupFormat::Rtf, U, T, "{\\rtf1 Vi\\u7879?t}") == "{\\rtf1 Vi" + RtfHex(Bytes(L"ệ", T)) + "t}");
+    CHECK(Run(MarkupFormat::Rtf, V, U, "{\\rtf1 Vie\\'e4t \\b Nam\\b0}") == "{\\rtf1 Vi\\u7879?t \\b Nam\\b0}");
+
+    // \ucN sets how many fallback characters follow \uN, per group
+    CHECK(Run(MarkupFormat::Rtf, U, U, "{\\uc2 \\u7879ee{\\uc0 \\u7879}\\u7879ee}") ==
+          "{\\uc2 \\u7879??{\\uc0 \\u7879}\\u7879??}");
+    CHECK(Run(MarkupFormat::Rtf, U, U, "\\u-10179?\\u-8704?") == "\\u-10179?\\u-8704?");
+
+    // Tables, \* destinations and \bin data are copied whole
+    CHECK(Run(MarkupFormat::Rtf, V, U, "{\\fonttbl{\\f0 Vie\xE4t;}}{\\*\\generator Vie\\'e4t;}Vie\xE4t") ==
+          "{\\fonttbl{\\f0 Vie\xE4t;}}{\\*\\generator Vie\\'e4t;}Vi\\u7879?t");
+    const std::string binary("}\\{\0", 4);
+    CHECK(Run(MarkupFormat::Rtf, V, U, "{\\pict\\bin4 " + binary + "}Vie\\'e4t") ==
+          "{\\pict\\bin4 " + binary + "}Vi\\u7879?t");
+    CHECK(Run(MarkupFormat::Rtf, V, U, "\\bin3 \\'aVie\\'e4t") == "\\bin3 \\'aVi\\u7879?t");
+
+    // Escaped specials, line breaks inside a word, unrepresentable text
+    CHECK(Run(MarkupFormat::Rtf, V, U, "a\\{b\\}c\\\\d") == "a\\{b\\}c\\\\d");
+    CHECK(Run(MarkupFormat::Rtf, V, U, "Vie\r\n\\'e4t") == "Vi\r\n\\u7879?t");
+    CHECK(Run(MarkupFormat::Rtf, U, T, "\\u8364?") == "\\u8364?");
+}
+
+// Every split of the input into two pieces, and byte by byte
+static bool SameUnderEverySplit(MarkupFormat format, VietEncoding from, VietEncoding to, const std::string& input,
+                                const std::string& expected) {
+    bool same = Run(format, from, to, input) == expected && Run(format, from, to, input, 1) == expected;
+    for (size_t at = 1; at < input.size(); at++) {
+        MarkupConverter converter(format, from, to);
+        std::string out;
+        converter.Feed(input.data(), at, out);
+        converter.Feed(input.data() + at, input.size() - at, out);
+        converter.Finish(out);
+        same = same && out == expected;
+    }
+    return same;
+}
+
+static void TestRtfUnicodeDelimiter() {
+    const VietEncoding U = VietEncoding::Unicode;
+    const VietEncoding V = VietEncoding::VNI_Windows;
+
+    // The space after \uN ends the control word; it is neither text nor the
+    // fallback character, which here is the y
+    CHECK(SameUnderEverySplit(MarkupFormat::Rtf, U, V, "{\\rtf1 x\\u7879 y}", "{\\rtf1 xe\\'e4}"));
+    CHECK(SameUnderEverySplit(MarkupFormat::Rtf, U, V, "{\\rtf1 x\\u7879 ?y}", "{\\rtf1 xe\\'e4y}"));
+    CHECK(SameUnderEverySplit(MarkupFormat::Rtf, U, V, "{\\rtf1\\uc0 x\\u7879 y}", "{\\rtf1\\uc0 xe\\'e4y}"));
+    CHECK(SameUnderEverySplit(MarkupFormat::Rtf, U, V, "{\\rtf1\\uc2 x\\u7879 ??y z}", "{\\rtf1\\uc2 xe\\'e4y z}"));
+
+    // A following space or digit of the text stays text
+    CHECK(SameUnderEverySplit(MarkupFormat::Rtf, U, V, "{\\rtf1\\uc0 x\\u7879  1}", "{\\rtf1\\uc0 xe\\'e4 1}"));
+    CHECK(SameUnderEverySplit(MarkupFormat::Rtf, U, V, "{\\rtf1 x\\u7879 ?1}", "{\\rtf1 xe\\'e41}"));
+
+    // Without fallback characters a written \uN gets a delimiter only before
+    // a digit or space
+    CHECK(SameUnderEverySplit(MarkupFormat::Rtf, U, U, "{\\rtf1\\uc0 x\\u7879 y}", "{\\rtf1\\uc0 x\\u7879y}"));
+    CHECK(SameUnderEverySplit(MarkupFormat::Rtf, U, U, "{\\uc0 \\u7879 1 2}", "{\\uc0 \\u7879 1 2}"));
+    CHECK(SameUnderEverySplit(MarkupFormat::Rtf, U, U, "{\\rtf1 x\\u7879 ?y}", "{\\rtf1 x\\u7879?y}"));
+
+    // Other control words keep theirs
+    CHECK(SameUnderEverySplit(MarkupFormat::Rtf, U, V, "{\\b x\\u7879 \\b0 y}", "{\\b xe\\'e4\\b0 y}"));
+}
+
+static void TestFormatForPath() {
+    CHECK(MarkupConverter::FormatForPath("a/b/page.HTML") == MarkupFormat::Html);
+    CHECK(MarkupConverter::FormatForPath("page.htm") == MarkupFormat::Html);
+    CHECK(MarkupConverter::FormatForPath("doc.rtf") == MarkupFormat::Rtf);
+    CHECK(MarkupConverter::FormatForPath("notes.txt") == MarkupFormat::Text);
+    CHECK(MarkupConverter::FormatForPath("dir.rtf/notes") == MarkupFormat::Text);
+}
+
+int main() {
+    TestHtmlMarkup();
+    TestHtmlEntities();
+    TestChunking();
+    TestPlainText();
+    TestRtf();
+    TestRtfUnicodeDelimiter();
+    TestFormatForPath();
+    return TestResult("test_markup");
+}
@@ -0,0 +1,175 @@
+// ViKey - Normalizer Tests
+// test_normalizer.cpp
+// Checks VietNormalizer against Unicode normalization data for the covered range.
+// Pass NormalizationTest.txt as argv[1] (or VIKEY_NORMALIZATION_TEST) to run
+// the official conformance lines too; with ICU available every covered letter
+// and mark sequence is also cross-checked against ICU.
+
+#include "test_common.h"
+#include "viet_normalizer.h"
+
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <vector>
+
+#ifdef VIKEY_HAVE_ICU
+#include <unicode/normalizer2.h>
+#include <unicode/unistr.h>
+#endif
+
+static std::wstring Nfc(const std::wstring& s) {
+    std::wstring out;
+    VietNormalizer::ToNfc(s.data(), s.size(), out);
+    return out;
+}
+
+static std::wstring Nfd(const std::wstring& s) {
+    std::wstring out;
+    VietNormalizer::ToNfd(s.data(), s.size(), out);
+    return out;
+}
+
+// Source, NFC, NFD (columns c1, c2, c3 of NormalizationTest.txt)
+struct Vector {
+    const wchar_t* source;
+    const wchar_t* nfc;
+    const wchar_t* nfd;
+};
+
+static const Vector VECTORS[] = {
+    {L"Việt", L"Việt", L"Việt"},
+    {L"Việt", L"Việt", L"Việt"},         // marks out of canonical order
+    {L"ệ", L"ệ", L"ệ"},                    // precomposed + extra mark
+    {L"ớ", L"ớ", L"ớ"},                   // horn (216) sorts before acute (230)
+    {L"ớ", L"ớ", L"ớ"},
+    {L"ự̀", L"ự̀", L"ự̀"},  // dot composes first, grave left over
+    {L"á́", L"á́", L"á́"},              // second acute is blocked
+    {L"ǖ", L"ǖ", L"ǖ"},
+    {L"Ḉ", L"Ḉ", L"Ḉ"},
+    {L"ą́", L"ą́", L"ą́"},              // no precomposed ą́
+    {L"́a", L"́a", L"́a"},                               // leading mark, no starter
+    {L"được", L"được", L"được"},
+    {L"ASCII only.", L"ASCII only.", L"ASCII only."},
+};
+
+static void TestVectors() {
+    for (const Vector& v : VECTORS) {
+        CHECK(Nfc(v.source) == v.nfc);
+        CHECK(Nfd(v.source) == v.nfd);
+        CHECK(Nfc(v.nfc) == v.nfc);
+        CHECK(Nfc(v.nfd) == v.nfc);
+        CHECK(Nfd(v.nfc) == v.nfd);
+        CHECK(Nfd(v.nfd) == v.nfd);
+    }
+}
+
+// Every covered letter decomposes and recomposes to itself
+static void TestRoundTrip() {
+    int decomposable = 0;
+    for (wchar_t c = 0x20; c < 0x2000; c++) {
+        std::wstring s(1, c);
+        std::wstring d = Nfd(s);
+        if (d != s) decomposable++;
+        CHECK(Nfc(d) == s);
+        CHECK(Nfc(s) == s);
+    }
+    CHECK_EQ(decomposable, 419);
+}
+
+static std::wstring ParseColumn(const std::string& column) {
+    std::wstring s;
+    std::istringstream in(column);
+    std::string hex;
+    while (in >> hex) s += static_cast<wchar_t>(std::strtoul(hex.c_str(), nullptr, 16));
+    return s;
+}
+
+static bool InCoveredRange(const std::wstring& s) {
+    for (wchar_t c : s) {
+        uint32_t cp = static_cast<uint32_t>(c);
+        bool ok = cp < 0x80 || VietNormalizer::CombiningClass(c) != 0 || Nfd(std::wstring(1, c)).size() > 1;
+        if (!ok || cp > 0xFFFF) return false;
+    }
+    return true;
+}
+
+static void TestConformanceFile(const char* path) {
+    std::ifstream file(path);
+    if (!file) {
+        std::printf("NormalizationTest.txt not found at %s, skipping\n", path);
+        return;
+    }
+
+    int checked = 0;
+    std::string line;
+    while (std::getline(file, line)) {
+        if (line.empty() || line[0] == '#' || line[0] == '@') continue;
+        std::vector<std::wstring> cols;
+        std::istringstream in(line);
+        std::string col;
+        while (cols.size() < 3 && std::getline(in, col, ';')) cols.push_back(ParseColumn(col));
+        if (cols.size() < 3 || !InCoveredRange(cols[0]) || !InCoveredRange(cols[1]) || !InCoveredRange(cols[2])) {
+            continue;
+        }
+        CHECK(Nfc(cols[0]) == cols[1]);
+        CHECK(Nfd(cols[0]) == cols[2]);
+        CHECK(Nfc(cols[2]) == cols[1]);
+        CHECK(Nfd(cols[1]) == cols[2]);
+        checked++;
+    }
+    std::printf("NormalizationTest.txt: %d line(s) in the covered range checked\n", checked);
+}
+
+#ifdef VIKEY_HAVE_ICU
+static std::wstring IcuNormalize(const icu::Normalizer2* norm, const std::wstring& s) {
+    icu::UnicodeString u;
+    for (wchar_t c : s) u.append(static_cast<UChar32>(c));
+    UErrorCode status = U_ZERO_ERROR;
+    icu::UnicodeString r = norm->normalize(u, status);
+    std::wstring out;
+    for (int32_t i = 0; i < r.length(); i = r.moveIndex32(i, 1)) out += static_cast<wchar_t>(r.char32At(i));
+    return out;
+}
+
+static void TestAgainstIcu() {
+    UErrorCode status = U_ZERO_ERROR;
+    const icu::Normalizer2* nfc = icu::Normalizer2::getNFCInstance(status);
+    const icu::Normalizer2* nfd = icu::Normalizer2::getNFDInstance(status);
+    CHECK(U_SUCCESS(status));
+    if (U_FAILURE(status)) return;
+
+    const wchar_t marks[] = {0x0300, 0x0301, 0x0302, 0x0303, 0x0304, 0x0306, 0x0307, 0x0308,
+                             0x0309, 0x030A, 0x030B, 0x030C, 0x031B, 0x0323, 0x0327, 0x0328};
+    std::vector<std::wstring> inputs;
+    for (wchar_t c = 0xC0; c < 0x2000; c++) {
+        if (Nfd(std::wstring(1, c)).size() > 1) inputs.emplace_back(1, c);
+    }
+    for (wchar_t base : std::wstring(L"aAeEoOuUyYcCnNsSzZiI")) {
+        for (wchar_t m1 : marks) {
+            for (wchar_t m2 : marks) {
+                inputs.push_back(std::wstring{base, m1, m2});
+            }
+        }
+    }
+
+    for (const auto& s : inputs) {
+        CHECK(Nfc(s) == IcuNormalize(nfc, s));
+        CHECK(Nfd(s) == IcuNormalize(nfd, s));
+    }
+    std::printf("ICU cross-check: %zu input(s)\n", inputs.size());
+}
+#endif
+
+int main(int argc, char** argv) {
+    TestVectors();
+    TestRoundTrip();
+
+    const char* path = argc > 1 ? argv[1] : std::getenv("VIKEY_NORMALIZATION_TEST");
+    if (path) TestConformanceFile(path);
+
+#ifdef VIKEY_HAVE_ICU
+    TestAgainstIcu();
+#endif
+    return TestResult("test_normalizer");
+}
@@ -0,0 +1,229 @@
+// ViKey - Word Result Cache Tests
+// test_result_cache.cpp
+// Cacheable keys, hits and pending strokes, what ends a word, settings, and
+// a replay against a stand-in engine that must never fall out of step
+
+#include "result_cache.h"
+#include "test_common.h"
+#include <string>
+
+// macOS keycodes used below
+static const uint16_t KEY_A = 0, KEY_S = 1, KEY_N = 45, KEY_G = 5;
+static const uint16_t KEY_1 = 18, KEY_SPACE = 49, KEY_DELETE = 51, KEY_ESC = 53;
+
+static CachedResult Result(uint32_t c, uint8_t backspace = 0) {
+    CachedResult result;
+    result.action = 1;
+    result.backspace = backspace;
+    result.chars = {c};
+    return result;
+}
+
+static uint32_t Key(uint16_t keycode, bool caps = false) {
+    return ResultCache::Stroke(keycode, caps, false);
+}
+
+static void TestCacheableKeys() {
+    CHECK(ResultCache::IsCacheable(Key(KEY_A)));
+    CHECK(ResultCache::IsCacheable(Key(KEY_N, true)));
+    CHECK(ResultCache::IsCacheable(Key(KEY_1)));
+    CHECK(!ResultCache::IsCacheable(ResultCache::Stroke(KEY_1, false, true)));  // '!'
+    CHECK(ResultCache::IsCacheable(ResultCache::Stroke(KEY_A, false, true)));
+    CHECK(!ResultCache::IsCacheable(Key(KEY_SPACE)));
+    CHECK(!ResultCache::IsCacheable(Key(KEY_DELETE)));
+    CHECK(!ResultCache::IsCacheable(Key(KEY_ESC)));
+    CHECK(!ResultCache::IsCacheable(Key(10)));   // unused keycode between B and V
+    CHECK(!ResultCache::IsCacheable(Key(200)));
+
+    int letters = 0;
+    for (uint16_t k = 0; k < 128; k++) letters += ResultCache::IsCacheable(Key(k));
+    CHECK_EQ(letters, 36);
+}
+
+static void TestHitsAndPending() {
+    ResultCache cache;
+    cache.SetConfig(7);
+
+    // Nothing is cached before the first clear
+    CHECK(cache.Lookup(Key(KEY_A)) == nullptr);
+    cache.Record(Key(KEY_A), Result('a'));
+    CHECK_EQ(cache.Size(), 0u);
+
+    // "as" once through the engine...
+    cache.Anchor();
+    CHECK(cache.Lookup(Key(KEY_A)) == nullptr);
+    cache.Record(Key(KEY_A), Result('a'));
+    CHECK(cache.Lookup(Key(KEY_S)) == nullptr);
+    cache.Record(Key(KEY_S), Result(0xE1, 1));
+    CHECK_EQ(cache.Size(), 2u);
+    CHECK(cache.Pending().empty());
+
+    // ...and again from the cache, with the engine left behind
+    cache.Anchor();
+    const CachedResult* a = cache.Lookup(Key(KEY_A));
+    CHECK(a && a->chars.size() == 1 && a->chars[0] == 'a');
+    const CachedResult* s = cache.Lookup(Key(KEY_S));
+    CHECK(s && s->backspace == 1 && s->chars[0] == 0xE1);
+    CHECK_EQ(cache.Pending().size(), 2u);
+    CHECK_EQ(cache.Pending()[1], Key(KEY_S));
+
+    // A new prefix misses; the owner replays, then records
+    CHECK(cache.Lookup(Key(KEY_N)) == nullptr);
+    cache.PendingReplayed();
+    cache.Record(Key(KEY_N), Result('n'));
+    CHECK(cache.Pending().empty());
+    CHECK_EQ(cache.GetStats().hits, 2u);
+    CHECK_EQ(cache.GetStats().misses, 3u);
+    CHECK_EQ(cache.GetStats().replayed, 2u);
+
+    // The same letter elsewhere in a word is a different entry
+    cache.Anchor();
+    CHECK(cache.Lookup(Key(KEY_S)) == nullptr);
+    // Caps is part of the key
+    cache.Anchor();
+    CHECK(cache.Lookup(Key(KEY_A, true)) == nullptr);
+}
+
+static void TestWordEnds() {
+    ResultCache cache;
+    cache.SetConfig(1);
+    cache.Anchor();
+    cache.Record(Key(KEY_A), Result('a'));
+
+    // Backspace reads state from before the word: it ends caching until a clear
+    cache.Record(Key(KEY_DELETE), CachedResult());
+    cache.Record(Key(KEY_N), Result('n'));
+    CHECK_EQ(cache.Size(), 1u);
+    CHECK(cache.Lookup(Key(KEY_G)) == nullptr);
+
+    cache.Anchor();
+    CHECK(cache.Lookup(Key(KEY_A)) != nullptr);
+    cache.PendingReplayed();
+    cache.Break();
+    CHECK(cache.Lookup(Key(KEY_N)) == nullptr);
+
+    // Very long words are not cached past MAX_WORD
+    cache.Anchor();
+    for (size_t i = 0; i < ResultCache::MAX_WORD + 5; i++) cache.Record(Key(KEY_N), Result('n'));
+    CHECK_EQ(cache.Size(), 1u + ResultCache::MAX_WORD);
+}
+
+static void TestConfigAndClear() {
+    ResultCache cache;
+    cache.SetConfig(1);
+    cache.Anchor();
+    cache.Record(Key(KEY_A), Result('a'));
+
+    // Other settings do not see it; going back does
+    cache.SetConfig(2);
+    cache.Anchor();
+    CHECK(cache.Lookup(Key(KEY_A)) == nullptr);
+    cache.Record(Key(KEY_A), Result('A'));
+    cache.SetConfig(1);
+    cache.Anchor();
+    const CachedResult* a = cache.Lookup(Key(KEY_A));
+    CHECK(a && a->chars[0] == 'a');
+    CHECK_EQ(cache.Size(), 2u);
+
+    // A settings change ends the word
+    cache.SetConfig(1);
+    CHECK(cache.Lookup(Key(KEY_S)) == nullptr);
+
+    cache.Clear();
+    cache.Anchor();
+    CHECK_EQ(cache.Size(), 0u);
+    CHECK(cache.Lookup(Key(KEY_A)) == nullptr);
+}
+
+static void TestFlushWhenFull() {
+    ResultCache cache(4);
+    cache.SetConfig(1);
+    for (uint16_t k : {KEY_A, KEY_S, KEY_N, KEY_G, KEY_1}) {
+        cache.Anchor();
+        cache.Record(Key(k), Result(k));
+    }
+    CHECK_EQ(cache.GetStats().flushes, 1u);
+    CHECK_EQ(cache.Size(), 1u);
+    cache.Anchor();
+    CHECK(cache.Lookup(Key(KEY_1)) != nullptr);
+}
+
+// A stand-in engine whose answers depend on the whole word and on the word
+// before it (as Backspace after Space does in core): driven through the cache
+// the way RustBridge drives core, every answer must match the engine's own
+class StandInEngine {
+public:
+    CachedResult Key(uint32_t stroke) {
+        uint16_t keycode = stroke & 0xFFFF;
+        if (keycode == KEY_SPACE) {
+            m_previous = m_word;
+            m_word.clear();
+            return CachedResult();
+        }
+        if (keycode == KEY_DELETE) {
+            if (m_word.empty()) m_word = m_previous;
+            else m_word.pop_back();
+            return Result(static_cast<uint32_t>(m_word.size()), 1);
+        }
+        m_word.push_back(static_cast<char>('a' + keycode % 26));
+        uint32_t h = 0;
+        for (char c : m_word) h = h * 31 + c;
+        return Result(h, static_cast<uint8_t>(m_word.size() % 3));
+    }
+    void Clear() { m_word.clear(); }
+
+private:
+    std::string m_word;
+    std::string m_previous;
+};
+
+static void TestReplayKeepsEngineInStep() {
+    StandInEngine engine;      // behind the cache
+    StandInEngine reference;   // sees every key
+    ResultCache cache;
+    cache.SetConfig(3);
+    cache.Anchor();
+
+    const uint16_t words[][4] = {{KEY_A, KEY_N, KEY_G, KEY_S}, {KEY_N, KEY_A, KEY_1, KEY_S}, {KEY_G, KEY_A, KEY_A, KEY_N}};
+    uint32_t seed = 1;
+    for (int i = 0; i < 3000; i++) {
+        seed = seed * 1103515245 + 12345;
+        const uint16_t* word = words[(seed >> 16) % 3];
+        std::vector<uint32_t> strokes;
+        for (int k = 0; k < 4; k++) strokes.push_back(Key(word[k]));
+        if ((seed >> 8) % 5 == 0) strokes.push_back(Key(KEY_DELETE));
+        strokes.push_back(Key(KEY_SPACE));
+
+        for (uint32_t stroke : strokes) {
+            CachedResult expected = reference.Key(stroke);
+            CachedResult got;
+            if (const CachedResult* hit = cache.Lookup(stroke)) {
+                got = *hit;
+            } else {
+                for (uint32_t pending : cache.Pending()) engine.Key(pending);
+                cache.PendingReplayed();
+                got = engine.Key(stroke);
+                cache.Record(stroke, got);
+            }
+            CHECK(got.chars == expected.chars && got.backspace == expected.backspace);
+        }
+
+        // The hook clears after Space
+        for (uint32_t pending : cache.Pending()) engine.Key(pending);
+        cache.PendingReplayed();
+        engine.Clear();
+        reference.Clear();
+        cache.Anchor();
+    }
+    CHECK(cache.GetStats().hits > cache.GetStats().misses * 10);
+}
+
+int main() {
+    TestCacheableKeys();
+    TestHitsAndPending();
+    TestWordEnds();
+    TestConfigAndClear();
+    TestFlushWhenFull();
+    TestReplayKeepsEngineInStep();
+    return TestResult("test_result_cache");
+}
@@ -0,0 +1,160 @@
+// ViKey - Settings File Tests
+// test_settings_file.cpp
+// Round trips, atomic replacement and damage detection of the settings file
+
+#include "settings_file.h"
+#include "test_common.h"
+#include <fstream>
+
+namespace fs = std::filesystem;
+
+static fs::path TestPath(const char* name) {
+    fs::path path = fs::temp_directory_path() / (std::string("vikey_test_") + name + ".dat");
+    fs::remove(path);
+    return path;
+}
+
+static std::string ReadBytes(const fs::path& path) {
+    std::ifstream in(path, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+}
+
+static void WriteBytes(const fs::path& path, const std::string& bytes) {
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    out.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+}
+
+static PersistedValues SampleValues() {
+    PersistedValues values;
+    values[L"Enabled"] = PersistedValue::Number(1);
+    values[L"HotkeyKey"] = PersistedValue::Number(0xFFFFFFFFu);
+    values[L"TextShortcuts"] = PersistedValue::String(L"vn|Việt Nam;tphcm|Thành phố Hồ Chí Minh;ok|\U0001F44D");
+    values[L"ExcludedApps"] = PersistedValue::String(L"");
+    return values;
+}
+
+static std::vector<PersistedWrite> AsBatch(const PersistedValues& values) {
+    std::vector<PersistedWrite> batch;
+    for (const auto& item : values) batch.push_back({item.first, item.second});
+    return batch;
+}
+
+static void TestRoundTrip() {
+    fs::path path = TestPath("roundtrip");
+    PersistedValues values = SampleValues();
+    {
+        FileSettingsStorage storage(path);
+        PersistedValues none;
+        CHECK(!storage.ReadAll(none));  // no file yet
+        CHECK(storage.Write(AsBatch(values)));
+    }
+
+    // A fresh instance, as on the next start
+    FileSettingsStorage storage(path);
+    PersistedValues read;
+    CHECK(storage.ReadAll(read));
+    CHECK(read == values);
+    CHECK(read[L"TextShortcuts"].text.back() == static_cast<wchar_t>(0x1F44D) || sizeof(wchar_t) == 2);
+    fs::remove(path);
+}
+
+static void TestWriteKeepsOtherValues() {
+    fs::path path = TestPath("merge");
+    CHECK(FileSettingsStorage(path).Write(AsBatch(SampleValues())));
+
+    // A storage that has not read the file yet must not drop what is in it
+    FileSettingsStorage storage(path);
+    CHECK(storage.Write({{L"Enabled", PersistedValue::Number(0)}}));
+
+    // The whole file is rewritten with the merged values, through a temporary
+    PersistedValues expected = SampleValues();
+    expected[L"Enabled"] = PersistedValue::Number(0);
+    PersistedValues read;
+    CHECK(FileSettingsStorage(path).ReadAll(read));
+    CHECK(read == expected);
+    CHECK(!fs::exists(fs::path(path).concat(".tmp")));
+    fs::remove(path);
+}
+
+static void TestDamageIsDetected() {
+    const std::string good = EncodeSettingsFile(SampleValues());
+    PersistedValues values;
+    CHECK(DecodeSettingsFile(good.data(), good.size(), values));
+    CHECK(values == SampleValues());
+
+    // Every truncation, as a crash mid-copy would leave it
+    for (size_t size = 0; size < good.size(); size++) {
+        PersistedValues out = {{L"Untouched", PersistedValue::Number(7)}};
+        CHECK(!DecodeSettingsFile(good.data(), size, out));
+        CHECK(out.size() == 1 && out.count(L"Untouched") == 1);
+    }
+
+    // Every single-bit flip, in the header or the payload
+    size_t missed = 0;
+    for (size_t i = 0; i < good.size(); i++) {
+        std::string bad = good;
+        bad[i] = static_cast<char>(bad[i] ^ 0x10);
+        PersistedValues out;
+        if (DecodeSettingsFile(bad.data(), bad.size(), out)) missed++;
+    }
+    CHECK_EQ(missed, 0u);
+
+    // Trailing bytes and a future format are refused too
+    std::string longer = good + '\0';
+    CHECK(!DecodeSettingsFile(longer.data(), longer.size(), values));
+    std::string future = good;
+    future[4] = 2;
+    CHECK(!DecodeSettingsFile(future.data(), future.size(), values));
+
+    // On disk: a damaged file reads as no file
+    fs::path path = TestPath("damaged");
+    std::string damaged = good;
+    damaged[damaged.size() - 3] ^= 0x01;
+    WriteBytes(path, damaged);
+    PersistedValues read;
+    CHECK(!FileSettingsStorage(path).ReadAll(read));
+    CHECK(read.empty());
+    fs::remove(path);
+}
+
+static void TestEncodingIsStable() {
+    // The bytes do not depend on the size of wchar_t
+    PersistedValues values;
+    values[L"A"] = PersistedValue::String(L"ệ\U0001F600");
+    std::string bytes = EncodeSettingsFile(values);
+    const char payload[] = "\x01\x00\x00\x00"           // count
+                           "\x01" "\x01\x00" "A\x00"    // string, name "A"
+                           "\x03\x00\x00\x00"           // 3 UTF-16 units
+                           "\xC7\x1E" "\x3D\xD8\x00\xDE";
+    CHECK_EQ(bytes.size(), 16 + sizeof(payload) - 1);
+    CHECK(bytes.compare(0, 4, "VKS\x1A") == 0);
+    CHECK(bytes.compare(16, std::string::npos, payload, sizeof(payload) - 1) == 0);
+}
+
+// Save() through the persister, then Load() on the next start
+static void TestPersisterOverFile() {
+    fs::path path = TestPath("persister");
+    {
+        FileSettingsStorage storage(path);
+        SettingsPersister persister(storage, std::chrono::hours(1));
+        persister.Set(L"Enabled", false);
+        persister.Set(L"Method", 1);
+        persister.Set(L"ExcludedApps", std::wstring(L"game.exe|photoshop.exe"));
+    }
+    PersistedValues read;
+    CHECK(FileSettingsStorage(path).ReadAll(read));
+    CHECK_EQ(read.size(), 3u);
+    CHECK(read[L"Method"] == PersistedValue::Number(1));
+    CHECK(read[L"ExcludedApps"] == PersistedValue::String(L"game.exe|photoshop.exe"));
+    CHECK_EQ(ReadBytes(path), EncodeSettingsFile(read));
+    fs::remove(path);
+}
+
+int main() {
+    TestRoundTrip();
+    TestWriteKeepsOtherValues();
+    TestDamageIsDetected();
+    TestEncodingIsStable();
+    TestPersisterOverFile();
+    return TestResult("test_settings_file");
+}
@@ -0,0 +1,190 @@
+// ViKey - Settings Persister Tests
+// test_settings_persister.cpp
+// Dirty tracking, coalescing, flush and retry against an in-memory storage
+
+#include "settings_persister.h"
+#include "test_common.h"
+#include <atomic>
+
+using namespace std::chrono_literals;
+
+// In-memory stand-in for the registry key
+class MemoryStorage : public SettingsStorage {
+public:
+    bool ReadAll(PersistedValues& out) override {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        out = PersistedValues(values.begin(), values.end());
+        return true;
+    }
+
+    bool Write(const std::vector<PersistedWrite>& batch) override {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        batches.push_back(batch);
+        if (failNext) {
+            failNext = false;
+            return false;
+        }
+        for (const auto& write : batch) values[write.name] = write.value;
+        return true;
+    }
+
+    size_t BatchCount() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return batches.size();
+    }
+
+    std::map<std::wstring, PersistedValue> Values() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return values;
+    }
+
+    std::vector<std::vector<PersistedWrite>> batches;
+    std::map<std::wstring, PersistedValue> values;
+    bool failNext = false;
+
+private:
+    std::mutex m_mutex;
+};
+
+static const auto NEVER = std::chrono::milliseconds(std::chrono::hours(1));
+
+static void TestUnchangedValuesAreNotWritten() {
+    MemoryStorage storage;
+    SettingsPersister persister(storage, NEVER);
+    persister.SetStored(L"Enabled", PersistedValue::Number(1));
+    persister.SetStored(L"TextShortcuts", PersistedValue::String(L"vn|Việt Nam"));
+
+    persister.Set(L"Enabled", true);
+    persister.Set(L"TextShortcuts", std::wstring(L"vn|Việt Nam"));
+    persister.Flush();
+    CHECK_EQ(storage.BatchCount(), 0u);
+
+    SettingsPersister::Stats stats = persister.GetStats();
+    CHECK_EQ(stats.sets, 2u);
+    CHECK_EQ(stats.unchanged, 2u);
+    CHECK_EQ(stats.batches, 0u);
+
+    // A string and a number never compare equal
+    persister.Set(L"Enabled", std::wstring(L"1"));
+    persister.Flush();
+    CHECK_EQ(storage.BatchCount(), 1u);
+}
+
+static void TestBurstIsCoalesced() {
+    MemoryStorage storage;
+    SettingsPersister persister(storage, NEVER);
+    persister.SetStored(L"Enabled", PersistedValue::Number(1));
+
+    // Ctrl+Space held down: every toggle saves every value
+    for (int i = 0; i < 101; i++) {
+        persister.Set(L"Enabled", i % 2 == 0);
+        persister.Set(L"Method", 1);
+        persister.Set(L"ExcludedApps", std::wstring(L"game.exe"));
+    }
+    CHECK_EQ(storage.BatchCount(), 0u);  // nothing before the window closes
+    persister.Flush();
+
+    // Each name once with its latest value; Enabled ended where it started
+    CHECK_EQ(storage.BatchCount(), 1u);
+    CHECK_EQ(storage.batches[0].size(), 2u);
+    auto values = storage.Values();
+    CHECK(values.count(L"Enabled") == 0);
+    CHECK(values[L"Method"] == PersistedValue::Number(1));
+    CHECK(values[L"ExcludedApps"] == PersistedValue::String(L"game.exe"));
+
+    SettingsPersister::Stats stats = persister.GetStats();
+    CHECK_EQ(stats.sets, 303u);
+    CHECK_EQ(stats.values, 2u);
+    CHECK_EQ(stats.batches, 1u);
+
+    // Only what changed since goes into the next batch
+    persister.Set(L"Method", 0);
+    persister.Set(L"ExcludedApps", std::wstring(L"game.exe"));
+    persister.Flush();
+    CHECK_EQ(storage.BatchCount(), 2u);
+    CHECK(storage.batches[1].size() == 1 && storage.batches[1][0].name == L"Method");
+}
+
+static void TestDebounceWritesOnItsOwn() {
+    MemoryStorage storage;
+    SettingsPersister persister(storage, 20ms);
+    persister.Set(L"Enabled", false);
+    persister.Set(L"Method", 1);
+
+    auto start = std::chrono::steady_clock::now();
+    while (storage.BatchCount() == 0 && std::chrono::steady_clock::now() - start < 5s) {
+        std::this_thread::sleep_for(1ms);
+    }
+    CHECK_EQ(storage.BatchCount(), 1u);
+    CHECK(std::chrono::steady_clock::now() - start >= 15ms);
+    CHECK_EQ(storage.Values().size(), 2u);
+}
+
+static void TestDestructorFlushes() {
+    MemoryStorage storage;
+    {
+        SettingsPersister persister(storage, NEVER);
+        persister.Set(L"SlowMode", true);
+    }
+    CHECK_EQ(storage.BatchCount(), 1u);
+    CHECK(storage.Values()[L"SlowMode"] == PersistedValue::Number(1));
+}
+
+static void TestFailedBatchIsRetried() {
+    MemoryStorage storage;
+    SettingsPersister persister(storage, NEVER);
+    storage.failNext = true;
+    persister.Set(L"Enabled", false);
+    persister.Set(L"Method", 1);
+    persister.Flush();
+    CHECK(storage.Values().empty());
+    CHECK_EQ(persister.GetStats().failures, 1u);
+
+    // A newer value replaces the failed one; the other is simply retried
+    persister.Set(L"Method", 0);
+    persister.Flush();
+    CHECK_EQ(storage.BatchCount(), 2u);
+    auto values = storage.Values();
+    CHECK(values[L"Enabled"] == PersistedValue::Number(0));
+    CHECK(values[L"Method"] == PersistedValue::Number(0));
+}
+
+// Tray, hotkey and dialog saving from different threads while flushes run
+static void TestConcurrentSetAndFlush() {
+    MemoryStorage storage;
+    SettingsPersister persister(storage, 1ms);
+    const int THREADS = 4;
+    const int SETS = 5000;
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < THREADS; t++) {
+        threads.emplace_back([&, t]() {
+            std::wstring name = L"Value" + std::to_wstring(t);
+            for (int i = 1; i <= SETS; i++) {
+                persister.Set(name.c_str(), i);
+                if (i % 1000 == 0) persister.Flush();
+            }
+        });
+    }
+    for (auto& thread : threads) thread.join();
+    persister.Flush();
+
+    auto values = storage.Values();
+    CHECK_EQ(values.size(), static_cast<size_t>(THREADS));
+    for (int t = 0; t < THREADS; t++) {
+        CHECK(values[L"Value" + std::to_wstring(t)] == PersistedValue::Number(SETS));
+    }
+    SettingsPersister::Stats stats = persister.GetStats();
+    CHECK_EQ(stats.sets, static_cast<uint64_t>(THREADS * SETS));
+    CHECK(stats.values < stats.sets);  // coalesced
+}
+
+int main() {
+    TestUnchangedValuesAreNotWritten();
+    TestBurstIsCoalesced();
+    TestDebounceWritesOnItsOwn();
+    TestDestructorFlushes();
+    TestFailedBatchIsRetried();
+    TestConcurrentSetAndFlush();
+    return TestResult("test_settings_persister");
+}
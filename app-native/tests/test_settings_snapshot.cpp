@@ -0,0 +1,122 @@
+// ViKey - Settings Snapshot Tests
+// test_settings_snapshot.cpp
+// Publishing snapshots while keystroke threads read them; build with
+// -DVIKEY_SANITIZER=thread to have TSan check the same run
+
+#include "settings_snapshot.h"
+#include "test_common.h"
+#include <thread>
+
+constexpr int PUBLISHES = 2000;
+constexpr int READERS = 4;
+constexpr int KEYS_PER_READER = 200000;
+
+// Every field of a generation is derived from its number, so a reader can
+// tell a torn snapshot (fields from two saves) from a consistent one
+static SettingsSnapshot MakeGeneration(int gen) {
+    SettingsSnapshot s;
+    bool odd = (gen % 2) != 0;
+    s.enabled = odd;
+    s.method = odd ? InputMethod::VNI : InputMethod::Telex;
+    s.modernTone = odd;
+    s.smartSwitch = odd;
+    s.clipboardMode = odd;
+    s.excludedApps.push_back(L"app" + std::to_wstring(gen) + L".exe");
+    for (int i = 0; i < gen % 37; i++) {
+        s.shortcuts.push_back({L"k" + std::to_wstring(gen), L"value " + std::to_wstring(gen)});
+    }
+    return s;
+}
+
+static bool IsConsistent(const SettingsSnapshot& s) {
+    if (s.excludedApps.size() != 1) return false;
+    int gen = std::stoi(s.excludedApps[0].substr(3));
+    bool odd = (gen % 2) != 0;
+    if (s.enabled != odd || s.modernTone != odd || s.smartSwitch != odd || s.clipboardMode != odd) return false;
+    if (s.method != (odd ? InputMethod::VNI : InputMethod::Telex)) return false;
+    if (s.shortcuts.size() != static_cast<size_t>(gen % 37)) return false;
+    std::wstring key = L"k" + std::to_wstring(gen);
+    for (const auto& shortcut : s.shortcuts) {
+        if (shortcut.key != key || shortcut.value != L"value " + std::to_wstring(gen)) return false;
+    }
+    return true;
+}
+
+static void TestPublishAndRead() {
+    SettingsStore store;
+    CHECK_EQ(store.Version(), 0u);
+    CHECK(store.Current() != nullptr);
+
+    SettingsStore::Reader reader(store);
+    CHECK_EQ(reader.Get().version, 0u);
+
+    CHECK_EQ(store.Publish(MakeGeneration(1)), 1u);
+    CHECK_EQ(store.Publish(MakeGeneration(2)), 2u);
+    const SettingsSnapshot& current = reader.Get();
+    CHECK_EQ(current.version, 2u);
+    CHECK(IsConsistent(current));
+    CHECK(!current.enabled);
+
+    // A snapshot someone holds outlives later publishes
+    std::shared_ptr<const SettingsSnapshot> held = store.Current();
+    store.Publish(MakeGeneration(3));
+    CHECK_EQ(held->version, 2u);
+    CHECK(IsConsistent(*held));
+    CHECK_EQ(reader.Get().version, 3u);
+}
+
+// The settings dialog saving repeatedly while several hooks replay keystrokes
+static void TestConcurrentSaveWhileTyping() {
+    SettingsStore store;
+    store.Publish(MakeGeneration(1));
+
+    std::atomic<int> torn{0};
+    std::atomic<int> wentBack{0};
+    std::atomic<int> versionsSeen{0};
+    std::atomic<bool> done{false};
+
+    std::vector<std::thread> readers;
+    for (int r = 0; r < READERS; r++) {
+        readers.emplace_back([&]() {
+            SettingsStore::Reader reader(store);
+            uint64_t last = 0;
+            int seen = 0;
+            for (int key = 0; key < KEYS_PER_READER || !done.load(std::memory_order_relaxed); key++) {
+                const SettingsSnapshot& settings = reader.Get();
+                if (settings.version < last) wentBack++;
+                if (settings.version != last) {
+                    seen++;
+                    // A full check per new snapshot; per key, what the hook reads
+                    if (!IsConsistent(settings)) torn++;
+                }
+                last = settings.version;
+
+                // What OnKeyPressed does with it: exclusion and shortcut lookups
+                if (settings.smartSwitch && settings.excludedApps.empty()) torn++;
+                for (const auto& shortcut : settings.shortcuts) {
+                    if (shortcut.key.empty()) torn++;
+                }
+            }
+            versionsSeen += seen;
+        });
+    }
+
+    for (int gen = 2; gen <= PUBLISHES; gen++) {
+        store.Publish(MakeGeneration(gen));
+        if (gen % 64 == 0) std::this_thread::yield();
+    }
+    done = true;
+    for (auto& t : readers) t.join();
+
+    CHECK_EQ(torn.load(), 0);
+    CHECK_EQ(wentBack.load(), 0);
+    CHECK(versionsSeen.load() > READERS);  // readers did observe updates
+    CHECK_EQ(store.Version(), static_cast<uint64_t>(PUBLISHES));
+    CHECK(IsConsistent(*store.Current()));
+}
+
+int main() {
+    TestPublishAndRead();
+    TestConcurrentSaveWhileTyping();
+    return TestResult("test_settings_snapshot");
+}
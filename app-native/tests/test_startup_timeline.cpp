@@ -0,0 +1,152 @@
+// ViKey - Startup Timeline Tests
+// test_startup_timeline.cpp
+// Phase nesting, marks, the process-start origin and the Chrome trace export
+
+#include "startup_timeline.h"
+#include "json_reader.h"
+#include "test_common.h"
+#include <cstring>
+
+using Clock = StartupTimeline::Clock;
+
+static const StartupTimeline::Event* Find(const std::vector<StartupTimeline::Event>& events, const char* name) {
+    for (const auto& event : events) {
+        if (std::strcmp(event.name, name) == 0) return &event;
+    }
+    return nullptr;
+}
+
+static void TestPhases() {
+    StartupTimeline timeline;
+    {
+        StartupPhase outer("init", timeline);
+        {
+            StartupPhase inner("settings", timeline);
+            std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        }
+        timeline.Mark(StartupTimeline::HOOK_READY);
+        StartupPhase second("core.dll", timeline);
+    }
+    timeline.End();  // unbalanced: ignored
+
+    std::vector<StartupTimeline::Event> events = timeline.Events();
+    CHECK_EQ(events.size(), 4u);
+    const auto* init = Find(events, "init");
+    const auto* settings = Find(events, "settings");
+    const auto* core = Find(events, "core.dll");
+    const auto* ready = Find(events, StartupTimeline::HOOK_READY);
+    CHECK(init && settings && core && ready);
+    if (!init || !settings || !core || !ready) return;
+
+    CHECK(init->depth == 0 && settings->depth == 1 && core->depth == 1);
+    CHECK(settings->duration >= 2000);
+    CHECK(init->duration >= settings->duration + core->duration);
+    CHECK(settings->start >= init->start && core->start >= settings->start + settings->duration);
+    CHECK(ready->mark && !init->mark);
+    CHECK(ready->start >= settings->start + settings->duration && ready->start <= core->start);
+    CHECK_EQ(timeline.MarkedAt(StartupTimeline::HOOK_READY), ready->start);
+    CHECK_EQ(timeline.MarkedAt(StartupTimeline::FIRST_KEY), -1);
+}
+
+static void TestProcessStart() {
+    Clock::time_point created = Clock::now() - std::chrono::milliseconds(30);
+    StartupTimeline timeline;
+    timeline.Begin("open");
+    timeline.SetProcessStart(created, "loader");
+    timeline.End();
+    timeline.SetProcessStart(Clock::now(), "later");  // not before the origin: ignored
+
+    std::vector<StartupTimeline::Event> events = timeline.Events();
+    CHECK_EQ(events.size(), 2u);
+    const auto* loader = Find(events, "loader");
+    const auto* open = Find(events, "open");
+    CHECK(loader && open);
+    if (!loader || !open) return;
+    CHECK_EQ(loader->start, 0);
+    CHECK(loader->duration >= 30000);
+    CHECK(open->start >= loader->duration);
+    CHECK(open->duration >= 0);  // still closed by End() after the shift
+}
+
+static void TestMarkFromAnotherThread() {
+    StartupTimeline timeline;
+    timeline.Mark("main");
+    std::thread([&]() { timeline.Mark(StartupTimeline::FIRST_KEY); }).join();
+    std::vector<StartupTimeline::Event> events = timeline.Events();
+    const auto* main = Find(events, "main");
+    const auto* key = Find(events, StartupTimeline::FIRST_KEY);
+    CHECK(main && key && main->thread == 1 && key->thread == 2);
+    CHECK(timeline.MarkedAt(StartupTimeline::FIRST_KEY) >= 0);
+}
+
+static void TestChromeTrace() {
+    StartupTimeline timeline;
+    {
+        StartupPhase phase("settings", timeline);
+        timeline.Mark(StartupTimeline::HOOK_READY);
+    }
+    timeline.Begin("open");  // not exported until it ends
+
+    std::string json = timeline.ChromeTraceJson();
+    Utf8JsonReader reader(json.data(), json.size());
+    int phases = 0, marks = 0, duration = -1;
+    std::wstring unit;
+    CHECK(reader.BeginObject());
+    while (reader.NextKey()) {
+        if (reader.KeyIs("displayTimeUnit")) {
+            CHECK(reader.ReadString(unit));
+        } else if (reader.KeyIs("traceEvents")) {
+            CHECK(reader.BeginArray());
+            while (reader.NextElement()) {
+                std::wstring name, ph;
+                int ts = -1, pid = 0, tid = 0;
+                CHECK(reader.BeginObject());
+                while (reader.NextKey()) {
+                    if (reader.KeyIs("name")) reader.ReadString(name);
+                    else if (reader.KeyIs("ph")) reader.ReadString(ph);
+                    else if (reader.KeyIs("ts")) reader.ReadInt(ts);
+                    else if (reader.KeyIs("dur")) reader.ReadInt(duration);
+                    else if (reader.KeyIs("pid")) reader.ReadInt(pid);
+                    else if (reader.KeyIs("tid")) reader.ReadInt(tid);
+                }
+                CHECK(ts >= 0 && pid == 1 && tid == 1);
+                if (ph == L"X") {
+                    phases++;
+                    CHECK(name == L"settings");
+                } else if (ph == L"i") {
+                    marks++;
+                    CHECK(name == L"hook ready");
+                }
+            }
+        }
+    }
+    CHECK(!reader.Failed());
+    CHECK(reader.AtEnd());
+    CHECK(unit == L"ms");
+    CHECK_EQ(phases, 1);
+    CHECK_EQ(marks, 1);
+    CHECK(duration >= 0);
+}
+
+static void TestSummary() {
+    StartupTimeline timeline;
+    {
+        StartupPhase outer("init", timeline);
+        StartupPhase inner("settings", timeline);
+    }
+    timeline.Mark(StartupTimeline::HOOK_READY);
+    std::wstring summary = timeline.Summary();
+    CHECK(summary.find(L"hook ready at ") != std::wstring::npos);
+    CHECK(summary.find(L"first key") == std::wstring::npos);
+    CHECK(summary.find(L" ms  init\n") != std::wstring::npos);
+    CHECK(summary.find(L" ms    settings\n") != std::wstring::npos);
+}
+
+int main() {
+    TestPhases();
+    TestProcessStart();
+    TestMarkFromAnotherThread();
+    TestChromeTrace();
+    TestSummary();
+    return TestResult("test_startup_timeline");
+}
@@ -0,0 +1,125 @@
+// ViKey - Transcoder Tests
+// test_transcoder.cpp
+// Every fused transcoder must match the two-pass conversion through Unicode
+
+#include "encoding_converter.h"
+#include "test_common.h"
+
+static const VietEncoding ENCODINGS[] = {
+    VietEncoding::Unicode, VietEncoding::VNI_Windows, VietEncoding::TCVN3, VietEncoding::Unicode_Comp,
+    VietEncoding::VISCII, VietEncoding::VIQR, VietEncoding::UTF8_Bytes,
+};
+
+static const wchar_t* const CORPUS[] = {
+    L"Tiếng Việt là ngôn ngữ chính thức của nước Cộng hòa Xã hội chủ nghĩa Việt Nam.",
+    L"Đường vô xứ Nghệ quanh quanh, non xanh nước biếc như tranh họa đồ.",
+    L"Người ơi người ở đừng về, ướt áo, ủ rũ, ừ ử, ựa ứa ữa; kỹ sư, tỷ lệ, lý do, ỵ.",
+    L"HÀ NỘI, ĐÀ NẴNG, HUẾ, CẦN THƠ, ỨNG DỤNG, ỶẴẲẶỴ.",
+    L"ASCII 0123456789 !@#$%^&*()_+-=[]{};':,./<>?",
+    L"",
+};
+
+static std::wstring Run(VietEncoding from, VietEncoding to, const std::wstring& text) {
+    std::wstring out;
+    EncodingConverter::GetTranscoder(from, to)(text.data(), text.size(), out);
+    return out;
+}
+
+static std::wstring TwoPass(VietEncoding from, VietEncoding to, const std::wstring& text) {
+    return Run(VietEncoding::Unicode, to, Run(from, VietEncoding::Unicode, text));
+}
+
+static void TestMatrixMatchesTwoPass() {
+    for (const wchar_t* line : CORPUS) {
+        for (VietEncoding from : ENCODINGS) {
+            // Same text expressed in the source encoding
+            std::wstring input = Run(VietEncoding::Unicode, from, line);
+            for (VietEncoding to : ENCODINGS) {
+                std::wstring fused = Run(from, to, input);
+                CHECK(fused == TwoPass(from, to, input));
+                if (from != to) CHECK(fused == EncodingConverter::Instance().Convert(input, from, to));
+            }
+        }
+    }
+}
+
+static void TestAppendsToOutput() {
+    std::wstring out = L"> ";
+    EncodingConverter::GetTranscoder(VietEncoding::TCVN3, VietEncoding::Unicode_Comp)(L"\xB8", 1, out);
+    CHECK(out == L"> a\u0301");
+
+    // Marks already in the output are left alone
+    out = L"\u00E1";
+    EncodingConverter::GetTranscoder(VietEncoding::Unicode, VietEncoding::Unicode_Comp)(L"\u0323", 1, out);
+    CHECK(out == L"\u00E1\u0323");
+}
+
+static void TestStreamBoundaries() {
+    // VNI base letter at the end of input is flushed
+    CHECK(Run(VietEncoding::VNI_Windows, VietEncoding::TCVN3, L"o") == L"o");
+    CHECK(Run(VietEncoding::VNI_Windows, VietEncoding::Unicode_Comp, L"a\xF9") == L"a\u0301");
+
+    // NFD input: leading mark, and marks composing across the last character
+    CHECK(Run(VietEncoding::Unicode_Comp, VietEncoding::VNI_Windows, L"\u0300a") == L"\u0300a");
+    CHECK(Run(VietEncoding::Unicode_Comp, VietEncoding::VNI_Windows, L"e\u0323\u0302") == L"e\xE4");
+
+    // VIQR letter still open at the end, and a dangling backslash
+    CHECK(Run(VietEncoding::VIQR, VietEncoding::VISCII, L"Vie^.") == L"Vi\xAE");
+    CHECK(Run(VietEncoding::VIQR, VietEncoding::Unicode, L"a\\") == L"a\\");
+
+    // A UTF-8 sequence cut off by the end of input passes through as bytes
+    CHECK(Run(VietEncoding::UTF8_Bytes, VietEncoding::Unicode, L"\xE1\xBB") == L"\xE1\xBB");
+}
+
+static std::wstring DecodeChunk(const std::string& bytes, size_t begin, size_t end, VietEncoding from) {
+    std::wstring text = EncodingConverter::DecodeBytes(bytes.data() + begin, end - begin, from);
+    return from == VietEncoding::Unicode ? text : EncodingConverter::Instance().Convert(text, from, VietEncoding::Unicode);
+}
+
+// Text with no blanks to cut at: chunks converted apart must still join up
+// to the text converted whole
+static void TestSplitWithoutBlanks() {
+    std::wstring text;
+    for (int i = 0; i < 20; i++) {
+        for (const wchar_t* line : CORPUS) {
+            for (const wchar_t* c = line; *c; c++) {
+                if (*c != L' ') text += *c;
+            }
+        }
+    }
+
+    for (VietEncoding from : ENCODINGS) {
+        std::string bytes = EncodingConverter::EncodeBytes(Run(VietEncoding::Unicode, from, text), from);
+        std::wstring whole = DecodeChunk(bytes, 0, bytes.size(), from);
+        for (size_t chunk : {1, 2, 7, 64}) {
+            std::wstring joined;
+            size_t pieces = 0;
+            for (size_t begin = 0; begin < bytes.size();) {
+                size_t end = (bytes.size() - begin > chunk)
+                                 ? EncodingConverter::FindSplit(bytes.data(), bytes.size(), begin + chunk, 8, from)
+                                 : bytes.size();
+                CHECK(end > begin);
+                joined += DecodeChunk(bytes, begin, end, from);
+                begin = end;
+                pieces++;
+            }
+            CHECK(joined == whole);
+            CHECK(pieces >= bytes.size() / (chunk + 8));
+        }
+    }
+
+    // No boundary within reach: no split
+    std::string tones(100, '\'');
+    CHECK_EQ(EncodingConverter::FindSplit(tones.data(), tones.size(), 10, 8, VietEncoding::VIQR), tones.size());
+    std::string marks = "e";
+    for (int i = 0; i < 40; i++) marks += "\xCC\x81";
+    CHECK_EQ(EncodingConverter::FindSplit(marks.data(), marks.size(), 10, 8, VietEncoding::Unicode), marks.size());
+}
+
+int main() {
+    TestMatrixMatchesTwoPass();
+    TestAppendsToOutput();
+    TestStreamBoundaries();
+    TestSplitWithoutBlanks();
+    return TestResult("test_transcoder");
+}
@@ -0,0 +1,87 @@
+// ViKey - VNI Codec Tests
+// test_vni_codec.cpp
+// Known VNI byte sequences plus a Unicode -> VNI -> Unicode round-trip corpus
+
+#include "encoding_converter.h"
+#include "test_common.h"
+#include "vni_codec.h"
+
+// VNI text as stored in a wstring: one byte per wchar_t
+static std::wstring Vni(const char* bytes) {
+    std::wstring s;
+    for (const unsigned char* p = reinterpret_cast<const unsigned char*>(bytes); *p; p++) {
+        s += static_cast<wchar_t>(*p);
+    }
+    return s;
+}
+
+static const wchar_t* const ROUND_TRIP_CORPUS[] = {
+    L"Tiếng Việt là ngôn ngữ chính thức của nước Cộng hòa Xã hội chủ nghĩa Việt Nam.",
+    L"Trăm năm trong cõi người ta, chữ tài chữ mệnh khéo là ghét nhau.",
+    L"Đường vô xứ Nghệ quanh quanh, non xanh nước biếc như tranh họa đồ.",
+    L"Người ơi người ở đừng về, ướt áo, ủ rũ, ừ ử, ựa ứa ữa.",
+    L"Khuya lắm rồi, thằng bé vẫn ngồi ngẫm nghĩ: \"Tại sao ỷ lại?\" - Tỵ nạn, tỷ lệ, kỹ sư, lý do.",
+    L"HÀ NỘI, THÀNH PHỐ HỒ CHÍ MINH, ĐÀ NẴNG, HUẾ, CẦN THƠ, QUẢNG NGÃI, ỨNG DỤNG, ỶẴẲẶỴ.",
+    L"ASCII 0123456789 !@#$%^&*()_+-=[]{};':,./<>? passes through unchanged.",
+    L"",
+};
+
+static void TestKnownSequences() {
+    EncodingConverter& conv = EncodingConverter::Instance();
+    CHECK(conv.Convert(L"Tiếng Việt", VietEncoding::Unicode, VietEncoding::VNI_Windows) == Vni("Tie\xE1ng Vie\xE4t"));
+    CHECK(conv.Convert(L"người", VietEncoding::Unicode, VietEncoding::VNI_Windows) == Vni("ng\xF6\xF4\xF8i"));
+    CHECK(conv.Convert(L"Đặng", VietEncoding::Unicode, VietEncoding::VNI_Windows) == Vni("\xD1" "a\xEBng"));
+    CHECK(conv.Convert(L"VIỆT NAM", VietEncoding::Unicode, VietEncoding::VNI_Windows) == Vni("VIE\xC4T NAM"));
+    CHECK(conv.Convert(L"ỵ ĩ ỉ", VietEncoding::Unicode, VietEncoding::VNI_Windows) == Vni("\xEE \xF3 \xE6"));
+
+    CHECK(conv.Convert(Vni("Ha\xF8 No\xE4i"), VietEncoding::VNI_Windows, VietEncoding::Unicode) == L"Hà Nội");
+    CHECK(conv.Convert(Vni("tr\xF6\xF4\xF9" "c"), VietEncoding::VNI_Windows, VietEncoding::Unicode) == L"trước");
+
+    // Mixed-case pairs take the case of the base letter
+    CHECK(conv.Convert(Vni("Vie\xC4t"), VietEncoding::VNI_Windows, VietEncoding::Unicode) == L"Việt");
+
+    // A diacritic byte that cannot attach stays as it was; a trailing base is flushed
+    CHECK(conv.Convert(Vni("i\xE2 o"), VietEncoding::VNI_Windows, VietEncoding::Unicode) == Vni("i\xE2 o"));
+    CHECK(conv.Convert(Vni("\xF6"), VietEncoding::VNI_Windows, VietEncoding::Unicode) == L"ư");
+}
+
+static void TestAllLetters() {
+    const std::wstring letters =
+        L"aàảãáạăằẳẵắặâầẩẫấậeèẻẽéẹêềểễếệiìỉĩíịoòỏõóọôồổỗốộơờởỡớợuùủũúụưừửữứựyỳỷỹýỵđ"
+        L"AÀẢÃÁẠĂẰẲẴẮẶÂẦẨẪẤẬEÈẺẼÉẸÊỀỂỄẾỆIÌỈĨÍỊOÒỎÕÓỌÔỒỔỖỐỘƠỜỞỠỚỢUÙỦŨÚỤƯỪỬỮỨỰYỲỶỸÝỴĐ";
+
+    // Letter by letter, so one letter's bytes never combine with the next
+    for (wchar_t c : letters) {
+        std::wstring in(1, c), vni, back;
+        VniCodec::Encode(in.data(), in.size(), vni);
+        CHECK(!vni.empty() && vni.size() <= 2);
+        for (wchar_t b : vni) CHECK(static_cast<uint32_t>(b) < 0x100);
+        VniCodec::Decode(vni.data(), vni.size(), back);
+        CHECK(back == in);
+    }
+
+    std::wstring vni, back;
+    VniCodec::Encode(letters.data(), letters.size(), vni);
+    VniCodec::Decode(vni.data(), vni.size(), back);
+    CHECK(back == letters);
+}
+
+static void TestRoundTripCorpus() {
+    EncodingConverter& conv = EncodingConverter::Instance();
+    for (const wchar_t* text : ROUND_TRIP_CORPUS) {
+        std::wstring vni = conv.Convert(text, VietEncoding::Unicode, VietEncoding::VNI_Windows);
+        CHECK(conv.Convert(vni, VietEncoding::VNI_Windows, VietEncoding::Unicode) == text);
+
+        // And through the byte-level file path used by vikey-convert
+        std::string bytes = EncodingConverter::EncodeBytes(vni, VietEncoding::VNI_Windows);
+        std::wstring decoded = EncodingConverter::DecodeBytes(bytes.data(), bytes.size(), VietEncoding::VNI_Windows);
+        CHECK(decoded == vni);
+    }
+}
+
+int main() {
+    TestKnownSequences();
+    TestAllLetters();
+    TestRoundTripCorpus();
+    return TestResult("test_vni_codec");
+}
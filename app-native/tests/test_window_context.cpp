@@ -0,0 +1,165 @@
+// ViKey - Window Context Store Tests
+// test_window_context.cpp
+// LRU order, both bounds, memory accounting, and churn over 10k synthetic windows
+
+#include "window_context.h"
+#include "test_common.h"
+#include <random>
+
+static WindowContext Context(const wchar_t* app, bool enabled, size_t snapshotBytes = 0) {
+    WindowContext context;
+    context.app = app;
+    context.enabled = enabled;
+    context.engineSnapshot.assign(snapshotBytes, 0x5A);
+    return context;
+}
+
+static WindowKey Key(uint64_t window, uint32_t process = 100) {
+    return {window, process};
+}
+
+static void TestFindAndReplace() {
+    WindowContextStore store;
+    CHECK(store.Find(Key(1)) == nullptr);
+    store.Put(Key(1), Context(L"winword.exe", true));
+    store.Put(Key(2), Context(L"winword.exe", false));  // a second window of the same app
+
+    const WindowContext* first = store.Find(Key(1));
+    const WindowContext* second = store.Find(Key(2));
+    CHECK(first && first->enabled && first->app == L"winword.exe");
+    CHECK(second && !second->enabled);
+
+    // The same handle in another process is another window
+    CHECK(store.Find(Key(1, 200)) == nullptr);
+
+    WindowContext replaced = Context(L"winword.exe", false);
+    replaced.encoding = 2;
+    replaced.injection = InjectionProfile::Clipboard;
+    store.Put(Key(1), std::move(replaced));
+    first = store.Find(Key(1));
+    CHECK(first && !first->enabled && first->encoding == 2 && first->injection == InjectionProfile::Clipboard);
+    CHECK_EQ(store.Size(), 2u);
+
+    CHECK(store.Erase(Key(2)));
+    CHECK(!store.Erase(Key(2)));
+    CHECK_EQ(store.Size(), 1u);
+    CHECK_EQ(store.GetStats().hits, 3u);
+    CHECK_EQ(store.GetStats().misses, 2u);
+}
+
+static void TestEvictsLeastRecentlyUsed() {
+    WindowContextStore store(3);
+    store.Put(Key(1), Context(L"a.exe", true));
+    store.Put(Key(2), Context(L"b.exe", true));
+    store.Put(Key(3), Context(L"c.exe", true));
+    CHECK(store.Find(Key(1)) != nullptr);  // 1 is now the most recent; 2 the least
+    store.Put(Key(4), Context(L"d.exe", true));
+
+    CHECK_EQ(store.Size(), 3u);
+    CHECK(store.Find(Key(2)) == nullptr);
+    CHECK(store.Find(Key(1)) && store.Find(Key(3)) && store.Find(Key(4)));
+    CHECK_EQ(store.GetStats().evictions, 1u);
+}
+
+static void TestByteBound() {
+    const size_t snapshot = 4096;
+    size_t perEntry = WindowContextStore::EntryBytes(Context(L"a.exe", true, snapshot));
+    WindowContextStore empty(1000);
+    size_t buckets = empty.MemoryUsage();  // the index's bucket array, reserved up front
+
+    // Room for three snapshot-carrying contexts, far below the count bound
+    WindowContextStore store(1000, buckets + 3 * perEntry + perEntry / 2);
+    for (uint64_t w = 1; w <= 10; w++) store.Put(Key(w), Context(L"a.exe", true, snapshot));
+    CHECK_EQ(store.Size(), 3u);
+    CHECK(store.MemoryUsage() <= buckets + 3 * perEntry + perEntry / 2);
+    CHECK(store.Find(Key(10)) && store.Find(Key(9)) && store.Find(Key(8)));
+
+    // Small contexts fit many more in the same budget
+    for (uint64_t w = 100; w < 120; w++) store.Put(Key(w), Context(L"a.exe", true));
+    CHECK(store.Size() > 10);
+
+    // A context alone over the budget is still kept, on its own
+    store.Put(Key(500), Context(L"huge.exe", true, 1 << 20));
+    CHECK_EQ(store.Size(), 1u);
+    CHECK(store.Find(Key(500)) != nullptr);
+}
+
+static void TestAccounting() {
+    WindowContextStore store(100, 1 << 30);
+    size_t base = store.MemoryUsage();
+    size_t expected = 0;
+    std::wstring longName(200, L'x');  // past any small-string buffer
+    for (uint64_t w = 1; w <= 50; w++) {
+        WindowContext context = Context(w % 2 ? L"a.exe" : longName.c_str(), true, w * 10);
+        expected += WindowContextStore::EntryBytes(context);
+        store.Put(Key(w), std::move(context));
+    }
+    CHECK_EQ(store.MemoryUsage(), base + expected);
+    CHECK(WindowContextStore::EntryBytes(Context(longName.c_str(), true)) >=
+          WindowContextStore::EntryBytes(Context(L"", true)) + 200 * sizeof(wchar_t));
+
+    // Replacing and erasing keep the total exact
+    WindowContext bigger = Context(L"a.exe", true, 5000);
+    size_t before = WindowContextStore::EntryBytes(Context(L"a.exe", true, 10));
+    size_t after = WindowContextStore::EntryBytes(bigger);
+    store.Put(Key(1), std::move(bigger));
+    expected = expected - before + after;
+    CHECK_EQ(store.MemoryUsage(), base + expected);
+    store.Erase(Key(1));
+    CHECK_EQ(store.MemoryUsage(), base + expected - after);
+
+    store.Clear();
+    CHECK_EQ(store.Size(), 0u);
+    CHECK(store.MemoryUsage() <= base);
+}
+
+// Focus hopping over 10k short-lived windows, with a few long-lived ones
+// (an editor, a browser, a chat window) returned to throughout
+static void TestChurn() {
+    const uint64_t WINDOWS = 10000;
+    const size_t MAX_CONTEXTS = 128;
+    const size_t MAX_BYTES = 64 * 1024;
+    WindowContextStore store(MAX_CONTEXTS, MAX_BYTES);
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<int> snapshotSize(0, 64);
+
+    const uint64_t LONG_LIVED[] = {0xA0001, 0xA0002, 0xA0003};
+    size_t longLivedMisses = 0;
+    WindowKey previous;
+    for (uint64_t i = 0; i < WINDOWS; i++) {
+        // Leave the previous window: store what it was doing
+        WindowKey window = Key(0x10000 + i, static_cast<uint32_t>(1000 + i % 37));
+        if (i > 0) {
+            store.Put(previous, Context(L"app.exe", i % 2 == 0, static_cast<size_t>(snapshotSize(rng))));
+        }
+        store.Find(window);
+        previous = window;
+
+        // Every few windows, go back to a long-lived one
+        if (i % 8 == 0) {
+            WindowKey back = Key(LONG_LIVED[(i / 8) % 3], 7);
+            store.Put(previous, Context(L"app.exe", true));
+            if (i >= 24 && !store.Find(back)) longLivedMisses++;  // after the first visit to each
+            store.Put(back, Context(L"code.exe", true, 48));
+            previous = back;
+        }
+
+        CHECK(store.Size() <= MAX_CONTEXTS);
+        CHECK(store.MemoryUsage() <= MAX_BYTES);
+    }
+
+    // Recently used windows survive the churn; the bounds held throughout
+    CHECK_EQ(longLivedMisses, 0u);
+    CHECK(store.GetStats().evictions >= WINDOWS - MAX_CONTEXTS);
+    CHECK(store.Find(Key(0x10000 + WINDOWS - 2, static_cast<uint32_t>(1000 + (WINDOWS - 2) % 37))) != nullptr);
+    CHECK(store.Find(Key(0x10000, 1000)) == nullptr);
+}
+
+int main() {
+    TestFindAndReplace();
+    TestEvictsLeastRecentlyUsed();
+    TestByteBound();
+    TestAccounting();
+    TestChurn();
+    return TestResult("test_window_context");
+}
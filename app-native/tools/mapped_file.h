@@ -0,0 +1,31 @@
+// ViKey - Read-only Memory-Mapped File
+// mapped_file.h
+// POSIX mmap wrapper used by the batch converter
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+class MappedFile {
+public:
+    MappedFile() = default;
+    ~MappedFile();
+
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+
+    // Map the whole file read-only. Empty files open successfully with Size() == 0.
+    bool Open(const std::string& path);
+    void Close();
+
+    const char* Data() const { return m_data; }
+    size_t Size() const { return m_size; }
+
+private:
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const char* m_data = nullptr;
+    size_t m_size = 0;
+};
@@ -0,0 +1,388 @@
+// ViKey - Batch Encoding Converter
+// vikey_convert.cpp
+// Command-line tool: converts files or directory trees between VietEncoding variants
+//
+// Project: ViKey | Author: Trần Công Sinh | https://github.com/kmis8x/ViKey
+
+#include "encoding_converter.h"
+#include "mapped_file.h"
+#include "markup_converter.h"
+#include "work_stealing_pool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+// Files larger than this are split into chunks converted in parallel
+constexpr size_t DEFAULT_CHUNK_SIZE = 4 * 1024 * 1024;
+
+// How far past a chunk boundary to look for a safe split point
+constexpr size_t MAX_SPLIT_SEARCH = 64 * 1024;
+
+// HTML and RTF files are streamed through MarkupConverter in pieces this size
+constexpr size_t MARKUP_PIECE_SIZE = 1024 * 1024;
+
+enum class MarkupMode { Auto, None, Html, Rtf };
+
+struct Options {
+    VietEncoding from = VietEncoding::TCVN3;
+    VietEncoding to = VietEncoding::Unicode;
+    bool detect = false;  // -f auto: detect each file's encoding
+    MarkupMode markup = MarkupMode::Auto;
+    unsigned threads = 0;
+    bool recursive = false;
+    bool quiet = false;
+    size_t chunkSize = DEFAULT_CHUNK_SIZE;
+    std::string output;
+    std::vector<std::string> inputs;
+};
+
+struct FileJob {
+    fs::path inPath;
+    fs::path outPath;
+    MappedFile input;
+    VietEncoding from = VietEncoding::TCVN3;
+    MarkupFormat format = MarkupFormat::Text;
+    std::vector<std::string> parts;  // converted chunks, in input order
+    std::atomic<size_t> remaining{0};
+};
+
+struct Stats {
+    std::atomic<uint64_t> bytesIn{0};
+    std::atomic<uint64_t> bytesOut{0};
+    std::atomic<size_t> filesDone{0};
+    std::atomic<size_t> filesFailed{0};
+};
+
+static void PrintUsage() {
+    std::fprintf(stderr,
+        "Usage: vikey-convert -f <enc> -t <enc> [options] -o <output> <input>...\n"
+        "\n"
+        "Encodings: unicode (UTF-8), vni, tcvn3, viscii, viqr, nfd (UTF-8, decomposed)\n"
+        "\n"
+        "Options:\n"
+        "  -f, --from <enc>     Source encoding, or auto to detect it per file (default: tcvn3)\n"
+        "  -t, --to <enc>       Target encoding (default: unicode)\n"
+        "  -o, --output <path>  Output file, or directory for several inputs / trees\n"
+        "  -m, --markup <mode>  auto (by extension), none, html or rtf: convert only the\n"
+        "                       text of HTML/RTF files, keeping tags and control words\n"
+        "  -r, --recursive      Descend into subdirectories of directory inputs\n"
+        "  -j, --jobs <n>       Worker threads (default: all cores)\n"
+        "      --chunk-mb <n>   Split files larger than n MiB (default: 4)\n"
+        "  -q, --quiet          Only print errors\n");
+}
+
+static bool ParseEncoding(const char* name, VietEncoding& enc) {
+    if (!std::strcmp(name, "unicode") || !std::strcmp(name, "utf8") || !std::strcmp(name, "utf-8")) {
+        enc = VietEncoding::Unicode;
+    } else if (!std::strcmp(name, "vni")) {
+        enc = VietEncoding::VNI_Windows;
+    } else if (!std::strcmp(name, "tcvn3") || !std::strcmp(name, "abc")) {
+        enc = VietEncoding::TCVN3;
+    } else if (!std::strcmp(name, "nfd") || !std::strcmp(name, "composite")) {
+        enc = VietEncoding::Unicode_Comp;
+    } else if (!std::strcmp(name, "viscii")) {
+        enc = VietEncoding::VISCII;
+    } else if (!std::strcmp(name, "viqr")) {
+        enc = VietEncoding::VIQR;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+static bool ParseArgs(int argc, char** argv, Options& opt) {
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        auto next = [&]() -> const char* { return (i + 1 < argc) ? argv[++i] : nullptr; };
+
+        if (arg == "-f" || arg == "--from" || arg == "-t" || arg == "--to") {
+            const char* value = next();
+            bool isFrom = (arg == "-f" || arg == "--from");
+            if (isFrom && value && !std::strcmp(value, "auto")) {
+                opt.detect = true;
+                continue;
+            }
+            VietEncoding& target = isFrom ? opt.from : opt.to;
+            if (!value || !ParseEncoding(value, target)) {
+                std::fprintf(stderr, "vikey-convert: unknown encoding '%s'\n", value ? value : "");
+                return false;
+            }
+        } else if (arg == "-o" || arg == "--output") {
+            const char* value = next();
+            if (!value) return false;
+            opt.output = value;
+        } else if (arg == "-m" || arg == "--markup") {
+            const char* value = next();
+            if (value && !std::strcmp(value, "auto")) {
+                opt.markup = MarkupMode::Auto;
+            } else if (value && !std::strcmp(value, "none")) {
+                opt.markup = MarkupMode::None;
+            } else if (value && !std::strcmp(value, "html")) {
+                opt.markup = MarkupMode::Html;
+            } else if (value && !std::strcmp(value, "rtf")) {
+                opt.markup = MarkupMode::Rtf;
+            } else {
+                std::fprintf(stderr, "vikey-convert: unknown markup mode '%s'\n", value ? value : "");
+                return false;
+            }
+        } else if (arg == "-r" || arg == "--recursive") {
+            opt.recursive = true;
+        } else if (arg == "-q" || arg == "--quiet") {
+            opt.quiet = true;
+        } else if (arg == "-j" || arg == "--jobs") {
+            const char* value = next();
+            if (!value) return false;
+            opt.threads = static_cast<unsigned>(std::strtoul(value, nullptr, 10));
+        } else if (arg == "--chunk-mb") {
+            const char* value = next();
+            if (!value) return false;
+            size_t mb = std::strtoul(value, nullptr, 10);
+            opt.chunkSize = (mb > 0 ? mb : 1) * 1024 * 1024;
+        } else if (arg == "-h" || arg == "--help") {
+            return false;
+        } else if (!arg.empty() && arg[0] == '-') {
+            std::fprintf(stderr, "vikey-convert: unknown option '%s'\n", arg.c_str());
+            return false;
+        } else {
+            opt.inputs.push_back(arg);
+        }
+    }
+    return !opt.inputs.empty() && !opt.output.empty();
+}
+
+static std::string ConvertRange(const char* data, size_t size, VietEncoding from, VietEncoding to) {
+    std::wstring text = EncodingConverter::DecodeBytes(data, size, from);
+    std::wstring converted = EncodingConverter::Instance().Convert(text, from, to);
+    return EncodingConverter::EncodeBytes(converted, to);
+}
+
+static bool WriteParts(const fs::path& path, const std::vector<std::string>& parts) {
+    FILE* f = std::fopen(path.c_str(), "wb");
+    if (!f) return false;
+    bool ok = true;
+    for (const auto& part : parts) {
+        if (!part.empty() && std::fwrite(part.data(), 1, part.size(), f) != part.size()) {
+            ok = false;
+            break;
+        }
+    }
+    if (std::fclose(f) != 0) ok = false;
+    return ok;
+}
+
+static MarkupFormat FormatFor(const Options& opt, const fs::path& path) {
+    switch (opt.markup) {
+        case MarkupMode::Auto: return MarkupConverter::FormatForPath(path.string());
+        case MarkupMode::None: return MarkupFormat::Text;
+        case MarkupMode::Html: return MarkupFormat::Html;
+        case MarkupMode::Rtf: return MarkupFormat::Rtf;
+    }
+    return MarkupFormat::Text;
+}
+
+// Markup is converted sequentially, one piece at a time straight to the
+// output file, so memory stays bounded whatever the file size
+static void ConvertMarkupFile(FileJob& job, VietEncoding to, Stats& stats, bool quiet) {
+    FILE* f = std::fopen(job.outPath.c_str(), "wb");
+    bool ok = f != nullptr;
+    uint64_t outBytes = 0;
+    if (ok) {
+        MarkupConverter converter(job.format, job.from, to);
+        std::string out;
+        const char* data = job.input.Data();
+        size_t size = job.input.Size();
+        for (size_t begin = 0; ok && begin <= size; begin += MARKUP_PIECE_SIZE) {
+            out.clear();
+            if (begin < size) {
+                converter.Feed(data + begin, std::min(MARKUP_PIECE_SIZE, size - begin), out);
+            } else {
+                converter.Finish(out);
+            }
+            ok = out.empty() || std::fwrite(out.data(), 1, out.size(), f) == out.size();
+            outBytes += out.size();
+        }
+        if (std::fclose(f) != 0) ok = false;
+    }
+
+    if (ok) {
+        stats.bytesIn += job.input.Size();
+        stats.bytesOut += outBytes;
+        stats.filesDone++;
+        if (!quiet) {
+            std::fprintf(stderr, "  %s -> %s (%ls, %s)\n", job.inPath.c_str(), job.outPath.c_str(),
+                         EncodingConverter::GetEncodingName(job.from),
+                         job.format == MarkupFormat::Html ? "HTML" : "RTF");
+        }
+    } else {
+        stats.filesFailed++;
+        std::fprintf(stderr, "vikey-convert: cannot write %s\n", job.outPath.c_str());
+    }
+    job.input.Close();
+}
+
+static void FinishJob(FileJob& job, Stats& stats, bool quiet) {
+    uint64_t outBytes = 0;
+    for (const auto& part : job.parts) outBytes += part.size();
+
+    if (WriteParts(job.outPath, job.parts)) {
+        stats.bytesIn += job.input.Size();
+        stats.bytesOut += outBytes;
+        stats.filesDone++;
+        if (!quiet) {
+            std::fprintf(stderr, "  %s -> %s (%ls)\n", job.inPath.c_str(), job.outPath.c_str(),
+                         EncodingConverter::GetEncodingName(job.from));
+        }
+    } else {
+        stats.filesFailed++;
+        std::fprintf(stderr, "vikey-convert: cannot write %s\n", job.outPath.c_str());
+    }
+
+    // Release memory as soon as the file is on disk
+    job.parts.clear();
+    job.parts.shrink_to_fit();
+    job.input.Close();
+}
+
+// Expand inputs into (source, destination) pairs
+static bool CollectJobs(const Options& opt, std::vector<std::unique_ptr<FileJob>>& jobs) {
+    fs::path output(opt.output);
+    std::error_code ec;
+    bool outputIsDir = opt.inputs.size() > 1 || fs::is_directory(output, ec);
+
+    auto addJob = [&](const fs::path& in, const fs::path& out) {
+        auto job = std::make_unique<FileJob>();
+        job->inPath = in;
+        job->outPath = out;
+        jobs.push_back(std::move(job));
+    };
+
+    for (const auto& inputStr : opt.inputs) {
+        fs::path input(inputStr);
+        if (fs::is_directory(input, ec)) {
+            outputIsDir = true;
+            fs::path destRoot = (opt.inputs.size() > 1) ? output / input.filename() : output;
+
+            auto visit = [&](const fs::directory_entry& entry) {
+                if (!entry.is_regular_file(ec)) return;
+                addJob(entry.path(), destRoot / fs::relative(entry.path(), input, ec));
+            };
+            if (opt.recursive) {
+                for (const auto& entry : fs::recursive_directory_iterator(input, ec)) visit(entry);
+            } else {
+                for (const auto& entry : fs::directory_iterator(input, ec)) visit(entry);
+            }
+        } else if (fs::is_regular_file(input, ec)) {
+            addJob(input, outputIsDir ? output / input.filename() : output);
+        } else {
+            std::fprintf(stderr, "vikey-convert: no such file or directory: %s\n", inputStr.c_str());
+            return false;
+        }
+    }
+
+    for (const auto& job : jobs) {
+        if (fs::exists(job->outPath, ec) && fs::equivalent(job->inPath, job->outPath, ec)) {
+            std::fprintf(stderr, "vikey-convert: refusing to overwrite input %s\n", job->inPath.c_str());
+            return false;
+        }
+        fs::path parent = job->outPath.parent_path();
+        if (!parent.empty()) fs::create_directories(parent, ec);
+    }
+    return true;
+}
+
+int main(int argc, char** argv) {
+    Options opt;
+    if (!ParseArgs(argc, argv, opt)) {
+        PrintUsage();
+        return 2;
+    }
+
+    std::vector<std::unique_ptr<FileJob>> jobs;
+    if (!CollectJobs(opt, jobs)) return 1;
+
+    Stats stats;
+    auto start = std::chrono::steady_clock::now();
+    WorkStealingPool pool(opt.threads);
+
+    for (auto& jobPtr : jobs) {
+        FileJob* job = jobPtr.get();
+        pool.Submit([job, &opt, &stats, &pool]() {
+            if (!job->input.Open(job->inPath.string())) {
+                stats.filesFailed++;
+                std::fprintf(stderr, "vikey-convert: cannot read %s\n", job->inPath.c_str());
+                return;
+            }
+
+            const char* data = job->input.Data();
+            size_t size = job->input.Size();
+
+            // Detection reads a bounded sample, so it is cheap even for huge files.
+            // Files with nothing to go on (plain ASCII) are copied as they are.
+            job->from = opt.from;
+            if (opt.detect) {
+                EncodingGuess best = EncodingConverter::DetectBytes(data, size).front();
+                job->from = best.confidence > 0 ? best.encoding : opt.to;
+            }
+            const VietEncoding from = job->from;
+
+            job->format = FormatFor(opt, job->inPath);
+            if (job->format != MarkupFormat::Text && from != opt.to) {
+                ConvertMarkupFile(*job, opt.to, stats, opt.quiet);
+                return;
+            }
+
+            if (from == opt.to || size <= opt.chunkSize) {
+                job->parts.push_back(from == opt.to ? std::string(data, size)
+                                                    : ConvertRange(data, size, from, opt.to));
+                FinishJob(*job, stats, opt.quiet);
+                return;
+            }
+
+            // Large file: split at safe boundaries and let idle workers steal chunks
+            std::vector<std::pair<size_t, size_t>> ranges;
+            for (size_t begin = 0; begin < size;) {
+                size_t end = (size - begin > opt.chunkSize)
+                                 ? EncodingConverter::FindSplit(data, size, begin + opt.chunkSize, MAX_SPLIT_SEARCH, from)
+                                 : size;
+                ranges.emplace_back(begin, end);
+                begin = end;
+            }
+
+            job->parts.resize(ranges.size());
+            job->remaining = ranges.size();
+            for (size_t i = 0; i < ranges.size(); i++) {
+                size_t begin = ranges[i].first;
+                size_t end = ranges[i].second;
+                pool.Submit([job, i, begin, end, &opt, &stats]() {
+                    job->parts[i] = ConvertRange(job->input.Data() + begin, end - begin, job->from, opt.to);
+                    if (job->remaining.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                        FinishJob(*job, stats, opt.quiet);
+                    }
+                });
+            }
+        });
+    }
+
+    pool.Wait();
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    double mbIn = stats.bytesIn.load() / (1024.0 * 1024.0);
+    double mbOut = stats.bytesOut.load() / (1024.0 * 1024.0);
+    std::fprintf(stderr,
+        "Converted %zu file(s) (%zu failed): %.2f MiB in, %.2f MiB out in %.3f s "
+        "= %.1f MiB/s on %u thread(s), %zu steal(s)\n",
+        stats.filesDone.load(), stats.filesFailed.load(), mbIn, mbOut, seconds,
+        seconds > 0 ? mbIn / seconds : 0.0, pool.ThreadCount(), pool.StealCount());
+
+    return stats.filesFailed.load() == 0 ? 0 : 1;
+}
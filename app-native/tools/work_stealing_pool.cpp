@@ -0,0 +1,119 @@
+// ViKey - Work-Stealing Thread Pool Implementation
+// work_stealing_pool.cpp
+
+#include "work_stealing_pool.h"
+
+// Index of the pool worker running on this thread, or -1 for outside threads
+static thread_local int t_workerIndex = -1;
+static thread_local const WorkStealingPool* t_workerPool = nullptr;
+
+WorkStealingPool::WorkStealingPool(unsigned threads)
+    : m_queued(0)
+    , m_pending(0)
+    , m_stop(false)
+    , m_nextQueue(0)
+    , m_steals(0) {
+    if (threads == 0) threads = std::thread::hardware_concurrency();
+    if (threads == 0) threads = 1;
+
+    for (unsigned i = 0; i < threads; i++) {
+        m_workers.push_back(std::make_unique<Worker>());
+    }
+    for (unsigned i = 0; i < threads; i++) {
+        m_threads.emplace_back([this, i]() { Run(i); });
+    }
+}
+
+WorkStealingPool::~WorkStealingPool() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_wakeCv.notify_all();
+    for (auto& t : m_threads) {
+        t.join();
+    }
+}
+
+void WorkStealingPool::Submit(Task task) {
+    unsigned index;
+    if (t_workerPool == this && t_workerIndex >= 0) {
+        index = static_cast<unsigned>(t_workerIndex);
+    } else {
+        index = m_nextQueue.fetch_add(1, std::memory_order_relaxed) % m_workers.size();
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_workers[index]->mutex);
+        m_workers[index]->tasks.push_back(std::move(task));
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_queued++;
+        m_pending++;
+    }
+    m_wakeCv.notify_one();
+}
+
+void WorkStealingPool::Wait() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_doneCv.wait(lock, [this]() { return m_pending == 0; });
+}
+
+bool WorkStealingPool::TryPop(unsigned index, Task& task) {
+    Worker& w = *m_workers[index];
+    std::lock_guard<std::mutex> lock(w.mutex);
+    if (w.tasks.empty()) return false;
+    task = std::move(w.tasks.back());
+    w.tasks.pop_back();
+    return true;
+}
+
+bool WorkStealingPool::TrySteal(unsigned thief, Task& task) {
+    size_t n = m_workers.size();
+    for (size_t offset = 1; offset < n; offset++) {
+        Worker& victim = *m_workers[(thief + offset) % n];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.tasks.empty()) {
+            task = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+            m_steals.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+    return false;
+}
+
+void WorkStealingPool::Run(unsigned index) {
+    t_workerIndex = static_cast<int>(index);
+    t_workerPool = this;
+
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_wakeCv.wait(lock, [this]() { return m_stop || m_queued > 0; });
+            if (m_queued == 0) return;  // stopping and nothing left to run
+        }
+
+        Task task;
+        if (!TryPop(index, task) && !TrySteal(index, task)) {
+            // Another worker claimed it between the wake-up and the pop
+            std::this_thread::yield();
+            continue;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_queued--;
+        }
+
+        task();
+
+        bool done;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            done = (--m_pending == 0);
+        }
+        if (done) m_doneCv.notify_all();
+    }
+}
@@ -0,0 +1,61 @@
+// ViKey - Work-Stealing Thread Pool
+// work_stealing_pool.h
+// Per-worker task deques; idle workers steal from the others
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class WorkStealingPool {
+public:
+    using Task = std::function<void()>;
+
+    // threads == 0 uses std::thread::hardware_concurrency()
+    explicit WorkStealingPool(unsigned threads = 0);
+    ~WorkStealingPool();
+
+    // Queue a task. Called from a worker it goes to that worker's own deque
+    // (run LIFO for cache locality); otherwise deques are filled round-robin.
+    void Submit(Task task);
+
+    // Block until every submitted task, including ones submitted by tasks, has run
+    void Wait();
+
+    unsigned ThreadCount() const { return static_cast<unsigned>(m_threads.size()); }
+
+    // Number of tasks taken from another worker's deque (for diagnostics)
+    size_t StealCount() const { return m_steals.load(std::memory_order_relaxed); }
+
+private:
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+    struct Worker {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    void Run(unsigned index);
+    bool TryPop(unsigned index, Task& task);
+    bool TrySteal(unsigned thief, Task& task);
+
+    std::vector<std::unique_ptr<Worker>> m_workers;
+    std::vector<std::thread> m_threads;
+
+    std::mutex m_mutex;
+    std::condition_variable m_wakeCv;
+    std::condition_variable m_doneCv;
+    size_t m_queued;                  // tasks sitting in deques (guarded by m_mutex)
+    size_t m_pending;                 // tasks submitted but not finished (guarded by m_mutex)
+    bool m_stop;
+
+    std::atomic<unsigned> m_nextQueue;
+    std::atomic<size_t> m_steals;
+};
@@ -0,0 +1,85 @@
+//! First-keystroke latency, cold vs warmed
+//!
+//! Run with `cargo bench --bench first_key`.
+//!
+//! Lazy tables are built once per process, so every sample is a fresh child
+//! process typing its first word: "cold" straight after `ime_init`, "warm"
+//! after `ime_warmup` (which the Windows app runs on a background thread at
+//! startup, long before the first key).
+
+use std::process::Command;
+use std::time::Instant;
+use vikey_core::data::keys;
+use vikey_core::*;
+
+const RUNS: usize = 21;
+
+/// Telex "text ": the space looks the raw word up for English auto-restore
+const WORD: &[u16] = &[keys::T, keys::E, keys::X, keys::T, keys::SPACE];
+
+/// Type the first word; print the first key's and the slowest key's time (ns)
+fn child(warm: bool) {
+    ime_init();
+    ime_method(0);
+    ime_english_auto_restore(true);
+    if warm {
+        ime_warmup();
+    }
+
+    let mut first = 0;
+    let mut slowest = 0;
+    for (i, &key) in WORD.iter().enumerate() {
+        let start = Instant::now();
+        let r = ime_key(key, false, false);
+        let elapsed = start.elapsed().as_nanos();
+        unsafe { ime_free(r) };
+        if i == 0 {
+            first = elapsed;
+        }
+        slowest = slowest.max(elapsed);
+    }
+    println!("{} {}", first, slowest);
+}
+
+fn median(mut samples: Vec<u128>) -> f64 {
+    samples.sort_unstable();
+    samples[samples.len() / 2] as f64 / 1000.0
+}
+
+fn run(mode: &str) -> (f64, f64) {
+    let exe = std::env::current_exe().expect("current exe");
+    let mut firsts = Vec::with_capacity(RUNS);
+    let mut slowest = Vec::with_capacity(RUNS);
+    for _ in 0..RUNS {
+        let out = Command::new(&exe)
+            .args(["--child", mode])
+            .output()
+            .expect("run child");
+        let text = String::from_utf8_lossy(&out.stdout);
+        let mut fields = text.split_whitespace().map(|f| f.parse::<u128>().unwrap());
+        firsts.push(fields.next().unwrap());
+        slowest.push(fields.next().unwrap());
+    }
+    (median(firsts), median(slowest))
+}
+
+fn main() {
+    let args: Vec<String> = std::env::args().collect();
+    if let Some(i) = args.iter().position(|a| a == "--child") {
+        child(args.get(i + 1).map(String::as_str) == Some("warm"));
+        return;
+    }
+
+    println!(
+        "first word \"text \" after startup, median of {} processes",
+        RUNS
+    );
+    println!(
+        "{:<8}{:>16}{:>20}",
+        "", "first key (us)", "slowest key (us)"
+    );
+    for mode in ["cold", "warm"] {
+        let (first, slowest) = run(mode);
+        println!("{:<8}{:>16.1}{:>20.1}", mode, first, slowest);
+    }
+}
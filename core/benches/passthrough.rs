@@ -0,0 +1,268 @@
+//! FFI calls saved by the passthrough mask
+//!
+//! Run with `cargo bench --bench passthrough`.
+//!
+//! Replays a Telex typing session (sentences with typos, words deleted and
+//! retyped, ESC, arrow keys and Enter) the way the Windows hook feeds the
+//! engine: arrows, Tab and Enter only clear it, Space is processed and then
+//! clears it, every other key goes through `ime_key_ext`. The session runs
+//! twice, once calling in for every key and once answering keys in the last
+//! result's mask locally; both must produce the same output.
+
+use std::time::Instant;
+use vikey_core::data::keys;
+use vikey_core::engine::passthrough::mask_contains;
+use vikey_core::engine::FLAG_PASSTHROUGH_MASK;
+use vikey_core::*;
+
+const REPEAT: usize = 200;
+
+/// Telex input for a few paragraphs of everyday text
+const SENTENCES: &[&str] = &[
+    "Hoom nay tooi ddi lamf muoonj vif trowif muwa to.",
+    "Chungs ta caanf hoanf thanhf baos caos truwowcs thuws sau.",
+    "Banj cos the gui lai file ddinhs kem cho minhf khoong?",
+    "Cuoocj hopj bawts ddaauf luc 9 giowf 30, phongf 204.",
+    "Xin camr own, tooi ddax nhaanj dduwowcj email cuar banj.",
+    "Giaos vieen yeeu caauf hocj sinh ddocj kyx ddeef baif.",
+    "Thowif tieets Haf Nooij thangs 11 mats mer vaf dduj nawngs.",
+    "Neeus cos gif thay ddooir, vui long baos lai cho tooi nhes.",
+];
+
+#[derive(Clone, Copy)]
+enum Stroke {
+    Key(u16, bool),
+    /// Arrows, Tab, Enter: the hook clears the engine and passes them on
+    Clear,
+}
+
+fn key_for(c: char) -> (u16, bool) {
+    let key = match c.to_ascii_lowercase() {
+        'a' => keys::A,
+        'b' => keys::B,
+        'c' => keys::C,
+        'd' => keys::D,
+        'e' => keys::E,
+        'f' => keys::F,
+        'g' => keys::G,
+        'h' => keys::H,
+        'i' => keys::I,
+        'j' => keys::J,
+        'k' => keys::K,
+        'l' => keys::L,
+        'm' => keys::M,
+        'n' => keys::N,
+        'o' => keys::O,
+        'p' => keys::P,
+        'q' => keys::Q,
+        'r' => keys::R,
+        's' => keys::S,
+        't' => keys::T,
+        'u' => keys::U,
+        'v' => keys::V,
+        'w' => keys::W,
+        'x' => keys::X,
+        'y' => keys::Y,
+        'z' => keys::Z,
+        '0' => keys::N0,
+        '1' => keys::N1,
+        '2' => keys::N2,
+        '3' => keys::N3,
+        '4' => keys::N4,
+        '5' => keys::N5,
+        '6' => keys::N6,
+        '7' => keys::N7,
+        '8' => keys::N8,
+        '9' => keys::N9,
+        '.' => keys::DOT,
+        ',' => keys::COMMA,
+        '?' => keys::SLASH,
+        ' ' => keys::SPACE,
+        _ => panic!("no key for {:?}", c),
+    };
+    (key, c.is_ascii_uppercase() || c == '?')
+}
+
+/// Small deterministic generator, so every run replays the same session
+struct Lcg(u64);
+
+impl Lcg {
+    fn below(&mut self, n: u64) -> u64 {
+        self.0 = self
+            .0
+            .wrapping_mul(6364136223846793005)
+            .wrapping_add(1442695040888963407);
+        (self.0 >> 33) % n
+    }
+}
+
+fn session() -> Vec<Stroke> {
+    let mut rng = Lcg(42);
+    let mut strokes = Vec::new();
+    let backspaces = |strokes: &mut Vec<Stroke>, n: usize| {
+        strokes.extend(std::iter::repeat(Stroke::Key(keys::DELETE, false)).take(n));
+    };
+
+    for _ in 0..REPEAT {
+        for sentence in SENTENCES {
+            for (i, word) in sentence.split(' ').enumerate() {
+                if i > 0 {
+                    strokes.push(Stroke::Key(keys::SPACE, false));
+                }
+                for c in word.chars() {
+                    // A slipped finger, noticed at once
+                    if rng.below(40) == 0 {
+                        strokes.push(Stroke::Key(keys::K, false));
+                        backspaces(&mut strokes, 1);
+                    }
+                    let (key, caps) = key_for(c);
+                    strokes.push(Stroke::Key(key, caps));
+                }
+                match rng.below(30) {
+                    // Wrong word: hold Backspace over it, usually a little
+                    // too long, then fix the space and retype it
+                    0 | 1 => {
+                        let overshoot = rng.below(4) as usize;
+                        backspaces(&mut strokes, word.chars().count() + overshoot);
+                        if overshoot > 0 && i > 0 {
+                            strokes.push(Stroke::Key(keys::SPACE, false));
+                        }
+                        strokes.extend(word.chars().map(|c| {
+                            let (key, caps) = key_for(c);
+                            Stroke::Key(key, caps)
+                        }));
+                    }
+                    // Cancel the transform, or tap ESC out of habit
+                    2 => strokes.push(Stroke::Key(keys::ESC, false)),
+                    _ => {}
+                }
+            }
+            // Move around to check something, then carry on
+            if rng.below(4) == 0 {
+                let steps = 1 + rng.below(6) as usize;
+                strokes.extend(std::iter::repeat(Stroke::Clear).take(2 * steps));
+            }
+            strokes.push(Stroke::Clear); // Enter
+        }
+    }
+    strokes
+}
+
+/// What the hook does with one key's result
+#[derive(PartialEq, Debug)]
+struct Output {
+    action: u8,
+    backspace: u8,
+    chars: Vec<u32>,
+    consumed: bool,
+}
+
+const PASSED_ON: Output = Output {
+    action: 0,
+    backspace: 0,
+    chars: Vec::new(),
+    consumed: false,
+};
+
+struct Replay {
+    outputs: Vec<Output>,
+    key_calls: usize,
+    clear_calls: usize,
+    skipped: usize,
+    micros: f64,
+}
+
+fn replay(strokes: &[Stroke], use_mask: bool) -> Replay {
+    ime_init();
+    ime_method(0);
+    ime_clear_all();
+
+    let mut replay = Replay {
+        outputs: Vec::with_capacity(strokes.len()),
+        key_calls: 0,
+        clear_calls: 0,
+        skipped: 0,
+        micros: 0.0,
+    };
+    let mut mask = [0u64; 2];
+    let start = Instant::now();
+    for &stroke in strokes {
+        match stroke {
+            Stroke::Clear => {
+                ime_clear();
+                replay.clear_calls += 1;
+                mask = [0; 2];
+            }
+            Stroke::Key(key, caps) => {
+                if use_mask && mask_contains(&mask, key) {
+                    replay.skipped += 1;
+                    replay.outputs.push(PASSED_ON);
+                    continue;
+                }
+                let r = ime_key_ext(key, caps, false, false);
+                replay.key_calls += 1;
+                let result = unsafe { &*r };
+                replay.outputs.push(Output {
+                    action: result.action,
+                    backspace: result.backspace,
+                    chars: result.chars[..result.count as usize].to_vec(),
+                    consumed: result.key_consumed(),
+                });
+                mask = if result.flags & FLAG_PASSTHROUGH_MASK != 0 {
+                    result.passthrough
+                } else {
+                    [0; 2]
+                };
+                unsafe { ime_free(r) };
+                if key == keys::SPACE {
+                    ime_clear();
+                    replay.clear_calls += 1;
+                    mask = [0; 2];
+                }
+            }
+        }
+    }
+    replay.micros = start.elapsed().as_secs_f64() * 1e6;
+    replay
+}
+
+fn main() {
+    let strokes = session();
+    let keys_total = strokes
+        .iter()
+        .filter(|s| matches!(s, Stroke::Key(..)))
+        .count();
+
+    let every = replay(&strokes, false);
+    let masked = replay(&strokes, true);
+    assert_eq!(every.outputs.len(), masked.outputs.len());
+    for (i, (a, b)) in every.outputs.iter().zip(&masked.outputs).enumerate() {
+        assert_eq!(a, b, "keystroke {} differs", i);
+    }
+
+    let calls_every = every.key_calls + every.clear_calls;
+    let calls_masked = masked.key_calls + masked.clear_calls;
+    println!(
+        "{} keystrokes ({} to the engine), outputs identical",
+        strokes.len(),
+        keys_total
+    );
+    println!(
+        "{:<14}{:>12}{:>12}{:>14}",
+        "", "key calls", "all calls", "time (us)"
+    );
+    println!(
+        "{:<14}{:>12}{:>12}{:>14.0}",
+        "every key", every.key_calls, calls_every, every.micros
+    );
+    println!(
+        "{:<14}{:>12}{:>12}{:>14.0}",
+        "with mask", masked.key_calls, calls_masked, masked.micros
+    );
+    println!(
+        "skipped {} key calls: {:.2}% of key calls, {:.2}% of all FFI calls",
+        masked.skipped,
+        100.0 * masked.skipped as f64 / every.key_calls as f64,
+        100.0 * masked.skipped as f64 / calls_every as f64
+    );
+}
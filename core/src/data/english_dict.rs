@@ -17,6 +17,11 @@ static DICT: LazyLock<HashSet<&'static str>> = LazyLock::new(|| {
         .collect()
 });
 
+/// Build the dictionary now rather than on the first lookup
+pub fn warm_up() {
+    LazyLock::force(&DICT);
+}
+
 /// Check if a word is in the English dictionary (case-insensitive)
 pub fn is_english_word(word: &str) -> bool {
     let lower = word.to_lowercase();
@@ -50,6 +55,13 @@ mod tests {
         assert!(!is_english_word("đc"));
     }
 
+    #[test]
+    fn test_warm_up() {
+        warm_up();
+        warm_up(); // idempotent
+        assert!(is_english_word("view"));
+    }
+
     #[test]
     fn test_dict_size() {
         assert!(DICT.len() >= 17000); // Should have ~18k words (10k + double telex)
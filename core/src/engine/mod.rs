@@ -13,7 +13,9 @@
 //! 4. **Longest-Match-First**: For diacritic placement
 
 pub mod buffer;
+pub mod passthrough;
 pub mod shortcut;
+pub mod snapshot;
 pub mod syllable;
 pub mod transform;
 pub mod validation;
@@ -51,12 +53,20 @@ pub struct Result {
     /// Flags byte:
     /// - bit 0 (0x01): key_consumed - if set, the trigger key should NOT be passed through
     ///   Used for shortcuts where the trigger key is part of the replacement
+    /// - bit 1 (0x02): passthrough_mask - `passthrough` is filled in
     pub flags: u8,
+    /// Keycodes (< 128) the engine would pass through untouched after this
+    /// key, as a bitset: see `engine::passthrough`. Appended last, so callers
+    /// that predate it still read the fields above at the same offsets
+    pub passthrough: [u64; 2],
 }
 
 /// Flag: key was consumed by shortcut, don't pass through
 pub const FLAG_KEY_CONSUMED: u8 = 0x01;
 
+/// Flag: `passthrough` holds the engine's mask (set by the FFI key calls)
+pub const FLAG_PASSTHROUGH_MASK: u8 = 0x02;
+
 impl Result {
     pub fn none() -> Self {
         Self {
@@ -65,6 +75,7 @@ impl Result {
             backspace: 0,
             count: 0,
             flags: 0,
+            passthrough: [0; 2],
         }
     }
 
@@ -75,6 +86,7 @@ impl Result {
             backspace,
             count: chars.len().min(MAX) as u8,
             flags: 0,
+            passthrough: [0; 2],
         };
         for (i, &c) in chars.iter().take(MAX).enumerate() {
             result.chars[i] = c as u32;
@@ -154,6 +166,14 @@ impl WordHistory {
         Some(self.data[self.head].clone())
     }
 
+    /// Most recent buffer, left in history
+    fn last(&self) -> Option<&Buffer> {
+        if self.len == 0 {
+            return None;
+        }
+        Some(&self.data[(self.head + HISTORY_CAPACITY - 1) % HISTORY_CAPACITY])
+    }
+
     fn clear(&mut self) {
         self.len = 0;
         self.head = 0;
@@ -365,6 +385,30 @@ impl Default for Engine {
     }
 }
 
+/// Build the lazily initialized tables (the English dictionary) and touch
+/// the static ones (telex doubles, vowel and character tables), so the first
+/// word typed does not pay for either.
+///
+/// Types a few words into a scratch engine, so it can run on any thread
+/// while another engine is in use.
+pub fn warm_up() {
+    use keys::{E, I, J, N5, N6, SPACE, T, V, X};
+    // Telex "vieejt text ": a tone, a mark, and an English word to look up
+    const TELEX: &[u16] = &[V, I, E, E, J, T, SPACE, T, E, X, T, SPACE];
+    // VNI "vie65t "
+    const VNI: &[u16] = &[V, I, E, N6, N5, T, SPACE];
+
+    english_dict::warm_up();
+    for (method, word) in [(0, TELEX), (1, VNI)] {
+        let mut e = Engine::new();
+        e.set_method(method);
+        e.set_english_auto_restore(true);
+        for &key in word {
+            e.on_key(key, false, false);
+        }
+    }
+}
+
 impl Engine {
     pub fn new() -> Self {
         Self {
@@ -456,6 +500,8 @@ impl Engine {
         if !enabled {
             self.pending_capitalize = false;
             self.saw_sentence_ending = false;
+            // Or the next clear() would re-arm pending_capitalize
+            self.auto_capitalize_used = false;
         }
     }
 
@@ -6885,4 +6931,17 @@ mod tests {
             );
         }
     }
+
+    /// Turning auto-capitalize off mid-word must not leave a capital armed
+    /// for the next clear() to re-arm
+    #[test]
+    fn test_auto_capitalize_off_disarms() {
+        let mut e = Engine::new();
+        e.set_auto_capitalize(true);
+        assert_eq!(type_word(&mut e, "ok. a"), "ok. A");
+
+        e.set_auto_capitalize(false);
+        e.clear();
+        assert_eq!(type_word(&mut e, "b"), "b");
+    }
 }
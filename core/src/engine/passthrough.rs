@@ -0,0 +1,217 @@
+//! Passthrough key mask
+//!
+//! A 128-bit set of keycodes the engine is guaranteed to pass through in its
+//! current state: `on_key_ext` would return `Action::None` and leave the
+//! engine exactly as it is, whatever the Caps and Shift state. The FFI puts
+//! it in every key result, so the native apps can answer those keys without
+//! calling in again. The set is conservative: a key left out may still turn
+//! out to be a no-op.
+//!
+//! Typical members: Backspace once the word is gone and there is no
+//! committed word to restore, ESC and the arrows when nothing is being
+//! typed, and every key while disabled with nothing pending.
+
+use super::Engine;
+use crate::data::keys;
+
+/// Navigation keys: break keys without a character, neutral for auto-capitalize
+const NAVIGATION: [u16; 5] = [keys::LEFT, keys::RIGHT, keys::UP, keys::DOWN, keys::TAB];
+
+/// Whether `key` is in a mask returned by `Engine::passthrough_mask`
+pub fn mask_contains(mask: &[u64; 2], key: u16) -> bool {
+    key < 128 && mask[(key >> 6) as usize] & (1u64 << (key & 63)) != 0
+}
+
+fn mask_add(mask: &mut [u64; 2], key: u16) {
+    mask[(key >> 6) as usize] |= 1u64 << (key & 63);
+}
+
+impl Engine {
+    /// Keys that are guaranteed no-ops in the current state (see module docs)
+    pub fn passthrough_mask(&self) -> [u64; 2] {
+        let mut mask = [0u64; 2];
+        let no_history = self.word_history.len == 0 && self.spaces_after_commit == 0;
+
+        if !self.enabled {
+            // Every key clears the word and history, then feeds the shortcut
+            // prefix: keys without a character only clear the prefix
+            if self.buf.is_empty()
+                && self.raw_input.is_empty()
+                && no_history
+                && self.shortcut_prefix.is_empty()
+            {
+                for key in NAVIGATION {
+                    mask_add(&mut mask, key);
+                }
+                mask_add(&mut mask, keys::ESC);
+                mask_add(&mut mask, keys::DELETE);
+            }
+            return mask;
+        }
+
+        // ESC and navigation end the word: no-ops once there is none
+        if self.word_is_clear() && no_history {
+            for key in NAVIGATION {
+                mask_add(&mut mask, key);
+            }
+            mask_add(&mut mask, keys::ESC);
+        }
+
+        // Backspace past the start of the word only notes that the text
+        // before it is not tracked, which is already noted
+        if self.buf.is_empty()
+            && self.raw_input.is_empty()
+            && self.spaces_after_commit == 0
+            && self.has_non_letter_prefix
+            && self.last_transform.is_none()
+            && !self.stroke_reverted
+            && self.reverted_circumflex_key.is_none()
+            && !self.restored_pending_clear
+            && !self.auto_capitalize_used
+        {
+            mask_add(&mut mask, keys::DELETE);
+        }
+        mask
+    }
+
+    /// Every field `clear()` resets is already reset (and `clear()` would not
+    /// re-arm auto-capitalize)
+    fn word_is_clear(&self) -> bool {
+        self.buf.is_empty()
+            && self.raw_input.is_empty()
+            && self.last_transform.is_none()
+            && !self.has_non_letter_prefix
+            && self.pending_breve_pos.is_none()
+            && self.pending_u_horn_pos.is_none()
+            && !self.stroke_reverted
+            && !self.had_mark_revert
+            && !self.pending_mark_revert_pop
+            && !self.had_any_transform
+            && !self.had_vowel_triggered_circumflex
+            && !self.had_circumflex_revert
+            && self.reverted_circumflex_key.is_none()
+            && !self.had_telex_transform
+            && self.telex_double_raw.is_none()
+            && self.telex_double_raw_len == 0
+            && !self.restored_pending_clear
+            && !self.restored_is_ascii
+            && self.shortcut_prefix.is_empty()
+            && !self.auto_capitalize_used
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use crate::utils::char_to_key;
+
+    /// Everything a key can change, as far as later keys can tell
+    fn state(e: &Engine) -> (Vec<u8>, usize, bool, bool) {
+        let snapshot = e
+            .snapshot()
+            .map(|s| s.as_bytes().to_vec())
+            .unwrap_or_default();
+        (
+            snapshot,
+            e.word_history.len,
+            e.enabled,
+            e.pending_capitalize,
+        )
+    }
+
+    fn type_keys(e: &mut Engine, input: &[char]) {
+        for &c in input {
+            e.on_key_ext(char_to_key(c), c.is_uppercase(), false, false);
+        }
+    }
+
+    /// After every prefix of `input`, check that each key in the mask is a
+    /// no-op under every Caps/Shift combination. Engines are not Clone, so
+    /// each probe replays the prefix into a fresh one.
+    fn check_mask(setup: fn(&mut Engine), input: &str) -> usize {
+        let input: Vec<char> = input.chars().collect();
+        let mut checked = 0;
+        for end in 0..=input.len() {
+            let mut e = Engine::new();
+            setup(&mut e);
+            type_keys(&mut e, &input[..end]);
+            let mask = e.passthrough_mask();
+            let before = state(&e);
+
+            for key in (0..128u16).filter(|&key| mask_contains(&mask, key)) {
+                for (caps, shift) in [(false, false), (true, false), (false, true), (true, true)] {
+                    let mut probe = Engine::new();
+                    setup(&mut probe);
+                    type_keys(&mut probe, &input[..end]);
+                    let r = probe.on_key_ext(key, caps, false, shift);
+                    let typed: String = input[..end].iter().collect();
+                    assert_eq!(r.action, 0, "key {} after {:?}", key, typed);
+                    assert!(
+                        state(&probe) == before,
+                        "key {} changed state after {:?}",
+                        key,
+                        typed
+                    );
+                    checked += 1;
+                }
+            }
+        }
+        checked
+    }
+
+    #[test]
+    fn test_mask_keys_are_noops() {
+        fn enabled(e: &mut Engine) {
+            e.set_auto_capitalize(true);
+            e.set_esc_restore(true);
+        }
+        fn disabled(e: &mut Engine) {
+            e.set_enabled(false);
+        }
+        for input in [
+            "vieejt nam<<<<<<<<<<<<<",
+            "xin chaof. ban<<<<\x1b\x1bddaay",
+            "ab<<<<<<cd -= \x1b<<<<",
+            "tesst<<<<<<<<<x",
+        ] {
+            assert!(check_mask(enabled, input) > 0, "{:?}", input);
+        }
+        assert!(check_mask(disabled, "abc, xyz<<<\x1b") > 0);
+    }
+
+    #[test]
+    fn test_backspace_past_word() {
+        let mut e = Engine::new();
+        for key in [keys::A, keys::DELETE] {
+            e.on_key(key, false, false);
+        }
+        // The first backspace at an empty word notes the untracked text...
+        assert!(!mask_contains(&e.passthrough_mask(), keys::DELETE));
+        e.on_key(keys::DELETE, false, false);
+        // ...the rest are no-ops
+        assert!(mask_contains(&e.passthrough_mask(), keys::DELETE));
+        assert!(!mask_contains(&e.passthrough_mask(), keys::A));
+    }
+
+    #[test]
+    fn test_committed_word_blocks_mask() {
+        let mut e = Engine::new();
+        for key in [keys::A, keys::S, keys::SPACE] {
+            e.on_key(key, false, false);
+        }
+        // Backspace would restore "á", ESC and arrows would drop it
+        let mask = e.passthrough_mask();
+        assert!(!mask_contains(&mask, keys::DELETE));
+        assert!(!mask_contains(&mask, keys::ESC));
+        assert!(!mask_contains(&mask, keys::LEFT));
+    }
+
+    #[test]
+    fn test_mask_contains_bounds() {
+        let mut mask = [0u64; 2];
+        mask_add(&mut mask, 127);
+        mask_add(&mut mask, 0);
+        assert!(mask_contains(&mask, 127) && mask_contains(&mask, 0));
+        assert!(!mask_contains(&mask, 64) && !mask_contains(&mask, 128));
+    }
+}
@@ -0,0 +1,452 @@
+//! Word snapshot
+//!
+//! Everything the engine knows about the word being typed, in a fixed-size
+//! `#[repr(C)]` struct that can be copied out and back in as bytes. The native
+//! apps keep one per focused window, so switching away mid-word and back
+//! continues the same word instead of mixing it with another window's text.
+//!
+//! Settings (method aside) and shortcuts are not part of a snapshot: they are
+//! the same for every window.
+
+use super::buffer::{Buffer, Char};
+use super::{Engine, Transform};
+
+/// Longest word (and last committed word) a snapshot holds
+pub const SNAPSHOT_CHARS: usize = 32;
+/// Longest raw keystroke history a snapshot holds
+pub const SNAPSHOT_RAW: usize = 48;
+/// Longest shortcut symbol prefix, in UTF-8 bytes
+pub const SNAPSHOT_PREFIX: usize = 16;
+/// Size in bytes of `WordSnapshot`
+pub const SNAPSHOT_SIZE: usize = 664;
+
+/// "VKS" + layout version; bump the version when the layout changes
+const SNAPSHOT_MAGIC: u32 = 0x564B_5301;
+
+const NONE_POS: u8 = 0xFF;
+const NONE_KEY: u16 = 0xFFFF;
+const NONE_LEN: u8 = 0xFF;
+
+// Per-word flags
+const HAS_NON_LETTER_PREFIX: u16 = 1 << 0;
+const STROKE_REVERTED: u16 = 1 << 1;
+const HAD_MARK_REVERT: u16 = 1 << 2;
+const PENDING_MARK_REVERT_POP: u16 = 1 << 3;
+const HAD_ANY_TRANSFORM: u16 = 1 << 4;
+const HAD_VOWEL_TRIGGERED_CIRCUMFLEX: u16 = 1 << 5;
+const HAD_CIRCUMFLEX_REVERT: u16 = 1 << 6;
+const HAD_TELEX_TRANSFORM: u16 = 1 << 7;
+const RESTORED_PENDING_CLEAR: u16 = 1 << 8;
+const RESTORED_IS_ASCII: u16 = 1 << 9;
+const PENDING_CAPITALIZE: u16 = 1 << 10;
+const AUTO_CAPITALIZE_USED: u16 = 1 << 11;
+const SAW_SENTENCE_ENDING: u16 = 1 << 12;
+
+/// A buffer character
+#[repr(C)]
+#[derive(Clone, Copy, Default)]
+pub struct SnapshotChar {
+    key: u16,
+    caps: u8,
+    tone: u8,
+    mark: u8,
+    stroke: u8,
+}
+
+/// A raw keystroke (key, caps, shift)
+#[repr(C)]
+#[derive(Clone, Copy, Default)]
+pub struct SnapshotKey {
+    key: u16,
+    caps: u8,
+    shift: u8,
+}
+
+/// Per-word engine state. Plain integers only, laid out without padding, so
+/// any byte pattern of `SNAPSHOT_SIZE` bytes is a value; `Engine::restore`
+/// checks the contents before using them.
+#[repr(C)]
+#[derive(Clone, Copy)]
+pub struct WordSnapshot {
+    magic: u32,
+    method: u8,
+    buf_len: u8,
+    raw_len: u8,
+    history_len: u8,
+    flags: u16,
+    reverted_circumflex_key: u16,
+    transform_key: u16,
+    transform_kind: u8, // 0 = none, else Transform variant + 1
+    transform_value: u8,
+    pending_breve_pos: u8,
+    pending_u_horn_pos: u8,
+    spaces_after_commit: u8,
+    prefix_len: u8,
+    telex_double_len: u8, // NONE_LEN = no telex_double_raw
+    telex_double_raw_len: u8,
+    reserved: [u8; 2],
+    buf: [SnapshotChar; SNAPSHOT_CHARS],
+    history: [SnapshotChar; SNAPSHOT_CHARS], // last committed word, for backspace-after-space
+    raw: [SnapshotKey; SNAPSHOT_RAW],
+    telex_double_raw: [u8; SNAPSHOT_RAW],
+    shortcut_prefix: [u8; SNAPSHOT_PREFIX],
+}
+
+const _: () = assert!(std::mem::size_of::<WordSnapshot>() == SNAPSHOT_SIZE);
+
+impl WordSnapshot {
+    fn empty() -> Self {
+        Self {
+            magic: SNAPSHOT_MAGIC,
+            method: 0,
+            buf_len: 0,
+            raw_len: 0,
+            history_len: 0,
+            flags: 0,
+            reverted_circumflex_key: NONE_KEY,
+            transform_key: 0,
+            transform_kind: 0,
+            transform_value: 0,
+            pending_breve_pos: NONE_POS,
+            pending_u_horn_pos: NONE_POS,
+            spaces_after_commit: 0,
+            prefix_len: 0,
+            telex_double_len: NONE_LEN,
+            telex_double_raw_len: 0,
+            reserved: [0; 2],
+            buf: [SnapshotChar::default(); SNAPSHOT_CHARS],
+            history: [SnapshotChar::default(); SNAPSHOT_CHARS],
+            raw: [SnapshotKey::default(); SNAPSHOT_RAW],
+            telex_double_raw: [0; SNAPSHOT_RAW],
+            shortcut_prefix: [0; SNAPSHOT_PREFIX],
+        }
+    }
+
+    /// The snapshot's bytes, to be stored as they are
+    pub fn as_bytes(&self) -> &[u8; SNAPSHOT_SIZE] {
+        // SAFETY: repr(C) with only integer fields and no padding (size checked above)
+        unsafe { &*(self as *const Self as *const [u8; SNAPSHOT_SIZE]) }
+    }
+
+    /// A snapshot from bytes written by `as_bytes`; None if the size is wrong
+    pub fn from_bytes(bytes: &[u8]) -> Option<Self> {
+        if bytes.len() != SNAPSHOT_SIZE {
+            return None;
+        }
+        // SAFETY: every bit pattern is a valid WordSnapshot
+        Some(unsafe { std::ptr::read_unaligned(bytes.as_ptr() as *const Self) })
+    }
+}
+
+fn pack_chars(buf: &Buffer, out: &mut [SnapshotChar; SNAPSHOT_CHARS]) -> Option<u8> {
+    if buf.len() > SNAPSHOT_CHARS {
+        return None;
+    }
+    for (slot, c) in out.iter_mut().zip(buf.iter()) {
+        *slot = SnapshotChar {
+            key: c.key,
+            caps: c.caps as u8,
+            tone: c.tone,
+            mark: c.mark,
+            stroke: c.stroke as u8,
+        };
+    }
+    Some(buf.len() as u8)
+}
+
+fn unpack_chars(chars: &[SnapshotChar]) -> Buffer {
+    let mut buf = Buffer::new();
+    for c in chars {
+        let mut ch = Char::new(c.key, c.caps != 0);
+        ch.tone = c.tone;
+        ch.mark = c.mark;
+        ch.stroke = c.stroke != 0;
+        buf.push(ch);
+    }
+    buf
+}
+
+fn pack_pos(pos: Option<usize>) -> u8 {
+    pos.map_or(NONE_POS, |p| p as u8)
+}
+
+fn unpack_pos(pos: u8, len: usize) -> Option<Option<usize>> {
+    match pos {
+        NONE_POS => Some(None),
+        p if (p as usize) < len => Some(Some(p as usize)),
+        _ => None,
+    }
+}
+
+fn pack_transform(t: Option<Transform>) -> (u8, u16, u8) {
+    match t {
+        None => (0, 0, 0),
+        Some(Transform::Mark(key, value)) => (1, key, value),
+        Some(Transform::Tone(key, value)) => (2, key, value),
+        Some(Transform::Stroke(key)) => (3, key, 0),
+        Some(Transform::ShortPatternStroke) => (4, 0, 0),
+        Some(Transform::WAsVowel) => (5, 0, 0),
+        Some(Transform::WShortcutSkipped) => (6, 0, 0),
+        Some(Transform::BracketAsVowel) => (7, 0, 0),
+    }
+}
+
+fn unpack_transform(kind: u8, key: u16, value: u8) -> Option<Option<Transform>> {
+    Some(match kind {
+        0 => None,
+        1 => Some(Transform::Mark(key, value)),
+        2 => Some(Transform::Tone(key, value)),
+        3 => Some(Transform::Stroke(key)),
+        4 => Some(Transform::ShortPatternStroke),
+        5 => Some(Transform::WAsVowel),
+        6 => Some(Transform::WShortcutSkipped),
+        7 => Some(Transform::BracketAsVowel),
+        _ => return None,
+    })
+}
+
+impl Engine {
+    /// Snapshot the word being typed.
+    ///
+    /// Returns None if the word, its keystrokes or the shortcut prefix are
+    /// longer than a snapshot holds; the caller then starts over with
+    /// `clear_all` instead of restoring.
+    pub fn snapshot(&self) -> Option<WordSnapshot> {
+        let mut s = WordSnapshot::empty();
+        s.method = self.method;
+        s.buf_len = pack_chars(&self.buf, &mut s.buf)?;
+
+        if self.raw_input.len() > SNAPSHOT_RAW {
+            return None;
+        }
+        for (slot, &(key, caps, shift)) in s.raw.iter_mut().zip(&self.raw_input) {
+            *slot = SnapshotKey {
+                key,
+                caps: caps as u8,
+                shift: shift as u8,
+            };
+        }
+        s.raw_len = self.raw_input.len() as u8;
+
+        // Only the last committed word can be restored by backspace after a
+        // space; older history is dropped
+        if self.spaces_after_commit > 0 {
+            if let Some(last) = self.word_history.last() {
+                s.history_len = pack_chars(last, &mut s.history)?;
+            }
+        }
+        s.spaces_after_commit = self.spaces_after_commit;
+
+        let flags = [
+            (self.has_non_letter_prefix, HAS_NON_LETTER_PREFIX),
+            (self.stroke_reverted, STROKE_REVERTED),
+            (self.had_mark_revert, HAD_MARK_REVERT),
+            (self.pending_mark_revert_pop, PENDING_MARK_REVERT_POP),
+            (self.had_any_transform, HAD_ANY_TRANSFORM),
+            (
+                self.had_vowel_triggered_circumflex,
+                HAD_VOWEL_TRIGGERED_CIRCUMFLEX,
+            ),
+            (self.had_circumflex_revert, HAD_CIRCUMFLEX_REVERT),
+            (self.had_telex_transform, HAD_TELEX_TRANSFORM),
+            (self.restored_pending_clear, RESTORED_PENDING_CLEAR),
+            (self.restored_is_ascii, RESTORED_IS_ASCII),
+            (self.pending_capitalize, PENDING_CAPITALIZE),
+            (self.auto_capitalize_used, AUTO_CAPITALIZE_USED),
+            (self.saw_sentence_ending, SAW_SENTENCE_ENDING),
+        ];
+        s.flags = flags
+            .iter()
+            .filter(|(set, _)| *set)
+            .fold(0, |acc, (_, bit)| acc | bit);
+
+        s.reverted_circumflex_key = self.reverted_circumflex_key.unwrap_or(NONE_KEY);
+        (s.transform_kind, s.transform_key, s.transform_value) =
+            pack_transform(self.last_transform);
+        s.pending_breve_pos = pack_pos(self.pending_breve_pos);
+        s.pending_u_horn_pos = pack_pos(self.pending_u_horn_pos);
+
+        if let Some(ref raw) = self.telex_double_raw {
+            if raw.len() > SNAPSHOT_RAW {
+                return None;
+            }
+            s.telex_double_raw[..raw.len()].copy_from_slice(raw.as_bytes());
+            s.telex_double_len = raw.len() as u8;
+        }
+        if self.telex_double_raw_len >= NONE_LEN as usize {
+            return None;
+        }
+        s.telex_double_raw_len = self.telex_double_raw_len as u8;
+
+        let prefix = self.shortcut_prefix.as_bytes();
+        if prefix.len() > SNAPSHOT_PREFIX {
+            return None;
+        }
+        s.shortcut_prefix[..prefix.len()].copy_from_slice(prefix);
+        s.prefix_len = prefix.len() as u8;
+
+        Some(s)
+    }
+
+    /// Continue the word in a snapshot, replacing the current one.
+    ///
+    /// Returns false, leaving the engine unchanged, if the snapshot is not
+    /// from this layout version, was taken with another input method, or is
+    /// inconsistent.
+    pub fn restore(&mut self, s: &WordSnapshot) -> bool {
+        if s.magic != SNAPSHOT_MAGIC || s.method != self.method {
+            return false;
+        }
+        let buf_len = s.buf_len as usize;
+        let history_len = s.history_len as usize;
+        let raw_len = s.raw_len as usize;
+        let prefix_len = s.prefix_len as usize;
+        if buf_len > SNAPSHOT_CHARS
+            || history_len > SNAPSHOT_CHARS
+            || raw_len > SNAPSHOT_RAW
+            || prefix_len > SNAPSHOT_PREFIX
+        {
+            return false;
+        }
+        let (Some(breve), Some(u_horn), Some(transform)) = (
+            unpack_pos(s.pending_breve_pos, buf_len),
+            unpack_pos(s.pending_u_horn_pos, buf_len),
+            unpack_transform(s.transform_kind, s.transform_key, s.transform_value),
+        ) else {
+            return false;
+        };
+        let telex_double_raw = match s.telex_double_len {
+            NONE_LEN => None,
+            len if (len as usize) <= SNAPSHOT_RAW => {
+                match std::str::from_utf8(&s.telex_double_raw[..len as usize]) {
+                    Ok(raw) => Some(raw.to_string()),
+                    Err(_) => return false,
+                }
+            }
+            _ => return false,
+        };
+        let Ok(prefix) = std::str::from_utf8(&s.shortcut_prefix[..prefix_len]) else {
+            return false;
+        };
+
+        self.clear_all();
+        self.buf = unpack_chars(&s.buf[..buf_len]);
+        self.raw_input.extend(
+            s.raw[..raw_len]
+                .iter()
+                .map(|k| (k.key, k.caps != 0, k.shift != 0)),
+        );
+        if history_len > 0 {
+            self.word_history
+                .push(unpack_chars(&s.history[..history_len]));
+        }
+        self.spaces_after_commit = s.spaces_after_commit;
+
+        let flag = |bit: u16| s.flags & bit != 0;
+        self.has_non_letter_prefix = flag(HAS_NON_LETTER_PREFIX);
+        self.stroke_reverted = flag(STROKE_REVERTED);
+        self.had_mark_revert = flag(HAD_MARK_REVERT);
+        self.pending_mark_revert_pop = flag(PENDING_MARK_REVERT_POP);
+        self.had_any_transform = flag(HAD_ANY_TRANSFORM);
+        self.had_vowel_triggered_circumflex = flag(HAD_VOWEL_TRIGGERED_CIRCUMFLEX);
+        self.had_circumflex_revert = flag(HAD_CIRCUMFLEX_REVERT);
+        self.had_telex_transform = flag(HAD_TELEX_TRANSFORM);
+        self.restored_pending_clear = flag(RESTORED_PENDING_CLEAR);
+        self.restored_is_ascii = flag(RESTORED_IS_ASCII);
+        self.pending_capitalize = flag(PENDING_CAPITALIZE);
+        self.auto_capitalize_used = flag(AUTO_CAPITALIZE_USED);
+        self.saw_sentence_ending = flag(SAW_SENTENCE_ENDING);
+
+        self.reverted_circumflex_key =
+            (s.reverted_circumflex_key != NONE_KEY).then_some(s.reverted_circumflex_key);
+        self.last_transform = transform;
+        self.pending_breve_pos = breve;
+        self.pending_u_horn_pos = u_horn;
+        self.telex_double_raw = telex_double_raw;
+        self.telex_double_raw_len = s.telex_double_raw_len as usize;
+        self.shortcut_prefix.push_str(prefix);
+        true
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use crate::utils::{type_word, type_word_on};
+
+    /// Type `before`, switch to another window and type there, come back and
+    /// type `after`: the screen must read as if nothing happened in between.
+    fn switch_mid_word(e: &mut Engine, before: &str, after: &str) -> String {
+        let screen = type_word(e, before);
+        let saved = WordSnapshot::from_bytes(e.snapshot().unwrap().as_bytes()).unwrap();
+
+        e.clear_all();
+        type_word(e, "khacs nuwax");
+
+        assert!(e.restore(&saved));
+        type_word_on(e, screen, after)
+    }
+
+    #[test]
+    fn test_restore_continues_word() {
+        let cases = [
+            ("vie", "ejt", "việt"),
+            ("tieeng", "s", "tiếng"),
+            ("as", "s", "as"),      // the mark is reverted, not re-applied
+            ("duo", "wcj", "dược"), // pending horn on u
+            ("ddd", "d", "ddd"),    // stroke reverted stays reverted
+            ("Nguyeexn", " ", "Nguyễn "),
+            ("chao", "f banj", "chào bạn"),
+        ];
+        for (before, after, expected) in cases {
+            let mut reference = Engine::new();
+            let uninterrupted = type_word(&mut reference, &format!("{}{}", before, after));
+
+            let mut e = Engine::new();
+            let screen = switch_mid_word(&mut e, before, after);
+            assert_eq!(screen, uninterrupted, "'{}' | '{}'", before, after);
+            assert_eq!(screen, expected, "'{}' | '{}'", before, after);
+        }
+    }
+
+    #[test]
+    fn test_restore_backspace_after_space() {
+        let mut e = Engine::new();
+        let screen = switch_mid_word(&mut e, "vieetj ", "<s");
+        assert_eq!(screen, "viết");
+    }
+
+    #[test]
+    fn test_restore_rejects_other_method() {
+        let mut e = Engine::new();
+        type_word(&mut e, "vie");
+        let saved = e.snapshot().unwrap();
+
+        e.set_method(1);
+        e.clear_all();
+        assert!(!e.restore(&saved));
+        assert!(e.get_buffer_string().is_empty());
+    }
+
+    #[test]
+    fn test_restore_rejects_bad_bytes() {
+        let mut e = Engine::new();
+        type_word(&mut e, "vie");
+        let mut bytes = *e.snapshot().unwrap().as_bytes();
+        assert!(WordSnapshot::from_bytes(&bytes[..SNAPSHOT_SIZE - 1]).is_none());
+
+        bytes[0] ^= 0xFF; // magic
+        assert!(!e.restore(&WordSnapshot::from_bytes(&bytes).unwrap()));
+        bytes[0] ^= 0xFF;
+        bytes[5] = SNAPSHOT_CHARS as u8 + 1; // buf_len
+        assert!(!e.restore(&WordSnapshot::from_bytes(&bytes).unwrap()));
+        assert_eq!(e.get_buffer_string(), "vie");
+    }
+
+    #[test]
+    fn test_snapshot_too_long() {
+        let mut e = Engine::new();
+        type_word(&mut e, &"n".repeat(SNAPSHOT_CHARS + 1));
+        assert!(e.snapshot().is_none());
+    }
+}
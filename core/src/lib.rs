@@ -28,7 +28,7 @@ pub mod input;
 pub mod updater;
 pub mod utils;
 
-use engine::{Engine, Result};
+use engine::{Engine, Result, FLAG_PASSTHROUGH_MASK};
 use std::sync::Mutex;
 
 // Global engine instance (thread-safe via Mutex)
@@ -56,6 +56,17 @@ pub extern "C" fn ime_init() {
     *guard = Some(Engine::new());
 }
 
+/// Build the engine's lazy tables ahead of the first keystroke.
+///
+/// The English auto-restore dictionary is otherwise built by the first word
+/// that needs it, inside the key handler. Call once after `ime_init`,
+/// preferably on a background thread: it does not take the engine lock, so
+/// keys can be processed meanwhile.
+#[no_mangle]
+pub extern "C" fn ime_warmup() {
+    engine::warm_up();
+}
+
 /// Process a key event and return the result.
 ///
 /// # Arguments
@@ -80,13 +91,22 @@ pub extern "C" fn ime_init() {
 pub extern "C" fn ime_key(key: u16, caps: bool, ctrl: bool) -> *mut Result {
     let mut guard = lock_engine();
     if let Some(ref mut e) = *guard {
-        let r = e.on_key(key, caps, ctrl);
+        let mut r = e.on_key(key, caps, ctrl);
+        publish_passthrough(e, &mut r);
         Box::into_raw(Box::new(r))
     } else {
         std::ptr::null_mut()
     }
 }
 
+/// Attach the keys that are no-ops after this one, so the caller can answer
+/// them without calling back in (see `engine::passthrough`). The mask holds
+/// for keys sent without Ctrl.
+fn publish_passthrough(e: &Engine, r: &mut Result) {
+    r.passthrough = e.passthrough_mask();
+    r.flags |= FLAG_PASSTHROUGH_MASK;
+}
+
 /// Process a key event with extended parameters.
 ///
 /// # Arguments
@@ -109,13 +129,40 @@ pub extern "C" fn ime_key(key: u16, caps: bool, ctrl: bool) -> *mut Result {
 pub extern "C" fn ime_key_ext(key: u16, caps: bool, ctrl: bool, shift: bool) -> *mut Result {
     let mut guard = lock_engine();
     if let Some(ref mut e) = *guard {
-        let r = e.on_key_ext(key, caps, ctrl, shift);
+        let mut r = e.on_key_ext(key, caps, ctrl, shift);
+        publish_passthrough(e, &mut r);
         Box::into_raw(Box::new(r))
     } else {
         std::ptr::null_mut()
     }
 }
 
+/// Feed keystrokes whose results the caller already has.
+///
+/// For callers that answer some keys from their own cache of earlier
+/// results: before using the engine again they bring it up to date with the
+/// keys it has not seen, in one call. Each stroke is packed as
+/// `keycode | caps << 16 | shift << 17`, processed as by `ime_key_ext`
+/// without Ctrl, and its result dropped.
+///
+/// # Safety
+/// `strokes` must point to `len` readable `u32` values.
+#[no_mangle]
+pub unsafe extern "C" fn ime_replay(strokes: *const u32, len: i64) {
+    if strokes.is_null() || len <= 0 {
+        return;
+    }
+    let strokes = std::slice::from_raw_parts(strokes, len as usize);
+
+    let mut guard = lock_engine();
+    if let Some(ref mut e) = *guard {
+        for &stroke in strokes {
+            let key = (stroke & 0xFFFF) as u16;
+            e.on_key_ext(key, stroke & (1 << 16) != 0, false, stroke & (1 << 17) != 0);
+        }
+    }
+}
+
 /// Set the input method.
 ///
 /// # Arguments
@@ -441,6 +488,72 @@ pub unsafe extern "C" fn ime_restore_word(word: *const std::os::raw::c_char) {
     }
 }
 
+// ============================================================
+// Snapshot FFI
+// ============================================================
+
+/// Copy the state of the word being typed into `out`.
+///
+/// Used when the foreground window changes mid-word: the native app keeps
+/// the bytes per window and hands them back to `ime_restore` when the
+/// window is focused again. The snapshot is a fixed-size POD
+/// (`engine::snapshot::SNAPSHOT_SIZE` bytes); treat it as opaque.
+///
+/// # Returns
+/// Number of bytes written: `SNAPSHOT_SIZE`, or 0 if `out` is too small,
+/// the engine is not initialized, or the word is too long to snapshot
+/// (start the window over with `ime_clear_all` instead).
+///
+/// # Safety
+/// `out` must point to valid memory of at least `max_len` bytes.
+#[no_mangle]
+pub unsafe extern "C" fn ime_snapshot(out: *mut u8, max_len: i64) -> i64 {
+    if out.is_null() || max_len < engine::snapshot::SNAPSHOT_SIZE as i64 {
+        return 0;
+    }
+
+    let guard = lock_engine();
+    if let Some(ref e) = *guard {
+        match e.snapshot() {
+            Some(snapshot) => {
+                let bytes = snapshot.as_bytes();
+                std::ptr::copy_nonoverlapping(bytes.as_ptr(), out, bytes.len());
+                bytes.len() as i64
+            }
+            None => 0,
+        }
+    } else {
+        0
+    }
+}
+
+/// Continue the word saved by `ime_snapshot`, replacing the current one.
+///
+/// # Returns
+/// `true` if restored; `false` (engine unchanged) if the bytes are not a
+/// snapshot of this engine version, were taken with another input method,
+/// or the engine is not initialized.
+///
+/// # Safety
+/// `data` must point to `len` readable bytes.
+#[no_mangle]
+pub unsafe extern "C" fn ime_restore(data: *const u8, len: i64) -> bool {
+    if data.is_null() || len <= 0 {
+        return false;
+    }
+    let bytes = std::slice::from_raw_parts(data, len as usize);
+    let Some(snapshot) = engine::snapshot::WordSnapshot::from_bytes(bytes) else {
+        return false;
+    };
+
+    let mut guard = lock_engine();
+    if let Some(ref mut e) = *guard {
+        e.restore(&snapshot)
+    } else {
+        false
+    }
+}
+
 // ============================================================
 // Tests
 // ============================================================
@@ -741,6 +854,132 @@ mod tests {
         ime_clear();
     }
 
+    #[test]
+    #[serial]
+    fn test_warmup_ffi() {
+        ime_init();
+        ime_warmup();
+
+        // The engine in use is untouched
+        let r = ime_key(keys::A, false, false);
+        assert!(!r.is_null());
+        unsafe { ime_free(r) };
+        let mut out = [0u32; 4];
+        assert_eq!(
+            unsafe { ime_get_buffer(out.as_mut_ptr(), out.len() as i64) },
+            1
+        );
+
+        ime_clear();
+    }
+
+    #[test]
+    #[serial]
+    fn test_snapshot_ffi_roundtrip() {
+        ime_init();
+        ime_method(0); // Telex
+
+        // "vie" in one window
+        for key in [keys::V, keys::I, keys::E] {
+            unsafe { ime_free(ime_key(key, false, false)) };
+        }
+        let mut saved = [0u8; 1024];
+        let len = unsafe { ime_snapshot(saved.as_mut_ptr(), saved.len() as i64) };
+        assert_eq!(len as usize, engine::snapshot::SNAPSHOT_SIZE);
+        let mut small = [0u8; 16];
+        assert_eq!(
+            unsafe { ime_snapshot(small.as_mut_ptr(), small.len() as i64) },
+            0
+        );
+
+        // Another window, then back
+        ime_clear_all();
+        unsafe { ime_free(ime_key(keys::A, false, false)) };
+        assert!(unsafe { ime_restore(saved.as_ptr(), len) });
+        assert!(!unsafe { ime_restore(saved.as_ptr(), len - 1) });
+        assert!(!unsafe { ime_restore(std::ptr::null(), len) });
+
+        // "e" continues "vie" to "viê"
+        let r = ime_key(keys::E, false, false);
+        assert!(!r.is_null());
+        let mut out = [0u32; 8];
+        let n = unsafe { ime_get_buffer(out.as_mut_ptr(), out.len() as i64) };
+        let word: String = out[..n as usize]
+            .iter()
+            .filter_map(|&c| char::from_u32(c))
+            .collect();
+        assert_eq!(word, "viê");
+        unsafe { ime_free(r) };
+
+        ime_clear();
+    }
+
+    #[test]
+    #[serial]
+    fn test_passthrough_mask_ffi() {
+        use engine::passthrough::mask_contains;
+        ime_init();
+        ime_method(0); // Telex
+        ime_clear_all();
+
+        // Native callers read the mask at a fixed offset after the flags
+        assert_eq!(std::mem::offset_of!(Result, passthrough), 1032);
+        assert_eq!(std::mem::size_of::<Result>(), 1048);
+
+        // "a", then backspace twice: the second leaves nothing to delete
+        let mut last = [0u64; 2];
+        for key in [keys::A, keys::DELETE, keys::DELETE] {
+            let r = ime_key_ext(key, false, false, false);
+            assert!(!r.is_null());
+            let result = unsafe { &*r };
+            assert!(result.flags & FLAG_PASSTHROUGH_MASK != 0);
+            last = result.passthrough;
+            unsafe { ime_free(r) };
+        }
+        assert!(mask_contains(&last, keys::DELETE));
+
+        // Typing a letter takes it away again
+        let r = ime_key(keys::A, false, false);
+        assert!(!mask_contains(unsafe { &(*r).passthrough }, keys::DELETE));
+        unsafe { ime_free(r) };
+
+        ime_clear();
+    }
+
+    #[test]
+    #[serial]
+    fn test_replay_ffi() {
+        ime_init();
+        ime_method(0); // Telex
+
+        // "vieje" as keys answered elsewhere, then "t" through the engine
+        let strokes: Vec<u32> = [keys::V, keys::I, keys::E, keys::E, keys::J]
+            .iter()
+            .map(|&k| k as u32)
+            .collect();
+        unsafe { ime_replay(strokes.as_ptr(), strokes.len() as i64) };
+        let r = ime_key_ext(keys::T, false, false, false);
+        unsafe { ime_free(r) };
+
+        let mut out = [0u32; 8];
+        let n = unsafe { ime_get_buffer(out.as_mut_ptr(), out.len() as i64) };
+        let word: String = out[..n as usize]
+            .iter()
+            .filter_map(|&c| char::from_u32(c))
+            .collect();
+        assert_eq!(word, "việt");
+
+        // Caps and Shift bits
+        ime_clear();
+        let upper = [keys::A as u32 | 1 << 16, keys::N as u32 | 1 << 17];
+        unsafe { ime_replay(upper.as_ptr(), upper.len() as i64) };
+        let n = unsafe { ime_get_buffer(out.as_mut_ptr(), out.len() as i64) };
+        assert_eq!(&out[..n as usize], &['A' as u32, 'n' as u32]);
+
+        unsafe { ime_replay(std::ptr::null(), 3) };
+        ime_clear();
+    }
+
     #[test]
     #[serial]
     fn test_restore_word_ffi_null_safety() {
@@ -235,7 +235,11 @@ mod test_utils {
 
     /// Simulate typing, returns screen output
     pub fn type_word(e: &mut Engine, input: &str) -> String {
-        let mut screen = String::new();
+        type_word_on(e, String::new(), input)
+    }
+
+    /// Simulate typing after `screen`, returns screen output
+    pub fn type_word_on(e: &mut Engine, mut screen: String, input: &str) -> String {
         for c in input.chars() {
             // Detect shifted symbols and get proper (key, shift) pair
             // NOTE: '<' is NOT included here - it maps to DELETE in test utilities